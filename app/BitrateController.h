@@ -0,0 +1,102 @@
+#pragma once
+
+#include "UdpSender.h"
+
+#include <stdint.h>
+#include <atomic>
+
+using namespace std;
+
+// 闭环自适应码率控制：根据接收端周期性报告的丢包率、单向时延梯度和接收速率估计可用带宽，
+// 输出编码器目标码率和单帧大小上限。时延梯度持续为正说明瓶颈队列在增长，先于丢包降低码率，
+// 使链路保持在最小排队时延附近
+class BitrateController {
+public:
+    struct Config {
+        bool enabled = false;
+        unsigned int minBitrateKbps = 1000;
+        unsigned int maxBitrateKbps = 0;        // 0表示以初始码率为上限
+        double overuseGradientUsPerS = 10000.0; // 时延趋势超过该值视为过载（超出容量8%时约为80000）
+        unsigned int overuseReports = 2;        // 连续过载的报告数
+        double decreaseFactor = 0.85;           // 过载时目标码率 = 接收速率 × 该系数
+        double increasePerSecond = 0.08;        // 远离已知容量时的乘性增长率
+        unsigned int additiveIncreaseKbps = 500; // 接近已知容量时每秒的加性增长
+        double lossLow = 0.02;                  // 低于该丢包率才允许增长
+        double lossHigh = 0.10;                 // 高于该丢包率按丢包比例降低码率
+        double frameSizeFrames = 1.0;           // 单帧大小上限（以平均帧大小计）
+    };
+
+    enum class State {
+        Increase,
+        Hold,
+        Decrease
+    };
+
+    struct Stats {
+        uint64_t reports;
+        uint64_t overuses;          // 因时延梯度降低码率的次数
+        uint64_t lossDecreases;     // 因丢包降低码率的次数
+        uint32_t targetBitrateKbps;
+        uint32_t maxFrameBytes;
+        uint32_t receiveRateKbps;   // 平滑后的接收速率
+        double lossRate;            // 最近一次报告的丢包率
+        double delayGradientUsPerS; // 累计排队时延的趋势斜率
+        State state;
+    };
+
+    BitrateController();
+
+    // 初始码率通常为配置的编码码率
+    void configure(const Config& config, unsigned int startBitrateKbps, unsigned int frameRate);
+
+    // 处理一个接收报告（由发送线程调用）
+    void onReport(const UdpSender::ReceiverReport& report);
+
+    // 编码线程读取当前目标，只在变化超过一定比例时更新，避免频繁重配置编码器
+    uint32_t getTargetBitrate() const { return targetKbps.load(std::memory_order_relaxed); }
+    uint32_t getMaxFrameBytes() const { return maxFrameBytes.load(std::memory_order_relaxed); }
+
+    // 编码线程也会读取，取自原子量而不是config（发送线程重新配置时会整体改写config）
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+    Stats getStats() const;
+
+    static const char* stateName(State state);
+
+private:
+    // 时延趋势拟合窗口（报告数）。单个关键帧造成的排队先升后降，在窗口内相互抵消
+    static const unsigned int kTrendWindow = 20;
+
+    // 启动时和手动修改码率时由发送线程整体改写，其他线程只通过原子量读取
+    Config config;
+    unsigned int frameRate;
+
+    // 以下仅由发送线程访问
+    double bitrate;             // 当前估计（kbps）
+    double receiveRate;         // 平滑后的接收速率（kbps）
+    double gradient;            // 累计排队时延的趋势斜率（微秒/秒）
+    double accumulatedDelay;    // 各报告时延梯度 × 区间长度的累计值（微秒）
+    double smoothedDelay;       // 累计值的指数平滑，单个关键帧的排队尖峰被压低后再拟合
+    double trendTime[kTrendWindow];
+    double trendDelay[kTrendWindow];
+    unsigned int trendCount;
+    double capacity;            // 最近一次过载时的接收速率，作为链路容量估计
+    unsigned int overuseCount;
+    uint64_t lastReportTimeUs;
+    uint32_t lastSequence;
+    bool haveReport;
+
+    void updateTrend(double timeSeconds, double delayUs);
+    void publish();
+
+    // 输出与统计（发送线程写入，其他线程读取）
+    std::atomic<bool> enabled;
+    std::atomic<uint32_t> targetKbps;
+    std::atomic<uint32_t> maxFrameBytes;
+    std::atomic<uint64_t> reports;
+    std::atomic<uint64_t> overuses;
+    std::atomic<uint64_t> lossDecreases;
+    std::atomic<uint32_t> receiveRateKbps;
+    std::atomic<uint32_t> lossPermille;
+    std::atomic<int32_t> gradientUsPerS;
+    std::atomic<State> state;
+};
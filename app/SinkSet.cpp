@@ -0,0 +1,427 @@
+#include "SinkSet.h"
+#include <iostream>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <sstream>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 开启分包节奏控制时每次最多连续发出的分包数
+const unsigned int kBurstPackets = 4;
+
+// 休眠到目标时刻前这段时间改为自旋（Windows默认时钟分辨率下休眠误差可达数毫秒）
+const uint64_t kSpinUs = 2000;
+
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+void sleepUntil(uint64_t targetUs) {
+    uint64_t now = nowMicros();
+    if (targetUs > now + kSpinUs) {
+        std::this_thread::sleep_for(std::chrono::microseconds(targetUs - now - kSpinUs));
+    }
+    while (nowMicros() < targetUs) {
+        std::this_thread::yield();
+    }
+}
+
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+SinkSet::SinkSet()
+    : running(false),
+      latency(nullptr),
+      threadTuning(nullptr) {
+}
+
+SinkSet::~SinkSet() {
+    try {
+        stop();
+    } catch (const std::exception& e) {
+        std::cerr << "Error in SinkSet destructor: " << e.what() << std::endl;
+    }
+}
+
+bool SinkSet::start(const Config& cfg, const std::vector<Destination>& destinations) {
+    try {
+        if (running) {
+            std::cerr << "Sink set already running" << std::endl;
+            return false;
+        }
+        if (destinations.empty()) {
+            std::cerr << "No destinations configured" << std::endl;
+            return false;
+        }
+
+        config = cfg;
+        config.fps = std::max(config.fps, 1);
+        config.queueSize = std::max(config.queueSize, 1);
+        config.pacingPercent = std::min(std::max(config.pacingPercent, 0), 100);
+
+        if (config.rtpOutput) {
+            RtpPacketizer::Config rtpConfig;
+            rtpConfig.enabled = true;
+            std::lock_guard<std::mutex> lock(rtpMutex);
+            rtpPacketizer.configure(rtpConfig, static_cast<unsigned int>(config.maxPacketSize));
+            std::cout << "RTP output enabled, max packet size " << config.maxPacketSize << " bytes" << std::endl;
+        }
+
+        sinks.clear();
+        outFramePool.resetStats();
+        for (const Destination& destination : destinations) {
+            std::unique_ptr<Sink> sink(new Sink());
+            sink->destination = destination;
+            sink->dropPolicy.configure(config.frameDrop);
+            sink->sender.setMulticastTtl(config.multicastTtl);
+            if (!sink->sender.initialize(destination.ip, destination.port)) {
+                std::cerr << "Failed to initialize destination " << destination.ip << ":" << destination.port << std::endl;
+                sinks.clear();
+                return false;
+            }
+            sinks.push_back(std::move(sink));
+        }
+
+        running = true;
+        for (auto& sink : sinks) {
+            if (!config.inlineSend) {
+                sink->thread = std::thread(&SinkSet::sinkThreadFunc, this, sink.get());
+            }
+        }
+
+        std::cout << "Sending to " << sinks.size() << " destination(s)" << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error starting sink set: " << e.what() << std::endl;
+        stop();
+        return false;
+    }
+}
+
+void SinkSet::stop() {
+    try {
+        running = false;
+        for (auto& sink : sinks) {
+            {
+                std::lock_guard<std::mutex> lock(sink->mutex);
+                sink->queue.clear();
+                sink->queueDepth.store(0, std::memory_order_relaxed);
+            }
+            sink->cv.notify_all();
+        }
+        for (auto& sink : sinks) {
+            if (sink->thread.joinable()) {
+                sink->thread.join();
+            }
+        }
+        sinks.clear();
+    } catch (const std::exception& e) {
+        std::cerr << "Error stopping sink set: " << e.what() << std::endl;
+    }
+}
+
+bool SinkSet::sendFrame(const FrameBufferPool::Lease& buffer, const FrameDropPolicy::FrameInfo& info,
+                        const PipelineLatency::FrameTimes& times) {
+    try {
+        if (!running || !buffer || buffer->data.empty()) {
+            return false;
+        }
+
+        OutFrameLease frame = outFramePool.acquire();
+        frame->buffer = buffer;
+        frame->info = info;
+        frame->times = times;
+
+        if (config.rtpOutput) {
+            // RTP时间戳为采样时刻（RFC 6184）：取采集时刻，不带入编码和排队的抖动；未提供时退回当前时刻
+            const std::vector<uint8_t>& data = frame->buffer->data;
+            uint64_t timestampUs = frame->info.captureUs ? frame->info.captureUs : nowMicros();
+            std::lock_guard<std::mutex> lock(rtpMutex);
+            frame->packetCount = rtpPacketizer.packetize(data.data(), data.size(), timestampUs,
+                                                         frame->headers, frame->packets);
+            if (frame->packetCount == 0) {
+                std::cerr << "Frame contains no NAL units" << std::endl;
+                return false;
+            }
+        }
+
+        // run-to-completion：在本线程上依次发出，没有排队和唤醒
+        if (config.inlineSend) {
+            for (auto& sink : sinks) {
+                deliver(sink.get(), *frame, false, 0);
+            }
+            return true;
+        }
+
+        frame->times.mark(PipelineLatency::Point::SinkPublish);
+
+        // 每个目的地只增加一个引用，队列已满时挤掉该目的地队列中（含新帧）优先级最低的帧中最旧的一个
+        auto infoOf = [](const OutFrameLease& queued) { return queued->info; };
+        for (auto& sink : sinks) {
+            {
+                std::lock_guard<std::mutex> lock(sink->mutex);
+                sink->queue.push_back(frame);
+                if (sink->queue.size() > static_cast<size_t>(config.queueSize)) {
+                    size_t victim = FrameDropPolicy::selectVictim(sink->queue.begin(), sink->queue.end(), infoOf);
+                    sink->dropPolicy.drop(FrameDropPolicy::Stage::Send, FrameDropPolicy::Reason::QueueFull,
+                                          sink->queue[victim]->info);
+                    sink->queue.erase(sink->queue.begin() + victim);
+                }
+                sink->queueDepth.store(sink->queue.size(), std::memory_order_relaxed);
+            }
+            sink->cv.notify_one();
+        }
+
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error dispatching frame: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void SinkSet::sinkThreadFunc(Sink* sink) {
+    try {
+        if (threadTuning) {
+            threadTuning->applyToCurrentThread(ThreadTuning::Stage::Send, "sink " + sink->destination.ip + ":" +
+                                               std::to_string(sink->destination.port));
+        }
+
+        while (running) {
+            OutFrameLease frame;
+            bool backlog = false;
+            {
+                std::unique_lock<std::mutex> lock(sink->mutex);
+                sink->cv.wait(lock, [this, sink] {
+                    return !sink->queue.empty() || !running;
+                });
+
+                if (!running) {
+                    break;
+                }
+
+                frame = std::move(sink->queue.front());
+                sink->queue.pop_front();
+                backlog = !sink->queue.empty();
+                sink->queueDepth.store(sink->queue.size(), std::memory_order_relaxed);
+            }
+
+            deliver(sink, *frame, backlog, PipelineLatency::nowNanos());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal error in sink thread: " << e.what() << std::endl;
+    }
+}
+
+void SinkSet::deliver(Sink* sink, const OutFrame& frame, bool backlog, uint64_t takeNs) {
+    // 发送前：参考链已断开、已过截止时刻的帧不再发送；上一帧发送受阻或队列积压时丢弃非参考帧
+    bool congested = sink->lastFrameBlocked || backlog;
+    if (!sink->dropPolicy.admit(FrameDropPolicy::Stage::Send, frame.info, nowMicros(), congested)) {
+        return;
+    }
+
+    // 只追踪第一个目的地：各目的地共享分包结果，追踪记录复制一份再补上本目的地的时刻
+    bool traced = latency && sink == sinks.front().get();
+    PipelineLatency::FrameTimes times;
+    if (traced) {
+        times = frame.times;
+        times.set(PipelineLatency::Point::SinkTake, takeNs);
+    }
+
+    sink->lastFrameBlocked = !sendToSink(sink, frame, traced ? &times : nullptr);
+    if (!sink->lastFrameBlocked) {
+        sink->framesSent.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (traced) {
+        latency->record(times);
+    }
+}
+
+bool SinkSet::sendToSink(Sink* sink, const OutFrame& frame, PipelineLatency::FrameTimes* times) {
+    UdpSender& sender = sink->sender;
+    double limit = sink->destination.rateLimitKbps * 1000.0 / 8.0 / 1000000.0;
+
+    const std::vector<uint8_t>& data = frame.buffer->data;
+
+    // 整帧作为一个数据报：只受速率上限约束
+    if (frame.packetCount == 0) {
+        pace(sink, data.size(), limit);
+        if (!sender.sendPacket(data.data(), data.size())) {
+            sink->blockedSends.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (times) {
+            times->mark(PipelineLatency::Point::FirstPacket);
+            times->set(PipelineLatency::Point::LastPacket, times->at(PipelineLatency::Point::FirstPacket));
+        }
+        sink->bytesSent.fetch_add(data.size(), std::memory_order_relaxed);
+        sink->packetsSent.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 速率取"本帧字节数 / 发送窗口"，有速率上限时不超过上限
+    double rate = 0.0;
+    if (config.pacingPercent > 0) {
+        double windowUs = 1000000.0 / config.fps * config.pacingPercent / 100.0;
+        rate = data.size() / windowUs;
+    }
+    if (limit > 0.0) {
+        rate = rate > 0.0 ? std::min(rate, limit) : limit;
+    }
+    unsigned int burst = rate > 0.0 ? kBurstPackets : frame.packetCount;
+
+    for (unsigned int first = 0; first < frame.packetCount; first += burst) {
+        unsigned int count = std::min(burst, frame.packetCount - first);
+        size_t bytes = 0;
+        for (unsigned int i = first; i < first + count; i++) {
+            bytes += frame.packets[i].headerSize + frame.packets[i].payloadSize;
+        }
+
+        pace(sink, bytes, rate);
+        if (!running) {
+            return false;
+        }
+
+        unsigned int sent = sender.sendPackets(frame.headers.data(), frame.packets.data() + first, count);
+        if (times && sent > 0) {
+            // 批量提交时一次返回多个分包，第一个分包以第一次提交返回的时刻为准
+            if (first == 0) {
+                times->mark(PipelineLatency::Point::FirstPacket);
+            }
+            times->mark(PipelineLatency::Point::LastPacket);
+        }
+        for (unsigned int i = first; i < first + sent; i++) {
+            sink->bytesSent.fetch_add(frame.packets[i].headerSize + frame.packets[i].payloadSize,
+                                      std::memory_order_relaxed);
+        }
+        sink->packetsSent.fetch_add(sent, std::memory_order_relaxed);
+
+        // 与整帧发送一致：发送缓冲区满时放弃本帧剩余分包
+        if (sent < count) {
+            sink->blockedSends.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void SinkSet::pace(Sink* sink, size_t bytes, double bytesPerUs) {
+    if (bytesPerUs <= 0.0) {
+        return;
+    }
+
+    // 令牌桶：每个目的地独立记录下一次最早发送时刻，空闲期间不累积额度
+    uint64_t now = nowMicros();
+    if (sink->nextDepartureUs > now) {
+        sleepUntil(sink->nextDepartureUs);
+        sink->totalWaitUs.fetch_add(sink->nextDepartureUs - now, std::memory_order_relaxed);
+        now = sink->nextDepartureUs;
+    }
+    sink->nextDepartureUs = now + static_cast<uint64_t>(bytes / bytesPerUs);
+}
+
+bool SinkSet::parseDestinations(const std::string& list, int defaultPort, std::vector<Destination>& destinations) {
+    std::stringstream stream(list);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        item = trim(item);
+        if (item.empty()) {
+            continue;
+        }
+
+        Destination destination;
+        destination.port = defaultPort;
+
+        try {
+            size_t at = item.find('@');
+            if (at != std::string::npos) {
+                destination.rateLimitKbps = std::stoi(item.substr(at + 1));
+                item = item.substr(0, at);
+            }
+
+            size_t colon = item.find(':');
+            if (colon != std::string::npos) {
+                destination.port = std::stoi(item.substr(colon + 1));
+                item = item.substr(0, colon);
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid destination: " << item << std::endl;
+            return false;
+        }
+
+        destination.ip = trim(item);
+        if (destination.ip.empty() || destination.port <= 0 || destination.port > 65535 ||
+            destination.rateLimitKbps < 0) {
+            std::cerr << "Invalid destination: " << item << std::endl;
+            return false;
+        }
+        destinations.push_back(destination);
+    }
+
+    return true;
+}
+
+bool SinkSet::takeKeyframeRequest() {
+    bool requested = false;
+    for (auto& sink : sinks) {
+        // 每个目的地的请求都要取走，避免同一次丢帧触发两次IDR
+        requested = sink->dropPolicy.takeKeyframeRequest() || requested;
+    }
+    return requested;
+}
+
+UdpSender* SinkSet::primary() {
+    return sinks.empty() ? nullptr : &sinks.front()->sender;
+}
+
+std::string SinkSet::getSdp() const {
+    if (sinks.empty()) {
+        return "";
+    }
+
+    const UdpSender& sender = sinks.front()->sender;
+    std::lock_guard<std::mutex> lock(rtpMutex);
+    return rtpPacketizer.generateSdp(sender.getTargetIp(), static_cast<unsigned int>(sender.getPort()),
+                                     static_cast<unsigned int>(config.fps));
+}
+
+std::vector<SinkSet::SinkStats> SinkSet::getStats() const {
+    std::vector<SinkStats> result;
+    result.reserve(sinks.size());
+
+    for (const auto& sink : sinks) {
+        SinkStats stats;
+        stats.address = sink->destination.ip + ":" + std::to_string(sink->destination.port);
+        stats.multicast = sink->sender.isMulticast();
+        stats.rateLimitKbps = sink->destination.rateLimitKbps;
+        stats.framesSent = sink->framesSent.load(std::memory_order_relaxed);
+        stats.drops = sink->dropPolicy.getStats();
+        stats.framesDropped = stats.drops.total();
+        stats.blockedSends = sink->blockedSends.load(std::memory_order_relaxed);
+        stats.sendErrors = sink->sender.getSendErrors();
+        stats.queueDepth = sink->queueDepth.load(std::memory_order_relaxed);
+        stats.bytesSent = sink->bytesSent.load(std::memory_order_relaxed);
+        stats.packetsSent = sink->packetsSent.load(std::memory_order_relaxed);
+        stats.totalWaitUs = sink->totalWaitUs.load(std::memory_order_relaxed);
+        result.push_back(stats);
+    }
+
+    return result;
+}
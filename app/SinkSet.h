@@ -0,0 +1,163 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "UdpSender.h"
+#include "RtpPacketizer.h"
+#include "FrameDropPolicy.h"
+#include "FramePool.h"
+#include "PipelineLatency.h"
+#include "ThreadTuning.h"
+
+// 一次编码、多路发送：每帧只分包一次，分包结果由所有目的地共享；
+// 每个目的地有独立的套接字、发送线程、帧队列、分包节奏和统计。
+// 某个目的地发送过慢时只丢弃它自己队列中的帧（先丢低优先级的），不阻塞其他目的地；
+// 各目的地分别跟踪参考链，丢弃参考帧后请求编码器插入IDR
+class SinkSet {
+public:
+    struct Destination {
+        std::string ip;
+        int port = 0;
+        int rateLimitKbps = 0;      // 该目的地的发送速率上限，0表示不限
+    };
+
+    struct Config {
+        bool rtpOutput = false;
+        int maxPacketSize = 1400;
+        int multicastTtl = 1;
+        int fps = 60;
+        int pacingPercent = 0;      // 每帧分包在帧间隔的这一百分比内发完，0表示不控制
+        int queueSize = 2;          // 每个目的地最多排队的帧数
+        bool inlineSend = false;    // 在调用sendFrame的线程上依次发给各目的地，不启动发送线程（run-to-completion）
+        FrameDropPolicy::Config frameDrop;
+    };
+
+    struct SinkStats {
+        std::string address;
+        bool multicast;
+        int rateLimitKbps;
+        uint64_t framesSent;
+        uint64_t framesDropped;     // 未发送的帧（队列已满、过期、拥塞或参考帧丢失）
+        uint64_t blockedSends;      // 发送缓冲区满、丢弃本帧剩余分包的次数
+        uint64_t sendErrors;        // 发送缓冲区满以外的套接字错误
+        size_t queueDepth;          // 当前排队等待发送的帧数
+        FrameDropPolicy::Stats drops;   // 按原因和帧类型统计的丢帧
+        uint64_t bytesSent;
+        uint64_t packetsSent;
+        uint64_t totalWaitUs;       // 分包节奏控制的累计等待时间
+    };
+
+    SinkSet();
+    ~SinkSet();
+
+    bool start(const Config& config, const std::vector<Destination>& destinations);
+    void stop();
+
+    // 分包一次后分发给所有目的地，各目的地共享同一缓冲区，不做复制；info携带截止时刻和优先级。
+    // 所有目的地发送完（或丢弃）后缓冲区回到池中。第一个目的地发完后补上目的地队列和分包发出的追踪点，
+    // 把times交给setLatency设置的记录器
+    bool sendFrame(const FrameBufferPool::Lease& buffer, const FrameDropPolicy::FrameInfo& info,
+                   const PipelineLatency::FrameTimes& times);
+
+    // 逐帧延迟的记录器，start之前设置
+    void setLatency(PipelineLatency* recorder) { latency = recorder; }
+
+    // 各目的地发送线程按发送阶段的设置调整调度，start之前设置
+    void setThreadTuning(ThreadTuning* tuning) { threadTuning = tuning; }
+
+    // 任一目的地丢弃了参考帧时返回true（编码线程在编码前调用）
+    bool takeKeyframeRequest();
+
+    // 解析"ip:port[@kbps]"的逗号分隔列表，空字符串得到空列表
+    static bool parseDestinations(const std::string& list, int defaultPort, std::vector<Destination>& destinations);
+
+    // 第一个目的地：接收报告从它的套接字读取
+    UdpSender* primary();
+
+    // RTP模式下描述本流的SDP（地址为第一个目的地），发送过关键帧后带参数集
+    std::string getSdp() const;
+
+    size_t size() const { return sinks.size(); }
+
+    // 只读取各目的地的原子计数，不取队列锁，可在统计线程和界面线程上调用
+    std::vector<SinkStats> getStats() const;
+
+    // 分包结果池的统计（稳态下allocations()不再增长）
+    FramePoolStats getPoolStats() const { return outFramePool.getStats(); }
+
+private:
+    // 一帧的共享分包结果，发送线程只读；从池中借出，分包头和分包表的容量随之复用
+    struct OutFrame {
+        FrameBufferPool::Lease buffer;
+        std::vector<uint8_t> headers;
+        std::vector<RtpPacketizer::Packet> packets;
+        unsigned int packetCount = 0;
+        FrameDropPolicy::FrameInfo info;
+        PipelineLatency::FrameTimes times;
+
+        void recycle() {
+            buffer.reset();
+            headers.clear();
+            packets.clear();
+            packetCount = 0;
+        }
+        size_t capacityBytes() const {
+            return headers.capacity() + packets.capacity() * sizeof(RtpPacketizer::Packet);
+        }
+    };
+    typedef FramePool<OutFrame>::Lease OutFrameLease;
+
+    struct Sink {
+        Destination destination;
+        UdpSender sender;
+        std::thread thread;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<OutFrameLease> queue;
+
+        // 分包节奏：下一个分包最早的发送时刻（微秒），仅由发送线程访问
+        uint64_t nextDepartureUs = 0;
+
+        // 该目的地的丢帧策略（参考链按目的地跟踪）；上一帧发送受阻时视为拥塞
+        FrameDropPolicy dropPolicy;
+        bool lastFrameBlocked = false;
+
+        std::atomic<uint64_t> framesSent{0};
+        std::atomic<uint64_t> blockedSends{0};
+        std::atomic<uint64_t> bytesSent{0};
+        std::atomic<uint64_t> packetsSent{0};
+        std::atomic<uint64_t> totalWaitUs{0};
+        // 队列长度：每次改动队列后在持有mutex时写入，getStats不取队列锁直接读取
+        std::atomic<size_t> queueDepth{0};
+    };
+
+    void sinkThreadFunc(Sink* sink);
+    // 按该目的地的丢帧策略放行后发送一帧（发送线程或inlineSend时的调用线程）；
+    // takeNs为发送线程取到该帧的时刻，inlineSend时为0
+    void deliver(Sink* sink, const OutFrame& frame, bool backlog, uint64_t takeNs);
+    // times不为空时记下第一个和最后一个分包发出的时刻
+    bool sendToSink(Sink* sink, const OutFrame& frame, PipelineLatency::FrameTimes* times);
+    void pace(Sink* sink, size_t bytes, double bytesPerUs);
+
+private:
+    Config config;
+    // 先于sinks声明：各目的地队列中的帧析构时归还到池中
+    FramePool<OutFrame> outFramePool;
+    std::vector<std::unique_ptr<Sink>> sinks;
+    std::atomic<bool> running;
+    PipelineLatency* latency;
+    ThreadTuning* threadTuning;
+
+    // 分包器只由推流的发送线程使用，getSdp由界面线程调用
+    RtpPacketizer rtpPacketizer;
+    mutable std::mutex rtpMutex;
+};
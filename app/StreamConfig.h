@@ -7,13 +7,58 @@ struct StreamConfig {
     char targetIp[64] = "127.0.0.1";
     int port = 4459;
 
+    // 额外的目的地："ip[:port][@kbps]"，逗号分隔，可为组播地址；每帧只编码、分包一次
+    char extraDestinations[512] = "";
+    int multicastTtl = 1;
+    int pacingPercent = 0;      // RTP分包在帧间隔的这一百分比内发完，0表示不控制
+
     // 视频配置
     int width = 640;
     int height = 640;
     int fps = 200;
     int bitrateKbps = 15000;
 
-    // 性能配置
-    int captureQueueSize = 2;
-    int encodeQueueSize = 2;
+    // 采集节拍：按绝对截止时刻采集；可向显示器的呈现时刻对齐，使采集落在呈现之后capturePhaseUs处
+    bool alignCapture = false;
+    int capturePhaseUs = 500;
+
+    // 自适应码率：根据接收端报告在[minBitrateKbps, maxBitrateKbps]内调整编码码率
+    bool adaptiveBitrate = false;
+    int minBitrateKbps = 1000;
+    int maxBitrateKbps = 0;     // 0表示以bitrateKbps为上限
+
+    // RTP输出：按RFC 6184分包，可用SDP文件直接由ffplay/VLC播放
+    bool rtpOutput = false;
+    int maxPacketSize = 1400;
+    char sdpPath[260] = "stream.sdp";
+
+    // 共享内存输出：替代UDP发送，同机消费者直接从命名共享内存读取编码帧
+    bool sharedMemoryOutput = false;
+    char shmName[64] = "udpstreamer";
+    int shmSlots = 8;
+    int shmSlotSizeKb = 1024;   // 每个槽位的最大帧大小
+
+    // 性能配置：采集→编码、编码→发送之间只保留最新的一帧，这里只设置每个目的地的发送队列
+    int sendQueueSize = 2;
+
+    // run-to-completion：一个线程依次完成采集、编码、分包和发送（各目的地也在该线程上依次发出），
+    // 省去两次线程间交接的唤醒延迟；关闭时为采集、编码、发送三线程流水线，吞吐更高
+    bool runToCompletion = false;
+
+    // 线程调度："cpu[:policy[:priority]]"，cpu为核编号或any，policy为default/normal/fifo/rr
+    // （Windows上fifo/rr映射为TIME_CRITICAL优先级）；run-to-completion下只使用采集线程的设置。
+    // 发送设置同时用于各目的地的发送线程
+    char captureThread[32] = "any";
+    char encodeThread[32] = "any";
+    char sendThread[32] = "any";
+    bool lockMemory = false;    // 锁定进程内存并预先触碰线程栈（Windows上只预触碰栈）
+    int schedProbe = 0;         // 线程启动时测量调度延迟的休眠次数，0表示不测量（测量期间线程不开始工作）
+
+    // 丢帧策略：采集后超过frameDeadlineMs仍未发出的帧丢弃（0表示只按队列长度丢帧），
+    // 发送拥塞时丢弃非参考帧
+    int frameDeadlineMs = 0;
+    bool congestionDrop = true;
+
+    // 本机指标导出：在127.0.0.1的该端口上以OpenMetrics格式提供/metrics，0表示不导出
+    int metricsPort = 0;
 };
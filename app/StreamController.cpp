@@ -2,20 +2,48 @@
 #include <iostream>
 #include <chrono>
 #include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <cctype>
 #include <windows.h>
 
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 下游线程等待新帧的最长时间，超时后检查停止标志并处理接收端报告
+const unsigned int kMailboxWaitUs = 10000;
+
+// 启动时在发送队列长度之外预先创建的编码缓冲区数
+const size_t kReservedFrameBuffers = 4;
+
+// 与采集时间戳相同的时钟（steady_clock微秒）
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// 指标标签值：名称中的空格换成下划线并转为小写，如"queue full" -> "queue_full"
+std::string metricLabel(const char* key, const char* value) {
+    std::string label = key;
+    label += "=\"";
+    for (const char* c = value; *c; c++) {
+        label += *c == ' ' ? '_' : static_cast<char>(tolower(static_cast<unsigned char>(*c)));
+    }
+    label += '"';
+    return label;
+}
+
+} // namespace
+
 StreamController::StreamController()
     : running(false),
-      captureFPS(0),
-      encodeFPS(0),
-      sendFPS(0),
-      bytesSent(0),
-      packetsSent(0),
-      captureFrameCount(0),
-      encodeFrameCount(0),
-      sendFrameCount(0)
+      requestedBitrateKbps(0),
+      appliedBitrateKbps(0)
 {
-    lastFPSTime = std::chrono::steady_clock::now();
 }
 
 StreamController::~StreamController() {
@@ -35,6 +63,32 @@ bool StreamController::start(const StreamConfig& cfg) {
 
         config = cfg;
 
+        // 丢帧策略：采集、编码阶段在此处理，各目的地发送前的丢帧由SinkSet处理
+        FrameDropPolicy::Config frameDrop;
+        frameDrop.deadlineMs = static_cast<unsigned int>(std::max(config.frameDeadlineMs, 0));
+        frameDrop.congestionDrop = config.congestionDrop;
+        dropPolicy.configure(frameDrop);
+        latency.reset();
+        stats.reset();
+
+        // 线程调度设置，在创建任何线程之前检查；run-to-completion下只有采集线程
+        ThreadTuning::Config threads;
+        const char* threadSpecs[ThreadTuning::kStages] = {config.captureThread, config.encodeThread, config.sendThread};
+        for (unsigned int i = 0; i < ThreadTuning::kStages; i++) {
+            bool used = i == static_cast<unsigned int>(ThreadTuning::Stage::Capture) || !config.runToCompletion;
+            if (used && !ThreadTuning::parseStage(threadSpecs[i], threads.stages[i])) {
+                std::cerr << "Invalid " << ThreadTuning::stageName(static_cast<ThreadTuning::Stage>(i))
+                          << " thread setting: " << threadSpecs[i] << std::endl;
+                return false;
+            }
+        }
+        threads.lockMemory = config.lockMemory;
+        threads.probeIterations = static_cast<unsigned int>(config.schedProbe);
+        threadTuning.configure(threads);
+        for (const auto& warning : threadTuning.getWarnings()) {
+            std::cerr << "Warning: " << warning << std::endl;
+        }
+
         // 初始化屏幕捕获
         if (!screenCapture.initialize(config.width, config.height)) {
             std::cerr << "Failed to initialize screen capture" << std::endl;
@@ -53,42 +107,79 @@ bool StreamController::start(const StreamConfig& cfg) {
             return false;
         }
 
-        // 初始化UDP发送器
-        if (!udpSender.initialize(config.targetIp, config.port)) {
-            std::cerr << "Failed to initialize UDP sender" << std::endl;
-            return false;
-        }
-
-        // 清空队列
-        {  
-            std::lock_guard<std::mutex> lock(captureMutex);
-            while (!captureQueue.empty()) {
-                captureQueue.pop();
+        if (config.sharedMemoryOutput) {
+            // 共享内存输出：不创建套接字，接收报告和自适应码率不可用
+            SharedMemoryWriter::Config shmConfig;
+            shmConfig.name = config.shmName;
+            shmConfig.slotCount = static_cast<unsigned int>(std::max(config.shmSlots, 2));
+            shmConfig.slotSize = static_cast<unsigned int>(std::max(config.shmSlotSizeKb, 4)) * 1024;
+            if (!shmWriter.create(shmConfig)) {
+                std::cerr << "Failed to initialize shared memory output" << std::endl;
+                return false;
             }
-        }
-        {
-            std::lock_guard<std::mutex> lock(encodeMutex);
-            while (!encodeQueue.empty()) {
-                encodeQueue.pop();
+        } else {
+            // 初始化发送目的地：主目的地在前，接收报告从它的套接字读取
+            std::vector<SinkSet::Destination> destinations(1);
+            destinations[0].ip = config.targetIp;
+            destinations[0].port = config.port;
+            if (!SinkSet::parseDestinations(config.extraDestinations, config.port, destinations)) {
+                std::cerr << "Invalid extra destinations" << std::endl;
+                return false;
+            }
+
+            SinkSet::Config sinkConfig;
+            sinkConfig.rtpOutput = config.rtpOutput;
+            sinkConfig.maxPacketSize = config.maxPacketSize;
+            sinkConfig.multicastTtl = config.multicastTtl;
+            sinkConfig.fps = config.fps;
+            sinkConfig.pacingPercent = config.pacingPercent;
+            sinkConfig.queueSize = config.sendQueueSize;
+            sinkConfig.inlineSend = config.runToCompletion;
+            sinkConfig.frameDrop = frameDrop;
+            sinks.setLatency(&latency);
+            sinks.setThreadTuning(&threadTuning);
+            if (!sinks.start(sinkConfig, destinations)) {
+                std::cerr << "Failed to initialize UDP sender" << std::endl;
+                return false;
             }
         }
 
+        // 初始化码率控制
+        requestedBitrateKbps = 0;
+        appliedBitrateKbps = config.bitrateKbps;
+        bitrateController.configure(
+            makeBitrateConfig(config.maxBitrateKbps),
+            config.bitrateKbps,
+            config.fps
+        );
+
+        // 清空信箱
+        captureMailbox.reset();
+        encodeMailbox.reset();
+        publishedInfo = FrameDropPolicy::FrameInfo();
+
+        // 在途的编码缓冲区：编码线程、信箱和各目的地队列，之后按需增加
+        framePool.reserve(static_cast<size_t>(std::max(config.sendQueueSize, 1)) + kReservedFrameBuffers);
+        framePool.resetStats();
+
         // 启动线程
         running = true;
-        captureThread = std::thread(&StreamController::captureThreadFunc, this);
-        encodeThread = std::thread(&StreamController::encodeThreadFunc, this);
-        sendThread = std::thread(&StreamController::sendThreadFunc, this);
-
-        // 设置线程优先级
-        SetThreadPriority(captureThread.native_handle(), THREAD_PRIORITY_HIGHEST);
-        SetThreadPriority(encodeThread.native_handle(), THREAD_PRIORITY_HIGHEST);
-        SetThreadPriority(sendThread.native_handle(), THREAD_PRIORITY_ABOVE_NORMAL);
+        // 线程优先级和CPU绑定由各线程启动时设置
+        if (config.runToCompletion) {
+            // 一个线程依次完成采集、编码、分包和发送，没有线程间交接
+            captureThread = std::thread(&StreamController::runToCompletionThreadFunc, this);
+        } else {
+            captureThread = std::thread(&StreamController::captureThreadFunc, this);
+            encodeThread = std::thread(&StreamController::encodeThreadFunc, this);
+            sendThread = std::thread(&StreamController::sendThreadFunc, this);
+        }
+        statsThread = std::thread(&StreamController::statsThreadFunc, this);
 
-        // 初始化FPS计算
-        lastFPSTime = std::chrono::steady_clock::now();
-        captureFrameCount = 0;
-        encodeFrameCount = 0;
-        sendFrameCount = 0;
+        // 指标导出只读取已发布的快照，端口不可用时只输出警告，不影响推流
+        if (config.metricsPort > 0 &&
+            !metricsServer.start(static_cast<unsigned int>(config.metricsPort), [this]() { return formatMetrics(); })) {
+            std::cerr << "Warning: Metrics export disabled" << std::endl;
+        }
 
         std::cout << "Stream started successfully" << std::endl;
         return true;
@@ -110,9 +201,9 @@ void StreamController::stop() {
         // 设置停止标志
         running = false;
 
-        // 通知所有线程
-        captureCV.notify_all();
-        encodeCV.notify_all();
+        // 唤醒等待新帧的线程
+        captureMailbox.notify();
+        encodeMailbox.notify();
 
         // 等待线程结束
         if (captureThread.joinable()) {
@@ -124,25 +215,23 @@ void StreamController::stop() {
         if (sendThread.joinable()) {
             sendThread.join();
         }
+        if (statsThread.joinable()) {
+            statsThread.join();
+        }
+        metricsServer.stop();
+
+        // 工作线程都已退出，最后发布一次快照，停止后界面显示最终的统计
+        collectStats();
 
         // 清理资源
         screenCapture.cleanup();
         encoder.cleanup();
-        udpSender.cleanup();
+        sinks.stop();
+        shmWriter.close();
 
-        // 清空队列
-        {
-            std::lock_guard<std::mutex> lock(captureMutex);
-            while (!captureQueue.empty()) {
-                captureQueue.pop();
-            }
-        }
-        {
-            std::lock_guard<std::mutex> lock(encodeMutex);
-            while (!encodeQueue.empty()) {
-                encodeQueue.pop();
-            }
-        }
+        // 清空信箱，释放未发送的帧
+        captureMailbox.reset();
+        encodeMailbox.reset();
 
         std::cout << "Stream stopped successfully" << std::endl;
     } catch (const std::exception& e) {
@@ -153,24 +242,20 @@ void StreamController::stop() {
 void StreamController::captureThreadFunc() {
     try {
         std::cout << "Capture thread started" << std::endl;
+        threadTuning.applyToCurrentThread(ThreadTuning::Stage::Capture, "capture");
+        startCaptureClock();
 
         while (running) {
             try {
                 CaptureFrame frame;
-                if (screenCapture.captureFrame(frame)) {
-                    // 检查队列大小，避免缓冲过多
-                    std::lock_guard<std::mutex> lock(captureMutex);
-                    if (captureQueue.size() >= static_cast<size_t>(config.captureQueueSize)) {
-                        // 丢弃旧帧，保持实时性
-                        captureQueue.pop();
+                if (captureNextFrame(frame)) {
+                    // 编码线程还没取走上一帧时覆盖它，保持实时性（尚未编码，不区分优先级）
+                    frame.times.mark(PipelineLatency::Point::CapturePublish);
+                    if (captureMailbox.publish(frame)) {
+                        dropPolicy.drop(FrameDropPolicy::Stage::Capture, FrameDropPolicy::Reason::QueueFull,
+                                        FrameDropPolicy::FrameInfo());
                     }
-                    captureQueue.push(frame);
-                    captureCV.notify_one();
-                    captureFrameCount++;
                 }
-
-                // 控制采集频率
-                std::this_thread::sleep_for(std::chrono::microseconds(1000000 / config.fps));
             } catch (const std::exception& e) {
                 std::cerr << "Error in capture thread: " << e.what() << std::endl;
                 // 短暂暂停后继续
@@ -189,47 +274,16 @@ void StreamController::captureThreadFunc() {
 void StreamController::encodeThreadFunc() {
     try {
         std::cout << "Encode thread started" << std::endl;
+        threadTuning.applyToCurrentThread(ThreadTuning::Stage::Encode, "encode");
 
         while (running) {
             try {
+                // 帧发布后立即醒来，不再轮询
                 CaptureFrame frame;
-                bool gotFrame = false;
-                
-                {
-                    std::unique_lock<std::mutex> lock(captureMutex);
-                    captureCV.wait(lock, [this] {
-                        return !captureQueue.empty() || !running;
-                    });
-
-                    if (!running) {
-                        break;
-                    }
-
-                    if (!captureQueue.empty()) {
-                        frame = captureQueue.front();
-                        captureQueue.pop();
-                        gotFrame = true;
-                    }
+                EncodedFrame encoded;
+                if (captureMailbox.wait(frame, kMailboxWaitUs) && running && encodeFrame(frame, encoded)) {
+                    publishEncodedFrame(encoded);
                 }
-
-                if (gotFrame) {
-                    // 编码帧
-                    std::vector<uint8_t> encodedData;
-                    if (encoder.encode(frame.texture, encodedData)) {
-                        // 检查队列大小，避免缓冲过多
-                        std::lock_guard<std::mutex> lock(encodeMutex);
-                        if (encodeQueue.size() >= static_cast<size_t>(config.encodeQueueSize)) {
-                            // 丢弃旧帧，保持实时性
-                            encodeQueue.pop();
-                        }
-                        encodeQueue.push(encodedData);
-                        encodeCV.notify_one();
-                        encodeFrameCount++;
-                    }
-                }
-
-                // 短暂睡眠，避免CPU占用过高
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
             } catch (const std::exception& e) {
                 std::cerr << "Error in encode thread: " << e.what() << std::endl;
                 // 短暂暂停后继续
@@ -248,38 +302,17 @@ void StreamController::encodeThreadFunc() {
 void StreamController::sendThreadFunc() {
     try {
         std::cout << "Send thread started" << std::endl;
+        threadTuning.applyToCurrentThread(ThreadTuning::Stage::Send, "send");
 
         while (running) {
             try {
-                std::vector<uint8_t> encodedData;
-                bool gotData = false;
-                
-                {
-                    std::unique_lock<std::mutex> lock(encodeMutex);
-                    encodeCV.wait(lock, [this] {
-                        return !encodeQueue.empty() || !running;
-                    });
-
-                    if (!running) {
-                        break;
-                    }
-
-                    if (!encodeQueue.empty()) {
-                        encodedData = encodeQueue.front();
-                        encodeQueue.pop();
-                        gotData = true;
-                    }
-                }
-
-                if (gotData) {
-                    // 发送数据
-                    if (udpSender.sendFrame(encodedData)) {
-                        sendFrameCount++;
-                    }
+                EncodedFrame encoded;
+                if (encodeMailbox.wait(encoded, kMailboxWaitUs) && running) {
+                    sendEncodedFrame(encoded);
                 }
 
-                // 短暂睡眠，避免CPU占用过高
-                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                // 处理接收端报告（没有新帧时每个等待周期处理一次）
+                processReports();
             } catch (const std::exception& e) {
                 std::cerr << "Error in send thread: " << e.what() << std::endl;
                 // 短暂暂停后继续
@@ -295,61 +328,378 @@ void StreamController::sendThreadFunc() {
     }
 }
 
-void StreamController::updateStats() {
+void StreamController::runToCompletionThreadFunc() {
     try {
-        calculateFPS();
-        bytesSent = udpSender.getBytesSent();
-        packetsSent = udpSender.getPacketsSent();
+        std::cout << "Run-to-completion thread started" << std::endl;
+        threadTuning.applyToCurrentThread(ThreadTuning::Stage::Capture, "run-to-completion");
+        startCaptureClock();
+
+        while (running) {
+            try {
+                CaptureFrame frame;
+                EncodedFrame encoded;
+                if (captureNextFrame(frame) && encodeFrame(frame, encoded)) {
+                    sendEncodedFrame(encoded);
+                }
+
+                // 处理接收端报告（每个节拍一次）
+                processReports();
+            } catch (const std::exception& e) {
+                std::cerr << "Error in run-to-completion thread: " << e.what() << std::endl;
+                // 短暂暂停后继续
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            }
+        }
+
+        std::cout << "Run-to-completion thread stopped" << std::endl;
     } catch (const std::exception& e) {
-        std::cerr << "Error updating stats: " << e.what() << std::endl;
+        std::cerr << "Fatal error in run-to-completion thread: " << e.what() << std::endl;
+        // 确保线程能够退出
+        running = false;
+    }
+}
+
+void StreamController::startCaptureClock() {
+    // 节拍从线程完成调度设置（包括调度延迟的测量）之后开始计，测量期间不算错过的节拍
+    FrameClock::Config clockConfig;
+    clockConfig.frameRate = static_cast<unsigned int>(config.fps);
+    clockConfig.phaseOffsetUs = config.capturePhaseUs;
+    captureClock.configure(clockConfig);
+}
+
+bool StreamController::captureNextFrame(CaptureFrame& frame) {
+    // 控制采集频率：等到下一个节拍的绝对截止时刻
+    captureClock.waitNextTick();
+
+    if (!screenCapture.captureFrame(frame)) {
+        return false;
+    }
+    frame.times = PipelineLatency::FrameTimes();
+    frame.times.set(PipelineLatency::Point::Acquire, frame.acquireNs);
+    frame.times.set(PipelineLatency::Point::CropCopy, frame.copyNs);
+
+    // 新呈现的画面带有呈现时刻，节拍向它对齐，使每次采集都紧跟在呈现之后
+    if (config.alignCapture && frame.presentTime != 0) {
+        captureClock.alignTo(frame.presentTime);
+    }
+    stats.addFrame(StreamStats::Stage::Capture);
+    return true;
+}
+
+bool StreamController::encodeFrame(const CaptureFrame& frame, EncodedFrame& encoded) {
+    encoded.times = frame.times;
+    encoded.times.mark(PipelineLatency::Point::EncodeTake);
+
+    // 采集→编码：排队期间已过截止时刻的帧不再编码
+    FrameDropPolicy::FrameInfo info = dropPolicy.makeFrame(frame.timestamp);
+    if (dropPolicy.expire(FrameDropPolicy::Stage::Capture, info, nowMicros())) {
+        return false;
+    }
+
+    // 应用新的目标码率（不重建编码会话）
+    applyTargetBitrate();
+
+    // 本地或任一目的地丢弃了参考帧时下一帧编码为IDR
+    bool keyframeRequested = dropPolicy.takeKeyframeRequest();
+    if (sinks.takeKeyframeRequest() || keyframeRequested) {
+        encoder.requestKeyframe();
+    }
+
+    // 编码到池中的缓冲区，容量沿用上次使用时的大小
+    encoded.buffer = framePool.acquire();
+    std::vector<uint8_t>& data = encoded.buffer->data;
+    if (!encoder.encode(frame.texture, data)) {
+        return false;
+    }
+    // 编码帧率按编码成功的帧计，之后过期或在信箱中被挤掉的帧由丢帧统计记录
+    stats.addFrame(StreamStats::Stage::Encode);
+    encoded.times.set(PipelineLatency::Point::EncodeSubmit, encoder.getLastTiming().submitNs);
+    encoded.times.set(PipelineLatency::Point::EncodeComplete, encoder.getLastTiming().completeNs);
+    info.priority = FrameDropPolicy::classify(data.data(), data.size());
+    encoded.info = info;
+
+    // 编码耗时可能使帧过期
+    return !dropPolicy.expire(FrameDropPolicy::Stage::Encode, info, nowMicros());
+}
+
+void StreamController::publishEncodedFrame(EncodedFrame& encoded) {
+    // 发送线程还没取走上一帧时只保留两者中的一帧：优先级较低的被挤掉，同优先级时挤掉较旧的。
+    // 比较后发送线程可能恰好取走了上一帧，此时新帧仍被丢弃，只是多丢了一个低优先级帧
+    if (encodeMailbox.pending()) {
+        FrameDropPolicy::FrameInfo candidates[2] = {publishedInfo, encoded.info};
+        size_t victim = FrameDropPolicy::selectVictim(candidates, candidates + 2,
+                                                      [](const FrameDropPolicy::FrameInfo& candidate) { return candidate; });
+        if (victim == 1) {
+            dropPolicy.drop(FrameDropPolicy::Stage::Encode, FrameDropPolicy::Reason::QueueFull, encoded.info);
+            return;
+        }
+    }
+
+    // 交换缓冲区而不复制；返回true时encoded中是被覆盖的上一帧
+    publishedInfo = encoded.info;
+    encoded.times.mark(PipelineLatency::Point::EncodePublish);
+    if (encodeMailbox.publish(encoded)) {
+        dropPolicy.drop(FrameDropPolicy::Stage::Encode, FrameDropPolicy::Reason::QueueFull, encoded.info);
+    }
+}
+
+void StreamController::sendEncodedFrame(EncodedFrame& encoded) {
+    // 编码→发送：参考链已断开或已过截止时刻的帧不再分发（拥塞按目的地判断）
+    encoded.times.mark(PipelineLatency::Point::SendTake);
+    if (!dropPolicy.admit(FrameDropPolicy::Stage::Encode, encoded.info, nowMicros(), false)) {
+        return;
+    }
+
+    const std::vector<uint8_t>& data = encoded.buffer->data;
+    if (config.sharedMemoryOutput) {
+        // 复制到共享内存槽位后立即返回，无系统调用
+        if (shmWriter.write(data.data(), data.size())) {
+            encoded.times.mark(PipelineLatency::Point::FirstPacket);
+            encoded.times.set(PipelineLatency::Point::LastPacket, encoded.times.at(PipelineLatency::Point::FirstPacket));
+            latency.record(encoded.times);
+            stats.addFrame(StreamStats::Stage::Send);
+        }
+    } else if (sinks.sendFrame(encoded.buffer, encoded.info, encoded.times)) {
+        // 分包一次后交给各目的地的发送线程（run-to-completion时在本线程发出），缓冲区在各目的地发送完后归还
+        stats.addFrame(StreamStats::Stage::Send);
+    }
+}
+
+bool StreamController::setBitrate(int bitrateKbps) {
+    if (bitrateKbps <= 0) {
+        std::cerr << "Invalid bitrate: " << bitrateKbps << std::endl;
+        return false;
+    }
+
+    requestedBitrateKbps = bitrateKbps;
+    return true;
+}
+
+bool StreamController::saveSdp(const char* path) {
+    try {
+        if (!running || !config.rtpOutput) {
+            std::cerr << "RTP output is not running" << std::endl;
+            return false;
+        }
+
+        std::string sdp = sinks.getSdp();
+        if (sdp.find("sprop-parameter-sets") == std::string::npos) {
+            std::cerr << "Parameter sets not received yet, SDP may not be playable" << std::endl;
+        }
+
+        std::ofstream file(path, std::ios::out | std::ios::trunc);
+        if (!file) {
+            std::cerr << "Failed to open SDP file: " << path << std::endl;
+            return false;
+        }
+        file << sdp;
+        std::cout << "SDP written to " << path << std::endl;
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error saving SDP: " << e.what() << std::endl;
+        return false;
     }
 }
 
-void StreamController::calculateFPS() {
+BitrateController::Config StreamController::makeBitrateConfig(int maxBitrateKbps) const {
+    BitrateController::Config bitrateConfig;
+    bitrateConfig.enabled = config.adaptiveBitrate;
+    bitrateConfig.minBitrateKbps = static_cast<unsigned int>(std::max(config.minBitrateKbps, 0));
+    bitrateConfig.maxBitrateKbps = static_cast<unsigned int>(std::max(maxBitrateKbps, 0));
+    return bitrateConfig;
+}
+
+void StreamController::applyTargetBitrate() {
     try {
-        auto now = std::chrono::steady_clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            now - lastFPSTime
-        ).count();
-
-        if (elapsed >= 1000) {
-            captureFPS = static_cast<int>(
-                captureFrameCount * 1000.0 / elapsed
-            );
-            encodeFPS = static_cast<int>(
-                encodeFrameCount * 1000.0 / elapsed
-            );
-            sendFPS = static_cast<int>(
-                sendFrameCount * 1000.0 / elapsed
-            );
+        int target = 0;
+        int maxFrameBytes = 0;
+
+        if (bitrateController.isEnabled()) {
+            target = static_cast<int>(bitrateController.getTargetBitrate());
+            maxFrameBytes = static_cast<int>(bitrateController.getMaxFrameBytes());
+        } else {
+            target = requestedBitrateKbps.exchange(0);
+        }
 
-            // 重置计数器
-            captureFrameCount = 0;
-            encodeFrameCount = 0;
-            sendFrameCount = 0;
-            lastFPSTime = now;
+        if (target <= 0 || target == appliedBitrateKbps) {
+            return;
+        }
+
+        // 失败时同样记录为已应用，避免每帧重试
+        if (!encoder.reconfigure(target, maxFrameBytes)) {
+            std::cerr << "Failed to apply bitrate " << target << " kbps" << std::endl;
         }
+        appliedBitrateKbps = target;
     } catch (const std::exception& e) {
-        std::cerr << "Error calculating FPS: " << e.what() << std::endl;
+        std::cerr << "Error applying bitrate: " << e.what() << std::endl;
     }
 }
 
-int StreamController::getCaptureFPS() const {
-    return captureFPS;
+void StreamController::processReports() {
+    try {
+        if (!bitrateController.isEnabled()) {
+            return;
+        }
+
+        // 手动修改码率时以新值为上限重新开始估计
+        int requested = requestedBitrateKbps.exchange(0);
+        if (requested > 0) {
+            bitrateController.configure(
+                makeBitrateConfig(requested),
+                std::min(requested, static_cast<int>(appliedBitrateKbps)),
+                config.fps
+            );
+        }
+
+        UdpSender::ReceiverReport report;
+        UdpSender* primary = sinks.primary();
+        while (primary && primary->pollReport(report)) {
+            bitrateController.onReport(report);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error processing receiver reports: " << e.what() << std::endl;
+    }
 }
 
-int StreamController::getEncodeFPS() const {
-    return encodeFPS;
+void StreamController::updateStats() {
+    try {
+        // 快照每StreamStats::kSampleIntervalMs才更新一次，其余的界面帧不做任何统计工作
+        if (stats.version() == statsSnapshot.version) {
+            return;
+        }
+        stats.read(statsSnapshot);
+        sinkStats = sinks.getStats();
+        threadReports = threadTuning.getReports();
+        threadWarnings = threadTuning.getWarnings();
+    } catch (const std::exception& e) {
+        std::cerr << "Error updating stats: " << e.what() << std::endl;
+    }
 }
 
-int StreamController::getSendFPS() const {
-    return sendFPS;
+void StreamController::statsThreadFunc() {
+    try {
+        while (running) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(StreamStats::kSampleIntervalMs));
+            if (running) {
+                collectStats();
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Fatal error in stats thread: " << e.what() << std::endl;
+    }
 }
 
-int StreamController::getBytesSent() const {
-    return bytesSent;
+void StreamController::collectStats() {
+    StreamStats::Snapshot snapshot = StreamStats::Snapshot();
+    for (unsigned int i = 0; i < StreamStats::kStages; i++) {
+        snapshot.frames[i] = stats.getFrames(static_cast<StreamStats::Stage>(i));
+    }
+
+    if (config.sharedMemoryOutput) {
+        // 每帧作为一个整体写入共享内存
+        snapshot.sharedMemory = shmWriter.getStats();
+        snapshot.bytesSent = snapshot.sharedMemory.bytesWritten;
+        snapshot.packetsSent = snapshot.sharedMemory.framesWritten;
+    } else {
+        for (const SinkSet::SinkStats& sink : sinks.getStats()) {
+            snapshot.bytesSent += sink.bytesSent;
+            snapshot.packetsSent += sink.packetsSent;
+            snapshot.blockedSends += sink.blockedSends;
+            snapshot.sendErrors += sink.sendErrors;
+            snapshot.sinkFramesDropped += sink.framesDropped;
+            snapshot.sinkQueueDepth += static_cast<uint32_t>(sink.queueDepth);
+            snapshot.sinkQueueMax = std::max(snapshot.sinkQueueMax, static_cast<uint32_t>(sink.queueDepth));
+            snapshot.sinks++;
+        }
+        UdpSender* primary = sinks.primary();
+        snapshot.reportsReceived = primary ? primary->getReportsReceived() : 0;
+    }
+
+    snapshot.captureQueueDepth = captureMailbox.pending() ? 1 : 0;
+    snapshot.encodeQueueDepth = encodeMailbox.pending() ? 1 : 0;
+    snapshot.targetBitrateKbps = static_cast<uint32_t>(std::max(static_cast<int>(appliedBitrateKbps), 0));
+    snapshot.drops = dropPolicy.getStats();
+    snapshot.captureHandoff = captureMailbox.getStats();
+    snapshot.encodeHandoff = encodeMailbox.getStats();
+    snapshot.framePool = framePool.getStats();
+    snapshot.packetPool = sinks.getPoolStats();
+    snapshot.captureClock = captureClock.getStats();
+    snapshot.latency = latency.getStats();
+
+    stats.publish(snapshot);
 }
 
-int StreamController::getPacketsSent() const {
-    return packetsSent;
+std::string StreamController::formatMetrics() const {
+    // 计数和速率取自统计线程发布的快照（每StreamStats::kSampleIntervalMs更新），直方图直接读取（无锁）
+    StreamStats::Snapshot snapshot = stats.read();
+
+    OpenMetricsWriter writer;
+    writer.family("udpstreamer_frames", "counter", nullptr, "Frames completed by each pipeline stage.");
+    for (unsigned int i = 0; i < StreamStats::kStages; i++) {
+        StreamStats::Stage stage = static_cast<StreamStats::Stage>(i);
+        writer.sample("udpstreamer_frames_total", metricLabel("stage", StreamStats::stageName(stage)),
+                      snapshot.stageFrames(stage));
+    }
+    writer.family("udpstreamer_stage_fps", "gauge", nullptr, "Frames per second of each stage over the last second.");
+    for (unsigned int i = 0; i < StreamStats::kStages; i++) {
+        StreamStats::Stage stage = static_cast<StreamStats::Stage>(i);
+        writer.sample("udpstreamer_stage_fps", metricLabel("stage", StreamStats::stageName(stage)),
+                      snapshot.shortWindow.stageFps(stage));
+    }
+
+    writer.family("udpstreamer_capture_ticks", "counter", nullptr, "Capture clock ticks fired.");
+    writer.sample("udpstreamer_capture_ticks_total", "", snapshot.captureClock.ticks);
+    writer.family("udpstreamer_capture_missed_ticks", "counter", nullptr,
+                  "Capture clock ticks skipped after falling behind.");
+    writer.sample("udpstreamer_capture_missed_ticks_total", "", snapshot.captureClock.missedTicks);
+    writer.family("udpstreamer_capture_tick_lateness_seconds", "histogram", "seconds",
+                  "Time from each capture tick deadline to the capture thread waking up.");
+    writer.histogram("udpstreamer_capture_tick_lateness_seconds", "", captureClock.latenessHistogram());
+
+    writer.family("udpstreamer_frame_latency_seconds", "histogram", "seconds",
+                  "Per-frame latency of pipeline stages and queues, from frame acquire to last packet sent.");
+    for (unsigned int i = 0; i < PipelineLatency::kSpans; i++) {
+        PipelineLatency::Span span = static_cast<PipelineLatency::Span>(i);
+        const char* kind = PipelineLatency::isQueue(span) ? "queue"
+                         : (span == PipelineLatency::Span::Total ? "total" : "stage");
+        writer.histogram("udpstreamer_frame_latency_seconds",
+                         metricLabel("span", PipelineLatency::spanKey(span)) + "," + metricLabel("kind", kind),
+                         latency.histogram(span));
+    }
+
+    writer.family("udpstreamer_dropped_frames", "counter", nullptr,
+                  "Frames dropped at the capture and encode stages or by shared memory output, by stage and reason.");
+    for (unsigned int stage = 0; stage < FrameDropPolicy::kStages; stage++) {
+        for (unsigned int reason = 0; reason < FrameDropPolicy::kReasons; reason++) {
+            std::string labels =
+                metricLabel("stage", FrameDropPolicy::stageName(static_cast<FrameDropPolicy::Stage>(stage))) + "," +
+                metricLabel("reason", FrameDropPolicy::reasonName(static_cast<FrameDropPolicy::Reason>(reason)));
+            writer.sample("udpstreamer_dropped_frames_total", labels, snapshot.drops.dropped[stage][reason]);
+        }
+    }
+    writer.family("udpstreamer_sink_dropped_frames", "counter", nullptr,
+                  "Frames not sent to a destination (queue full, expired, congestion or reference lost), "
+                  "summed over destinations.");
+    writer.sample("udpstreamer_sink_dropped_frames_total", "", snapshot.sinkFramesDropped);
+
+    writer.family("udpstreamer_sent_bytes", "counter", "bytes",
+                  "Bytes sent to all destinations, or written to shared memory.");
+    writer.sample("udpstreamer_sent_bytes_total", "", snapshot.bytesSent);
+    writer.family("udpstreamer_sent_packets", "counter", nullptr, "Packets sent, or frames written to shared memory.");
+    writer.sample("udpstreamer_sent_packets_total", "", snapshot.packetsSent);
+    writer.family("udpstreamer_blocked_sends", "counter", nullptr,
+                  "Frames whose remaining packets were dropped because the socket send buffer was full.");
+    writer.sample("udpstreamer_blocked_sends_total", "", snapshot.blockedSends);
+    writer.family("udpstreamer_socket_errors", "counter", nullptr, "Socket send errors other than a full send buffer.");
+    writer.sample("udpstreamer_socket_errors_total", "", snapshot.sendErrors);
+
+    writer.family("udpstreamer_queue_depth", "gauge", nullptr, "Frames waiting in each queue when last sampled.");
+    const char* queues[3] = {"capture", "encode", "sinks"};
+    uint32_t depths[3] = {snapshot.captureQueueDepth, snapshot.encodeQueueDepth, snapshot.sinkQueueDepth};
+    for (unsigned int i = 0; i < 3; i++) {
+        writer.sample("udpstreamer_queue_depth", metricLabel("queue", queues[i]), static_cast<uint64_t>(depths[i]));
+    }
+    writer.family("udpstreamer_target_bitrate_kbps", "gauge", nullptr, "Encoder target bitrate in kbps.");
+    writer.sample("udpstreamer_target_bitrate_kbps", "", static_cast<uint64_t>(snapshot.targetBitrateKbps));
+    return writer.finish();
 }
@@ -5,11 +5,19 @@
 #include <chrono>
 #include <thread>
 #include <atomic>
-#include <mutex>
-#include <queue>
-#include <condition_variable>
 
 #include "StreamConfig.h"
+#include "BitrateController.h"
+#include "SinkSet.h"
+#include "SharedMemoryTransport.h"
+#include "FrameDropPolicy.h"
+#include "FrameMailbox.h"
+#include "FramePool.h"
+#include "FrameClock.h"
+#include "PipelineLatency.h"
+#include "ThreadTuning.h"
+#include "StreamStats.h"
+#include "MetricsServer.h"
 
 // 前向声明
 class ScreenCapture;
@@ -20,6 +28,10 @@ class UdpSender;
 struct CaptureFrame {
     void* texture;
     uint64_t timestamp;
+    uint64_t presentTime;
+    uint64_t acquireNs;
+    uint64_t copyNs;
+    PipelineLatency::FrameTimes times;      // 逐帧延迟追踪记录，随帧经过采集→编码信箱
 };
 
 class StreamController {
@@ -32,21 +44,88 @@ public:
 
     bool isRunning() const { return running; }
 
-    // 统计信息
-    int getCaptureFPS() const { return captureFPS; }
-    int getEncodeFPS() const { return encodeFPS; }
-    int getSendFPS() const { return sendFPS; }
-    int getBytesSent() const { return bytesSent; }
-    int getPacketsSent() const { return packetsSent; }
-
+    // 运行时修改码率，不重建编码会话。启用自适应码率时作为新的码率上限
+    bool setBitrate(int bitrateKbps);
+
+    // RTP输出时写出SDP文件，需在发送过关键帧后调用
+    bool saveSdp(const char* path);
+
+    // 任意线程读取统计线程最近发布的快照（导出接口使用），不加锁
+    StreamStats::Snapshot readStats() const { return stats.read(); }
+
+    // 以下统计取自界面线程上updateStats复制的快照，只在界面线程上调用
+    const StreamStats::Snapshot& getStatsSnapshot() const { return statsSnapshot; }
+    int getCaptureFPS() const { return static_cast<int>(statsSnapshot.shortWindow.stageFps(StreamStats::Stage::Capture) + 0.5); }
+    int getEncodeFPS() const { return static_cast<int>(statsSnapshot.shortWindow.stageFps(StreamStats::Stage::Encode) + 0.5); }
+    int getSendFPS() const { return static_cast<int>(statsSnapshot.shortWindow.stageFps(StreamStats::Stage::Send) + 0.5); }
+    uint64_t getBytesSent() const { return statsSnapshot.bytesSent; }
+    uint64_t getPacketsSent() const { return statsSnapshot.packetsSent; }
+    int getTargetBitrate() const { return static_cast<int>(statsSnapshot.targetBitrateKbps); }
+    uint64_t getReportsReceived() const { return statsSnapshot.reportsReceived; }
+    const std::vector<SinkSet::SinkStats>& getSinkStats() const { return sinkStats; }
+    bool isSharedMemoryOutput() const { return config.sharedMemoryOutput; }
+    const SharedMemoryWriter::Stats& getSharedMemoryStats() const { return statsSnapshot.sharedMemory; }
+    // 采集、编码阶段的丢帧（各目的地发送前的丢帧见getSinkStats）
+    const FrameDropPolicy::Stats& getDropStats() const { return statsSnapshot.drops; }
+    // 采集→编码、编码→发送两处交接的延迟和覆盖数
+    const HandoffStats& getCaptureHandoffStats() const { return statsSnapshot.captureHandoff; }
+    const HandoffStats& getEncodeHandoffStats() const { return statsSnapshot.encodeHandoff; }
+    // 编码输出缓冲区池和分包结果池的分配统计，稳态下分配数不再增长
+    const FramePoolStats& getFramePoolStats() const { return statsSnapshot.framePool; }
+    const FramePoolStats& getPacketPoolStats() const { return statsSnapshot.packetPool; }
+    // 采集节拍的实际帧率和抖动
+    const FrameClock::Stats& getCaptureClockStats() const { return statsSnapshot.captureClock; }
+    // 各阶段和队列的逐帧延迟（取到画面到第一个目的地的最后一个分包发出）
+    bool isRunToCompletion() const { return config.runToCompletion; }
+    const PipelineLatency::Stats& getLatencyStats() const { return statsSnapshot.latency; }
+    // 各线程的CPU绑定、调度策略和启动时测得的调度延迟，以及配置检查发现的问题
+    const std::vector<ThreadTuning::ThreadReport>& getThreadReports() const { return threadReports; }
+    const std::vector<std::string>& getThreadWarnings() const { return threadWarnings; }
+
+    // 本机指标导出的端口和被抓取的次数（未导出时isRunning为false）
+    const MetricsServer& getMetricsServer() const { return metricsServer; }
+
+    // 界面线程每帧调用：有新快照时复制一份，并刷新各目的地和线程调度的明细（不可平凡复制，不在快照中）
     void updateStats();
 
 private:
+    // 编码后的帧，附带截止时刻和优先级；缓冲区从framePool借出，发送完后归还
+    struct EncodedFrame {
+        FrameBufferPool::Lease buffer;
+        FrameDropPolicy::FrameInfo info;
+        PipelineLatency::FrameTimes times;
+    };
+
     void captureThreadFunc();
     void encodeThreadFunc();
     void sendThreadFunc();
+    void runToCompletionThreadFunc();
+
+    // 在采集线程上配置并启动采集节拍
+    void startCaptureClock();
+
+    // 等到下一个采集节拍并采集一帧
+    bool captureNextFrame(CaptureFrame& frame);
+
+    // 编码一帧，在采集→编码和编码→发送边界按截止时刻丢帧；返回false表示该帧不再继续
+    bool encodeFrame(const CaptureFrame& frame, EncodedFrame& encoded);
+
+    // 放入encodeMailbox，发送线程还没取走上一帧时按优先级保留一帧（编码线程调用）
+    void publishEncodedFrame(EncodedFrame& encoded);
+
+    // 分发到各目的地或写入共享内存，发出后记录各阶段延迟
+    void sendEncodedFrame(EncodedFrame& encoded);
 
-    void calculateFPS();
+    void applyTargetBitrate();
+    void processReports();
+    BitrateController::Config makeBitrateConfig(int maxBitrateKbps) const;
+
+    // 统计线程：每StreamStats::kSampleIntervalMs汇总一次各模块的统计并发布快照
+    void statsThreadFunc();
+    void collectStats();
+
+    // 在指标服务线程上生成OpenMetrics文本：读取已发布的快照和无锁的延迟直方图
+    std::string formatMetrics() const;
 
 private:
     // 配置
@@ -55,36 +134,49 @@ private:
     // 模块实例
     ScreenCapture screenCapture;
     NVEncoder encoder;
-    UdpSender udpSender;
+    // 先于sinks和信箱声明，比所有借出的缓冲区活得更久
+    FrameBufferPool framePool;
+    // 逐帧延迟，帧发出时由发送线程或第一个目的地的发送线程记录；同样先于sinks声明
+    PipelineLatency latency;
+    // 线程调度设置，各线程（包括各目的地的发送线程）启动时对自身应用；先于sinks声明
+    ThreadTuning threadTuning;
+    SinkSet sinks;
+    SharedMemoryWriter shmWriter;
+    BitrateController bitrateController;
+    FrameDropPolicy dropPolicy;
+
+    // 采集节拍：按绝对截止时刻触发采集，采集耗时不会推迟下一次采集
+    FrameClock captureClock;
 
     // 线程
     std::thread captureThread;
     std::thread encodeThread;
     std::thread sendThread;
+    std::thread statsThread;
 
     // 控制标志
     std::atomic<bool> running;
 
-    // 帧队列
-    std::queue<CaptureFrame> captureQueue;
-    std::queue<std::vector<uint8_t>> encodeQueue;
-
-    // 队列同步
-    std::mutex captureMutex;
-    std::mutex encodeMutex;
-    std::condition_variable captureCV;
-    std::condition_variable encodeCV;
-
-    // 统计信息
-    int captureFPS = 0;
-    int encodeFPS = 0;
-    int sendFPS = 0;
-    int bytesSent = 0;
-    int packetsSent = 0;
-
-    // FPS计算
-    int captureFrameCount = 0;
-    int encodeFrameCount = 0;
-    int sendFrameCount = 0;
-    std::chrono::steady_clock::time_point lastFPSTime;
+    // 阶段之间的最新帧信箱：下游只取最新的一帧，还没取走的旧帧被覆盖
+    FrameMailbox<CaptureFrame> captureMailbox;
+    FrameMailbox<EncodedFrame> encodeMailbox;
+
+    // 最近一次放入encodeMailbox的帧（仅编码线程访问），覆盖前比较优先级
+    FrameDropPolicy::FrameInfo publishedInfo;
+
+    // 码率控制：setBitrate写入请求，编码线程应用到编码器
+    std::atomic<int> requestedBitrateKbps;
+    std::atomic<int> appliedBitrateKbps;
+
+    // 统计：工作线程写计数器，统计线程发布快照
+    StreamStats stats;
+
+    // 本机指标导出，在自己的低优先级线程上读取快照
+    MetricsServer metricsServer;
+
+    // 界面线程持有的副本
+    StreamStats::Snapshot statsSnapshot = StreamStats::Snapshot();
+    std::vector<SinkSet::SinkStats> sinkStats;
+    std::vector<ThreadTuning::ThreadReport> threadReports;
+    std::vector<std::string> threadWarnings;
 };
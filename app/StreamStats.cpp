@@ -0,0 +1,104 @@
+#include "StreamStats.h"
+#include <chrono>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+} // namespace
+
+StreamStats::StreamStats()
+    : historyCount(0),
+      historyNext(0),
+      startUs(0),
+      sampleCount(0) {
+    reset();
+}
+
+void StreamStats::reset() {
+    for (unsigned int i = 0; i < kStages; i++) {
+        counters[i].frames.store(0, std::memory_order_relaxed);
+    }
+    historyCount = 0;
+    historyNext = 0;
+    startUs = nowMicros();
+}
+
+void StreamStats::publish(Snapshot& snapshot) {
+    snapshot.timestampUs = nowMicros();
+    snapshot.uptimeUs = snapshot.timestampUs - startUs;
+    snapshot.version = ++sampleCount;
+
+    Sample current;
+    current.timestampUs = snapshot.timestampUs;
+    for (unsigned int i = 0; i < kStages; i++) {
+        current.frames[i] = snapshot.frames[i];
+    }
+    current.bytes = snapshot.bytesSent;
+    current.packets = snapshot.packetsSent;
+    current.drops = snapshot.totalDrops();
+
+    const Sample* shortStart = windowStart(current.timestampUs, kShortWindowMs * 1000ull);
+    const Sample* longStart = windowStart(current.timestampUs, kLongWindowMs * 1000ull);
+    snapshot.shortWindow = shortStart ? rates(*shortStart, current) : Rates();
+    snapshot.longWindow = longStart ? rates(*longStart, current) : Rates();
+
+    history[historyNext] = current;
+    historyNext = (historyNext + 1) % kHistory;
+    if (historyCount < kHistory) {
+        historyCount++;
+    }
+
+    published.store(snapshot);
+}
+
+const StreamStats::Sample* StreamStats::windowStart(uint64_t nowUs, uint64_t windowUs) const {
+    if (historyCount == 0) {
+        return nullptr;
+    }
+
+    // 从最新往最旧找，第一个达到窗口长度的采样即为起点
+    const Sample* oldest = nullptr;
+    for (unsigned int i = 1; i <= historyCount; i++) {
+        const Sample& sample = history[(historyNext + kHistory - i) % kHistory];
+        oldest = &sample;
+        if (nowUs - sample.timestampUs >= windowUs) {
+            break;
+        }
+    }
+    return oldest;
+}
+
+StreamStats::Rates StreamStats::rates(const Sample& from, const Sample& to) {
+    Rates result = Rates();
+    if (to.timestampUs <= from.timestampUs) {
+        return result;
+    }
+
+    // 计数只增不减；推流重启时窗口已随reset清空，差值不会为负
+    double seconds = (to.timestampUs - from.timestampUs) / 1000000.0;
+    for (unsigned int i = 0; i < kStages; i++) {
+        result.fps[i] = (to.frames[i] - from.frames[i]) / seconds;
+    }
+    result.bitrateKbps = (to.bytes - from.bytes) * 8.0 / 1000.0 / seconds;
+    result.packetsPerSecond = (to.packets - from.packets) / seconds;
+    result.dropsPerSecond = (to.drops - from.drops) / seconds;
+    return result;
+}
+
+const char* StreamStats::stageName(Stage stage) {
+    switch (stage) {
+    case Stage::Capture: return "capture";
+    case Stage::Encode: return "encode";
+    case Stage::Send: return "send";
+    default: return "unknown";
+    }
+}
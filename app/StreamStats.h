@@ -0,0 +1,146 @@
+#pragma once
+
+#include "SeqLock.h"
+#include "FrameDropPolicy.h"
+#include "FrameMailbox.h"
+#include "FramePool.h"
+#include "FrameClock.h"
+#include "PipelineLatency.h"
+#include "SharedMemoryTransport.h"
+
+#include <stdint.h>
+#include <atomic>
+
+using namespace std;
+
+// 推流统计：工作线程只递增各自的64位计数器；统计线程每kSampleIntervalMs把这些计数器和各模块的统计
+// 汇总为一份快照，算出1秒和10秒滑动窗口内的速率，以序列锁发布。界面和导出接口只读取快照，
+// 不直接读工作线程写入的数据，也不会读到一半新一半旧的快照；读取不加锁，不阻塞统计线程
+class StreamStats {
+public:
+    enum class Stage {
+        Capture,
+        Encode,
+        Send,
+        Count
+    };
+
+    static const unsigned int kStages = static_cast<unsigned int>(Stage::Count);
+
+    static const unsigned int kSampleIntervalMs = 100;
+    static const unsigned int kShortWindowMs = 1000;
+    static const unsigned int kLongWindowMs = 10000;
+
+    // 滑动窗口内的速率
+    struct Rates {
+        double fps[kStages];
+        double bitrateKbps;         // 发出的数据速率（各目的地之和，或写入共享内存的速率）
+        double packetsPerSecond;
+        double dropsPerSecond;      // 各阶段和各目的地的丢帧之和
+
+        double stageFps(Stage stage) const { return fps[static_cast<unsigned int>(stage)]; }
+    };
+
+    // 一次采样的完整快照。计数均为启动以来的累计值（64位），仪表为采样时刻的瞬时值
+    struct Snapshot {
+        uint64_t version;               // 第几次采样，0表示尚未采样
+        uint64_t timestampUs;           // 采样时刻（steady_clock微秒）
+        uint64_t uptimeUs;              // 启动以来的时长
+
+        // 计数
+        uint64_t frames[kStages];       // 各阶段处理完成的帧
+        uint64_t bytesSent;
+        uint64_t packetsSent;
+        uint64_t blockedSends;          // 发送缓冲区满、丢弃剩余分包的次数（各目的地之和）
+        uint64_t sendErrors;            // 其他套接字发送错误（各目的地之和）
+        uint64_t sinkFramesDropped;     // 各目的地发送前丢弃的帧
+        uint64_t reportsReceived;
+
+        // 滑动窗口速率
+        Rates shortWindow;              // kShortWindowMs
+        Rates longWindow;               // kLongWindowMs
+
+        // 仪表
+        uint32_t captureQueueDepth;     // 采集→编码信箱中未取走的帧（0或1）
+        uint32_t encodeQueueDepth;      // 编码→发送信箱中未取走的帧（0或1）
+        uint32_t sinkQueueDepth;        // 各目的地发送队列中的帧之和
+        uint32_t sinkQueueMax;          // 最长的目的地发送队列
+        uint32_t sinks;
+        uint32_t targetBitrateKbps;
+
+        // 各模块的统计
+        FrameDropPolicy::Stats drops;   // 采集、编码阶段及共享内存输出的丢帧
+        HandoffStats captureHandoff;
+        HandoffStats encodeHandoff;
+        FramePoolStats framePool;
+        FramePoolStats packetPool;
+        FrameClock::Stats captureClock;
+        PipelineLatency::Stats latency;
+        SharedMemoryWriter::Stats sharedMemory;
+
+        uint64_t stageFrames(Stage stage) const { return frames[static_cast<unsigned int>(stage)]; }
+        uint64_t totalDrops() const { return drops.total() + sinkFramesDropped; }
+    };
+
+    StreamStats();
+
+    StreamStats(const StreamStats&) = delete;
+    StreamStats& operator=(const StreamStats&) = delete;
+
+    // 计数器清零、滑动窗口重新开始，只能在工作线程和统计线程都未运行时调用。
+    // 已发布的快照保留到下一次采样（停止推流后界面仍显示最后的统计）
+    void reset();
+
+    // 工作线程：一帧完成了某个阶段。每个阶段只由一个线程计数（run-to-completion时同一线程计三个阶段）
+    void addFrame(Stage stage) {
+        std::atomic<uint64_t>& counter = counters[static_cast<unsigned int>(stage)].frames;
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    uint64_t getFrames(Stage stage) const {
+        return counters[static_cast<unsigned int>(stage)].frames.load(std::memory_order_relaxed);
+    }
+
+    // 统计线程：snapshot中已填好计数、仪表和各模块的统计，补上版本、时长和速率后发布
+    void publish(Snapshot& snapshot);
+
+    // 任意线程：读取最近发布的快照，返回其版本
+    uint64_t read(Snapshot& snapshot) const { return published.load(snapshot); }
+    Snapshot read() const { return published.load(); }
+    uint64_t version() const { return published.version(); }
+
+    static const char* stageName(Stage stage);
+
+private:
+    // 每个阶段的计数器独占一个缓存行，各线程递增时互不干扰
+    struct alignas(64) StageCounters {
+        std::atomic<uint64_t> frames;
+    };
+
+    // 计算速率用的累计值
+    struct Sample {
+        uint64_t timestampUs;
+        uint64_t frames[kStages];
+        uint64_t bytes;
+        uint64_t packets;
+        uint64_t drops;
+    };
+
+    // 覆盖长窗口所需的采样数（含窗口起点）
+    static const unsigned int kHistory = kLongWindowMs / kSampleIntervalMs + 1;
+
+    StageCounters counters[kStages];
+
+    // 以下仅由统计线程访问
+    Sample history[kHistory];
+    unsigned int historyCount;
+    unsigned int historyNext;
+    uint64_t startUs;
+    uint64_t sampleCount;
+
+    SeqLock<Snapshot> published;
+
+    // 取窗口起点：最近一个不晚于now - windowUs的采样，采样不足一个窗口时取最早的采样
+    const Sample* windowStart(uint64_t nowUs, uint64_t windowUs) const;
+    static Rates rates(const Sample& from, const Sample& to);
+};
@@ -0,0 +1,195 @@
+#include "FrameClock.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #include <mmsystem.h>
+    #pragma comment(lib, "winmm.lib")
+#endif
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// 系统休眠的唤醒误差：Windows在时钟分辨率提高到1ms后约1ms，其他平台约50us
+unsigned int defaultSpinUs() {
+#ifdef _WIN32
+    return 1500;
+#else
+    return 200;
+#endif
+}
+
+} // namespace
+
+FrameClock::FrameClock()
+    : intervalUs(0.0),
+      anchorUs(0),
+      nextTick(0),
+      adaptiveSpin(true),
+      phaseLocked(false),
+      spinEstimateUs(0.0),
+      targetFps(0),
+      ticks(0),
+      missedTicks(0),
+      firstTickUs(0),
+      lastTickUs(0),
+      spinUs(0),
+      oversleepSamples(0),
+      totalOversleepUs(0),
+      phaseCorrections(0),
+      phaseErrorUs(0) {
+    configure(Config());
+}
+
+void FrameClock::configure(const Config& config) {
+    this->config = config;
+    this->config.frameRate = std::max(config.frameRate, 1u);
+    this->config.phaseGain = std::min(std::max(config.phaseGain, 0.0), 1.0);
+    intervalUs = 1000000.0 / this->config.frameRate;
+
+    // 自适应时从平台默认值开始，随唤醒误差的测量收敛
+    adaptiveSpin = config.spinUs == 0;
+    spinEstimateUs = adaptiveSpin ? defaultSpinUs() : config.spinUs;
+#ifdef _WIN32
+    // 把系统时钟分辨率提高到1ms，进程退出时自动恢复
+    timeBeginPeriod(1);
+#endif
+
+    anchorUs = nowMicros();
+    nextTick = 0;
+    phaseLocked = false;
+
+    targetFps.store(this->config.frameRate, std::memory_order_relaxed);
+    ticks.store(0, std::memory_order_relaxed);
+    missedTicks.store(0, std::memory_order_relaxed);
+    firstTickUs.store(0, std::memory_order_relaxed);
+    lastTickUs.store(0, std::memory_order_relaxed);
+    spinUs.store(static_cast<unsigned int>(spinEstimateUs), std::memory_order_relaxed);
+    oversleepSamples.store(0, std::memory_order_relaxed);
+    totalOversleepUs.store(0, std::memory_order_relaxed);
+    phaseCorrections.store(0, std::memory_order_relaxed);
+    phaseErrorUs.store(0, std::memory_order_relaxed);
+    lateness.reset();
+}
+
+uint64_t FrameClock::deadlineOf(uint64_t tick) const {
+    return anchorUs + static_cast<uint64_t>(std::llround(tick * intervalUs));
+}
+
+uint64_t FrameClock::waitNextTick() {
+    uint64_t deadline = deadlineOf(nextTick);
+    uint64_t now = nowMicros();
+
+    // 落后一个帧间隔以上：跳到最近一个已到的节拍，其间的节拍计为错过
+    uint64_t skipped = 0;
+    if (config.skipMissed && now >= deadline + static_cast<uint64_t>(intervalUs)) {
+        skipped = static_cast<uint64_t>((now - deadline) / intervalUs);
+        nextTick += skipped;
+        deadline = deadlineOf(nextTick);
+    }
+    nextTick++;
+
+    uint64_t oversleepUs = 0;
+    bool slept = false;
+    unsigned int currentSpinUs = static_cast<unsigned int>(spinEstimateUs);
+    if (now < deadline && deadline - now > currentSpinUs) {
+        uint64_t wakeTarget = deadline - currentSpinUs;
+        std::this_thread::sleep_for(std::chrono::microseconds(wakeTarget - now));
+        uint64_t woke = nowMicros();
+        oversleepUs = woke > wakeTarget ? woke - wakeTarget : 0;
+        slept = true;
+
+        // 随机分位数估计：误差超过估计值时上调q/(1-q)步，否则下调一步，稳定在q分位上。
+        // 自旋不超过半个帧间隔，以免高帧率下整段等待都在自旋
+        if (adaptiveSpin) {
+            if (oversleepUs > spinEstimateUs) {
+                spinEstimateUs += kSpinStepUs * kSpinQuantile / (1.0 - kSpinQuantile);
+            } else {
+                spinEstimateUs -= kSpinStepUs;
+            }
+            double maxSpin = std::min(static_cast<double>(kMaxSpinUs), intervalUs / 2);
+            spinEstimateUs = std::min(std::max(spinEstimateUs, static_cast<double>(kMinSpinUs)), maxSpin);
+            currentSpinUs = static_cast<unsigned int>(spinEstimateUs);
+        }
+    }
+
+    uint64_t fired = nowMicros();
+    while (fired < deadline) {
+        std::this_thread::yield();
+        fired = nowMicros();
+    }
+
+    // 节拍数最后写入：读取方看到的节拍数对应的时刻已经可见
+    uint64_t tick = ticks.load(std::memory_order_relaxed);
+    if (tick == 0) {
+        firstTickUs.store(fired, std::memory_order_relaxed);
+    }
+    lastTickUs.store(fired, std::memory_order_relaxed);
+    increment(missedTicks, skipped);
+    spinUs.store(currentSpinUs, std::memory_order_relaxed);
+    if (slept) {
+        increment(oversleepSamples, 1);
+        increment(totalOversleepUs, oversleepUs);
+    }
+    lateness.record((fired - deadline) * 1000);
+    ticks.store(tick + 1, std::memory_order_release);
+    return deadline;
+}
+
+void FrameClock::alignTo(uint64_t signalUs) {
+    // 相位误差：期望节拍时刻（信号 + 偏移）相对最近节拍的距离，折算到(-interval/2, interval/2]
+    int64_t target = static_cast<int64_t>(signalUs) + config.phaseOffsetUs;
+    double error = std::fmod(static_cast<double>(target - static_cast<int64_t>(anchorUs)), intervalUs);
+    if (error > intervalUs / 2) {
+        error -= intervalUs;
+    } else if (error <= -intervalUs / 2) {
+        error += intervalUs;
+    }
+
+    // 首次对齐直接校正，之后按比例逐步修正，单次呈现时刻的抖动不会让节拍跳动
+    double correction = phaseLocked ? error * config.phaseGain : error;
+    phaseLocked = true;
+    int64_t shift = static_cast<int64_t>(std::llround(correction));
+    anchorUs = static_cast<uint64_t>(static_cast<int64_t>(anchorUs) + shift);
+
+    increment(phaseCorrections, 1);
+    phaseErrorUs.store(static_cast<int64_t>(std::llround(error)), std::memory_order_relaxed);
+}
+
+FrameClock::Stats FrameClock::getStats() const {
+    Stats stats;
+    stats.ticks = ticks.load(std::memory_order_acquire);
+    uint64_t first = firstTickUs.load(std::memory_order_relaxed);
+    uint64_t last = lastTickUs.load(std::memory_order_relaxed);
+    stats.missedTicks = missedTicks.load(std::memory_order_relaxed);
+    stats.targetFps = targetFps.load(std::memory_order_relaxed);
+    stats.achievedFps = stats.ticks > 1 && last > first ? (stats.ticks - 1) * 1000000.0 / (last - first) : 0.0;
+
+    HdrHistogram::Summary summary = lateness.summarize();
+    stats.avgLatenessUs = summary.meanNs / 1000.0;
+    stats.latenessP50Us = static_cast<int64_t>(summary.p50Ns / 1000);
+    stats.latenessP99Us = static_cast<int64_t>(summary.p99Ns / 1000);
+    stats.latenessMaxUs = static_cast<int64_t>(summary.maxNs / 1000);
+
+    uint64_t samples = oversleepSamples.load(std::memory_order_relaxed);
+    stats.avgOversleepUs = samples ? static_cast<double>(totalOversleepUs.load(std::memory_order_relaxed)) / samples : 0.0;
+    stats.spinUs = spinUs.load(std::memory_order_relaxed);
+    stats.phaseCorrections = phaseCorrections.load(std::memory_order_relaxed);
+    stats.phaseErrorUs = phaseErrorUs.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "HdrHistogram.h"
+#include <stdint.h>
+#include <atomic>
+
+using namespace std;
+
+// 采集节拍时钟：第n个节拍的截止时刻为 起点 + n × 帧间隔（单调时钟的绝对时刻），
+// 采集本身的耗时不会累积成漂移。等待先休眠到截止时刻前spinUs，剩余时间自旋；
+// 自旋阈值可按测得的休眠唤醒误差自适应，跟踪误差的90分位（偶发的长时间延迟不会把阈值推高）。
+// 落后超过一个帧间隔时可跳过错过的节拍，直接对齐到最近已到的节拍，而不是连续补采。
+// alignTo按外部信号（如显示器的呈现时刻）平移起点，使节拍落在信号之后phaseOffsetUs处。
+// 统计由节拍线程以原子量写入、节拍抖动记入无锁HDR直方图，getStats不取锁，不会阻塞（可能是实时优先级的）节拍线程
+// 与LowLatencyStreamer的FrameClock相同
+class FrameClock {
+public:
+    struct Config {
+        unsigned int frameRate = 60;
+        unsigned int spinUs = 0;            // 自旋阈值，0表示按测得的唤醒误差自适应
+        bool skipMissed = true;             // 跳过错过的节拍
+        int phaseOffsetUs = 500;            // 节拍相对外部信号的偏移
+        double phaseGain = 0.125;           // 每次对齐修正相位误差的比例（首次对齐直接校正）
+    };
+
+    struct Stats {
+        uint64_t ticks;                 // 已触发的节拍
+        uint64_t missedTicks;           // 被跳过的节拍
+        double targetFps;
+        double achievedFps;             // 首个节拍到最近节拍之间的实际节拍率
+        double avgLatenessUs;           // 实际唤醒时刻晚于截止时刻的平均值（节拍抖动）
+        int64_t latenessP50Us;
+        int64_t latenessP99Us;
+        int64_t latenessMaxUs;
+        double avgOversleepUs;          // 系统休眠比请求时刻晚醒的平均值
+        unsigned int spinUs;            // 当前自旋阈值
+        uint64_t phaseCorrections;      // alignTo的调用次数
+        int64_t phaseErrorUs;           // 最近一次对齐时的相位误差
+    };
+
+    FrameClock();
+
+    // 配置并以当前时刻为起点，在节拍线程上（开始等待节拍之前）或节拍线程未运行时调用
+    void configure(const Config& config);
+
+    // 等待下一个节拍（仅节拍线程调用），返回该节拍的截止时刻
+    uint64_t waitNextTick();
+
+    // 外部信号发生在signalUs（steady_clock微秒），把节拍相位向它对齐（仅节拍线程调用）。
+    // 只有帧率为信号频率的整数倍时，信号才会稳定落在同一相位上
+    void alignTo(uint64_t signalUs);
+
+    // 可在任意线程上调用，不取锁；各字段分别读取，与并发的节拍之间不是原子快照（可能相差正在触发的一个节拍）
+    Stats getStats() const;
+
+    // 节拍晚于截止时刻的纳秒直方图（供指标导出）
+    const HdrHistogram& latenessHistogram() const { return lateness; }
+
+private:
+    static const unsigned int kMinSpinUs = 50;
+    static const unsigned int kMaxSpinUs = 4000;
+    static const unsigned int kSpinStepUs = 4;      // 分位数估计的步长
+    static constexpr double kSpinQuantile = 0.9;
+
+    Config config;
+    double intervalUs;
+
+    // 以下仅由节拍线程访问
+    uint64_t anchorUs;          // 第0个节拍的截止时刻
+    uint64_t nextTick;
+    bool adaptiveSpin;
+    bool phaseLocked;
+    double spinEstimateUs;      // 唤醒误差分位数的估计
+
+    // 统计信息（只由节拍线程写入，其他线程不取锁读取）
+    std::atomic<unsigned int> targetFps;
+    std::atomic<uint64_t> ticks;
+    std::atomic<uint64_t> missedTicks;
+    std::atomic<uint64_t> firstTickUs;
+    std::atomic<uint64_t> lastTickUs;
+    std::atomic<unsigned int> spinUs;
+    std::atomic<uint64_t> oversleepSamples;
+    std::atomic<uint64_t> totalOversleepUs;
+    std::atomic<uint64_t> phaseCorrections;
+    std::atomic<int64_t> phaseErrorUs;
+    HdrHistogram lateness;          // 纳秒
+
+    // 单写入方的累加：读出再写回，不需要原子的读改写
+    static void increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    uint64_t deadlineOf(uint64_t tick) const;
+};
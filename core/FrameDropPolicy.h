@@ -0,0 +1,137 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+
+// 按截止时刻和优先级丢帧：每帧从采集起带有截止时刻（采集时刻 + 期限）和优先级，
+// 在每个阶段边界（采集→编码、编码→发送、发送前）检查，已过期的帧不再继续处理。
+// 优先级由编码结果判定：IDR > 参考帧 > 非参考帧。队列已满或发送拥塞时先丢低优先级的帧。
+// 编码前过期的帧一律丢弃；编码后过期时只丢弃非参考帧，参考帧和IDR晚到也发送（丢弃它们要靠IDR恢复）。
+// 参考帧被丢弃后，其后的非IDR帧无法解码，直到下一个IDR之前一并丢弃，同时请求编码器立即插入IDR。
+// 与LowLatencyStreamer的FrameDropPolicy相同
+class FrameDropPolicy {
+public:
+    enum class Priority : uint8_t {
+        NonReference,   // 不被其他帧参考（nal_ref_idc为0），丢弃不影响后续帧
+        Reference,
+        Idr
+    };
+
+    // 丢弃发生的阶段边界
+    enum class Stage : uint8_t {
+        Capture,        // 采集→编码
+        Encode,         // 编码→发送
+        Send            // 发送前
+    };
+
+    enum class Reason : uint8_t {
+        QueueFull,      // 队列已满被挤掉
+        Expired,        // 超过截止时刻
+        Congestion,     // 发送拥塞时丢弃低优先级帧
+        ReferenceLost   // 所参考的帧已被丢弃
+    };
+
+    static const unsigned int kPriorities = 3;
+    static const unsigned int kStages = 3;
+    static const unsigned int kReasons = 4;
+
+    struct Config {
+        unsigned int deadlineMs = 0;    // 采集后超过该时间仍未发出的帧丢弃，0表示不按截止时刻丢弃
+        bool congestionDrop = true;     // 发送拥塞时丢弃非参考帧
+    };
+
+    // 在阶段之间传递的帧信息
+    struct FrameInfo {
+        uint64_t sequence = 0;          // 采集顺序编号，用于判断帧是否在丢失的参考帧之后
+        uint64_t captureUs = 0;         // 采集时刻（steady_clock微秒）
+        uint64_t deadlineUs = 0;        // 0表示无截止时刻
+        Priority priority = Priority::Reference;
+    };
+
+    struct Stats {
+        uint64_t framesAdmitted;                    // 通过放行检查的帧
+        uint64_t framesLate;                        // 其中已过截止时刻、因是参考帧或IDR仍然发送的帧
+        uint64_t dropped[kStages][kReasons];        // 按阶段和原因统计的丢帧数
+        uint64_t droppedByPriority[kPriorities];    // 编码后丢弃的帧（采集阶段的帧尚无优先级）
+        uint64_t keyframeRequests;                  // 因参考帧丢失请求的IDR
+
+        uint64_t total() const;
+        uint64_t byStage(Stage stage) const;
+        uint64_t byReason(Reason reason) const;
+    };
+
+    FrameDropPolicy();
+
+    // 在各线程启动前调用，参考链状态和统计重新开始
+    void configure(const Config& config);
+    const Config& getConfig() const { return config; }
+
+    // 由编码输出判定优先级：第一个图像切片为IDR时为Idr，否则按nal_ref_idc区分；
+    // 找不到切片（非H.264数据）时按参考帧处理
+    static Priority classify(const uint8_t* data, size_t size);
+
+    // 采集时为帧分配编号和截止时刻
+    FrameInfo makeFrame(uint64_t captureUs);
+
+    // 阶段边界检查：帧已过截止时刻且可以丢弃时记录丢弃并返回true
+    bool expire(Stage stage, const FrameInfo& frame, uint64_t nowUs);
+
+    // 编码后帧的放行检查（通常在发送前）：依次判断参考链、截止时刻和拥塞，
+    // 可以继续处理时返回true，否则记录在stage的丢弃原因
+    bool admit(Stage stage, const FrameInfo& frame, uint64_t nowUs, bool congested);
+
+    // 记录一次丢弃（如队列已满时由调用方选出的帧），参考帧的丢弃会中断参考链
+    void drop(Stage stage, Reason reason, const FrameInfo& frame);
+
+    // 队列已满时挤掉哪一帧：优先级最低的帧中最早的一个。candidates按从旧到新排列，
+    // 返回其下标。IDR只会被更新的IDR挤掉，此时较旧的帧都已无用
+    template <typename Iterator, typename InfoOf>
+    static size_t selectVictim(Iterator begin, Iterator end, InfoOf infoOf) {
+        size_t victim = 0;
+        Priority lowest = Priority::Idr;
+        size_t index = 0;
+        for (Iterator it = begin; it != end; ++it, index++) {
+            Priority priority = infoOf(*it).priority;
+            if (index == 0 || priority < lowest) {
+                lowest = priority;
+                victim = index;
+            }
+        }
+        return victim;
+    }
+
+    // 编码线程在编码前取走IDR请求
+    bool takeKeyframeRequest() { return keyframeRequested.exchange(false, std::memory_order_relaxed); }
+
+    Stats getStats() const;
+
+    static const char* priorityName(Priority priority);
+    static const char* stageName(Stage stage);
+    static const char* reasonName(Reason reason);
+
+private:
+    Config config;
+    std::atomic<uint64_t> nextSequence;
+
+    // 参考链状态：自lastIdrSequence之后第一个丢失的参考帧编号，0表示参考链完整
+    std::mutex chainMutex;
+    uint64_t lastIdrSequence;
+    uint64_t firstLostSequence;
+
+    std::atomic<bool> keyframeRequested;
+
+    std::atomic<uint64_t> framesAdmitted;
+    std::atomic<uint64_t> framesLate;
+    std::atomic<uint64_t> dropped[kStages][kReasons];
+    std::atomic<uint64_t> droppedByPriority[kPriorities];
+    std::atomic<uint64_t> keyframeRequests;
+
+    void reset();
+    static bool isLate(const FrameInfo& frame, uint64_t nowUs);
+    bool referenceLost(const FrameInfo& frame);
+    void count(Stage stage, Reason reason, Priority priority);
+};
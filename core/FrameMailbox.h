@@ -0,0 +1,241 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #pragma comment(lib, "synchronization.lib")
+#else
+    #include <unistd.h>
+    #include <time.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+#endif
+
+using namespace std;
+
+// 帧交接统计：发布到取走的延迟按2的幂分桶，各线程可随时读取快照
+struct HandoffStats {
+    static const unsigned int kBuckets = 24;   // 桶i为[2^(i-1), 2^i)微秒，桶0为0微秒
+
+    uint64_t published;         // 发布的帧数
+    uint64_t taken;             // 被消费者取走的帧数
+    uint64_t overwritten;       // 未被取走就被新帧覆盖的帧数
+    uint64_t totalLatencyUs;
+    uint64_t maxLatencyUs;
+    uint64_t buckets[kBuckets];
+
+    double meanUs() const {
+        return taken > 0 ? static_cast<double>(totalLatencyUs) / taken : 0.0;
+    }
+
+    // 返回所在桶的上界（不超过最大值）
+    uint64_t percentileUs(double fraction) const {
+        uint64_t target = static_cast<uint64_t>(fraction * taken);
+        uint64_t seen = 0;
+        for (unsigned int i = 0; i < kBuckets; i++) {
+            seen += buckets[i];
+            if (seen > target) {
+                uint64_t upper = i == 0 ? 0 : (1ull << i) - 1;
+                return upper < maxLatencyUs ? upper : maxLatencyUs;
+            }
+        }
+        return maxLatencyUs;
+    }
+};
+
+// 单生产者单消费者的"最新值"信箱（三缓冲）：生产者和消费者各持有一个槽位，
+// 第三个槽位在两者之间交换。发布和取走都只是一次原子交换加一次swap，不复制帧数据，不分配内存；
+// 消费者还没取走的帧被新帧覆盖，交还给生产者以便统计丢帧或复用缓冲区。
+// wait在没有新帧时阻塞：Linux上用futex，Windows上用WaitOnAddress，
+// 只有消费者正在等待时生产者才进入内核唤醒，帧发布后消费者立即醒来
+template <typename T>
+class FrameMailbox {
+public:
+    FrameMailbox() {
+        reset();
+    }
+
+    FrameMailbox(const FrameMailbox&) = delete;
+    FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+    // 清空槽位和统计，只能在生产者和消费者线程都未运行时调用
+    void reset() {
+        for (unsigned int i = 0; i < kSlots; i++) {
+            slots[i].value = T();
+            slots[i].publishUs = 0;
+        }
+        producerSlot = 0;
+        consumerSlot = 1;
+        state.store(2, std::memory_order_relaxed);
+        published = 0;
+        taken = 0;
+        overwritten = 0;
+        totalLatencyUs = 0;
+        maxLatencyUs = 0;
+        for (unsigned int i = 0; i < HandoffStats::kBuckets; i++) {
+            buckets[i] = 0;
+        }
+    }
+
+    // 生产者：把value换入信箱。返回后value中是换出的旧槽位内容：
+    // 返回true时是未被取走就被覆盖的帧，返回false时是消费者已用过的槽位，可以复用
+    bool publish(T& value) {
+        Slot& slot = slots[producerSlot];
+        std::swap(slot.value, value);
+        slot.publishUs = nowMicros();
+
+        uint32_t previous = state.exchange(producerSlot | kFreshBit, std::memory_order_acq_rel);
+        producerSlot = previous & kSlotMask;
+        std::swap(slots[producerSlot].value, value);
+
+        published.fetch_add(1, std::memory_order_relaxed);
+        bool replaced = (previous & kFreshBit) != 0;
+        if (replaced) {
+            overwritten.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (previous & kWaitingBit) {
+            wake();
+        }
+        return replaced;
+    }
+
+    // 生产者：上一次发布的帧是否还未被取走（可据此决定是否值得覆盖）
+    bool pending() const {
+        return (state.load(std::memory_order_acquire) & kFreshBit) != 0;
+    }
+
+    // 消费者：取走最新的帧，没有新帧时返回false。value原有的内容换入信箱，之后交还给生产者
+    bool take(T& value) {
+        if (!(state.load(std::memory_order_acquire) & kFreshBit)) {
+            return false;
+        }
+        uint32_t previous = state.exchange(consumerSlot, std::memory_order_acq_rel);
+        consumerSlot = previous & kSlotMask;
+        Slot& slot = slots[consumerSlot];
+        std::swap(slot.value, value);
+        recordLatency(nowMicros() - slot.publishUs);
+        return true;
+    }
+
+    // 消费者：没有新帧时最多等待timeoutUs微秒。被notify、超时或虚假唤醒时返回false，
+    // 调用方检查停止标志后重新等待
+    bool wait(T& value, unsigned int timeoutUs) {
+        for (;;) {
+            if (take(value)) {
+                return true;
+            }
+            // 置等待位：其间有帧发布时CAS失败，回到开头重新取
+            uint32_t current = state.load(std::memory_order_acquire);
+            if (current & kFreshBit) {
+                continue;
+            }
+            if (!(current & kWaitingBit) &&
+                !state.compare_exchange_strong(current, current | kWaitingBit, std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {
+                continue;
+            }
+            waitOnState(current | kWaitingBit, timeoutUs);
+            if (take(value)) {
+                return true;
+            }
+            state.fetch_and(~kWaitingBit, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    // 唤醒正在wait的消费者（如停止时）
+    void notify() {
+        if (state.fetch_and(~kWaitingBit, std::memory_order_acq_rel) & kWaitingBit) {
+            wake();
+        }
+    }
+
+    HandoffStats getStats() const {
+        HandoffStats stats;
+        stats.published = published.load(std::memory_order_relaxed);
+        stats.taken = taken.load(std::memory_order_relaxed);
+        stats.overwritten = overwritten.load(std::memory_order_relaxed);
+        stats.totalLatencyUs = totalLatencyUs.load(std::memory_order_relaxed);
+        stats.maxLatencyUs = maxLatencyUs.load(std::memory_order_relaxed);
+        for (unsigned int i = 0; i < HandoffStats::kBuckets; i++) {
+            stats.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+
+private:
+    static const unsigned int kSlots = 3;
+    static const uint32_t kSlotMask = 3;        // 交换槽位的下标
+    static const uint32_t kFreshBit = 4;        // 交换槽位中有未取走的帧
+    static const uint32_t kWaitingBit = 8;      // 消费者正在等待
+
+    struct alignas(64) Slot {
+        T value;
+        uint64_t publishUs;
+    };
+
+    Slot slots[kSlots];
+
+    // 生产者和消费者各自持有的槽位，分别只由一方访问
+    alignas(64) uint32_t producerSlot;
+    alignas(64) uint32_t consumerSlot;
+
+    // 交换槽位的下标和标志位
+    alignas(64) std::atomic<uint32_t> state;
+
+    // 统计（发布计数由生产者写入，其余由消费者写入，其他线程读取快照）
+    alignas(64) std::atomic<uint64_t> published;
+    std::atomic<uint64_t> taken;
+    std::atomic<uint64_t> overwritten;
+    std::atomic<uint64_t> totalLatencyUs;
+    std::atomic<uint64_t> maxLatencyUs;
+    std::atomic<uint64_t> buckets[HandoffStats::kBuckets];
+
+    static uint64_t nowMicros() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+
+    void recordLatency(uint64_t latencyUs) {
+        taken.fetch_add(1, std::memory_order_relaxed);
+        totalLatencyUs.fetch_add(latencyUs, std::memory_order_relaxed);
+        if (latencyUs > maxLatencyUs.load(std::memory_order_relaxed)) {
+            maxLatencyUs.store(latencyUs, std::memory_order_relaxed);
+        }
+        unsigned int bucket = 0;
+        while (bucket < HandoffStats::kBuckets - 1 && (latencyUs >> bucket) != 0) {
+            bucket++;
+        }
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void waitOnState(uint32_t observed, unsigned int timeoutUs) {
+#ifdef _WIN32
+        DWORD timeoutMs = static_cast<DWORD>((timeoutUs + 999) / 1000);
+        WaitOnAddress(reinterpret_cast<volatile VOID*>(&state), &observed, sizeof(observed), timeoutMs);
+#else
+        // 值已改变时立即返回EAGAIN
+        struct timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(timeoutUs / 1000000);
+        timeout.tv_nsec = static_cast<long>(timeoutUs % 1000000) * 1000;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state), FUTEX_WAIT_PRIVATE, observed, &timeout, nullptr, 0);
+#endif
+    }
+
+    void wake() {
+#ifdef _WIN32
+        WakeByAddressSingle(reinterpret_cast<PVOID>(&state));
+#else
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+};
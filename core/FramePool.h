@@ -0,0 +1,205 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+using namespace std;
+
+// 帧缓冲区池的统计
+struct FramePoolStats {
+    uint64_t acquires;          // 借出次数
+    uint64_t buffersAllocated;  // 新建的缓冲区（空闲列表为空时）
+    uint64_t growths;           // 借出期间容量增长（缓冲区内部重新分配）的次数
+    uint64_t buffersInUse;
+    uint64_t peakBuffersInUse;
+    uint64_t retainedBytes;     // 各缓冲区最近一次归还时的容量之和
+    uint64_t peakRetainedBytes;
+
+    // 新建和增长都是一次堆分配
+    uint64_t allocations() const { return buffersAllocated + growths; }
+};
+
+// 帧缓冲区池：缓冲区用完后连同已分配的容量一起回到池中，下一帧直接复用，稳态下不再分配内存。
+// acquire返回的Lease是带引用计数的句柄，可以复制给多个发送目的地，最后一个Lease析构时
+// 调用T::recycle()（清空内容、保留容量）并把缓冲区放回空闲列表。
+// T需提供recycle()和capacityBytes()（当前占用的堆内存，用于统计增长次数和内存峰值）。
+// 统计计数在持有mutex时写入（借出和归还本就要取锁），getStats不取锁直接读取原子值，
+// 统计线程不会与借出和归还争锁；各计数分别读取，彼此之间不是原子快照。
+// 池必须比所有Lease活得更久
+template <typename T>
+class FramePool {
+public:
+    typedef FramePoolStats Stats;
+
+private:
+    struct Entry {
+        T value;
+        std::atomic<uint32_t> references;
+        size_t capacity;            // 上次归还时的容量
+        FramePool* pool;
+    };
+
+public:
+    class Lease {
+    public:
+        Lease() : entry(nullptr) {}
+        Lease(const Lease& other) : entry(other.entry) {
+            if (entry) {
+                entry->references.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        Lease(Lease&& other) noexcept : entry(other.entry) {
+            other.entry = nullptr;
+        }
+        ~Lease() {
+            reset();
+        }
+
+        Lease& operator=(Lease other) noexcept {
+            std::swap(entry, other.entry);
+            return *this;
+        }
+
+        // 提前归还（最后一个引用时）
+        void reset() {
+            if (entry && entry->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                entry->pool->release(entry);
+            }
+            entry = nullptr;
+        }
+
+        T* get() const { return &entry->value; }
+        T* operator->() const { return &entry->value; }
+        T& operator*() const { return entry->value; }
+        explicit operator bool() const { return entry != nullptr; }
+
+    private:
+        friend class FramePool;
+        explicit Lease(Entry* entry) : entry(entry) {}
+
+        Entry* entry;
+    };
+
+    FramePool() {
+        resetStats();
+    }
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // 预先创建count个缓冲区（不计入buffersAllocated），启动时调用以免第一批帧分配
+    void reserve(size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (entries.size() < count) {
+            addEntry();
+        }
+        freeList.reserve(entries.size());
+    }
+
+    Lease acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeList.empty()) {
+            addEntry();
+            increment(buffersAllocated, 1);
+        }
+        Entry* entry = freeList.back();
+        freeList.pop_back();
+        entry->references.store(1, std::memory_order_relaxed);
+
+        increment(acquires, 1);
+        increment(buffersInUse, 1);
+        raisePeak(peakBuffersInUse, buffersInUse.load(std::memory_order_relaxed));
+        return Lease(entry);
+    }
+
+    // 不取锁，可在统计线程上随时调用
+    Stats getStats() const {
+        Stats stats;
+        stats.acquires = acquires.load(std::memory_order_relaxed);
+        stats.buffersAllocated = buffersAllocated.load(std::memory_order_relaxed);
+        stats.growths = growths.load(std::memory_order_relaxed);
+        stats.buffersInUse = buffersInUse.load(std::memory_order_relaxed);
+        stats.peakBuffersInUse = peakBuffersInUse.load(std::memory_order_relaxed);
+        stats.retainedBytes = retainedBytes.load(std::memory_order_relaxed);
+        stats.peakRetainedBytes = peakRetainedBytes.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    // 统计重新开始（缓冲区和已保留的容量不变）
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        acquires.store(0, std::memory_order_relaxed);
+        buffersAllocated.store(0, std::memory_order_relaxed);
+        growths.store(0, std::memory_order_relaxed);
+        peakBuffersInUse.store(buffersInUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        peakRetainedBytes.store(retainedBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::vector<Entry*> freeList;
+
+    // 统计计数（持有mutex时写入，读取不取锁）
+    std::atomic<uint64_t> acquires{0};
+    std::atomic<uint64_t> buffersAllocated{0};
+    std::atomic<uint64_t> growths{0};
+    std::atomic<uint64_t> buffersInUse{0};
+    std::atomic<uint64_t> peakBuffersInUse{0};
+    std::atomic<uint64_t> retainedBytes{0};
+    std::atomic<uint64_t> peakRetainedBytes{0};
+
+    // 写入方已由mutex串行化，读出再写回即可，不需要原子的读改写
+    static void increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void raisePeak(std::atomic<uint64_t>& peak, uint64_t value) {
+        if (value > peak.load(std::memory_order_relaxed)) {
+            peak.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    // 调用方持有mutex
+    void addEntry() {
+        std::unique_ptr<Entry> entry(new Entry());
+        entry->references.store(0, std::memory_order_relaxed);
+        entry->capacity = entry->value.capacityBytes();
+        entry->pool = this;
+        increment(retainedBytes, entry->capacity);
+        freeList.push_back(entry.get());
+        entries.push_back(std::move(entry));
+        // 空闲列表预留到缓冲区总数，归还时不再分配
+        freeList.reserve(entries.size());
+    }
+
+    void release(Entry* entry) {
+        entry->value.recycle();
+        size_t capacity = entry->value.capacityBytes();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (capacity > entry->capacity) {
+            increment(growths, 1);
+        }
+        uint64_t retained = retainedBytes.load(std::memory_order_relaxed) - entry->capacity + capacity;
+        retainedBytes.store(retained, std::memory_order_relaxed);
+        raisePeak(peakRetainedBytes, retained);
+        entry->capacity = capacity;
+        buffersInUse.store(buffersInUse.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        freeList.push_back(entry);
+    }
+};
+
+// 编码输出缓冲区：NVEncoder::encode按帧大小resize，容量只增不减
+struct FrameBuffer {
+    std::vector<uint8_t> data;
+
+    void recycle() { data.clear(); }
+    size_t capacityBytes() const { return data.capacity(); }
+};
+
+typedef FramePool<FrameBuffer> FrameBufferPool;
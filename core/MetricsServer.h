@@ -0,0 +1,85 @@
+#pragma once
+
+#include "HdrHistogram.h"
+
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+// 确保Winsock头文件正确包含
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+#endif
+
+// OpenMetrics文本格式的拼装：先声明指标族（# TYPE、# UNIT、# HELP），紧接着写该族的样本，最后以# EOF结束。
+// 指标名和标签由调用方保证合法（小写字母、数字和下划线），标签写成key="value"，多个标签以逗号分隔
+class OpenMetricsWriter {
+public:
+    // 延迟直方图导出的桶上界（纳秒），以秒写入le标签
+    static const unsigned int kLatencyBuckets = 14;
+    static const uint64_t kLatencyBoundsNs[kLatencyBuckets];
+    static const char* const kLatencyBoundLabels[kLatencyBuckets];
+
+    // type为counter、gauge或histogram；unit非空时指标族名须以"_"加unit结尾
+    void family(const char* name, const char* type, const char* unit, const char* help);
+
+    // name为完整的样本名（计数器带_total后缀），labels为空表示不带标签
+    void sample(const char* name, const std::string& labels, uint64_t value);
+    void sample(const char* name, const std::string& labels, double value);
+
+    // 纳秒直方图按kLatencyBoundsNs写成以秒为单位的累积直方图（name_bucket、name_count、name_sum）
+    void histogram(const char* name, const std::string& labels, const HdrHistogram& histogram);
+
+    // 追加# EOF并返回全文
+    std::string finish();
+
+private:
+    std::string text;
+
+    void appendSample(const char* name, const char* suffix, const std::string& labels, const char* value);
+};
+
+// 本机指标导出：在127.0.0.1的TCP端口上以HTTP提供GET /metrics（OpenMetrics文本格式），供本机的采集代理抓取。
+// 单独的低优先级线程以非阻塞套接字等待连接，每次处理一个请求后关闭连接，慢客户端最多占用kRequestTimeoutMs。
+// 指标内容由collector在服务线程上生成，只应读取各模块的原子计数和无锁统计，不能与流水线线程争锁。
+// 与LowLatencyStreamer的MetricsServer相同
+class MetricsServer {
+public:
+    typedef std::function<std::string()> Collector;
+
+    static const unsigned int kPollIntervalMs = 200;    // 等待连接的超时，超时后检查退出标志
+    static const unsigned int kRequestTimeoutMs = 1000; // 读取请求和写出响应的总期限
+    static const size_t kMaxRequestBytes = 4096;
+
+    MetricsServer();
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // 绑定127.0.0.1:port并启动服务线程，端口被占用等失败时返回false
+    bool start(unsigned int port, Collector collector);
+    void stop();
+
+    bool isRunning() const { return running; }
+    unsigned int getPort() const { return port; }
+    uint64_t getScrapes() const { return scrapes.load(std::memory_order_relaxed); }
+
+private:
+    SOCKET listenSocket;
+    unsigned int port;
+    Collector collector;
+    std::thread serveThread;
+    std::atomic<bool> running;
+    std::atomic<uint64_t> scrapes;
+
+    void serveThreadFunc();
+    void handleConnection(SOCKET client);
+};
@@ -2,10 +2,21 @@
 #include <iostream>
 #include <cstring>
 #include <sstream>
+#include <chrono>
 
 // DirectX头文件
 #include <d3d11.h>
 
+namespace {
+
+uint64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+} // namespace
+
 NVEncoder::NVEncoder() {
 }
 
@@ -343,6 +354,58 @@ bool NVEncoder::createBitstreamBuffer() {
 }
 #endif
 
+bool NVEncoder::reconfigure(int bitrateKbps, int maxFrameBytes) {
+    if (!initialized) {
+        lastError = "Encoder not initialized";
+        return false;
+    }
+
+    if (bitrateKbps <= 0) {
+        lastError = "Invalid bitrate";
+        return false;
+    }
+
+#ifdef NVENC_AVAILABLE
+    try {
+        NV_ENC_CONFIG newConfig = *encodeConfig;
+        newConfig.rcParams.averageBitRate = bitrateKbps * 1000;
+        newConfig.rcParams.maxBitRate = bitrateKbps * 1000;
+        newConfig.rcParams.vbvBufferSize = maxFrameBytes > 0 ? maxFrameBytes * 8 : bitrateKbps * 1000 / fps;
+        newConfig.rcParams.vbvInitialDelay = newConfig.rcParams.vbvBufferSize;
+
+        // 不重置编码器，不插入IDR
+        NV_ENC_RECONFIGURE_PARAMS reconfigureParams = {};
+        reconfigureParams.version = NV_ENC_RECONFIGURE_PARAMS_VER;
+        reconfigureParams.reInitEncodeParams = *initParams;
+        reconfigureParams.reInitEncodeParams.encodeConfig = &newConfig;
+        reconfigureParams.resetEncoder = 0;
+        reconfigureParams.forceIDR = 0;
+
+        NVENCSTATUS status = nvencEncoder->nvEncReconfigureEncoder(nvencEncoder, &reconfigureParams);
+        if (status != NV_ENC_SUCCESS) {
+            std::stringstream ss;
+            ss << "Failed to reconfigure NVENC encoder: " << status;
+            lastError = ss.str();
+            std::cerr << lastError << std::endl;
+            return false;
+        }
+
+        *encodeConfig = newConfig;
+        bitrate = bitrateKbps;
+        return true;
+    } catch (const std::exception& e) {
+        std::stringstream ss;
+        ss << "Exception during NVENC reconfiguration: " << e.what();
+        lastError = ss.str();
+        std::cerr << lastError << std::endl;
+        return false;
+    }
+#else
+    lastError = "NVENC SDK not available";
+    return false;
+#endif
+}
+
 bool NVEncoder::encode(
     void* inputTexture,
     std::vector<uint8_t>& output
@@ -407,8 +470,13 @@ bool NVEncoder::encode(
         picParams.pictureStruct = NV_ENC_PIC_STRUCT_FRAME;
         picParams.frameIdx = frameCount++;
         picParams.inputTimeStamp = frameCount;
+        if (keyframePending) {
+            picParams.encodePicFlags = NV_ENC_PIC_FLAG_FORCEIDR | NV_ENC_PIC_FLAG_OUTPUT_SPSPPS;
+            keyframePending = false;
+        }
 
         // 编码帧
+        lastTiming.submitNs = nowNanos();
         status = nvencEncoder->nvEncEncodePicture(nvencEncoder, &picParams);
         if (status != NV_ENC_SUCCESS) {
             std::stringstream ss;
@@ -441,6 +509,7 @@ bool NVEncoder::encode(
             lastError = ss.str();
             std::cerr << lastError << std::endl;
         }
+        lastTiming.completeNs = nowNanos();
 
         // 解锁输入资源
         nvencEncoder->nvEncUnmapInputResource(nvencEncoder, nvencMappedResource);
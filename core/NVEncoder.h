@@ -19,6 +19,12 @@ class ID3D11Texture2D;
 
 class NVEncoder {
 public:
+    // 最近一帧的编码时刻（steady_clock纳秒），用于逐帧延迟追踪
+    struct Timing {
+        uint64_t submitNs = 0;      // 提交编码（nvEncEncodePicture）
+        uint64_t completeNs = 0;    // 码流复制完成
+    };
+
     NVEncoder();
     ~NVEncoder();
 
@@ -37,11 +43,21 @@ public:
         std::vector<uint8_t>& output
     );
 
+    // 运行时调整目标码率和单帧大小上限，保持编码会话和参考帧
+    bool reconfigure(int bitrateKbps, int maxFrameBytes);
+
+    // 下一帧编码为IDR并重发SPS/PPS（参考帧被丢弃后恢复解码），在编码线程上调用
+    void requestKeyframe() { keyframePending = true; }
+
     bool isInitialized() const { return initialized; }
     int getWidth() const { return width; }
     int getHeight() const { return height; }
+    int getBitrate() const { return bitrate; }
     std::string getLastError() const { return lastError; }
 
+    // 在调用encode的线程上读取
+    const Timing& getLastTiming() const { return lastTiming; }
+
 private:
     bool createEncoderSession();
     bool initializeEncoder();
@@ -82,6 +98,8 @@ private:
 
     // 帧计数
     int frameCount = 0;
+    bool keyframePending = false;
+    Timing lastTiming;
     
     // 错误信息
     std::string lastError;
@@ -0,0 +1,285 @@
+#include "RtpPacketizer.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <algorithm>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// RFC 6184负载类型
+const uint8_t kStapA = 24;
+const uint8_t kFuA = 28;
+
+// FU-A前缀（FU indicator + FU header）和STAP-A头的长度
+const unsigned int kFuHeaderSize = 2;
+const unsigned int kStapHeaderSize = 1;
+const unsigned int kStapLengthSize = 2;
+
+void putUint16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value >> 8);
+    p[1] = static_cast<uint8_t>(value);
+}
+
+void putUint32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value >> 24);
+    p[1] = static_cast<uint8_t>(value >> 16);
+    p[2] = static_cast<uint8_t>(value >> 8);
+    p[3] = static_cast<uint8_t>(value);
+}
+
+// H.264 NAL单元类型
+const uint8_t kNalSps = 7;
+const uint8_t kNalPps = 8;
+
+// 从offset开始查找下一个起始码，返回起始码之后第一个字节的位置，找不到时返回size
+size_t findNalStart(const uint8_t* data, size_t size, size_t offset) {
+    for (size_t i = offset; i + 3 <= size; i++) {
+        if (data[i] == 0 && data[i + 1] == 0) {
+            if (data[i + 2] == 1) {
+                return i + 3;
+            }
+            if (data[i + 2] == 0 && i + 4 <= size && data[i + 3] == 1) {
+                return i + 4;
+            }
+        }
+    }
+    return size;
+}
+
+std::string base64Encode(const std::vector<uint8_t>& data) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string result;
+    size_t i = 0;
+    for (; i + 3 <= data.size(); i += 3) {
+        uint32_t v = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        result += table[(v >> 18) & 0x3F];
+        result += table[(v >> 12) & 0x3F];
+        result += table[(v >> 6) & 0x3F];
+        result += table[v & 0x3F];
+    }
+    if (i + 1 == data.size()) {
+        uint32_t v = data[i] << 16;
+        result += table[(v >> 18) & 0x3F];
+        result += table[(v >> 12) & 0x3F];
+        result += "==";
+    } else if (i + 2 == data.size()) {
+        uint32_t v = (data[i] << 16) | (data[i + 1] << 8);
+        result += table[(v >> 18) & 0x3F];
+        result += table[(v >> 12) & 0x3F];
+        result += table[(v >> 6) & 0x3F];
+        result += '=';
+    }
+    return result;
+}
+
+} // namespace
+
+RtpPacketizer::RtpPacketizer()
+    : maxPayload(0),
+      ssrc(0),
+      sequence(0),
+      timestampOffset(0),
+      singleNals(0),
+      aggregatedNals(0),
+      aggregationPackets(0),
+      fragmentedNals(0),
+      fragmentPackets(0) {
+}
+
+void RtpPacketizer::configure(const Config& config, unsigned int maxPacketSize) {
+    this->config = config;
+    maxPayload = maxPacketSize > kHeaderSize ? maxPacketSize - kHeaderSize : 0;
+
+    // 序列号和时间戳起点随机化（RFC 3550第5.1节）
+    std::random_device random;
+    ssrc = config.ssrc ? config.ssrc : random();
+    sequence = static_cast<uint16_t>(random());
+    timestampOffset = random();
+
+    sps.clear();
+    pps.clear();
+}
+
+void RtpPacketizer::writeHeader(std::vector<uint8_t>& headers, uint32_t timestamp, bool marker) {
+    size_t offset = headers.size();
+    headers.resize(offset + kHeaderSize);
+    uint8_t* header = headers.data() + offset;
+
+    header[0] = 0x80;  // V=2，无填充、扩展和CSRC
+    header[1] = static_cast<uint8_t>((marker ? 0x80 : 0x00) | (config.payloadType & 0x7F));
+    putUint16(header + 2, sequence++);
+    putUint32(header + 4, timestamp);
+    putUint32(header + 8, ssrc);
+}
+
+unsigned int RtpPacketizer::packetize(const uint8_t* data, size_t size, uint64_t timestampUs,
+                                      std::vector<uint8_t>& headers, std::vector<Packet>& packets) {
+    headers.clear();
+    packets.clear();
+    if (maxPayload <= kFuHeaderSize) {
+        return 0;
+    }
+
+    // 拆分NAL单元，去掉起始码和NAL之间的尾随0字节
+    nals.clear();
+    size_t pos = findNalStart(data, size, 0);
+    while (pos < size) {
+        size_t next = findNalStart(data, size, pos + 1);
+        size_t end = next < size ? next - 3 : size;
+        while (end > pos && data[end - 1] == 0) {
+            end--;
+        }
+        if (end > pos) {
+            Nal nal = {data + pos, end - pos};
+            nals.push_back(nal);
+
+            // 记录参数集，用于生成SDP
+            uint8_t type = data[pos] & 0x1F;
+            if (type == kNalSps) {
+                sps.assign(data + pos, data + end);
+            } else if (type == kNalPps) {
+                pps.assign(data + pos, data + end);
+            }
+        }
+        pos = next;
+    }
+
+    uint32_t timestamp = toRtpTimestamp(timestampUs) + timestampOffset;
+    size_t nalCount = nals.size();
+    size_t i = 0;
+
+    while (i < nalCount) {
+        // 尽可能把连续的小NAL单元聚合为一个STAP-A包
+        size_t aggregateSize = kStapHeaderSize;
+        size_t j = i;
+        while (j < nalCount && aggregateSize + kStapLengthSize + nals[j].size <= maxPayload) {
+            aggregateSize += kStapLengthSize + nals[j].size;
+            j++;
+        }
+
+        if (j - i >= 2) {
+            uint32_t headerOffset = static_cast<uint32_t>(headers.size());
+            writeHeader(headers, timestamp, j == nalCount);
+
+            // STAP-A头：F位取或，NRI取最大值
+            uint8_t forbidden = 0;
+            uint8_t nri = 0;
+            for (size_t k = i; k < j; k++) {
+                forbidden |= nals[k].data[0] & 0x80;
+                nri = std::max<uint8_t>(nri, nals[k].data[0] & 0x60);
+            }
+            headers.push_back(static_cast<uint8_t>(forbidden | nri | kStapA));
+
+            for (size_t k = i; k < j; k++) {
+                uint8_t length[kStapLengthSize];
+                putUint16(length, static_cast<uint16_t>(nals[k].size));
+                headers.insert(headers.end(), length, length + kStapLengthSize);
+                headers.insert(headers.end(), nals[k].data, nals[k].data + nals[k].size);
+            }
+
+            Packet packet = {headerOffset, static_cast<uint32_t>(headers.size() - headerOffset), nullptr, 0};
+            packets.push_back(packet);
+            aggregatedNals.fetch_add(j - i, std::memory_order_relaxed);
+            aggregationPackets.fetch_add(1, std::memory_order_relaxed);
+            i = j;
+            continue;
+        }
+
+        const Nal& nal = nals[i];
+        bool lastNal = i + 1 == nalCount;
+
+        if (nal.size <= maxPayload) {
+            // 单NAL单元包：负载即NAL单元本身
+            uint32_t headerOffset = static_cast<uint32_t>(headers.size());
+            writeHeader(headers, timestamp, lastNal);
+            Packet packet = {headerOffset, kHeaderSize, nal.data, static_cast<uint32_t>(nal.size)};
+            packets.push_back(packet);
+            singleNals.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // FU-A分片：去掉NAL头，各分片大小均分，便于GSO按相同分段大小发送
+            const uint8_t* payload = nal.data + 1;
+            size_t remaining = nal.size - 1;
+            size_t fragmentMax = maxPayload - kFuHeaderSize;
+            size_t fragments = (remaining + fragmentMax - 1) / fragmentMax;
+            size_t fragmentSize = (remaining + fragments - 1) / fragments;
+
+            uint8_t indicator = static_cast<uint8_t>((nal.data[0] & 0xE0) | kFuA);
+            uint8_t type = nal.data[0] & 0x1F;
+
+            for (size_t f = 0; f < fragments; f++) {
+                size_t offset = f * fragmentSize;
+                size_t length = std::min(fragmentSize, remaining - offset);
+                bool first = f == 0;
+                bool last = f + 1 == fragments;
+
+                uint32_t headerOffset = static_cast<uint32_t>(headers.size());
+                writeHeader(headers, timestamp, lastNal && last);
+                headers.push_back(indicator);
+                headers.push_back(static_cast<uint8_t>((first ? 0x80 : 0x00) | (last ? 0x40 : 0x00) | type));
+
+                Packet packet = {headerOffset, kHeaderSize + kFuHeaderSize, payload + offset,
+                                 static_cast<uint32_t>(length)};
+                packets.push_back(packet);
+            }
+
+            fragmentedNals.fetch_add(1, std::memory_order_relaxed);
+            fragmentPackets.fetch_add(fragments, std::memory_order_relaxed);
+        }
+        i++;
+    }
+
+    return static_cast<unsigned int>(packets.size());
+}
+
+std::string RtpPacketizer::generateSdp(const std::string& address, unsigned int port, unsigned int frameRate) const {
+    unsigned int pt = config.payloadType;
+    std::ostringstream sdp;
+    sdp << "v=0\r\n";
+    sdp << "o=- " << ssrc << " 0 IN IP4 " << address << "\r\n";
+    sdp << "s=UDPStreamer\r\n";
+    sdp << "c=IN IP4 " << address << "\r\n";
+    sdp << "t=0 0\r\n";
+    sdp << "m=video " << port << " RTP/AVP " << pt << "\r\n";
+    sdp << "a=rtpmap:" << pt << " H264/90000\r\n";
+    sdp << "a=fmtp:" << pt << " packetization-mode=1";
+    if (hasParameterSets() && sps.size() >= 4) {
+        // profile-level-id为SPS中profile_idc、约束标志和level_idc三个字节
+        sdp << ";profile-level-id=" << std::hex << std::setfill('0')
+            << std::setw(2) << static_cast<unsigned int>(sps[1])
+            << std::setw(2) << static_cast<unsigned int>(sps[2])
+            << std::setw(2) << static_cast<unsigned int>(sps[3]) << std::dec;
+        sdp << ";sprop-parameter-sets=" << base64Encode(sps) << "," << base64Encode(pps);
+    }
+    sdp << "\r\n";
+    if (frameRate > 0) {
+        sdp << "a=framerate:" << frameRate << "\r\n";
+    }
+    return sdp.str();
+}
+
+bool RtpPacketizer::writeSdp(const std::string& path, const std::string& address, unsigned int port,
+                             unsigned int frameRate) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Failed to open SDP file: " << path << std::endl;
+        return false;
+    }
+    file << generateSdp(address, port, frameRate);
+    return static_cast<bool>(file);
+}
+
+RtpPacketizer::Stats RtpPacketizer::getStats() const {
+    Stats stats;
+    stats.singleNals = singleNals.load(std::memory_order_relaxed);
+    stats.aggregatedNals = aggregatedNals.load(std::memory_order_relaxed);
+    stats.aggregationPackets = aggregationPackets.load(std::memory_order_relaxed);
+    stats.fragmentedNals = fragmentedNals.load(std::memory_order_relaxed);
+    stats.fragmentPackets = fragmentPackets.load(std::memory_order_relaxed);
+    return stats;
+}
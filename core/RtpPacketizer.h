@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <string>
+#include <atomic>
+
+using namespace std;
+
+// RTP/H.264分包（RFC 6184，packetization-mode=1）：按NAL单元边界切分Annex-B帧，
+// 小NAL单元（SPS/PPS/SEI等）以STAP-A聚合，超过负载上限的NAL单元以FU-A分片，
+// 其余每个NAL单元单独成包。时间戳为90kHz，帧的最后一个分包置marker位
+class RtpPacketizer {
+public:
+    static const unsigned int kHeaderSize = 12;
+
+    struct Config {
+        bool enabled = false;
+        uint8_t payloadType = 96;   // 动态负载类型
+        uint32_t ssrc = 0;          // 0表示随机生成
+        std::string sdpPath;        // 收到参数集后写出SDP文件，空表示不写
+    };
+
+    // 分包描述：包头（RTP头及FU/STAP-A前缀）位于headers缓冲区的headerOffset处，
+    // 负载直接引用编码帧缓冲区；STAP-A的聚合负载整体复制在包头之后，payloadSize为0
+    struct Packet {
+        uint32_t headerOffset;
+        uint32_t headerSize;
+        const uint8_t* payload;
+        uint32_t payloadSize;
+    };
+
+    struct Stats {
+        uint64_t singleNals;        // 单独成包的NAL单元
+        uint64_t aggregatedNals;    // 以STAP-A聚合的NAL单元
+        uint64_t aggregationPackets;
+        uint64_t fragmentedNals;    // 以FU-A分片的NAL单元
+        uint64_t fragmentPackets;
+    };
+
+    RtpPacketizer();
+
+    void configure(const Config& config, unsigned int maxPacketSize);
+
+    // 切分一帧，包头写入headers（跨帧复用），分包描述写入packets，返回分包数
+    unsigned int packetize(const uint8_t* data, size_t size, uint64_t timestampUs,
+                           std::vector<uint8_t>& headers, std::vector<Packet>& packets);
+
+    // 是否已从码流中取得SPS和PPS（生成SDP需要）
+    bool hasParameterSets() const { return !sps.empty() && !pps.empty(); }
+
+    // 生成描述本流的SDP（RFC 6184第8.2节），参数集已知时带sprop-parameter-sets和profile-level-id
+    std::string generateSdp(const std::string& address, unsigned int port, unsigned int frameRate) const;
+    bool writeSdp(const std::string& path, const std::string& address, unsigned int port,
+                  unsigned int frameRate) const;
+
+    const Config& getConfig() const { return config; }
+    uint32_t getSsrc() const { return ssrc; }
+    Stats getStats() const;
+
+    // 微秒时间戳转换为90kHz RTP时钟
+    static uint32_t toRtpTimestamp(uint64_t timestampUs) {
+        return static_cast<uint32_t>(timestampUs * 9 / 100);
+    }
+
+private:
+    Config config;
+    unsigned int maxPayload;
+    uint32_t ssrc;
+    uint16_t sequence;
+    uint32_t timestampOffset;
+
+    // 最近一次见到的参数集
+    std::vector<uint8_t> sps;
+    std::vector<uint8_t> pps;
+
+    // 当前帧的NAL单元位置（跨帧复用）
+    struct Nal {
+        const uint8_t* data;
+        size_t size;
+    };
+    std::vector<Nal> nals;
+
+    void writeHeader(std::vector<uint8_t>& headers, uint32_t timestamp, bool marker);
+
+    // 统计信息（由发送线程写入，其他线程读取）
+    std::atomic<uint64_t> singleNals;
+    std::atomic<uint64_t> aggregatedNals;
+    std::atomic<uint64_t> aggregationPackets;
+    std::atomic<uint64_t> fragmentedNals;
+    std::atomic<uint64_t> fragmentPackets;
+};
@@ -10,6 +10,33 @@
 
 using Microsoft::WRL::ComPtr;
 
+namespace {
+
+// DXGI的呈现时刻是QueryPerformanceCounter计数：按它距当前计数的时长换算到steady_clock微秒
+uint64_t presentTimeMicros(int64_t presentQpc, uint64_t nowUs) {
+    if (presentQpc == 0) {
+        return 0;
+    }
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    int64_t ageUs = (counter.QuadPart - presentQpc) * 1000000 / frequency.QuadPart;
+    if (ageUs < 0 || static_cast<uint64_t>(ageUs) > nowUs) {
+        return 0;
+    }
+    return nowUs - static_cast<uint64_t>(ageUs);
+}
+
+// 逐帧延迟追踪的时钟（steady_clock纳秒）
+uint64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+} // namespace
+
 ScreenCapture::ScreenCapture()
     : outputWidth(0),
       outputHeight(0),
@@ -310,7 +337,8 @@ bool ScreenCapture::captureFrame(CaptureFrame& frame) {
         // 获取下一帧
         DXGI_OUTDUPL_FRAME_INFO frameInfo;
         ComPtr<IDXGIResource> resource;
-        HRESULT hr = dup->AcquireNextFrame(1000, &frameInfo, &resource);
+        // 采集频率由采集节拍控制，没有新画面时立即返回，不在这里阻塞
+        HRESULT hr = dup->AcquireNextFrame(0, &frameInfo, &resource);
         
         if (hr == DXGI_ERROR_WAIT_TIMEOUT) {
             return false;
@@ -331,6 +359,7 @@ bool ScreenCapture::captureFrame(CaptureFrame& frame) {
             }
             return false;
         }
+        uint64_t acquireNs = nowNanos();
 
         // 获取纹理
         ComPtr<ID3D11Texture2D> srcTexture;
@@ -365,10 +394,14 @@ bool ScreenCapture::captureFrame(CaptureFrame& frame) {
         // 填充帧信息
         frame.texture = outTexture;
         frame.resource = resource.Detach();
-        frame.timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::system_clock::now().time_since_epoch()
+        // 与LowLatencyStreamer一致使用steady_clock微秒，不受系统时间调整影响，可与发送路径的时间戳直接相减
+        frame.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
         ).count();
+        frame.presentTime = presentTimeMicros(frameInfo.LastPresentTime.QuadPart, frame.timestamp);
         frame.frameIndex = frameCount++;
+        frame.acquireNs = acquireNs;
+        frame.copyNs = nowNanos();
 
         return true;
     } catch (const std::exception& e) {
@@ -17,8 +17,11 @@ public:
     struct CaptureFrame {
         void* texture; // 简化为void*，避免DirectX依赖
         void* resource; // 简化为void*，避免DirectX依赖
-        uint64_t timestamp;
+        uint64_t timestamp;     // 采集时刻（steady_clock微秒）
+        uint64_t presentTime;   // 画面呈现到显示器的时刻（同一时钟），0表示自上次采集以来没有新呈现
         int frameIndex;
+        uint64_t acquireNs;     // AcquireNextFrame返回的时刻（steady_clock纳秒），用于逐帧延迟追踪
+        uint64_t copyNs;        // 裁剪复制提交完成的时刻（同一时钟）
     };
 
     ScreenCapture();
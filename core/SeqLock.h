@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+
+using namespace std;
+
+// 单写者序列锁：写者先把序列号加1（奇数表示正在写），逐字写入数据，再把序列号加1；
+// 读者复制数据前后各读一次序列号，两次相同且为偶数才算读到一致的快照，否则重试。
+// 写者从不等待读者，读者不写共享内存，任意多个线程可以同时读取。
+// 数据按8字节原子字存放，读写都是原子操作，读者与写者并发时不存在数据竞争。
+// T必须可平凡复制（不能含std::string、std::vector等）
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() : sequence(0) {
+        T value = T();
+        store(value);
+        sequence.store(0, std::memory_order_relaxed);
+    }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    // 写者：发布新的值，同一时刻只能有一个线程调用
+    void store(const T& value) {
+        uint64_t buffer[kWords] = {};
+        memcpy(buffer, &value, sizeof(T));
+
+        uint64_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; i++) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // 读者：读取最近一次发布的完整值，返回其版本号（第几次发布，从未发布时为0）
+    uint64_t load(T& value) const {
+        uint64_t buffer[kWords];
+        for (unsigned int attempt = 0; ; attempt++) {
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                for (size_t i = 0; i < kWords; i++) {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    memcpy(&value, buffer, sizeof(T));
+                    return before / 2;
+                }
+            }
+            // 写者可能在写到一半时被抢占，多次重试失败后让出CPU
+            if (attempt >= kSpinAttempts) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    T load() const {
+        T value;
+        load(value);
+        return value;
+    }
+
+    // 已发布的次数，可用于判断是否有新值
+    uint64_t version() const {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static const size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    static const unsigned int kSpinAttempts = 64;
+
+    alignas(64) std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> words[kWords];
+};
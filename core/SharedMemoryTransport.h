@@ -0,0 +1,173 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+// 同机共享内存传输：编码帧写入命名共享内存中的环形槽位，同一主机上的消费进程直接读取，
+// 不经过回环UDP协议栈。每个槽位以序列号做顺序锁（写入期间为奇数），生产者从不等待消费者，
+// 落后超过一圈的消费者跳到最新的帧。门铃为共享的32位计数：Linux上用futex，
+// Windows上用同名事件；只有存在等待者时生产者才进入内核唤醒，稳态数据路径没有系统调用
+namespace shm {
+
+const uint32_t kMagic = 0x4C4C534D;    // "LLSM"，与LowLatencyStreamer的消费者库布局相同
+const uint32_t kVersion = 1;
+
+// 共享内存头部，位于映射区起始处
+struct RingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;                      // 每个槽位可容纳的最大帧字节数
+    std::atomic<uint64_t> writeSequence;    // 已发布的帧数
+    std::atomic<uint32_t> doorbell;         // 每发布一帧加1，消费者在其上等待
+    std::atomic<uint32_t> waiters;          // 正在等待门铃的消费者数
+    std::atomic<uint32_t> closed;           // 生产者已关闭
+    uint8_t reserved[28];
+};
+
+// 槽位头部，其后紧跟slotSize字节的帧数据
+struct SlotHeader {
+    std::atomic<uint64_t> sequence;         // 2×帧序号+1表示写入中，2×帧序号+2表示已发布
+    uint64_t timestampUs;                   // 发布时刻（steady_clock微秒，同机进程间可比）
+    uint32_t size;
+    uint32_t flags;
+    uint8_t reserved[40];
+};
+
+const uint32_t kFlagKeyframe = 1;
+
+static_assert(sizeof(RingHeader) == 64, "RingHeader must occupy one cache line");
+static_assert(sizeof(SlotHeader) == 64, "SlotHeader must occupy one cache line");
+
+// 槽位之间的跨度（按缓存行对齐）
+inline size_t slotStride(uint32_t slotSize) {
+    return sizeof(SlotHeader) + ((static_cast<size_t>(slotSize) + 63) & ~static_cast<size_t>(63));
+}
+
+inline size_t mappingSize(uint32_t slotCount, uint32_t slotSize) {
+    return sizeof(RingHeader) + slotStride(slotSize) * slotCount;
+}
+
+// 平台相关的命名共享内存和门铃
+class Mapping {
+public:
+    Mapping();
+    ~Mapping();
+
+    bool create(const std::string& name, size_t size);
+    bool open(const std::string& name);
+    void close();
+
+    uint8_t* data() const { return base; }
+    size_t size() const { return length; }
+
+    // 在门铃上等待其值离开observed，超时或被唤醒返回
+    void wait(std::atomic<uint32_t>* doorbell, uint32_t observed, unsigned int timeoutMs);
+    void wake(std::atomic<uint32_t>* doorbell);
+
+private:
+    std::string name;
+    bool owner;
+    uint8_t* base;
+    size_t length;
+#ifdef _WIN32
+    void* mappingHandle;
+    void* eventHandle;
+#else
+    int fd;
+#endif
+};
+
+} // namespace shm
+
+// 生产者：推流进程的发送线程调用write发布编码帧
+class SharedMemoryWriter {
+public:
+    struct Config {
+        std::string name = "udpstreamer";
+        unsigned int slotCount = 8;
+        unsigned int slotSize = 1 << 20;    // 1MB，超过的帧被丢弃
+    };
+
+    struct Stats {
+        uint64_t framesWritten;
+        uint64_t bytesWritten;
+        uint64_t framesTooLarge;
+        uint64_t wakeups;                   // 存在等待者时的唤醒系统调用
+        uint64_t keyframes;
+    };
+
+    SharedMemoryWriter();
+    ~SharedMemoryWriter();
+
+    bool create(const Config& config);
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+
+    // 复制一帧到下一个槽位并发布，帧超过槽位大小时返回false
+    bool write(const uint8_t* data, size_t size);
+
+    const Config& getConfig() const { return config; }
+    Stats getStats() const;
+
+private:
+    Config config;
+    shm::Mapping mapping;
+    shm::RingHeader* header;
+    uint64_t sequence;
+
+    std::atomic<uint64_t> framesWritten;
+    std::atomic<uint64_t> bytesWritten;
+    std::atomic<uint64_t> framesTooLarge;
+    std::atomic<uint64_t> wakeups;
+    std::atomic<uint64_t> keyframes;
+};
+
+// 消费者库：同机进程打开生产者创建的共享内存并按顺序读取帧
+class SharedMemoryReader {
+public:
+    struct FrameInfo {
+        uint64_t sequence;
+        uint64_t timestampUs;
+        bool keyframe;
+    };
+
+    struct Stats {
+        uint64_t framesRead;
+        uint64_t framesSkipped;             // 落后超过一圈或读取期间被覆盖而跳过的帧
+        uint64_t waits;                     // 进入内核等待门铃的次数
+    };
+
+    SharedMemoryReader();
+    ~SharedMemoryReader();
+
+    // 打开已存在的共享内存，从下一帧开始读取
+    bool open(const std::string& name);
+    void close();
+
+    bool isOpen() const { return header != nullptr; }
+
+    // 生产者是否已关闭
+    bool isClosed() const;
+
+    // 读取下一帧到data，先自旋再在门铃上等待，超时或生产者关闭时返回false
+    bool read(std::vector<uint8_t>& data, FrameInfo& info, unsigned int timeoutMs);
+
+    Stats getStats() const { return stats; }
+
+private:
+    shm::Mapping mapping;
+    shm::RingHeader* header;
+    uint8_t* slots;
+    size_t stride;
+    uint64_t nextSequence;
+    Stats stats;
+
+    bool tryRead(std::vector<uint8_t>& data, FrameInfo& info);
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <mutex>
+
+using namespace std;
+
+// 流水线线程的调度设置：每个阶段可绑定到一个CPU核，并使用实时调度策略
+// （Linux的SCHED_FIFO/SCHED_RR；Windows没有按线程的实时策略，映射为THREAD_PRIORITY_TIME_CRITICAL）。
+// 可选锁定进程内存（mlockall）并预先触碰各线程的栈，运行中不再因缺页停顿。
+// 各线程启动时对自身调用applyToCurrentThread；开启测量时随后测量本线程的调度延迟
+// （休眠的实际唤醒时刻晚于请求时刻的量），反映所在核上其他线程和进程的抢占程度。
+// 测量会推迟线程开始工作，默认关闭，只在诊断调度问题时开启。
+// configure在线程启动前检查配置：CPU是否存在、绑定的核是否已隔离（isolcpus/cpuset，仅Linux）、
+// 实时线程是否共用一个核、实时调度是否被限流（sched_rt_runtime_us）。
+// 与LowLatencyStreamer的ThreadTuning相同
+class ThreadTuning {
+public:
+    enum class Stage {
+        Capture,        // 采集线程（run-to-completion模式下的唯一线程）
+        Encode,
+        Send,
+        Count
+    };
+
+    static const unsigned int kStages = static_cast<unsigned int>(Stage::Count);
+
+    enum class Policy {
+        Default,        // 保持原有优先级（Windows上采集、编码为HIGHEST，发送为ABOVE_NORMAL）
+        Normal,         // 普通分时调度（SCHED_OTHER / THREAD_PRIORITY_NORMAL）
+        Fifo,           // SCHED_FIFO：运行到阻塞或被更高优先级抢占
+        RoundRobin      // SCHED_RR：同优先级的线程按时间片轮转
+    };
+
+    // 实时策略未指定优先级时使用的值（Linux为1-99）
+    static const int kDefaultRtPriority = 50;
+
+    struct StageConfig {
+        int cpu = -1;                   // 绑定的CPU核，-1表示不绑定
+        Policy policy = Policy::Default;
+        int priority = 0;               // 实时优先级，0表示kDefaultRtPriority
+    };
+
+    struct Config {
+        StageConfig stages[kStages];
+        bool lockMemory = false;            // mlockall并预先触碰各线程的栈
+        unsigned int probeIterations = 0;   // 启动时测量调度延迟的休眠次数，0表示不测量（默认）
+        unsigned int probeIntervalUs = 500;
+
+        StageConfig& stage(Stage which) { return stages[static_cast<unsigned int>(which)]; }
+        const StageConfig& stage(Stage which) const { return stages[static_cast<unsigned int>(which)]; }
+    };
+
+    // 一个线程应用设置的结果
+    struct ThreadReport {
+        std::string name;
+        Stage stage;
+        int cpu;                        // 实际绑定的核，-1表示未绑定
+        Policy policy;                  // 实际生效的策略（设置失败时为Default）
+        int priority;
+        std::string error;              // 未能生效的设置及原因，为空表示全部生效
+        LatencyHistogram wakeLatency;   // 调度延迟
+    };
+
+    ThreadTuning();
+
+    // 检查配置，需要时锁定进程内存；发现的问题由getWarnings返回（不阻止启动）。
+    // 只能在流水线线程启动前调用
+    void configure(const Config& config);
+
+    // 在流水线线程开头调用：按stage的设置调整当前线程，预触碰栈，开启测量时测量调度延迟，
+    // 结果打印一行并记入报告。name用于输出（如"capture"）
+    void applyToCurrentThread(Stage stage, const std::string& name);
+
+    const Config& getConfig() const { return config; }
+    bool isMemoryLocked() const { return memoryLocked; }
+    std::vector<std::string> getWarnings() const;
+    std::vector<ThreadReport> getReports() const;
+
+    static const char* stageName(Stage stage);
+    static const char* policyName(Policy policy);
+
+    // 解析"cpu[:policy[:priority]]"：cpu为核编号或any，policy为default/normal/fifo/rr，
+    // 例如"2:fifo:80"、"any:rr"、"3"
+    static bool parseStage(const std::string& spec, StageConfig& config);
+    static std::string formatStage(const StageConfig& config);
+
+    // 已隔离的CPU核（/sys/devices/system/cpu/isolated），其他平台为空
+    static std::vector<int> isolatedCpus();
+
+private:
+    Config config;
+    bool memoryLocked;
+
+    mutable std::mutex mutex;
+    std::vector<std::string> warnings;
+    std::vector<ThreadReport> reports;
+
+    void checkConfig();
+    bool lockProcessMemory(std::string& error);
+    void warn(const std::string& message);
+};
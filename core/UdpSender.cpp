@@ -15,7 +15,9 @@ UdpSender::UdpSender()
     : udpSocket(INVALID_SOCKET),
       connected(false),
       bytesSent(0),
-      packetsSent(0)
+      packetsSent(0),
+      reportsReceived(0),
+      sendErrors(0)
 {
     // 初始化Winsock
     WSADATA wsaData;
@@ -112,6 +114,17 @@ bool UdpSender::initialize(const std::string& ip, int p) {
             return false;
         }
 
+        // 组播目标：一次发送由网络复制给组内所有接收端
+        multicast = IN_MULTICAST(ntohl(serverAddr.sin_addr.s_addr));
+        if (multicast) {
+            DWORD ttl = static_cast<DWORD>(multicastTtl);
+            if (setsockopt(udpSocket, IPPROTO_IP, IP_MULTICAST_TTL,
+                           reinterpret_cast<const char*>(&ttl), sizeof(ttl)) == SOCKET_ERROR) {
+                std::cerr << "Failed to set multicast TTL: " << WSAGetLastError() << std::endl;
+            }
+            std::cout << "Multicast destination " << targetIp << ", TTL " << multicastTtl << std::endl;
+        }
+
         connected = true;
         std::cout << "UdpSender initialized successfully" << std::endl;
         return true;
@@ -132,6 +145,8 @@ void UdpSender::cleanup() {
         // 重置统计信息
         bytesSent = 0;
         packetsSent = 0;
+        reportsReceived = 0;
+        sendErrors = 0;
         connected = false;
 
         std::cout << "UdpSender cleaned up" << std::endl;
@@ -165,14 +180,15 @@ bool UdpSender::sendPacket(const uint8_t* data, size_t size) {
         if (bytesSentResult == SOCKET_ERROR) {
             int error = WSAGetLastError();
             if (error != WSAEWOULDBLOCK) {
+                increment(sendErrors, 1);
                 std::cerr << "Failed to send packet: " << error << std::endl;
             }
             return false;
         }
 
         // 更新统计信息
-        bytesSent += bytesSentResult;
-        packetsSent++;
+        increment(bytesSent, static_cast<uint64_t>(bytesSentResult));
+        increment(packetsSent, 1);
 
         return true;
     } catch (const std::exception& e) {
@@ -194,3 +210,101 @@ bool UdpSender::sendFrame(const std::vector<uint8_t>& data) {
         return false;
     }
 }
+
+bool UdpSender::sendBuffers(const uint8_t* header, size_t headerSize, const uint8_t* payload, size_t payloadSize) {
+    // 包头和负载以两段缓冲区提交，负载不做复制
+    WSABUF buffers[2];
+    buffers[0].buf = reinterpret_cast<CHAR*>(const_cast<uint8_t*>(header));
+    buffers[0].len = static_cast<ULONG>(headerSize);
+    buffers[1].buf = reinterpret_cast<CHAR*>(const_cast<uint8_t*>(payload));
+    buffers[1].len = static_cast<ULONG>(payloadSize);
+
+    DWORD sentBytes = 0;
+    int result = WSASendTo(
+        udpSocket,
+        buffers,
+        payloadSize > 0 ? 2 : 1,
+        &sentBytes,
+        0,
+        reinterpret_cast<sockaddr*>(&serverAddr),
+        serverAddrSize,
+        nullptr,
+        nullptr
+    );
+
+    if (result == SOCKET_ERROR) {
+        int error = WSAGetLastError();
+        if (error != WSAEWOULDBLOCK) {
+            increment(sendErrors, 1);
+            std::cerr << "Failed to send RTP packet: " << error << std::endl;
+        }
+        return false;
+    }
+
+    increment(bytesSent, sentBytes);
+    increment(packetsSent, 1);
+    return true;
+}
+
+unsigned int UdpSender::sendPackets(const uint8_t* headers, const RtpPacketizer::Packet* packets, unsigned int count) {
+    if (!connected || udpSocket == INVALID_SOCKET) {
+        std::cerr << "UDP sender not initialized" << std::endl;
+        return 0;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+        const RtpPacketizer::Packet& packet = packets[i];
+        if (!sendBuffers(headers + packet.headerOffset, packet.headerSize, packet.payload, packet.payloadSize)) {
+            return i;
+        }
+    }
+
+    return count;
+}
+
+bool UdpSender::pollReport(ReceiverReport& report) {
+    try {
+        if (!connected || udpSocket == INVALID_SOCKET) {
+            return false;
+        }
+
+        // socket为非阻塞模式，逐个读取直到取得一个有效报告或没有数据
+        char buffer[256];
+        while (true) {
+            sockaddr_in fromAddr;
+            int fromAddrSize = sizeof(fromAddr);
+            int received = recvfrom(
+                udpSocket,
+                buffer,
+                sizeof(buffer),
+                0,
+                reinterpret_cast<sockaddr*>(&fromAddr),
+                &fromAddrSize
+            );
+
+            if (received == SOCKET_ERROR) {
+                int error = WSAGetLastError();
+                // WSAECONNRESET: 之前发往目标的数据报触发了ICMP端口不可达，忽略
+                if (error != WSAEWOULDBLOCK && error != WSAECONNRESET) {
+                    std::cerr << "Failed to receive report: " << error << std::endl;
+                }
+                return false;
+            }
+
+            if (received < static_cast<int>(sizeof(ReceiverReport))) {
+                continue;
+            }
+
+            memcpy(&report, buffer, sizeof(ReceiverReport));
+            if (report.magic != kReportMagic) {
+                continue;
+            }
+
+            increment(reportsReceived, 1);
+            return true;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error receiving report: " << e.what() << std::endl;
+        return false;
+    }
+}
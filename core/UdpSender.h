@@ -3,6 +3,9 @@
 #include <string>
 #include <vector>
 #include <stdint.h>
+#include <atomic>
+
+#include "RtpPacketizer.h"
 
 using namespace std;
 
@@ -16,22 +19,56 @@ using namespace std;
 
 class UdpSender {
 public:
+    // 接收端周期性报告（"RRPT"），由接收端发回本socket的源地址。
+    // 字段布局与LowLatencyStreamer的UDPTransmitter::ReceiverReport一致
+    static const uint32_t kReportMagic = 0x54505252;
+
+    struct ReceiverReport {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t intervalUs;        // 报告覆盖的时间区间
+        uint32_t packetsExpected;
+        uint32_t packetsReceived;
+        uint32_t bytesReceived;
+        int32_t delayGradient;      // 单向时延梯度（微秒/秒）
+        uint32_t highestFrameId;
+    };
+
     UdpSender();
     ~UdpSender();
 
     bool initialize(const std::string& targetIp, int port);
     void cleanup();
 
+    // 目标为组播地址时使用的TTL（需在initialize之前设置）
+    void setMulticastTtl(int ttl) { multicastTtl = ttl; }
+    bool isMulticast() const { return multicast; }
+
+    const std::string& getTargetIp() const { return targetIp; }
+    int getPort() const { return port; }
+
     bool sendFrame(const std::vector<uint8_t>& data);
     bool sendPacket(const uint8_t* data, size_t size);
 
+    // 发送已分好的RTP包（包头在headers缓冲区中，负载引用编码帧），
+    // 发送缓冲区满时停止，返回已交给内核的分包数
+    unsigned int sendPackets(const uint8_t* headers, const RtpPacketizer::Packet* packets, unsigned int count);
+
+    // 非阻塞读取一个接收报告，没有报告时返回false
+    bool pollReport(ReceiverReport& report);
+
+    // 统计由发送线程写入，可在任意线程读取
     bool isConnected() const { return connected; }
-    int getBytesSent() const { return bytesSent; }
-    int getPacketsSent() const { return packetsSent; }
+    uint64_t getBytesSent() const { return bytesSent.load(std::memory_order_relaxed); }
+    uint64_t getPacketsSent() const { return packetsSent.load(std::memory_order_relaxed); }
+    uint64_t getReportsReceived() const { return reportsReceived.load(std::memory_order_relaxed); }
+    // 发送缓冲区满以外的发送错误
+    uint64_t getSendErrors() const { return sendErrors.load(std::memory_order_relaxed); }
 
 private:
     bool createSocket();
     bool resolveAddress();
+    bool sendBuffers(const uint8_t* header, size_t headerSize, const uint8_t* payload, size_t payloadSize);
 
 private:
     std::string targetIp;
@@ -48,8 +85,17 @@ private:
 #endif
 
     bool connected = false;
+    bool multicast = false;
+    int multicastTtl = 1;
+
+    // 统计信息：64位，每个计数器只有一个写入线程（发送统计为目的地的发送线程，报告数为推流的发送线程），
+    // 递增不需要原子读改写
+    std::atomic<uint64_t> bytesSent;
+    std::atomic<uint64_t> packetsSent;
+    std::atomic<uint64_t> reportsReceived;
+    std::atomic<uint64_t> sendErrors;
 
-    // 统计信息
-    int bytesSent = 0;
-    int packetsSent = 0;
+    static void increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
 };
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+using namespace std;
+
+// 发送端/接收端时钟同步：按NTP方式由一次探测往返的四个时间戳估计两端时钟偏差，
+//   t1 接收端发出探测  t2 发送端收到探测  t3 发送端发出应答  t4 接收端收到应答
+//   偏差 θ = ((t2 - t1) + (t3 - t4)) / 2，往返 δ = (t4 - t1) - (t3 - t2)
+// 只采用往返时间接近近期最小值的样本（排队造成的不对称最小），
+// 对最近采用的样本做偏差-时间的最小二乘拟合，斜率即两端时钟的相对漂移，样本之间按拟合直线外推。
+// 两端均使用steady_clock微秒；偏差定义为发送端时钟减接收端时钟
+class ClockSync {
+public:
+    struct Stats {
+        uint64_t samples;           // 收到的应答数
+        uint64_t samplesUsed;       // 通过往返时间过滤的样本数
+        bool synchronized;
+        int64_t offsetUs;           // 当前偏差估计（发送端 - 接收端）
+        uint32_t rttUs;             // 最近一个样本的往返时间
+        uint32_t minRttUs;          // 过滤窗口内的最小往返时间
+        double driftPpm;            // 发送端时钟相对接收端的快慢（百万分之一）
+    };
+
+    ClockSync();
+
+    void reset();
+
+    // 加入一次探测往返的四个时间戳，t1、t4为本地时钟，t2、t3为远端时钟
+    void addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4);
+
+    // 采用的样本数达到kMinSamples后才认为已同步
+    bool isSynchronized() const { return samplesUsed >= kMinSamples; }
+
+    // 本地时刻对应的远端时钟偏差
+    int64_t offsetAt(uint64_t localUs) const;
+
+    // 本地时刻换算为远端时钟
+    uint64_t toRemote(uint64_t localUs) const {
+        return static_cast<uint64_t>(static_cast<int64_t>(localUs) + offsetAt(localUs));
+    }
+
+    Stats getStats() const;
+
+private:
+    static const unsigned int kWindow = 8;         // 最小往返时间的过滤窗口（样本数）
+    static const unsigned int kHistory = 16;       // 参与拟合的采用样本数
+    static const unsigned int kMinSamples = 3;
+
+    uint32_t rttWindow[kWindow];
+    unsigned int windowCount;
+    unsigned int windowNext;
+
+    uint64_t samples;
+    uint64_t samplesUsed;
+    uint32_t lastRttUs;
+
+    // 采用的样本（本地时刻，偏差）
+    uint64_t historyLocalUs[kHistory];
+    double historyOffsetUs[kHistory];
+    unsigned int historyCount;
+    unsigned int historyNext;
+
+    // 拟合结果：offset(t) = baseOffsetUs + drift × (t - baseLocalUs)
+    uint64_t baseLocalUs;
+    double baseOffsetUs;
+    double drift;
+
+    uint32_t windowMinRtt() const;
+    void fit();
+};
@@ -6,11 +6,23 @@ using namespace std;
 
 class ConfigManager {
 public:
+    // --max-packet-size auto时的分包大小上限：巨型帧（MTU 9000）减去IPv4/UDP头
+    static const unsigned int kJumboPacketSize = 8972;
+
     struct Config {
         // 屏幕采集参数
         unsigned int displayIndex;
         unsigned int outputWidth;
         unsigned int outputHeight;
+        bool alignCapture;          // 采集节拍向显示器的呈现时刻对齐
+        int capturePhaseUs;         // 对齐时节拍落在呈现时刻之后的偏移
+        unsigned int captureSpinUs; // 采集节拍的自旋阈值，0表示按测得的唤醒误差自适应
+        std::string pipelineMode;   // pipelined | rtc（一个线程完成采集、编码和发送）
+        std::string captureThread;  // 各阶段线程的调度设置"cpu[:policy[:priority]]"，如"2:fifo:80"
+        std::string encodeThread;
+        std::string sendThread;
+        bool lockMemory;            // mlockall并预先触碰线程栈
+        unsigned int schedProbe;    // 线程启动时测量调度延迟的休眠次数，0表示不测量
         
         // 编码参数
         unsigned int frameRate;
@@ -19,7 +31,37 @@ public:
         // 传输参数
         std::string serverIP;
         unsigned int serverPort;
-        unsigned int maxPacketSize;
+        unsigned int maxPacketSize;     // 开启路径MTU探测时为分包大小上限
+        bool pathMtu;                   // 路径MTU探测（--max-packet-size auto或--pmtu）
+        unsigned int pathMtuIntervalMs; // 重新探测间隔，0表示只在启动时探测
+        std::string sendBackend;    // auto | sendto | sendmmsg | gso | uring
+        bool zeroCopy;
+        bool uringSqPoll;           // io_uring后端使用内核轮询线程
+        unsigned int uringEntries;  // io_uring提交队列深度
+        std::string fecMode;        // none | xor | rs
+        double fecRedundancy;
+        double fecKeyframeRedundancy;
+        unsigned int fecGroupSize;
+        bool interleave;            // 帧内分包在FEC组之间交织发出
+        unsigned int nackPort;      // 0表示关闭NACK重传
+        unsigned int retransmitRing;
+        unsigned int retransmitDeadlineMs;
+        bool pacing;
+        double pacingFraction;      // 每帧分包在帧间隔的这一比例内发完
+        unsigned int pacingBurst;
+        bool abr;                   // 自适应码率，需配合--nack-port反馈端口
+        unsigned int abrMinBitrate;
+        unsigned int abrMaxBitrate; // 0表示以--bitrate为上限
+        std::string protocol;       // custom | rtp
+        unsigned int rtpPayloadType;
+        std::string sdpFile;        // RTP模式下写出的SDP文件，空表示不写
+        std::string transport;      // udp | shm（同机消费者经共享内存读取）
+        std::string shmName;
+        unsigned int shmSlots;
+        unsigned int shmSlotSize;   // 每个槽位的最大帧字节数
+        unsigned int frameDeadlineMs;   // 采集后超过该时间仍未发出的帧丢弃，0表示只按队列长度丢帧
+        bool congestionDrop;        // 发送拥塞时丢弃非参考帧
+        unsigned int metricsPort;   // 本机指标导出端口（127.0.0.1，OpenMetrics），0表示不导出
     };
     
 private:
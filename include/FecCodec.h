@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+// 前向纠错编解码
+// 数据分包按组编码：每组k个数据包生成m个校验包，任意收到k个即可恢复整组。
+// Reed-Solomon使用GF(256)上的系统Cauchy矩阵，XOR模式每组只生成1个校验包。
+class FecCodec {
+public:
+    enum class Mode {
+        None,
+        Xor,          // 每组1个异或校验包，可恢复组内任意1个丢包
+        ReedSolomon   // 每组m个校验包，可恢复组内任意m个丢包
+    };
+
+    struct Config {
+        Mode mode = Mode::None;
+        double redundancy = 0.1;          // 普通帧冗余比例（校验包数/数据包数）
+        double keyframeRedundancy = 0.3;  // 关键帧冗余比例
+        unsigned int maxGroupSize = 48;   // 每组最多数据包数（k + m <= 255）
+    };
+
+    // 最大码字长度（GF(256)的Cauchy矩阵要求k + m <= 256）
+    static const unsigned int kMaxShards = 255;
+
+    // 计算一帧的分组参数：groupSize为每组数据包数，parityPerGroup为每组校验包数
+    static void planGroups(const Config& config, unsigned int packetCount, bool keyframe,
+                           unsigned int& groupSize, unsigned int& parityPerGroup);
+
+    // 编码：data[i]长度为dataSizes[i]（不足symbolSize的部分视为0），
+    // parity[j]为symbolSize字节的输出缓冲区
+    static void encode(Mode mode, const uint8_t* const* data, const uint32_t* dataSizes, unsigned int k,
+                       uint8_t* const* parity, unsigned int m, size_t symbolSize);
+
+    // 解码：shards[0..k)为数据、shards[k..k+m)为校验，均为symbolSize字节（数据包尾部补0）。
+    // present标记已收到的分片，缺失的数据分片在原位重建。收到的分片少于k个时返回false。
+    static bool decode(Mode mode, uint8_t* const* shards, const bool* present, unsigned int k, unsigned int m,
+                       size_t symbolSize);
+
+    // dst ^= c * src（GF(256)），按CPU能力选择AVX2/SSSE3/标量实现
+    static void mulAdd(uint8_t* dst, const uint8_t* src, uint8_t c, size_t size);
+
+    // 当前使用的GF(256)内核名称
+    static const char* kernelName();
+
+    static const char* modeName(Mode mode);
+    static bool parseMode(const std::string& name, Mode& mode);
+
+private:
+    static uint8_t coefficient(Mode mode, unsigned int parityIndex, unsigned int dataIndex, unsigned int k);
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// H.264 Annex-B码流辅助函数
+namespace h264 {
+
+enum NalType {
+    NAL_SLICE = 1,
+    NAL_IDR = 5,
+    NAL_SEI = 6,
+    NAL_SPS = 7,
+    NAL_PPS = 8,
+    NAL_AUD = 9
+};
+
+// 从offset开始查找下一个起始码（00 00 01或00 00 00 01），
+// 返回起始码之后第一个字节的位置，找不到时返回size
+inline size_t findNalStart(const uint8_t* data, size_t size, size_t offset) {
+    for (size_t i = offset; i + 3 <= size; i++) {
+        if (data[i] == 0 && data[i + 1] == 0) {
+            if (data[i + 2] == 1) {
+                return i + 3;
+            }
+            if (data[i + 2] == 0 && i + 4 <= size && data[i + 3] == 1) {
+                return i + 4;
+            }
+        }
+    }
+    return size;
+}
+
+inline uint8_t nalType(uint8_t header) {
+    return header & 0x1F;
+}
+
+// nal_ref_idc为0表示该NAL不被其他图像参考，可以丢弃而不影响后续解码
+inline uint8_t nalRefIdc(uint8_t header) {
+    return (header >> 5) & 0x03;
+}
+
+// 判断帧是否为IDR关键帧：扫描到第一个图像切片NAL为止
+inline bool isKeyframe(const uint8_t* data, size_t size) {
+    size_t pos = findNalStart(data, size, 0);
+    while (pos < size) {
+        uint8_t type = nalType(data[pos]);
+        if (type == NAL_IDR) {
+            return true;
+        }
+        if (type == NAL_SLICE) {
+            return false;
+        }
+        pos = findNalStart(data, size, pos + 1);
+    }
+    return false;
+}
+
+} // namespace h264
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+using namespace std;
+
+// 无锁HDR直方图（纳秒）：小于2^kSubBits的值逐一计数，更大的值按最高位分组，每组再按其后kSubBits位
+// 线性细分，相对误差不超过1/2^kSubBits（约1.6%），覆盖到2^(kMaxBits+1)纳秒（约137秒），更大的值计入最后一个桶。
+// record只有原子加和比较交换，可由多个线程并发调用；读取逐桶加载，与并发的记录之间不是原子快照
+// （总数可能相差正在记录的几个样本），对分位数的影响可以忽略
+class HdrHistogram {
+public:
+    static const unsigned int kSubBits = 6;
+    static const unsigned int kSubBuckets = 1u << kSubBits;
+    static const unsigned int kMaxBits = 36;
+    static const unsigned int kBuckets = kSubBuckets * (kMaxBits - kSubBits + 2);
+
+    // 一次读取得到的摘要
+    struct Summary {
+        uint64_t count;
+        double meanNs;
+        uint64_t minNs;
+        uint64_t p50Ns;
+        uint64_t p90Ns;
+        uint64_t p99Ns;
+        uint64_t p999Ns;
+        uint64_t maxNs;
+    };
+
+    HdrHistogram() {
+        reset();
+    }
+
+    HdrHistogram(const HdrHistogram&) = delete;
+    HdrHistogram& operator=(const HdrHistogram&) = delete;
+
+    // 清零，只能在没有线程记录时调用
+    void reset() {
+        for (unsigned int i = 0; i < kBuckets; i++) {
+            counts[i].store(0, std::memory_order_relaxed);
+        }
+        total.store(0, std::memory_order_relaxed);
+        sumNs.store(0, std::memory_order_relaxed);
+        minNs.store(UINT64_MAX, std::memory_order_relaxed);
+        maxNs.store(0, std::memory_order_relaxed);
+    }
+
+    void record(uint64_t valueNs) {
+        counts[bucketOf(valueNs)].fetch_add(1, std::memory_order_relaxed);
+        sumNs.fetch_add(valueNs, std::memory_order_relaxed);
+        uint64_t current = minNs.load(std::memory_order_relaxed);
+        while (valueNs < current && !minNs.compare_exchange_weak(current, valueNs, std::memory_order_relaxed)) {
+        }
+        current = maxNs.load(std::memory_order_relaxed);
+        while (valueNs > current && !maxNs.compare_exchange_weak(current, valueNs, std::memory_order_relaxed)) {
+        }
+        // 最后增加总数：读取方按总数分配名次时，对应的桶计数已经可见
+        total.fetch_add(1, std::memory_order_release);
+    }
+
+    uint64_t count() const {
+        return total.load(std::memory_order_acquire);
+    }
+
+    // 第fraction分位所在桶的上界，限制在[最小值, 最大值]内
+    uint64_t percentile(double fraction) const {
+        const double fractions[1] = {fraction};
+        uint64_t value = 0;
+        percentiles(fractions, 1, &value);
+        return value;
+    }
+
+    Summary summarize() const {
+        static const double fractions[5] = {0.5, 0.9, 0.99, 0.999, 1.0};
+        uint64_t values[5];
+        Summary summary;
+        summary.count = percentiles(fractions, 5, values);
+        summary.p50Ns = values[0];
+        summary.p90Ns = values[1];
+        summary.p99Ns = values[2];
+        summary.p999Ns = values[3];
+        summary.minNs = summary.count ? minNs.load(std::memory_order_relaxed) : 0;
+        summary.maxNs = summary.count ? maxNs.load(std::memory_order_relaxed) : 0;
+        summary.meanNs = summary.count ? static_cast<double>(sumNs.load(std::memory_order_relaxed)) / summary.count : 0.0;
+        return summary;
+    }
+
+    // 不大于boundNs的样本数（按桶的上界计，误差同分位数）
+    uint64_t countAtOrBelow(uint64_t boundNs) const {
+        uint64_t cumulative = 0;
+        for (unsigned int i = 0; i < kBuckets && upperBound(i) <= boundNs; i++) {
+            cumulative += counts[i].load(std::memory_order_relaxed);
+        }
+        return cumulative;
+    }
+
+    // 一次遍历求不大于各上界（boundsNs，升序）的累计样本数，返回全部样本数。
+    // 与逐个调用countAtOrBelow不同，结果来自同一次遍历，随上界单调不减且不超过返回值（供导出累积直方图）
+    uint64_t cumulativeCounts(const uint64_t* boundsNs, unsigned int n, uint64_t* results) const {
+        uint64_t cumulative = 0;
+        unsigned int next = 0;
+        for (unsigned int i = 0; i < kBuckets; i++) {
+            uint64_t bound = upperBound(i);
+            while (next < n && bound > boundsNs[next]) {
+                results[next++] = cumulative;
+            }
+            cumulative += counts[i].load(std::memory_order_relaxed);
+        }
+        for (; next < n; next++) {
+            results[next] = cumulative;
+        }
+        return cumulative;
+    }
+
+    uint64_t sum() const {
+        return sumNs.load(std::memory_order_relaxed);
+    }
+
+    static unsigned int bucketOf(uint64_t valueNs) {
+        if (valueNs < kSubBuckets) {
+            return static_cast<unsigned int>(valueNs);
+        }
+        unsigned int msb = highestBit(valueNs);
+        if (msb > kMaxBits) {
+            return kBuckets - 1;
+        }
+        unsigned int shift = msb - kSubBits;
+        return kSubBuckets * (shift + 1) + static_cast<unsigned int>((valueNs >> shift) - kSubBuckets);
+    }
+
+    // 第bucket个桶包含的最大值
+    static uint64_t upperBound(unsigned int bucket) {
+        unsigned int group = bucket / kSubBuckets;
+        uint64_t offset = bucket % kSubBuckets;
+        if (group == 0) {
+            return offset;
+        }
+        unsigned int shift = group - 1;
+        return ((kSubBuckets + offset + 1) << shift) - 1;
+    }
+
+private:
+    std::atomic<uint64_t> counts[kBuckets];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sumNs;
+    std::atomic<uint64_t> minNs;
+    std::atomic<uint64_t> maxNs;
+
+    static unsigned int highestBit(uint64_t value) {
+        unsigned int bit = 0;
+        while (value >>= 1) {
+            bit++;
+        }
+        return bit;
+    }
+
+    // 按升序的fractions一次遍历求多个分位数，返回参与计算的样本数
+    uint64_t percentiles(const double* fractions, unsigned int n, uint64_t* values) const {
+        uint64_t samples = count();
+        uint64_t minimum = minNs.load(std::memory_order_relaxed);
+        uint64_t maximum = maxNs.load(std::memory_order_relaxed);
+        unsigned int next = 0;
+        uint64_t cumulative = 0;
+        for (unsigned int i = 0; i < kBuckets && next < n && samples > 0; i++) {
+            cumulative += counts[i].load(std::memory_order_relaxed);
+            while (next < n && cumulative >= rankOf(fractions[next], samples)) {
+                uint64_t bound = upperBound(i);
+                values[next++] = bound < minimum ? minimum : (bound > maximum ? maximum : bound);
+            }
+        }
+        // 没有样本，或并发记录使桶计数尚未达到名次
+        for (; next < n; next++) {
+            values[next] = samples ? maximum : 0;
+        }
+        return samples;
+    }
+
+    static uint64_t rankOf(double fraction, uint64_t samples) {
+        uint64_t rank = static_cast<uint64_t>(fraction * samples + 0.999999);
+        return rank == 0 ? 1 : (rank > samples ? samples : rank);
+    }
+};
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdint.h>
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+// 对数分桶的延迟直方图（微秒）：每倍程4个桶（相邻桶上界相差约19%），
+// 覆盖16us到约16s，最后一个桶收纳更大的值。纯POD结构，可随统计结构体整体复制和清零
+struct LatencyHistogram {
+    static const unsigned int kBucketsPerOctave = 4;
+    static const unsigned int kBuckets = 81;
+    static const uint64_t kFirstBoundUs = 16;
+
+    uint64_t counts[kBuckets];
+    uint64_t count;
+    int64_t sumUs;
+    int64_t minUs;
+    int64_t maxUs;
+
+    // 第i个桶的上界（含），最后一个桶返回UINT64_MAX
+    static uint64_t upperBound(unsigned int bucket) {
+        if (bucket >= kBuckets - 1) {
+            return UINT64_MAX;
+        }
+        return static_cast<uint64_t>(std::llround(
+            kFirstBoundUs * std::pow(2.0, static_cast<double>(bucket) / kBucketsPerOctave)));
+    }
+
+    static unsigned int bucketOf(uint64_t valueUs) {
+        if (valueUs <= kFirstBoundUs) {
+            return 0;
+        }
+        double position = std::log2(static_cast<double>(valueUs) / kFirstBoundUs) * kBucketsPerOctave;
+        unsigned int bucket = static_cast<unsigned int>(std::min(std::ceil(position), kBuckets - 1.0));
+        // 修正上界取整带来的边界误差
+        while (bucket < kBuckets - 1 && valueUs > upperBound(bucket)) {
+            bucket++;
+        }
+        while (bucket > 0 && valueUs <= upperBound(bucket - 1)) {
+            bucket--;
+        }
+        return bucket;
+    }
+
+    void clear() {
+        for (unsigned int i = 0; i < kBuckets; i++) {
+            counts[i] = 0;
+        }
+        count = 0;
+        sumUs = 0;
+        minUs = 0;
+        maxUs = 0;
+    }
+
+    // 负值（时钟同步误差）计入第一个桶，但保留在最小值和总和中
+    void record(int64_t valueUs) {
+        counts[bucketOf(valueUs > 0 ? static_cast<uint64_t>(valueUs) : 0)]++;
+        if (count == 0 || valueUs < minUs) {
+            minUs = valueUs;
+        }
+        if (count == 0 || valueUs > maxUs) {
+            maxUs = valueUs;
+        }
+        count++;
+        sumUs += valueUs;
+    }
+
+    double mean() const {
+        return count ? static_cast<double>(sumUs) / count : 0.0;
+    }
+
+    // 分位数估计：在所在桶的上下界之间按名次线性插值，结果限制在[最小值, 最大值]内
+    int64_t percentile(double fraction) const {
+        if (count == 0) {
+            return 0;
+        }
+        double rank = fraction * (count - 1) + 1;
+        uint64_t cumulative = 0;
+        for (unsigned int i = 0; i < kBuckets; i++) {
+            if (counts[i] == 0) {
+                continue;
+            }
+            if (cumulative + counts[i] >= rank) {
+                double lower = i == 0 ? 0.0 : static_cast<double>(upperBound(i - 1));
+                double upper = i == kBuckets - 1 ? static_cast<double>(maxUs) : static_cast<double>(upperBound(i));
+                double value = lower + (upper - lower) * (rank - cumulative) / counts[i];
+                value = std::min(std::max(value, static_cast<double>(minUs)), static_cast<double>(maxUs));
+                return static_cast<int64_t>(value);
+            }
+            cumulative += counts[i];
+        }
+        return maxUs;
+    }
+};
@@ -7,7 +7,14 @@
 #include "ScreenCapture.h"
 #include "NVEncoder.h"
 #include "UDPTransmitter.h"
-#include "LockFreeQueue.h"
+#include "BitrateController.h"
+#include "SharedMemoryTransport.h"
+#include "FrameDropPolicy.h"
+#include "SpscRing.h"
+#include "FrameClock.h"
+#include "PipelineLatency.h"
+#include "ThreadTuning.h"
+#include "MetricsServer.h"
 #include <thread>
 #include <atomic>
 #include <string>
@@ -16,12 +23,22 @@ using namespace std;
 
 class LiveStreamer {
 public:
+    // 线程模型
+    enum class PipelineMode {
+        Pipelined,          // 采集、编码、发送各一个线程，经队列交接，吞吐最高
+        RunToCompletion     // 一个线程依次完成采集、编码、分包和发送，没有交接的唤醒延迟
+    };
+    
     // 配置参数
     struct Config {
         // 屏幕采集参数
         unsigned int displayIndex;
         unsigned int outputWidth;
         unsigned int outputHeight;
+        FrameClock::Config captureClock;    // 采集节拍（帧率取frameRate）
+        bool alignCapture;                  // 采集节拍向显示器的呈现时刻对齐
+        PipelineMode pipelineMode;
+        ThreadTuning::Config threads;       // 各阶段线程的CPU绑定、调度策略和内存锁定
         
         // 编码参数
         unsigned int frameRate;
@@ -30,7 +47,28 @@ public:
         // 传输参数
         std::string serverIP;
         unsigned int serverPort;
-        unsigned int maxPacketSize;
+        unsigned int maxPacketSize;     // 开启路径MTU探测时为分包大小上限
+        PathMtuDiscovery::Config pathMtu;   // 路径MTU探测
+        UDPTransmitter::SendBackend sendBackend;
+        bool zeroCopy;                  // 启用MSG_ZEROCOPY（Linux），io_uring后端下为注册缓冲区+SEND_ZC
+        UringSender::Config uring;      // io_uring后端参数
+        FecCodec::Config fec;           // 前向纠错
+        bool interleave;                // 帧内分包在FEC组之间交织发出
+        UDPTransmitter::RetransmitConfig retransmit;  // NACK重传
+        PacketPacer::Config pacing;     // 分包节奏控制
+        BitrateController::Config abr;  // 自适应码率（需要反馈端口）
+        RtpPacketizer::Config rtp;      // RTP/H.264输出（替代自定义包头）
+        bool sharedMemory;              // 以共享内存替代UDP，供同机消费者读取
+        SharedMemoryWriter::Config shm;
+        FrameDropPolicy::Config frameDrop;  // 按截止时刻和优先级丢帧
+        unsigned int metricsPort;       // 本机指标导出端口（127.0.0.1），0表示不导出
+    };
+    
+    // 各阶段完成的帧数（启动以来）
+    struct FrameCounts {
+        uint64_t captured;
+        uint64_t encoded;
+        uint64_t sent;              // 发出或写入共享内存
     };
     
     LiveStreamer();
@@ -47,16 +85,68 @@ public:
     
     // 获取状态
     bool isRunning() const { return running; }
+    UDPTransmitter::TransmitStats getTransmitStats() const { return transmitter.getStats(); }
+    BitrateController::Stats getBitrateStats() const { return bitrateController.getStats(); }
+    SharedMemoryWriter::Stats getSharedMemoryStats() const { return shmWriter.getStats(); }
+    FrameDropPolicy::Stats getDropStats() const { return dropPolicy.getStats(); }
+    FrameClock::Stats getCaptureClockStats() const { return captureClock.getStats(); }
+    PipelineLatency::Stats getLatencyStats() const { return latency.getStats(); }
+    std::vector<ThreadTuning::ThreadReport> getThreadReports() const { return threadTuning.getReports(); }
+    FrameCounts getFrameCounts() const;
+    
+    static const char* pipelineModeName(PipelineMode mode);
+    static bool parsePipelineMode(const std::string& name, PipelineMode& mode);
     
 private:
+    // 采集的帧，附带逐帧延迟追踪记录
+    struct CapturedFrame {
+        ScreenCapture::CaptureFrame capture;
+        PipelineLatency::FrameTimes times;
+    };
+
+    // 编码后的帧，附带采集时刻、截止时刻和优先级
+    struct EncodedFrame {
+        std::vector<uint8_t> data;
+        FrameDropPolicy::FrameInfo info;
+        PipelineLatency::FrameTimes times;
+    };
+
     // 模块实例
     ScreenCapture screenCapture;
     NVEncoder encoder;
     UDPTransmitter transmitter;
+    SharedMemoryWriter shmWriter;
+    BitrateController bitrateController;
+    FrameDropPolicy dropPolicy;
+    
+    // 采集节拍：按绝对截止时刻触发采集，采集耗时不会推迟下一次采集
+    FrameClock captureClock;
+    
+    // 各阶段和队列的逐帧延迟，帧发出时记录
+    PipelineLatency latency;
+    
+    // 线程调度设置，各线程启动时对自身应用
+    ThreadTuning threadTuning;
     
-    // 无锁队列用于线程间通信
-    LockFreeQueue<ScreenCapture::CaptureFrame> captureQueue;
-    LockFreeQueue<std::vector<uint8_t>> encodeQueue;
+    // 本机指标导出，在自己的低优先级线程上生成指标
+    MetricsServer metricsServer;
+    
+    // 各阶段完成的帧数，每个计数只由一个线程递增
+    std::atomic<uint64_t> framesCaptured;
+    std::atomic<uint64_t> framesEncoded;
+    std::atomic<uint64_t> framesSent;
+    
+    // 上一次抓取时的帧数，用于计算两次抓取之间的帧率（仅指标服务线程访问）
+    FrameCounts lastScrapeFrames;
+    uint64_t lastScrapeUs;
+    
+    // 编码器当前使用的码率（仅编码线程访问）
+    uint32_t appliedBitrateKbps;
+    
+    // 线程间队列：容量为1的有界环形队列，满时由生产者挤掉旧帧，只保留最新的一帧；
+    // 下游线程阻塞等待新帧，不再轮询
+    SpscRing<CapturedFrame> captureQueue;
+    SpscRing<EncodedFrame> encodeQueue;
     
     // 线程
     std::thread captureThread;
@@ -73,4 +163,29 @@ private:
     void captureThreadFunc();
     void encodeThreadFunc();
     void transmitThreadFunc();
+    void runToCompletionThreadFunc();
+    
+    // 在采集线程上配置并启动采集节拍
+    void startCaptureClock();
+    
+    // 等到下一个采集节拍并采集一帧
+    bool captureNextFrame(CapturedFrame& frame);
+    
+    // 编码一帧，在采集→编码和编码→发送边界按截止时刻丢帧；返回false表示该帧不再继续
+    bool encodeCapturedFrame(const CapturedFrame& capturedFrame, EncodedFrame& encodedFrame);
+    
+    // 发送前按参考链、截止时刻和拥塞丢帧，发出后记录各阶段延迟
+    void sendEncodedFrame(EncodedFrame& encodedFrame);
+    
+    // 把码率控制的目标同步到编码器和节奏控制
+    void applyTargetBitrate();
+    
+    // 编码帧放入发送队列，队列中已有帧时挤掉优先级较低的一帧
+    void enqueueEncodedFrame(EncodedFrame&& frame);
+    
+    // 发送端是否拥塞：上一帧发送受阻，或码率控制判定链路过载
+    bool isCongested() const;
+    
+    // 生成OpenMetrics文本（在指标服务线程上调用）
+    std::string formatMetrics();
 };
\ No newline at end of file
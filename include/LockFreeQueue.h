@@ -3,7 +3,8 @@
 #include <atomic>
 #include <memory>
 
-// 单生产者单消费者无锁队列
+// 单生产者单消费者无锁队列（无界，每次push分配节点和数据）。
+// 流水线已改用SpscRing，这里保留作为tools/QueueBenchmark.cpp的对比基准
 template<typename T>
 class LockFreeQueue {
 private:
@@ -22,7 +23,12 @@ private:
         if (old_head == tail.load(std::memory_order_acquire)) {
             return nullptr;
         }
-        head.store(old_head->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        // push先交换tail再链接next，其间next仍为空，此时视为队列为空
+        Node* const next = old_head->next.load(std::memory_order_acquire);
+        if (!next) {
+            return nullptr;
+        }
+        head.store(next, std::memory_order_relaxed);
         return old_head;
     }
     
@@ -12,6 +12,12 @@
 
 class NVEncoder {
 public:
+    // 最近一帧的编码时刻（timing::nowNanos()），用于逐帧延迟追踪
+    struct Timing {
+        uint64_t submitNs = 0;      // 提交编码（nvEncEncodePicture）
+        uint64_t completeNs = 0;    // 码流复制完成
+    };
+
     NVEncoder();
     
     NVEncoder(
@@ -29,6 +35,18 @@ public:
         std::vector<uint8_t>& output
     );
 
+    // 运行时调整目标码率和单帧大小上限（VBV缓冲区），不重建编码会话。
+    // 必须在调用encode的线程上调用；maxFrameBytes为0时按一帧平均大小
+    bool reconfigure(int bitrateKbps, int maxFrameBytes);
+
+    // 下一帧编码为IDR并重发SPS/PPS（参考帧被丢弃后恢复解码），必须在调用encode的线程上调用
+    void requestKeyframe() { keyframePending = true; }
+
+    int getBitrate() const { return bitrate; }
+
+    // 在调用encode的线程上读取
+    const Timing& getLastTiming() const { return lastTiming; }
+
     void stop();
 
 private:
@@ -40,6 +58,9 @@ private:
     int height = 0;
     int fps = 0;
     int bitrate = 0;
+    bool keyframePending = false;
+    uint64_t frameCount = 0;       // 简化实现按帧计数插入IDR
+    Timing lastTiming;
 
 #ifdef NVENC_AVAILABLE
     void* nvencEncoder = nullptr;
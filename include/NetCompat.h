@@ -0,0 +1,134 @@
+#pragma once
+
+// 跨平台套接字兼容层
+// 传输模块在Windows上使用Winsock2，在Linux上使用BSD套接字，
+// 以便发送端批量发送路径和接收端工具可以在Linux回环上验证。
+
+#ifdef _WIN32
+    // 强制包含winsock2.h并防止winsock.h被包含
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef _WINSOCKAPI_
+        #define _WINSOCKAPI_
+    #endif
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #pragma comment(lib, "ws2_32.lib")
+#else
+    #include <sys/types.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <sys/select.h>
+    #include <netinet/in.h>
+    #include <netinet/udp.h>
+    #include <arpa/inet.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <errno.h>
+    #include <cstring>
+
+    typedef int SOCKET;
+    #ifndef INVALID_SOCKET
+        #define INVALID_SOCKET (-1)
+    #endif
+    #ifndef SOCKET_ERROR
+        #define SOCKET_ERROR (-1)
+    #endif
+#endif
+
+#include <stdint.h>
+
+namespace net {
+
+// 初始化/清理网络库（Windows上为WSAStartup/WSACleanup，Linux上为空操作）
+inline bool startup() {
+#ifdef _WIN32
+    WSADATA wsaData;
+    return WSAStartup(MAKEWORD(2, 2), &wsaData) == 0;
+#else
+    return true;
+#endif
+}
+
+inline void cleanup() {
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+inline int lastError() {
+#ifdef _WIN32
+    return WSAGetLastError();
+#else
+    return errno;
+#endif
+}
+
+// 发送缓冲区已满（非阻塞套接字）
+inline bool isWouldBlock(int error) {
+#ifdef _WIN32
+    return error == WSAEWOULDBLOCK;
+#else
+    return error == EAGAIN || error == EWOULDBLOCK;
+#endif
+}
+
+inline void closeSocket(SOCKET s) {
+#ifdef _WIN32
+    closesocket(s);
+#else
+    close(s);
+#endif
+}
+
+inline bool setNonBlocking(SOCKET s) {
+#ifdef _WIN32
+    u_long mode = 1;
+    return ioctlsocket(s, FIONBIO, &mode) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+// 阻塞接收的超时时间，用于接收线程定期检查退出标志
+inline bool setReceiveTimeout(SOCKET s, unsigned int timeoutMs) {
+#ifdef _WIN32
+    DWORD timeout = timeoutMs;
+    return setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout)) == 0;
+#else
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    return setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0;
+#endif
+}
+
+// 等待套接字可读（有数据或新连接），超时返回false
+inline bool waitReadable(SOCKET s, uint64_t timeoutUs) {
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(s, &readSet);
+    timeval timeout;
+    timeout.tv_sec = static_cast<long>(timeoutUs / 1000000);
+    timeout.tv_usec = static_cast<long>(timeoutUs % 1000000);
+    return select(static_cast<int>(s) + 1, &readSet, nullptr, nullptr, &timeout) > 0;
+}
+
+// 等待套接字可写（发送缓冲区有空间），超时返回false
+inline bool waitWritable(SOCKET s, uint64_t timeoutUs) {
+    fd_set writeSet;
+    FD_ZERO(&writeSet);
+    FD_SET(s, &writeSet);
+    timeval timeout;
+    timeout.tv_sec = static_cast<long>(timeoutUs / 1000000);
+    timeout.tv_usec = static_cast<long>(timeoutUs % 1000000);
+    return select(static_cast<int>(s) + 1, nullptr, &writeSet, nullptr, &timeout) > 0;
+}
+
+inline bool setReceiveBufferSize(SOCKET s, int size) {
+    return setsockopt(s, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&size), sizeof(size)) == 0;
+}
+
+} // namespace net
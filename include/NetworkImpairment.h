@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <random>
+
+using namespace std;
+
+// 确定性网络损伤模型：对每个到达的数据包决定丢弃与否及其送达时刻。
+// 依次模拟Gilbert-Elliott突发丢包和独立随机丢包、带宽上限下的排队（队列满时尾部丢弃）、
+// 传播时延和抖动、乱序和重复。随机数由带种子的mt19937_64生成并自行换算为各分布，
+// 每个数据包消耗固定个数的随机数，因此相同种子、相同的包序列在任何平台上得到相同的随机丢包、
+// 突发丢包、乱序和重复模式（带宽上限下的队列丢包取决于到达时刻，不在此列）
+class NetworkImpairment {
+public:
+    enum class DelayDistribution {
+        Uniform,    // 时延 ± 抖动内均匀分布
+        Normal,     // 以抖动为标准差的正态分布
+        Pareto      // 只向后拖尾的Pareto分布（α=3，均值为抖动），模拟无线重传造成的长尾
+    };
+
+    struct Config {
+        uint64_t seed = 1;
+        double lossRate = 0.0;              // 独立随机丢包率
+
+        // Gilbert-Elliott两状态模型：每个包按转移概率切换状态，各状态有各自的丢包率
+        double burstEnter = 0.0;            // 好状态进入坏状态的概率（0表示关闭突发丢包）
+        double burstExit = 0.3;             // 坏状态回到好状态的概率，平均突发长度为其倒数
+        double burstLossGood = 0.0;         // 好状态下的丢包率
+        double burstLossBad = 1.0;          // 坏状态下的丢包率
+
+        unsigned int delayUs = 0;           // 单向传播时延
+        unsigned int jitterUs = 0;
+        DelayDistribution distribution = DelayDistribution::Uniform;
+
+        double reorderRate = 0.0;           // 被额外延迟、越过后续分包的比例
+        unsigned int reorderDelayUs = 1000; // 乱序分包的额外时延
+        double duplicateRate = 0.0;
+
+        unsigned int bandwidthKbps = 0;     // 链路速率，0表示不限
+        unsigned int queueBytes = 65536;    // 链路队列长度，排队超过该字节数时尾部丢弃
+    };
+
+    struct Stats {
+        uint64_t packetsIn;
+        uint64_t packetsOut;                // 含重复
+        uint64_t bytesIn;
+        uint64_t droppedRandom;
+        uint64_t droppedBurst;
+        uint64_t droppedQueue;
+        uint64_t reordered;
+        uint64_t duplicated;
+        uint64_t burstEpisodes;             // 进入坏状态的次数
+        uint64_t maxQueueDelayUs;
+    };
+
+    NetworkImpairment();
+
+    void configure(const Config& config);
+
+    // 处理一个在nowUs到达、大小为size字节的数据包，把各份拷贝的送达时刻写入releaseUs，
+    // 返回拷贝数：0为丢弃，1为正常，2为重复
+    unsigned int process(size_t size, uint64_t nowUs, uint64_t releaseUs[2]);
+
+    const Config& getConfig() const { return config; }
+    Stats getStats() const { return stats; }
+
+    // 预置场景：clean、lan、wifi、lossy、burst、congested、mobile
+    static bool applyScenario(const std::string& name, Config& config);
+    static std::vector<std::string> scenarioNames();
+
+    static bool parseDistribution(const std::string& name, DelayDistribution& distribution);
+    static const char* distributionName(DelayDistribution distribution);
+
+private:
+    Config config;
+    Stats stats;
+
+    // 标准规定了mt19937_64的输出序列，各分布的换算自行实现以保证跨平台一致
+    std::mt19937_64 random;
+
+    bool badState;
+    uint64_t linkFreeUs;        // 链路发送完队列中已有数据包的时刻
+    uint64_t lastReleaseUs;     // 按序送达的最晚时刻，抖动不造成乱序
+
+    double uniform();
+    int64_t sampleDelay(double u1, double u2);
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <stdint.h>
+#include <algorithm>
+
+using namespace std;
+
+// 帧内分包交织：把一帧的分包排成矩阵，第g列为第g个FEC组（数据包在前、该组校验包在后），
+// 按行依次发出，相邻发出的分包属于不同的组。G个组时连续丢失L个分包，每组最多丢失ceil(L / G)个，
+// 突发丢包被分散到各组的校验能力之内。只有最后一组可能较短，其列在行数超出后留空。
+// 交织顺序完全由包头中的packetCount、fecGroupSize和fecGroupParity决定，接收端据此换算发送位置；
+// 未启用FEC（fecGroupSize为0）或只有一组时顺序不变
+struct PacketInterleaver {
+    // 发送顺序中第position个分包的packetId写入order[position]，order至少容纳totalPackets个元素
+    static void buildOrder(unsigned int packetCount, unsigned int groupSize, unsigned int parityPerGroup,
+                           uint16_t* order) {
+        unsigned int groups = groupCount(packetCount, groupSize);
+        if (groups <= 1) {
+            unsigned int total = packetCount + groups * parityPerGroup;
+            for (unsigned int i = 0; i < total; i++) {
+                order[i] = static_cast<uint16_t>(i);
+            }
+            return;
+        }
+
+        unsigned int rows = groupSize + parityPerGroup;
+        unsigned int position = 0;
+        for (unsigned int row = 0; row < rows; row++) {
+            for (unsigned int group = 0; group < groups; group++) {
+                unsigned int dataCount = std::min(groupSize, packetCount - group * groupSize);
+                if (row < dataCount) {
+                    order[position++] = static_cast<uint16_t>(group * groupSize + row);
+                } else if (row < dataCount + parityPerGroup) {
+                    order[position++] = static_cast<uint16_t>(packetCount + group * parityPerGroup + row - dataCount);
+                }
+            }
+        }
+    }
+
+    // buildOrder的逆映射：packetId在发送顺序中的位置
+    static unsigned int sendPosition(unsigned int packetId, unsigned int packetCount, unsigned int groupSize,
+                                     unsigned int parityPerGroup) {
+        unsigned int groups = groupCount(packetCount, groupSize);
+        if (groups <= 1) {
+            return packetId;
+        }
+
+        unsigned int group;
+        unsigned int row;
+        if (packetId < packetCount) {
+            group = packetId / groupSize;
+            row = packetId % groupSize;
+        } else {
+            group = (packetId - packetCount) / parityPerGroup;
+            row = std::min(groupSize, packetCount - group * groupSize) + (packetId - packetCount) % parityPerGroup;
+        }
+
+        // 最后一组的分包数为lastRows，此后各行只有前groups - 1列
+        unsigned int lastRows = packetCount - (groups - 1) * groupSize + parityPerGroup;
+        unsigned int before = row <= lastRows ? row * groups : lastRows * groups + (row - lastRows) * (groups - 1);
+        return before + group;
+    }
+
+    static unsigned int groupCount(unsigned int packetCount, unsigned int groupSize) {
+        return groupSize > 0 ? (packetCount + groupSize - 1) / groupSize : 0;
+    }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+using namespace std;
+
+// 令牌桶分包节奏控制：把一帧的分包均匀分布在帧间隔的一部分时间内发出，
+// 避免关键帧以线速突发占满交换机和接收端的缓冲区
+class PacketPacer {
+public:
+    struct Config {
+        bool enabled = false;
+        double frameFraction = 0.5;     // 每帧分包在帧间隔的这一比例内发完
+        unsigned int burstPackets = 4;  // 每次最多连续发出的分包数（令牌桶容量）
+        unsigned int spinUs = 0;        // 混合定时器的自旋阈值，0表示按平台默认值
+    };
+
+    struct Stats {
+        uint64_t waits;                 // 因令牌不足而等待的次数
+        uint64_t totalWaitUs;
+        uint64_t totalLatenessUs;       // 实际出发时刻晚于计划时刻的累计值（定时器误差）
+        uint32_t departureJitterUs;     // 相邻突发出发间隔的变化（RFC 3550平滑）
+        uint32_t lastRateKbps;          // 最近一帧的发送速率
+        double avgLatenessUs;
+    };
+
+    PacketPacer();
+
+    // 根据编码器的码率和帧率计算基础速率
+    void configure(const Config& config, unsigned int bitrateKbps, unsigned int frameRate, unsigned int maxPacketSize);
+
+    // 运行时更新码率（仅发送线程调用）
+    void setBitrate(unsigned int bitrateKbps);
+
+    // 开始一帧：速率取"基础速率"和"在窗口内发完本帧所需速率"的较大者
+    void beginFrame(size_t frameBytes);
+
+    // 等待直到令牌足以发出bytes字节（混合休眠/自旋），并扣除令牌
+    void acquire(size_t bytes);
+
+    // 归还acquire已扣除但未被内核接受的字节（发送缓冲区满时的剩余分包），重试时不重复计费
+    void refund(size_t bytes);
+
+    bool isEnabled() const { return config.enabled; }
+    unsigned int getBurstPackets() const { return config.burstPackets; }
+    Stats getStats() const;
+
+private:
+    Config config;
+    unsigned int spinUs;
+    double baseRate;        // 字节/微秒
+    double windowUs;        // 每帧发送窗口
+    double capacity;        // 令牌桶容量（字节）
+
+    // 以下仅由发送线程访问
+    double rate;
+    double tokens;
+    uint64_t lastRefillUs;
+    uint64_t lastDepartureUs;
+    int64_t lastGapUs;
+    double jitterUs;
+
+    // 统计信息（由发送线程写入，其他线程读取）
+    std::atomic<uint64_t> waits;
+    std::atomic<uint64_t> totalWaitUs;
+    std::atomic<uint64_t> totalLatenessUs;
+    std::atomic<uint32_t> departureJitterUs;
+    std::atomic<uint32_t> lastRateKbps;
+};
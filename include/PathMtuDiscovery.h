@@ -0,0 +1,119 @@
+#pragma once
+
+#include "NetCompat.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+// 路径MTU探测：在独立线程中以禁止分片（DF）的探测包测量到接收端的最大UDP负载，
+// 启动时探测一次，之后按固定间隔重新探测，结果变化时通过回调通知发送端调整分包大小。
+// 探测包经数据路径发往接收端的流端口，接收端只应答完整收到的探测（长度与包内声明一致），
+// 应答经反馈端口返回，因此结果同时受路径MTU和接收端缓冲区大小约束。
+// Linux上探测套接字设为IP_PMTUDISC_DO，并以IP_MTU读取内核记录的路由MTU作为上限；
+// 超出路由MTU的探测由内核直接以EMSGSIZE拒绝。接收端无法应答时不发送探测，
+// 分包大小保持fallbackPacketSize，只在内核记录的路由MTU更小时（如隧道）随之降低
+class PathMtuDiscovery {
+public:
+    static const uint32_t kProbeMagic = 0x51544D50;  // "PMTQ"
+    static const uint32_t kAckMagic = 0x41544D50;    // "PMTA"
+
+    // IPv4头（20字节）+ UDP头（8字节），MTU与UDP负载之差
+    static const unsigned int kIpUdpOverhead = 28;
+
+    // 探测包：Probe之后以零填充到size字节
+    struct Probe {
+        uint32_t magic;
+        uint32_t probeId;
+        uint32_t size;          // 探测包的UDP负载长度
+        uint32_t check;         // ~magic，降低误识别媒体包的概率
+    };
+
+    struct Ack {
+        uint32_t magic;
+        uint32_t probeId;
+        uint32_t size;
+    };
+
+    struct Config {
+        bool enabled = false;
+        unsigned int minPacketSize = 1200;      // 搜索下限，第一个探测即为该大小（IPv6最小MTU 1280减去包头后仍有余量）
+        unsigned int fallbackPacketSize = 1400; // 接收端不应答时使用的分包大小（不超过内核上限）
+        unsigned int intervalMs = 60000;        // 重新探测间隔，0表示只在启动时探测
+        unsigned int probeTimeoutMs = 200;      // 等待单个探测应答的最长时间（测得往返时间后按其4倍缩短）
+        unsigned int probeRetries = 3;          // 同一大小的探测次数，全部无应答才判定过大（区分丢包）
+        unsigned int granularity = 16;          // 二分搜索在上下界相差不超过该值时结束
+    };
+
+    struct Stats {
+        unsigned int packetSize;    // 当前探测结果（UDP负载字节数）
+        unsigned int kernelMtu;     // 内核记录的路由MTU（IP_MTU，0表示不可用）
+        uint64_t probesSent;
+        uint64_t probesAcked;
+        uint64_t probesRejected;    // 超出路由MTU而被内核拒绝的探测（EMSGSIZE）
+        uint64_t searches;
+        bool receiverResponding;    // 最近一次搜索中接收端是否应答探测
+    };
+
+    // 探测结果变化时在探测线程中调用
+    typedef std::function<void(unsigned int packetSize)> ChangeHandler;
+
+    PathMtuDiscovery();
+    ~PathMtuDiscovery();
+
+    // maxPacketSize为分包大小上限（发送端缓冲区大小）；acknowledged为false表示接收端无法应答（未开启反馈端口
+    // 或RTP输出）。返回时已确定初始分包大小
+    bool start(const sockaddr_in& destination, unsigned int maxPacketSize, bool acknowledged,
+               const Config& config, const ChangeHandler& handler);
+    void stop();
+
+    // 处理反馈端口收到的应答（反馈线程调用）
+    void handleAck(const uint8_t* message, size_t size);
+
+    unsigned int getPacketSize() const { return packetSize.load(std::memory_order_relaxed); }
+    bool isRunning() const { return running; }
+    Stats getStats() const;
+
+    // 读取连接到目的地址的套接字的路由MTU（仅Linux）
+    static bool queryKernelMtu(SOCKET sock, unsigned int& mtu);
+
+private:
+    SOCKET sock;
+    Config config;
+    ChangeHandler changeHandler;
+    unsigned int maxPacketSize;
+    bool acknowledged;
+
+    std::atomic<bool> running;
+    std::thread thread;
+    std::vector<uint8_t> probeBuffer;
+
+    // 应答与探测线程之间的同步
+    std::mutex ackMutex;
+    std::condition_variable ackArrived;
+    uint32_t nextProbeId;
+    uint32_t lastAckedId;
+    uint64_t minRttUs;          // 已应答探测的最小往返时间，0表示尚无样本（仅探测线程访问）
+
+    std::atomic<unsigned int> packetSize;
+    std::atomic<unsigned int> kernelMtu;
+    std::atomic<uint64_t> probesSent;
+    std::atomic<uint64_t> probesAcked;
+    std::atomic<uint64_t> probesRejected;
+    std::atomic<uint64_t> searches;
+    std::atomic<bool> receiverResponding;
+
+    void threadFunc();
+    unsigned int search();
+    unsigned int kernelLimit();
+    bool probe(unsigned int size);
+    unsigned int probeTimeoutMs() const;
+    void update(unsigned int size);
+};
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "HdrHistogram.h"
+#include "PreciseTimer.h"
+#include <stdint.h>
+#include <atomic>
+
+using namespace std;
+
+// 逐帧延迟追踪：每帧带一条追踪记录，在各追踪点记下单调时钟的纳秒时刻（timing::nowNanos()），
+// 帧发出后按阶段和队列区间计入无锁HDR直方图。记录只有原子操作，界面和统计输出随时读取p50/p99/p999，
+// 不与流水线线程争锁。GPU上的裁剪和编码是异步的，追踪点记录的是CPU提交和取回结果的时刻
+class PipelineLatency {
+public:
+    enum class Point {
+        Acquire,            // 取到新画面（AcquireNextFrame返回）
+        CropCopy,           // 裁剪/缩放提交完成
+        CapturePublish,     // 放入采集→编码队列
+        EncodeTake,         // 开始处理该帧的编码（编码线程取到帧）
+        EncodeSubmit,       // 提交给编码器
+        EncodeComplete,     // 取到码流
+        EncodePublish,      // 放入编码→发送队列
+        SendTake,           // 开始处理该帧的发送（发送线程取到帧）
+        SinkPublish,        // 分包结果放入目的地的发送队列（多目的地发送时）
+        SinkTake,           // 目的地的发送线程取到帧
+        FirstPacket,        // 第一个分包发出
+        LastPacket,         // 最后一个分包发出
+        Count
+    };
+
+    static const unsigned int kPoints = static_cast<unsigned int>(Point::Count);
+
+    // 一帧的追踪记录，0表示未经过该点（如run-to-completion模式下没有队列）
+    struct FrameTimes {
+        uint64_t ns[kPoints] = {};
+
+        void mark(Point point) { ns[static_cast<unsigned int>(point)] = timing::nowNanos(); }
+        void set(Point point, uint64_t valueNs) { ns[static_cast<unsigned int>(point)] = valueNs; }
+        uint64_t at(Point point) const { return ns[static_cast<unsigned int>(point)]; }
+    };
+
+    enum class Span {
+        CropCopy,           // 阶段：取到画面 → 裁剪提交完成
+        CaptureQueue,       // 队列：采集→编码
+        EncodeSetup,        // 阶段：开始编码 → 提交编码器（截止时刻检查、码率调整、输入资源映射）
+        Encode,             // 阶段：提交编码器 → 取到码流
+        EncodeQueue,        // 队列：编码→发送
+        Packetize,          // 阶段：开始发送 → 第一个分包发出（丢帧判断、分包、FEC，多目的地时含目的地队列）
+        SinkQueue,          // 队列：目的地的发送队列
+        PacketSend,         // 阶段：第一个分包 → 最后一个分包（含节奏控制的等待）
+        Total,              // 取到画面 → 最后一个分包
+        Count
+    };
+
+    static const unsigned int kSpans = static_cast<unsigned int>(Span::Count);
+
+    struct Stats {
+        uint64_t frames;
+        HdrHistogram::Summary spans[kSpans];
+
+        const HdrHistogram::Summary& span(Span which) const { return spans[static_cast<unsigned int>(which)]; }
+    };
+
+    static const char* spanName(Span span) {
+        switch (span) {
+        case Span::CropCopy: return "Crop Copy";
+        case Span::CaptureQueue: return "Capture -> Encode";
+        case Span::EncodeSetup: return "Encode Setup";
+        case Span::Encode: return "Encode";
+        case Span::EncodeQueue: return "Encode -> Send";
+        case Span::Packetize: return "Packetize";
+        case Span::SinkQueue: return "Sink Queue";
+        case Span::PacketSend: return "Packet Send";
+        case Span::Total: return "Total";
+        default: return "Unknown";
+        }
+    }
+
+    // 导出指标时的标签值
+    static const char* spanKey(Span span) {
+        switch (span) {
+        case Span::CropCopy: return "crop_copy";
+        case Span::CaptureQueue: return "capture_queue";
+        case Span::EncodeSetup: return "encode_setup";
+        case Span::Encode: return "encode";
+        case Span::EncodeQueue: return "encode_queue";
+        case Span::Packetize: return "packetize";
+        case Span::SinkQueue: return "sink_queue";
+        case Span::PacketSend: return "packet_send";
+        case Span::Total: return "total";
+        default: return "unknown";
+        }
+    }
+
+    // 队列区间（其余为阶段区间和Total）
+    static bool isQueue(Span span) {
+        return span == Span::CaptureQueue || span == Span::EncodeQueue || span == Span::SinkQueue;
+    }
+
+    PipelineLatency() {
+        reset();
+    }
+
+    // 只能在没有线程记录时调用
+    void reset() {
+        frames.store(0, std::memory_order_relaxed);
+        for (unsigned int i = 0; i < kSpans; i++) {
+            histograms[i].reset();
+        }
+    }
+
+    // 帧发出后由发送线程调用
+    void record(const FrameTimes& times) {
+        add(Span::CropCopy, times, Point::Acquire, Point::CropCopy);
+        add(Span::CaptureQueue, times, Point::CapturePublish, Point::EncodeTake);
+        add(Span::EncodeSetup, times, Point::EncodeTake, Point::EncodeSubmit);
+        add(Span::Encode, times, Point::EncodeSubmit, Point::EncodeComplete);
+        add(Span::EncodeQueue, times, Point::EncodePublish, Point::SendTake);
+        add(Span::Packetize, times, Point::SendTake, Point::FirstPacket);
+        add(Span::SinkQueue, times, Point::SinkPublish, Point::SinkTake);
+        add(Span::PacketSend, times, Point::FirstPacket, Point::LastPacket);
+        add(Span::Total, times, Point::Acquire, Point::LastPacket);
+        frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Stats getStats() const {
+        Stats stats;
+        stats.frames = frames.load(std::memory_order_relaxed);
+        for (unsigned int i = 0; i < kSpans; i++) {
+            stats.spans[i] = histograms[i].summarize();
+        }
+        return stats;
+    }
+
+    const HdrHistogram& histogram(Span span) const { return histograms[static_cast<unsigned int>(span)]; }
+
+private:
+    std::atomic<uint64_t> frames;
+    HdrHistogram histograms[kSpans];
+
+    void add(Span span, const FrameTimes& times, Point from, Point to) {
+        uint64_t fromNs = times.at(from);
+        uint64_t toNs = times.at(to);
+        if (fromNs != 0 && toNs >= fromNs) {
+            histograms[static_cast<unsigned int>(span)].record(toNs - fromNs);
+        }
+    }
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <chrono>
+#include <thread>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <mmsystem.h>
+    #pragma comment(lib, "winmm.lib")
+#endif
+
+// 高精度定时：先休眠到目标时刻前spinUs微秒，剩余时间自旋等待。
+// 系统休眠的唤醒误差通常为50us（Linux）到1ms（Windows默认时钟分辨率），
+// 自旋段吸收这部分误差，代价是每次等待最多占用spinUs的CPU时间。
+namespace timing {
+
+inline uint64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// 与nowMicros同一时钟，用于逐帧延迟追踪
+inline uint64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// Windows上把系统时钟分辨率提高到1ms，进程退出时自动恢复
+inline void enableHighResolution() {
+#ifdef _WIN32
+    timeBeginPeriod(1);
+#endif
+}
+
+// 各平台的默认自旋阈值
+inline unsigned int defaultSpinUs() {
+#ifdef _WIN32
+    return 1500;
+#else
+    return 200;
+#endif
+}
+
+inline void sleepUntil(uint64_t targetUs, unsigned int spinUs) {
+    uint64_t now = nowMicros();
+    if (now >= targetUs) {
+        return;
+    }
+
+    if (targetUs - now > spinUs) {
+        std::this_thread::sleep_for(std::chrono::microseconds(targetUs - now - spinUs));
+    }
+
+    while (nowMicros() < targetUs) {
+        std::this_thread::yield();
+    }
+}
+
+} // namespace timing
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <atomic>
+
+using namespace std;
+
+// 重传环：保存最近发送的分包，供反馈线程按(frameId, packetId)查找重发。
+// 单写者（发送线程）多读者（反馈线程），所有存储在初始化时分配。
+// 每个槽位以序列锁保护：写者写入期间序号为奇数，读者复制后校验序号未变，
+// 因此发送线程从不等待读者，被覆盖的槽位只会让读者查找失败。
+class RetransmitRing {
+public:
+    RetransmitRing();
+
+    // packetCapacity：可保存的分包数；frameCapacity：可索引的帧数；maxPacketSize：单个分包最大字节数
+    bool initialize(unsigned int packetCapacity, unsigned int frameCapacity, unsigned int maxPacketSize);
+
+    // 发送线程：登记一帧并为其数据包预留连续槽位，随后逐个写入
+    void beginFrame(uint32_t frameId, uint16_t packetCount, uint64_t sendTimeUs);
+    void storePacket(uint32_t frameId, uint16_t packetId, const uint8_t* header, size_t headerSize,
+                     const uint8_t* payload, size_t payloadSize);
+
+    // 反馈线程：查找帧的发送时间，帧不在索引中时返回false
+    bool findFrame(uint32_t frameId, uint64_t& sendTimeUs, uint16_t& packetCount) const;
+
+    // 反馈线程：把分包复制到packet（至少maxPacketSize字节），分包已被覆盖或正在写入时返回false
+    bool readPacket(uint32_t frameId, uint16_t packetId, uint8_t* packet, size_t& size) const;
+
+    bool isInitialized() const { return packetCapacity > 0; }
+    unsigned int getMaxPacketSize() const { return maxPacketSize; }
+
+private:
+    struct PacketSlot {
+        std::atomic<uint32_t> sequence;
+        uint32_t frameId;
+        uint16_t packetId;
+        uint32_t size;
+    };
+
+    struct FrameEntry {
+        std::atomic<uint32_t> sequence;
+        uint32_t frameId;
+        uint16_t packetCount;
+        uint64_t firstPosition;   // 第一个数据包在环中的全局位置
+        uint64_t sendTimeUs;
+    };
+
+    unsigned int packetCapacity;
+    unsigned int frameCapacity;
+    unsigned int maxPacketSize;
+
+    std::vector<PacketSlot> packetSlots;
+    std::vector<uint8_t> packetData;      // packetCapacity × maxPacketSize
+    std::vector<FrameEntry> frameEntries;
+
+    // 下一个分包的全局写入位置（仅发送线程修改）
+    uint64_t writePosition;
+    uint64_t currentFramePosition;
+};
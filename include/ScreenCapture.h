@@ -33,7 +33,10 @@ public:
         ID3D11Texture2D* texture;
         unsigned int width;
         unsigned int height;
-        uint64_t timestamp;
+        uint64_t timestamp;     // 采集时刻（timing::nowMicros()），随帧传到包头供接收端计算单向延迟
+        uint64_t presentTime;   // 画面呈现到显示器的时刻（同一时钟），0表示自上次采集以来没有新呈现
+        uint64_t acquireNs;     // AcquireNextFrame返回的时刻（timing::nowNanos()），用于逐帧延迟追踪
+        uint64_t copyNs;        // 裁剪/缩放提交完成的时刻（同一时钟）
     };
     
     ScreenCapture();
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #pragma comment(lib, "synchronization.lib")
+#else
+    #include <unistd.h>
+    #include <time.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+#endif
+
+using namespace std;
+
+// 有界单生产者单消费者环形队列：槽位在构造时一次分配，每个槽位带序列号
+// （等于2×写入位置时空闲，等于2×写入位置+1时已发布，取出后变为下一圈的空闲值），
+// 读写位置、槽位和唤醒计数各占一个缓存行。
+// 稳态入队、出队都只有acquire/release的加载和存储，没有堆分配。
+// OverwriteOldest模式下队列满时生产者挤掉最旧的元素（"只保留最新帧"），
+// 此时生产者和消费者都可能推进读位置，出队改为对读位置做CAS。
+// popWait在队列为空时阻塞：Linux上用futex，Windows上用WaitOnAddress；
+// 只有消费者在等待时生产者才进入内核唤醒
+template <typename T>
+class SpscRing {
+public:
+    enum class Overflow {
+        Reject,             // 队列满时push失败
+        OverwriteOldest     // 队列满时挤掉最旧的元素
+    };
+
+    static const size_t kCacheLine = 64;
+
+    // 容量向上取整为2的幂
+    explicit SpscRing(size_t capacity, Overflow overflow = Overflow::Reject)
+        : overflow(overflow),
+          slotCount(roundUpPowerOfTwo(capacity)),
+          mask(slotCount - 1),
+          slots(new Slot[slotCount]),
+          head(0),
+          tail(0),
+          signal(0) {
+        for (size_t i = 0; i < slotCount; i++) {
+            slots[i].sequence.store(2 * i, std::memory_order_relaxed);
+        }
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // 生产者：队列满时返回false，value保持不变
+    bool tryPush(T&& value) {
+        uint64_t position = tail.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != 2 * position) {
+            return false;
+        }
+        publish(slot, position, std::move(value));
+        return true;
+    }
+
+    // 生产者（OverwriteOldest模式）：队列满时挤掉最旧的元素并移入evicted，返回是否挤掉了元素
+    bool pushOverwrite(T&& value, T& evicted) {
+        uint64_t position = tail.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & mask];
+        bool overwritten = false;
+        while (slot.sequence.load(std::memory_order_acquire) != 2 * position) {
+            // 该槽位仍存放上一圈的元素，即队列中最旧的元素；取不到说明消费者正在取出它
+            if (!overwritten && pop(evicted)) {
+                overwritten = true;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        publish(slot, position, std::move(value));
+        return overwritten;
+    }
+
+    // 消费者取出最旧的元素；OverwriteOldest模式下生产者也可调用，以便按内容决定挤掉哪个元素
+    // （Reject模式下读位置只由消费者推进，生产者不能调用）
+    bool pop(T& value) {
+        uint64_t position = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[position & mask];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence < 2 * position + 1) {
+                return false;
+            }
+            if (sequence != 2 * position + 1) {
+                // 读位置已被另一方推进
+                position = head.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (overflow == Overflow::Reject) {
+                head.store(position + 1, std::memory_order_relaxed);
+            } else if (!head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                continue;
+            }
+            value = std::move(slot.value);
+            slot.sequence.store(2 * (position + slotCount), std::memory_order_release);
+            return true;
+        }
+    }
+
+    // 消费者：队列为空时最多等待timeoutUs微秒，期间有元素发布或notify时立即返回。
+    // 被notify或虚假唤醒时返回false，调用方检查停止标志后重新等待
+    bool popWait(T& value, unsigned int timeoutUs) {
+        for (;;) {
+            uint32_t state = signal.load(std::memory_order_acquire);
+            if (pop(value)) {
+                return true;
+            }
+            // 置等待位：其间有元素发布时CAS失败，回到开头重新取
+            if (!(state & kWaitingBit) &&
+                !signal.compare_exchange_strong(state, state | kWaitingBit, std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+                continue;
+            }
+            waitOnSignal(state | kWaitingBit, timeoutUs);
+            if (pop(value)) {
+                return true;
+            }
+            // 超时或被notify：清除可能残留的等待位
+            signal.fetch_and(~kWaitingBit, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    // 唤醒正在popWait的消费者（如停止时）
+    void notify() {
+        signal.fetch_add(kSignalStep, std::memory_order_release);
+        signal.fetch_and(~kWaitingBit, std::memory_order_relaxed);
+        wakeSignal();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    // 近似值：其他线程读取时两端可能正在推进
+    size_t size() const {
+        uint64_t readPosition = head.load(std::memory_order_relaxed);
+        uint64_t writePosition = tail.load(std::memory_order_relaxed);
+        return writePosition > readPosition ? static_cast<size_t>(writePosition - readPosition) : 0;
+    }
+
+    size_t capacity() const { return slotCount; }
+
+private:
+    static const uint32_t kWaitingBit = 1;
+    static const uint32_t kSignalStep = 2;
+
+    struct alignas(kCacheLine) Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+
+    const Overflow overflow;
+    const size_t slotCount;
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    // 读位置（消费者推进，OverwriteOldest模式下生产者也会推进）
+    alignas(kCacheLine) std::atomic<uint64_t> head;
+    // 写位置（仅生产者推进）
+    alignas(kCacheLine) std::atomic<uint64_t> tail;
+    // 每发布一个元素加kSignalStep，最低位表示消费者正在等待
+    alignas(kCacheLine) std::atomic<uint32_t> signal;
+
+    void publish(Slot& slot, uint64_t position, T&& value) {
+        slot.value = std::move(value);
+        slot.sequence.store(2 * position + 1, std::memory_order_release);
+        tail.store(position + 1, std::memory_order_relaxed);
+
+        // 与消费者置等待位的CAS同在signal上排序：先于该CAS时CAS失败，后于时这里看到等待位
+        if (signal.fetch_add(kSignalStep, std::memory_order_release) & kWaitingBit) {
+            signal.fetch_and(~kWaitingBit, std::memory_order_relaxed);
+            wakeSignal();
+        }
+    }
+
+    void waitOnSignal(uint32_t observed, uint64_t timeoutUs) {
+#ifdef _WIN32
+        DWORD timeoutMs = static_cast<DWORD>((timeoutUs + 999) / 1000);
+        WaitOnAddress(reinterpret_cast<volatile VOID*>(&signal), &observed, sizeof(observed), timeoutMs);
+#else
+        // 值已改变时立即返回EAGAIN
+        struct timespec timeout;
+        timeout.tv_sec = static_cast<time_t>(timeoutUs / 1000000);
+        timeout.tv_nsec = static_cast<long>(timeoutUs % 1000000) * 1000;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&signal), FUTEX_WAIT_PRIVATE, observed, &timeout, nullptr, 0);
+#endif
+    }
+
+    void wakeSignal() {
+#ifdef _WIN32
+        WakeByAddressSingle(reinterpret_cast<PVOID>(&signal));
+#else
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&signal), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+#endif
+    }
+
+    static size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+};
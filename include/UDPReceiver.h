@@ -0,0 +1,247 @@
+#pragma once
+
+#include "NetCompat.h"
+#include "UDPTransmitter.h"
+#include "ClockSync.h"
+#include "LatencyHistogram.h"
+
+#include <stdint.h>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+
+using namespace std;
+
+// UDP视频流接收端：按frameId/packetId重组分包，按需FEC恢复，
+// 经自适应抖动缓冲后交付"最新的完整帧"
+class UDPReceiver {
+public:
+    struct Config {
+        unsigned int port = 5000;
+        unsigned int maxPacketSize = 1400;    // 需不小于发送端；发送端探测路径MTU时只选用不超过该值的分包大小
+        unsigned int frameSlots = 8;          // 预分配的帧槽位数
+        unsigned int maxPacketsPerFrame = 1536; // 单帧最多分包数（数据包 + 校验包）
+        int socketBufferSize = 8 * 1024 * 1024;
+
+        // 抖动缓冲：目标延迟 = clamp(jitterMultiplier × 抖动, minDelayUs, maxDelayUs)
+        unsigned int minDelayUs = 0;
+        unsigned int maxDelayUs = 20000;
+        double jitterMultiplier = 3.0;
+
+        // NACK：向发送端反馈端口请求重传缺失的数据包，0表示关闭
+        unsigned int nackPort = 0;
+        unsigned int nackDelayUs = 500;          // 帧停止到达多久后（或出现更新的帧时）发送NACK
+        unsigned int nackRetryIntervalUs = 2000;
+        unsigned int maxNackRetries = 3;
+        unsigned int nackDeadlineUs = 20000;     // 帧首包到达后超过该时间不再请求，应与发送端期限一致
+
+        // 接收报告：按该间隔向同一反馈端口报告丢包、接收速率和时延梯度，供发送端码率控制使用，0表示关闭。
+        // 只需要报告时可把maxNackRetries设为0
+        unsigned int reportIntervalUs = 0;
+
+        // 时钟同步：按该间隔向同一反馈端口发送探测，估计两端时钟偏差和漂移，
+        // 用于计算跨主机的单向延迟，0表示关闭（此时端到端延迟只在同一主机上有意义）。
+        // 启动时先以较短间隔连续探测，尽快完成同步
+        unsigned int clockSyncIntervalUs = 1000000;
+    };
+
+    struct ReceivedFrame {
+        std::vector<uint8_t> data;
+        uint32_t frameId;
+        uint64_t timestamp;           // 发送端时间戳（微秒）
+        bool keyframe;
+        bool recovered;               // 是否经FEC恢复
+        uint32_t completionLatencyUs; // 第一个分包到达至帧完整的耗时
+        int64_t endToEndLatencyUs;    // 发送端时间戳（采集时刻）至帧完整的单向延迟，时钟同步后按发送端时钟计算
+        bool clockSynchronized;       // endToEndLatencyUs是否经时钟同步校正（否则仅同一主机上有意义）
+        uint32_t bufferDelayUs;       // 帧完整后在抖动缓冲中等待的时间
+    };
+
+    struct ReceiveStats {
+        uint64_t packetsReceived;
+        uint64_t bytesReceived;
+        uint64_t parityPacketsReceived;
+        uint64_t packetsReordered;    // 晚于同一流中更靠后的分包到达
+        uint64_t packetsDuplicate;
+        uint64_t packetsLate;         // 所属帧已交付或已被淘汰
+        uint64_t packetsInvalid;      // 包头或长度不合法、超出槽位容量
+        uint64_t packetsLost;         // 已结束帧中未收到的数据包（不含整帧丢失）
+        uint64_t packetsRecovered;    // 经FEC恢复的数据包
+
+        uint64_t framesExpected;      // 按frameId范围推算的帧数
+        uint64_t framesCompleted;
+        uint64_t framesRecovered;     // 经FEC恢复后完整的帧
+        uint64_t framesDelivered;
+        uint64_t framesSkipped;       // 完整但被更新的完整帧取代、未交付
+        uint64_t framesLost;          // 未能完整接收的帧（含整帧丢失）
+
+        uint32_t jitterUs;            // 帧到达间隔抖动（RFC 3550算法）
+        uint32_t targetDelayUs;       // 当前抖动缓冲目标延迟
+        double avgCompletionLatencyUs;
+        uint32_t maxCompletionLatencyUs;
+        double avgEndToEndLatencyUs;
+        int64_t maxEndToEndLatencyUs;
+        double avgBufferDelayUs;
+
+        // 单向延迟直方图：启用时钟同步时只统计同步后完整的帧
+        LatencyHistogram endToEndHistogram;
+        LatencyHistogram completionHistogram;
+
+        // NACK重传
+        uint64_t nacksSent;
+        uint64_t packetsNacked;           // NACK中请求的分包数
+        uint64_t packetsRetransmitReceived;
+        uint64_t framesRetransmitted;     // 经重传补齐的帧
+        uint32_t nackRttUs;               // NACK发出至重传包到达的平滑时间
+
+        // 接收报告
+        uint64_t reportsSent;
+        int32_t delayGradientUsPerS;      // 最近一次报告的时延梯度
+
+        // 时钟同步
+        uint64_t clockProbesSent;
+        ClockSync::Stats clock;
+
+        // 路径MTU探测
+        uint64_t pathMtuProbesReceived;
+        uint64_t pathMtuProbesAnswered;   // 完整收到并应答的探测
+    };
+
+private:
+    enum class SlotState {
+        Empty,
+        Assembling,
+        Complete
+    };
+
+    // 帧槽位：分包按packetId存入固定大小的单元，初始化时一次性分配
+    struct FrameSlot {
+        SlotState state;
+        uint32_t frameId;
+        uint16_t packetCount;
+        uint32_t frameSize;
+        uint64_t timestamp;
+        uint8_t flags;
+        uint8_t fecGroupSize;
+        uint8_t fecGroupParity;
+        uint32_t payloadStride;        // 发送端分包负载大小，由非末尾数据包或校验包确定
+        int32_t lastPayloadSize;       // 直接收到的末尾数据包负载大小，-1表示未收到（可能经FEC恢复）
+        uint32_t dataReceived;         // 已有数据包数（含FEC恢复）
+        uint32_t dataRecovered;
+        uint64_t firstPacketTime;      // steady_clock微秒
+        uint64_t completeTime;
+        int64_t transitUs;             // 帧完整时刻（本地时钟）与发送端时间戳之差，含两端时钟偏差
+        int64_t endToEndUs;            // 单向延迟，时钟同步后已扣除偏差
+        bool clockSynchronized;
+        uint64_t lastPacketTime;
+        uint32_t nackCount;
+        uint64_t lastNackTime;
+        bool retransmitted;            // 是否收到过重传包
+        uint32_t totalPackets;         // 数据包 + 校验包
+        uint32_t reportedPackets;      // 已计入接收报告应收数的分包位置
+        std::vector<uint8_t> cells;    // maxPacketsPerFrame × cellSize
+        std::vector<uint8_t> present;  // 每个packetId是否已收到
+        std::vector<uint8_t> groupDataReceived;
+        std::vector<uint8_t> groupParityReceived;
+    };
+
+    Config config;
+    unsigned int cellSize;
+
+    SOCKET sock;
+    std::atomic<bool> running;
+    std::thread receiveThread;
+
+    // 槽位表由接收线程写入、消费线程读取
+    std::mutex slotMutex;
+    std::condition_variable frameReady;
+    std::vector<FrameSlot> slots;
+
+    // 流状态（受slotMutex保护）
+    bool streamStarted;
+    uint32_t firstFrameId;
+    uint32_t highestFrameId;
+    uint16_t highestPacketId;      // highestFrameId帧内见到的最大发送位置（交织时不等于packetId）
+    bool anyDelivered;
+    uint32_t lastDeliveredFrameId;
+
+    // 抖动估计（受slotMutex保护）
+    bool haveTransit;
+    int64_t lastTransitUs;
+    int64_t baseTransitUs;
+    double jitterUs;
+
+    // NACK发送目标与往返时间（受slotMutex保护）
+    sockaddr_in senderAddr;
+    bool haveSender;
+    double nackRttUs;
+
+    // 当前报告区间的累计值（受slotMutex保护）
+    uint32_t reportSequence;
+    uint64_t reportStartTime;
+    uint32_t reportPacketsExpected;    // 按各帧已见到的最大packetId逐步累计，帧结束时补齐尾部
+    uint32_t reportPacketsReceived;
+    uint32_t reportBytesReceived;
+    int64_t reportTransitOrigin;
+    // 帧首包传输时间对到达时间的最小二乘拟合
+    unsigned int reportSamples;
+    double reportSumX;
+    double reportSumY;
+    double reportSumXY;
+    double reportSumXX;
+
+    // 时钟同步（受slotMutex保护）
+    ClockSync clockSync;
+    uint32_t clockSequence;
+    uint64_t lastClockProbeTime;
+
+    // 接收缓冲区，初始化时分配
+    std::vector<uint8_t> receiveBuffers;
+
+    // 统计信息（受slotMutex保护）
+    ReceiveStats stats;
+    uint64_t totalCompletionLatencyUs;
+    uint64_t totalBufferDelayUs;
+
+    void receiveThreadFunc();
+    void handlePacket(const uint8_t* packet, size_t size, const sockaddr_in& from, uint64_t now);
+    FrameSlot* acquireSlot(const UDPTransmitter::PacketHeader& header, bool create, uint64_t now);
+    void releaseSlot(FrameSlot& slot);
+    void recoverGroup(FrameSlot& slot, unsigned int group);
+    void completeFrame(FrameSlot& slot, uint64_t now);
+    void abandonOlderFrames(uint32_t frameId, uint64_t now);
+    bool isRepairable(const FrameSlot& slot, uint64_t now) const;
+    void sendNacks(uint64_t now);
+    void sendNack(FrameSlot& slot, uint64_t now);
+    void noteFrameStart(const UDPTransmitter::PacketHeader& header, uint64_t now);
+    void notePacketPosition(FrameSlot& slot, uint32_t packetId);
+    void sendReport(uint64_t now);
+    void sendClockProbe(uint64_t now);
+    void handleClockReply(const uint8_t* packet, uint64_t now);
+    void handlePathMtuProbe(const PathMtuDiscovery::Probe& probe, size_t size, const sockaddr_in& from);
+    FrameSlot* findDeliverableFrame(uint64_t now, uint64_t& nextReadyTime);
+    void deliverFrame(FrameSlot& slot, ReceivedFrame& frame, uint64_t now);
+    uint64_t readyTime(const FrameSlot& slot) const;
+    uint32_t targetDelayUs() const;
+    unsigned int groupDataCount(const FrameSlot& slot, unsigned int group) const;
+
+public:
+    UDPReceiver();
+    ~UDPReceiver();
+
+    bool initialize(const Config& config);
+    void start();
+    void stop();
+
+    // 等待下一帧：返回已过抖动缓冲延迟的最新完整帧，更早的未交付完整帧计为跳过。
+    // frame.data的容量跨帧复用，稳态下不分配内存。超时返回false。
+    bool waitFrame(ReceivedFrame& frame, unsigned int timeoutMs);
+
+    ReceiveStats getStats();
+
+    bool isRunning() const { return running; }
+    const Config& getConfig() const { return config; }
+};
@@ -1,56 +1,449 @@
 #pragma once
 
-// 强制包含winsock2.h并防止winsock.h被包含
-#define WIN32_LEAN_AND_MEAN
-#define _WINSOCKAPI_
+#include "NetCompat.h"
+#include "FecCodec.h"
+#include "RetransmitRing.h"
+#include "PacketPacer.h"
+#include "RtpPacketizer.h"
+#include "UringSender.h"
+#include "PathMtuDiscovery.h"
+#include "PacketInterleaver.h"
 
 #include <stdint.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
 #include <vector>
 #include <atomic>
 #include <string>
+#include <thread>
+#include <functional>
 
 using namespace std;
 
-#pragma comment(lib, "ws2_32.lib")
-
 class UDPTransmitter {
-private:
-    SOCKET sock;
-    sockaddr_in serverAddr;
-    
-    // 配置参数
-    std::string serverIP;
-    unsigned int serverPort;
-    unsigned int maxPacketSize;
-    
-    std::atomic<bool> running;
-    
 public:
+    // 发送后端
+    enum class SendBackend {
+        Auto,       // 自动选择当前平台可用的最快后端
+        PerPacket,  // 每个分包一次sendto（兼容路径）
+        Batched,    // sendmmsg，一次系统调用提交多个分包（Linux）
+        Segmented,  // UDP GSO（UDP_SEGMENT），由内核完成分段（Linux）
+        Uring       // io_uring，整帧分包以链接的SQE一次提交（Linux 5.6+）
+    };
+
+    // 发送统计
+    struct TransmitStats {
+        uint64_t framesSent;
+        uint64_t packetsSent;
+        uint64_t bytesSent;
+        uint64_t packetsDropped;   // 发送缓冲区持续满、超过重试期限而丢弃的分包
+        uint64_t blockedSends;     // 发送缓冲区满、等待可写后重试的次数
+        uint64_t sendErrors;       // 套接字发送错误（非缓冲区满）而放弃的帧
+        uint64_t syscalls;         // 发送相关的系统调用总数
+        uint64_t totalSendTimeUs;  // 所有帧的发送耗时总和
+        uint32_t lastFrameSyscalls;
+        uint32_t lastFrameSendTimeUs;
+        double avgSyscallsPerFrame;
+        double avgSendTimeUs;
+        SendBackend backend;       // 实际生效的后端
+
+        // 分包开销
+        uint64_t allocations;      // 分包阶段的堆分配次数（稳态应为0）
+        uint64_t bytesCopied;      // 分包阶段在用户态复制的字节数（仅包头）
+        double avgAllocationsPerFrame;
+        double avgBytesCopiedPerFrame;
+
+        // MSG_ZEROCOPY
+        bool zeroCopy;                 // 零拷贝是否生效
+        uint64_t zeroCopySends;        // 以MSG_ZEROCOPY提交的消息数
+        uint64_t zeroCopyCompletions;  // 已收到完成通知的消息数
+        uint64_t zeroCopyDeferredCopies; // 内核回退为复制的消息数（如回环或不支持SG的网卡）
+        uint64_t zeroCopySlotStalls;   // 在途缓冲区用尽时退回普通发送的帧数
+
+        // 前向纠错
+        uint64_t keyframesSent;
+        uint64_t fecParityPackets;     // 已生成的校验包数
+        uint64_t fecEncodeTimeUs;      // 校验包编码耗时总和
+        double avgFecEncodeTimeUs;
+
+        // NACK重传
+        uint64_t nacksReceived;
+        uint64_t retransmitRequests;   // NACK中请求的分包数
+        uint64_t packetsRetransmitted;
+        uint64_t retransmitExpired;    // 超过重传期限而放弃的分包
+        uint64_t retransmitUnavailable; // 已被重传环覆盖的分包
+        uint64_t reportsReceived;      // 接收报告
+        uint64_t clockProbesAnswered;  // 已应答的时钟同步探测
+
+        // 节奏控制
+        bool pacing;
+        uint64_t pacingWaits;
+        double avgPacingLatenessUs;    // 定时器唤醒晚于计划时刻的平均值
+        uint32_t departureJitterUs;    // 突发出发间隔抖动
+        uint32_t pacingRateKbps;       // 最近一帧的发送速率
+
+        // RTP分包
+        bool rtp;
+        uint64_t rtpSingleNals;
+        uint64_t rtpAggregatedNals;    // 以STAP-A聚合的NAL单元
+        uint64_t rtpAggregationPackets;
+        uint64_t rtpFragmentedNals;    // 以FU-A分片的NAL单元
+
+        // io_uring后端
+        bool uringSqPoll;
+        bool uringRegisteredBuffers;
+        uint64_t uringSubmitted;       // 提交的SQE数
+        uint64_t uringCancelled;       // 因链中前一个分包阻塞而取消的SQE
+        uint64_t uringEnters;          // io_uring_enter调用次数（SQPOLL下稳态为0）
+        uint64_t uringWakeups;         // 唤醒SQPOLL线程的次数
+        uint64_t uringNotifications;   // SEND_ZC完成通知
+        uint64_t uringBufferStalls;    // 注册缓冲区用尽而等待的次数
+
+        // 分包大小与包头开销（按首次发送的分包统计，不含重传）
+        unsigned int packetSize;       // 当前生效的分包大小（UDP负载字节数）
+        double avgPacketsPerFrame;     // 每帧分包数（含校验包）
+        double headerOverheadPercent;  // 包头（协议头 + IPv4/UDP头）占线上字节的比例
+
+        // 路径MTU探测
+        bool pathMtu;
+        unsigned int pathMtuKernelMtu; // 内核记录的路由MTU
+        uint64_t pathMtuProbesSent;
+        uint64_t pathMtuProbesAcked;
+        uint64_t pathMtuProbesRejected; // 超出路由MTU被内核拒绝的探测
+        uint64_t pathMtuSearches;
+        bool pathMtuResponding;        // 接收端是否应答探测
+
+        // 帧内分包交织
+        bool interleaving;
+        uint64_t interleavedFrames;    // 分包跨多个FEC组交织发出的帧数
+    };
+
+    // 最近一帧的分包发出时刻（timing::nowNanos()），用于逐帧延迟追踪，0表示没有分包发出。
+    // 批量后端一次提交多个分包，firstNs是第一次提交返回的时刻
+    struct PacketTimes {
+        uint64_t firstNs = 0;
+        uint64_t lastNs = 0;
+    };
+
+    // NACK重传配置（需在initialize之前设置）
+    struct RetransmitConfig {
+        unsigned int feedbackPort = 0;    // 接收NACK的本地端口，0表示关闭重传
+        unsigned int ringPackets = 4096;  // 重传环可保存的分包数
+        unsigned int deadlineMs = 20;     // 帧发送后超过该时间不再重传
+    };
+
     struct UDPFrame {
         std::vector<uint8_t> data;
         uint32_t frameId;
         uint64_t timestamp;
     };
-    
+
+    // 分包标志
+    enum PacketFlags : uint8_t {
+        PACKET_FLAG_PARITY = 0x01,    // FEC校验包
+        PACKET_FLAG_KEYFRAME = 0x02,  // 所属帧为IDR关键帧
+        PACKET_FLAG_FEC_XOR = 0x04,   // 校验包为XOR编码（否则为Reed-Solomon）
+        PACKET_FLAG_RETRANSMIT = 0x08, // 应NACK重发的分包
+        PACKET_FLAG_INTERLEAVED = 0x10 // 所属帧按PacketInterleaver的顺序发出
+    };
+
     // UDP数据包结构
     struct PacketHeader {
-        uint32_t frameId;      // 全局唯一帧标识符
-        uint16_t packetId;     // 当前分包序号
-        uint16_t packetCount;  // 当前帧总包数
-        uint64_t timestamp;    // 微秒级时间戳
+        uint32_t frameId;        // 全局唯一帧标识符
+        uint16_t packetId;       // 当前分包序号（数据包0..packetCount-1，校验包排在其后）
+        uint16_t packetCount;    // 当前帧数据包总数
+        uint64_t timestamp;      // 发送端steady_clock微秒时间戳（采集时刻，未提供时为发送时刻）
+        uint32_t frameSize;      // 帧数据总字节数，用于确定恢复出的最后一包长度
+        uint8_t flags;           // PacketFlags
+        uint8_t fecGroup;        // FEC分组序号
+        uint8_t fecGroupSize;    // 每组数据包数（0表示未启用FEC）；第g组为[g * size, min((g + 1) * size, packetCount))
+        uint8_t fecGroupParity;  // 每组校验包数m；第g组第j个校验包的packetId为packetCount + g * m + j
+    };
+
+    // NACK消息：接收端发往发送端反馈端口，NackHeader之后紧跟rangeCount个NackRange
+    static const uint32_t kNackMagic = 0x4B43414E;  // "NACK"
+    static const unsigned int kMaxNackRanges = 64;
+
+    struct NackHeader {
+        uint32_t magic;
+        uint32_t frameId;
+        uint16_t rangeCount;
+        uint16_t reserved;
+    };
+
+    struct NackRange {
+        uint16_t firstPacketId;
+        uint16_t count;
+    };
+
+    // 接收报告：接收端按固定间隔发往同一反馈端口，供码率控制使用
+    static const uint32_t kReportMagic = 0x54505252;  // "RRPT"
+
+    struct ReceiverReport {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t intervalUs;        // 统计区间长度
+        uint32_t packetsExpected;   // 区间内应收的分包数（含校验包）
+        uint32_t packetsReceived;   // 区间内收到的分包数（不含重传）
+        uint32_t bytesReceived;     // 区间内收到的字节数（含重传）
+        int32_t delayGradient;      // 帧首包单向传输时间对到达时间的斜率（微秒/秒），为正表示排队增长
+        uint32_t highestFrameId;
+    };
+
+    // 时钟同步：接收端向同一反馈端口发送探测，发送端立即应答。应答经数据套接字的目的地址发回，
+    // 与媒体包走相同路径到达接收端的流套接字。时间戳均为各自的steady_clock微秒
+    static const uint32_t kClockProbeMagic = 0x514B4C43;  // "CLKQ"
+    static const uint32_t kClockReplyMagic = 0x524B4C43;  // "CLKR"
+
+    struct ClockProbe {
+        uint32_t magic;
+        uint32_t sequence;
+        uint64_t originateUs;       // t1：接收端发出探测的时刻
+    };
+
+    struct ClockReply {
+        uint32_t magic;
+        uint32_t sequence;
+        uint64_t originateUs;       // 原样带回t1
+        uint64_t receiveUs;         // t2：发送端收到探测的时刻
+        uint64_t transmitUs;        // t3：发送端发出应答的时刻
+    };
+
+    typedef std::function<void(const ReceiverReport&)> ReportHandler;
+
+private:
+    // 分包描述：包头和负载分别指向包头数组与编码帧缓冲区，发送时以两段iovec提交。
+    // 自定义协议的包头为PacketHeader，RTP模式下为RTP头及FU-A/STAP-A前缀
+    struct OutPacket {
+        const uint8_t* header;
+        uint32_t headerSize;
+        const uint8_t* payload;
+        uint32_t payloadSize;
     };
-    
+
+    // 每帧的包头和校验包负载，跨帧复用
+    struct FrameStorage {
+        std::vector<PacketHeader> headers;
+        std::vector<uint8_t> parity;
+        std::vector<uint8_t> rtpHeaders;
+    };
+
+    // MSG_ZEROCOPY在途帧：内核发出完成通知之前，帧数据、包头和校验包都不能释放或修改
+    struct ZeroCopySlot {
+        std::vector<uint8_t> data;
+        FrameStorage storage;
+        uint32_t firstNotification;  // 本帧第一个零拷贝通知序号
+        uint32_t notificationCount;  // 本帧提交的零拷贝消息数
+        uint32_t completedCount;     // 已完成的通知数
+        bool inFlight;
+    };
+
+    static const unsigned int kZeroCopySlots = 8;
+
+    SOCKET sock;
+    sockaddr_in serverAddr;
+
+    // 配置参数
+    std::string serverIP;
+    unsigned int serverPort;
+    unsigned int maxPacketSize;     // 分包大小上限，各缓冲区按此分配
+    SendBackend requestedBackend;
+    std::atomic<SendBackend> activeBackend;
+    bool zeroCopyRequested;
+    bool zeroCopyEnabled;
+    FecCodec::Config fecConfig;
+    RetransmitConfig retransmitConfig;
+    PacketPacer::Config pacingConfig;
+    RtpPacketizer::Config rtpConfig;
+    UringSender::Config uringConfig;
+    PathMtuDiscovery::Config pathMtuConfig;
+    unsigned int bitrateKbps;
+    unsigned int frameRate;
+    ReportHandler reportHandler;
+
+    std::atomic<bool> running;
+
+    // 码率控制下发的目标码率，由发送线程同步到节奏控制
+    std::atomic<unsigned int> targetBitrateKbps;
+
+    // 分包节奏控制（仅发送线程访问）
+    PacketPacer pacer;
+
+    // RTP分包（仅发送线程访问）
+    RtpPacketizer rtpPacketizer;
+    std::vector<RtpPacketizer::Packet> rtpPackets;
+    bool sdpWritten;
+
+    // io_uring后端（仅发送线程访问）
+    UringSender uring;
+
+    // 路径MTU探测：探测线程写入当前分包大小，发送线程在每帧分包前读取
+    PathMtuDiscovery pathMtu;
+    std::atomic<unsigned int> packetSize;
+    unsigned int rtpPacketSize;     // RTP分包器当前使用的分包大小（仅发送线程访问）
+
+    // NACK反馈：独立套接字和线程，重传从反馈套接字发出，不占用主发送路径
+    SOCKET feedbackSock;
+    std::thread feedbackThread;
+    RetransmitRing retransmitRing;
+
+    // 帧ID计数器（用于只传入数据的sendFrame重载）
+    uint32_t frameIdCounter;
+
+    // 每帧的包头、校验包和分包描述，跨帧复用，稳态下不发生分配
+    FrameStorage frameStorage;
+    std::vector<OutPacket> outPackets;
+
+    // 帧内分包交织：发送顺序和按该顺序排列的分包描述，跨帧复用（仅发送线程访问）
+    bool interleaving;
+    std::vector<uint16_t> sendOrder;
+    std::vector<OutPacket> interleavedPackets;
+
+    // 零拷贝在途帧环
+    ZeroCopySlot zeroCopySlots[kZeroCopySlots];
+    unsigned int zeroCopyNextSlot;
+    uint32_t zeroCopyNextNotification;
+
+    // 当前帧的发送标志和零拷贝消息计数
+    int frameSendFlags;
+    uint32_t frameZeroCopyMessages;
+
+    // 仅发送线程访问
+    PacketTimes lastPacketTimes;
+
+    // 统计信息（由发送线程写入，其他线程读取）
+    std::atomic<uint64_t> framesSent;
+    std::atomic<uint64_t> packetsSent;
+    std::atomic<uint64_t> bytesSent;
+    std::atomic<uint64_t> packetsDropped;
+    std::atomic<uint64_t> blockedSends;
+    std::atomic<uint64_t> sendErrors;
+    std::atomic<uint64_t> syscalls;
+    std::atomic<uint64_t> totalSendTimeUs;
+    std::atomic<uint32_t> lastFrameSyscalls;
+    std::atomic<uint32_t> lastFrameSendTimeUs;
+    std::atomic<bool> congested;
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> bytesCopied;
+    std::atomic<uint64_t> zeroCopySends;
+    std::atomic<uint64_t> zeroCopyCompletions;
+    std::atomic<uint64_t> zeroCopyDeferredCopies;
+    std::atomic<uint64_t> zeroCopySlotStalls;
+    std::atomic<uint64_t> keyframesSent;
+    std::atomic<uint64_t> fecParityPackets;
+    std::atomic<uint64_t> fecEncodeTimeUs;
+    std::atomic<uint64_t> nacksReceived;
+    std::atomic<uint64_t> retransmitRequests;
+    std::atomic<uint64_t> packetsRetransmitted;
+    std::atomic<uint64_t> retransmitExpired;
+    std::atomic<uint64_t> retransmitUnavailable;
+    std::atomic<uint64_t> reportsReceived;
+    std::atomic<uint64_t> clockProbesAnswered;
+    std::atomic<uint64_t> packetsBuilt;
+    std::atomic<uint64_t> headerBytes;
+    std::atomic<uint64_t> payloadBytes;
+    std::atomic<uint64_t> interleavedFrames;
+
+    SendBackend resolveBackend(SendBackend backend) const;
+    bool enableZeroCopy();
+
+    // 构建分包描述（不复制负载）并按需生成FEC校验包，返回分包总数，失败返回-1
+    int packetize(const uint8_t* data, size_t size, uint32_t frameId, uint64_t timestamp,
+                  FrameStorage& storage);
+    void encodeParity(unsigned int packetCount, unsigned int groupSize, unsigned int parityPerGroup,
+                      unsigned int payloadSize, FrameStorage& storage);
+    int packetizeRtp(const uint8_t* data, size_t size, uint64_t timestamp, FrameStorage& storage);
+    bool sendFrameData(const uint8_t* data, size_t size, uint32_t frameId, uint64_t timestamp);
+    bool sendFrameZeroCopy(std::vector<uint8_t>& data, uint32_t frameId, uint64_t timestamp);
+    bool transmitPackets(unsigned int packetCount);
+    void storeForRetransmit();
+    void interleavePackets(unsigned int packetCount);
+    bool startFeedback();
+    void feedbackThreadFunc();
+    void handleNack(const uint8_t* message, size_t size, uint8_t* packet);
+    void handleReport(const uint8_t* message, size_t size);
+    void handleClockProbe(const uint8_t* message, size_t size, uint64_t receiveUs);
+    void reapZeroCopyCompletions();
+
+    // 各后端实现，返回本次使用的系统调用数，失败返回-1。
+    // 发送缓冲区满时立即返回，sent为已交给内核的分包数，由调用方等待可写后重试
+    int sendPackets(const OutPacket* packets, unsigned int count, unsigned int& sent);
+    int sendPerPacket(const OutPacket* packets, unsigned int count, unsigned int& sent);
+#ifdef __linux__
+    int sendBatched(const OutPacket* packets, unsigned int count, unsigned int& sent);
+    int sendSegmented(const OutPacket* packets, unsigned int count, unsigned int& sent);
+    int sendUring(const OutPacket* packets, unsigned int count, unsigned int& sent);
+#endif
+
+public:
     UDPTransmitter();
     ~UDPTransmitter();
-    
-    bool initialize(const std::string& serverIP, unsigned int serverPort, unsigned int maxPacketSize = 1400);
+
+    bool initialize(const std::string& serverIP, unsigned int serverPort, unsigned int maxPacketSize = 1400,
+                    SendBackend backend = SendBackend::Auto, bool zeroCopy = false);
     bool sendFrame(const UDPFrame& frame);
     bool sendFrame(const std::vector<uint8_t>& data);
+    // 转移帧缓冲区所有权：启用MSG_ZEROCOPY时缓冲区会保留到内核完成发送，
+    // 返回时data中是一个已完成发送的旧缓冲区（保留容量，可直接复用）
+    bool sendFrame(std::vector<uint8_t>&& data);
+    // 同上，时间戳由调用方提供（如采集时刻，需为timing::nowMicros()时钟），接收端据此计算采集到接收的单向延迟
+    bool sendFrame(std::vector<uint8_t>&& data, uint64_t timestamp);
     void stop();
-    
+
+    // 配置前向纠错（可在发送线程启动前的任意时刻调用）
+    void setFecConfig(const FecCodec::Config& config) { fecConfig = config; }
+    const FecCodec::Config& getFecConfig() const { return fecConfig; }
+
+    void setRetransmitConfig(const RetransmitConfig& config) { retransmitConfig = config; }
+    const RetransmitConfig& getRetransmitConfig() const { return retransmitConfig; }
+
+    // 配置分包节奏控制（需在initialize之前设置）；码率和帧率同时决定发送速率下限和重试期限
+    void setPacingConfig(const PacketPacer::Config& config, unsigned int bitrateKbps, unsigned int frameRate) {
+        pacingConfig = config;
+        this->bitrateKbps = bitrateKbps;
+        this->frameRate = frameRate;
+    }
+
+    // 配置RTP输出（需在initialize之前设置）：启用后按RFC 6184分包，不再使用PacketHeader，FEC和NACK重传不可用
+    void setRtpConfig(const RtpPacketizer::Config& config) { rtpConfig = config; }
+    const RtpPacketizer::Config& getRtpConfig() const { return rtpConfig; }
+
+    // 配置io_uring后端（需在initialize之前设置）；与zeroCopy同时开启时使用注册缓冲区和SEND_ZC
+    void setUringConfig(const UringSender::Config& config) { uringConfig = config; }
+    const UringSender::Config& getUringConfig() const { return uringConfig; }
+
+    // 配置路径MTU探测（需在initialize之前设置）：开启后initialize的maxPacketSize只作为上限，
+    // 实际分包大小由探测结果决定并在运行中跟随路径变化
+    void setPathMtuConfig(const PathMtuDiscovery::Config& config) { pathMtuConfig = config; }
+    const PathMtuDiscovery::Config& getPathMtuConfig() const { return pathMtuConfig; }
+
+    // 配置帧内分包交织（需在initialize之前设置）：一帧的数据包和校验包在各FEC组之间轮流发出，
+    // 需要FEC，未开启节奏控制时一并开启，使分包分布在整个发送窗口内。RTP模式下不可用
+    void setInterleaving(bool enabled) { interleaving = enabled; }
+    bool isInterleaving() const { return interleaving; }
+
+    // 接收报告回调，在反馈线程中调用（需在initialize之前设置，且需开启反馈端口）
+    void setReportHandler(const ReportHandler& handler) { reportHandler = handler; }
+
+    // 运行时更新目标码率（码率控制调整编码器后调用），节奏控制的基础速率随之变化
+    void setTargetBitrate(unsigned int bitrateKbps) { targetBitrateKbps.store(bitrateKbps, std::memory_order_relaxed); }
+
+    TransmitStats getStats() const;
+
+    // 在调用sendFrame的线程上读取
+    const PacketTimes& getLastPacketTimes() const { return lastPacketTimes; }
+
     const std::string& getServerIP() const { return serverIP; }
     unsigned int getServerPort() const { return serverPort; }
     unsigned int getMaxPacketSize() const { return maxPacketSize; }
-};
\ No newline at end of file
+    unsigned int getPacketSize() const { return packetSize.load(std::memory_order_relaxed); }
+    // 上一帧发送时遇到发送缓冲区满，或发送耗时超过一个帧间隔（发送跟不上编码）
+    bool isCongested() const { return congested.load(std::memory_order_relaxed); }
+    SendBackend getSendBackend() const { return activeBackend.load(); }
+    bool isZeroCopyEnabled() const { return zeroCopyEnabled; }
+    bool isRtpEnabled() const { return rtpConfig.enabled; }
+
+    // RTP模式下描述本流的SDP，发送过关键帧后带参数集
+    std::string getSdp() const;
+
+    static const char* backendName(SendBackend backend);
+    static bool parseBackend(const std::string& name, SendBackend& backend);
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "NetCompat.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <atomic>
+
+#ifdef __linux__
+    #include <sys/uio.h>
+#endif
+
+using namespace std;
+
+// io_uring发送后端（Linux 5.6+，直接使用系统调用，不依赖liburing）：
+// 一组分包以链接的SQE提交，前一个分包失败（如发送缓冲区满）时后续分包被取消，
+// 调用方可从阻塞的分包精确重试。套接字注册为固定文件；开启注册缓冲区时
+// 分包复制到预注册的缓冲区并以SEND_ZC发出（Linux 6.0+），完成通知到达后缓冲区才复用。
+// SQPOLL模式下由内核线程轮询提交队列，稳态发送不进入内核
+class UringSender {
+public:
+    struct Config {
+        unsigned int entries = 256;         // 提交队列深度，也是单条链的最大分包数
+        bool sqPoll = false;                // 内核线程轮询提交队列
+        unsigned int sqPollIdleMs = 100;    // SQPOLL线程空闲该时间后休眠，需要时再唤醒
+        bool registeredBuffers = false;     // 分包复制到注册缓冲区并以SEND_ZC发送
+        unsigned int bufferSize = 1500;     // 每个注册缓冲区槽位的大小（不小于最大分包）
+    };
+
+    struct Stats {
+        uint64_t submitted;         // 提交的SQE数
+        uint64_t completed;         // 成功完成的发送
+        uint64_t failed;            // 以错误完成（含发送缓冲区满）的发送
+        uint64_t cancelled;         // 因链中前一个分包失败而取消的发送
+        uint64_t enters;            // io_uring_enter调用次数
+        uint64_t wakeups;           // 唤醒SQPOLL线程的次数
+        uint64_t notifications;     // SEND_ZC完成通知
+        uint64_t bufferStalls;      // 注册缓冲区用尽、等待完成通知的次数
+    };
+
+    UringSender();
+    ~UringSender();
+
+    // 当前内核是否支持io_uring（可能被seccomp或sysctl禁用）
+    static bool isSupported();
+
+    bool initialize(SOCKET sock, const sockaddr_in& destination, const Config& config);
+    void shutdown();
+
+    bool isInitialized() const { return ringFd >= 0; }
+    bool isSqPoll() const { return config.sqPoll; }
+    bool usesRegisteredBuffers() const { return config.registeredBuffers; }
+
+    // 单条链最多可包含的分包数
+    unsigned int getChainCapacity() const { return sqEntries; }
+
+    // 把一个分包加入当前链（包头和负载两段），队列已满时返回false
+    bool prepareSend(const uint8_t* header, uint32_t headerSize, const uint8_t* payload, uint32_t payloadSize);
+
+    // 提交当前链并收割其完成事件，返回本次使用的系统调用数，失败返回-1。
+    // sent为从链首起连续发送成功的分包数，bytes为其字节数；发送缓冲区满时blocked为true
+    int submitChain(unsigned int& sent, size_t& bytes, bool& blocked);
+
+    Stats getStats() const;
+
+private:
+    int ringFd;
+    Config config;
+    sockaddr_in destination;
+
+    // 提交队列和完成队列的共享内存
+    void* sqRing;
+    size_t sqRingSize;
+    void* cqRing;
+    size_t cqRingSize;
+    void* sqeMemory;
+    size_t sqeMemorySize;
+
+    unsigned int* sqHead;
+    unsigned int* sqTail;
+    unsigned int* sqMask;
+    unsigned int* sqFlags;
+    unsigned int* sqArray;
+    unsigned int sqEntries;
+    unsigned int* cqHead;
+    unsigned int* cqTail;
+    unsigned int* cqMask;
+    void* cqes;
+
+#ifdef __linux__
+    // 当前链：SENDMSG的消息头和iovec必须保持有效直到SQE被内核取走
+    std::vector<msghdr> messages;
+    std::vector<iovec> iovecs;
+#endif
+    std::vector<int> results;
+    unsigned int chainLength;
+    unsigned int chainTail;     // 本链起始时的提交队列尾
+
+    // 注册缓冲区：槽位循环使用，SEND_ZC的完成通知到达前不能复用
+    uint8_t* buffers;
+    size_t buffersSize;
+    unsigned int bufferSlots;
+    unsigned int nextSlot;
+    std::vector<uint8_t> slotBusy;
+    unsigned int busySlots;
+
+    // 统计信息（由发送线程写入，其他线程读取）
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> failed;
+    std::atomic<uint64_t> cancelled;
+    std::atomic<uint64_t> enters;
+    std::atomic<uint64_t> wakeups;
+    std::atomic<uint64_t> notifications;
+    std::atomic<uint64_t> bufferStalls;
+
+    int enter(unsigned int toSubmit, unsigned int minComplete, unsigned int flags);
+    unsigned int reapCompletions();
+    bool acquireSlot(unsigned int& slot);
+    bool probeSendZc();
+};
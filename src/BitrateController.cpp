@@ -0,0 +1,211 @@
+#include "BitrateController.h"
+#include "PreciseTimer.h"
+#include <algorithm>
+#include <cmath>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 增长时目标码率变化不足该比例则不通知编码器
+const double kPublishThreshold = 0.02;
+// 接收速率超过容量估计该倍数时认为链路已变宽，放弃旧的容量估计
+const double kCapacityResetRatio = 1.2;
+
+} // namespace
+
+BitrateController::BitrateController()
+    : frameRate(1),
+      bitrate(0.0),
+      receiveRate(0.0),
+      gradient(0.0),
+      accumulatedDelay(0.0),
+      smoothedDelay(0.0),
+      trendCount(0),
+      capacity(0.0),
+      overuseCount(0),
+      lastReportTimeUs(0),
+      lastSequence(0),
+      haveReport(false),
+      targetKbps(0),
+      maxFrameBytes(0),
+      reports(0),
+      overuses(0),
+      lossDecreases(0),
+      receiveRateKbps(0),
+      lossPermille(0),
+      gradientUsPerS(0),
+      state(State::Hold) {
+}
+
+void BitrateController::configure(const Config& config, unsigned int startBitrateKbps, unsigned int frameRate) {
+    this->config = config;
+    if (this->config.maxBitrateKbps == 0) {
+        this->config.maxBitrateKbps = startBitrateKbps;
+    }
+    this->config.minBitrateKbps = std::min(this->config.minBitrateKbps, this->config.maxBitrateKbps);
+    this->frameRate = std::max(frameRate, 1u);
+
+    bitrate = std::min(std::max(static_cast<double>(startBitrateKbps), static_cast<double>(this->config.minBitrateKbps)),
+                       static_cast<double>(this->config.maxBitrateKbps));
+    receiveRate = 0.0;
+    gradient = 0.0;
+    accumulatedDelay = 0.0;
+    smoothedDelay = 0.0;
+    trendCount = 0;
+    capacity = 0.0;
+    overuseCount = 0;
+    haveReport = false;
+
+    targetKbps.store(static_cast<uint32_t>(bitrate), std::memory_order_relaxed);
+    maxFrameBytes.store(static_cast<uint32_t>(bitrate * 1000.0 / 8.0 / this->frameRate * this->config.frameSizeFrames),
+                        std::memory_order_relaxed);
+    state.store(State::Hold, std::memory_order_relaxed);
+}
+
+void BitrateController::onReport(const UDPTransmitter::ReceiverReport& report) {
+    if (!config.enabled || report.intervalUs == 0 || report.packetsExpected == 0) {
+        return;
+    }
+    // 丢弃重复或乱序到达的旧报告
+    if (haveReport && static_cast<int32_t>(report.sequence - lastSequence) <= 0) {
+        return;
+    }
+
+    uint64_t now = timing::nowMicros();
+    double elapsed = haveReport ? (now - lastReportTimeUs) / 1000000.0 : report.intervalUs / 1000000.0;
+    elapsed = std::min(elapsed, 1.0);
+
+    double loss = 0.0;
+    if (report.packetsReceived < report.packetsExpected) {
+        loss = 1.0 - static_cast<double>(report.packetsReceived) / report.packetsExpected;
+    }
+    double rate = report.bytesReceived * 8000.0 / report.intervalUs;
+
+    receiveRate = haveReport ? receiveRate + (rate - receiveRate) / 4.0 : rate;
+
+    // 把各区间的时延梯度积分为排队时延变化，再对最近的窗口做线性拟合，单个报告的噪声不触发调整
+    accumulatedDelay += report.delayGradient * (report.intervalUs / 1000000.0);
+    smoothedDelay = haveReport ? smoothedDelay * 0.9 + accumulatedDelay * 0.1 : accumulatedDelay;
+    updateTrend(now / 1000000.0, smoothedDelay);
+    haveReport = true;
+    lastSequence = report.sequence;
+    lastReportTimeUs = now;
+
+    bool overuse = gradient > config.overuseGradientUsPerS;
+    bool underuse = gradient < -config.overuseGradientUsPerS;
+    overuseCount = overuse ? overuseCount + 1 : 0;
+
+    if (capacity > 0.0 && receiveRate > capacity * kCapacityResetRatio) {
+        capacity = 0.0;
+    }
+
+    State next;
+    if (overuseCount >= config.overuseReports) {
+        // 瓶颈队列持续增长：降到实际接收速率以下，让队列排空
+        capacity = receiveRate;
+        bitrate = std::min(bitrate, receiveRate * config.decreaseFactor);
+        overuseCount = 0;
+        overuses.fetch_add(1, std::memory_order_relaxed);
+        next = State::Decrease;
+    } else if (loss > config.lossHigh) {
+        bitrate *= 1.0 - 0.5 * loss;
+        lossDecreases.fetch_add(1, std::memory_order_relaxed);
+        next = State::Decrease;
+    } else if (overuse || underuse || loss >= config.lossLow) {
+        // 队列正在增长或排空，或有少量丢包：保持当前码率
+        next = State::Hold;
+    } else {
+        double increased;
+        if (capacity > 0.0 && bitrate > capacity * 0.9) {
+            increased = bitrate + config.additiveIncreaseKbps * elapsed;
+        } else {
+            increased = bitrate * std::pow(1.0 + config.increasePerSecond, elapsed);
+        }
+        // 编码器未用满码率（画面静止）时不继续抬高目标
+        bitrate = std::max(bitrate, std::min(increased, receiveRate * 1.5 + 100.0));
+        next = State::Increase;
+    }
+
+    bitrate = std::min(std::max(bitrate, static_cast<double>(config.minBitrateKbps)),
+                       static_cast<double>(config.maxBitrateKbps));
+    state.store(next, std::memory_order_relaxed);
+
+    reports.fetch_add(1, std::memory_order_relaxed);
+    receiveRateKbps.store(static_cast<uint32_t>(receiveRate), std::memory_order_relaxed);
+    lossPermille.store(static_cast<uint32_t>(loss * 1000.0), std::memory_order_relaxed);
+    gradientUsPerS.store(static_cast<int32_t>(gradient), std::memory_order_relaxed);
+
+    publish();
+}
+
+void BitrateController::updateTrend(double timeSeconds, double delayUs) {
+    if (trendCount == kTrendWindow) {
+        for (unsigned int i = 1; i < kTrendWindow; i++) {
+            trendTime[i - 1] = trendTime[i];
+            trendDelay[i - 1] = trendDelay[i];
+        }
+        trendCount--;
+    }
+    trendTime[trendCount] = timeSeconds;
+    trendDelay[trendCount] = delayUs;
+    trendCount++;
+
+    if (trendCount < 2) {
+        gradient = 0.0;
+        return;
+    }
+
+    double meanTime = 0.0;
+    double meanDelay = 0.0;
+    for (unsigned int i = 0; i < trendCount; i++) {
+        meanTime += trendTime[i];
+        meanDelay += trendDelay[i];
+    }
+    meanTime /= trendCount;
+    meanDelay /= trendCount;
+
+    double numerator = 0.0;
+    double denominator = 0.0;
+    for (unsigned int i = 0; i < trendCount; i++) {
+        numerator += (trendTime[i] - meanTime) * (trendDelay[i] - meanDelay);
+        denominator += (trendTime[i] - meanTime) * (trendTime[i] - meanTime);
+    }
+    gradient = denominator > 0.0 ? numerator / denominator : 0.0;
+}
+
+void BitrateController::publish() {
+    // 降低立即生效，增长累积到一定比例再通知编码器
+    double published = targetKbps.load(std::memory_order_relaxed);
+    if (bitrate > published && bitrate - published < published * kPublishThreshold) {
+        return;
+    }
+
+    targetKbps.store(static_cast<uint32_t>(bitrate), std::memory_order_relaxed);
+    maxFrameBytes.store(static_cast<uint32_t>(bitrate * 1000.0 / 8.0 / frameRate * config.frameSizeFrames),
+                        std::memory_order_relaxed);
+}
+
+BitrateController::Stats BitrateController::getStats() const {
+    Stats stats;
+    stats.reports = reports.load(std::memory_order_relaxed);
+    stats.overuses = overuses.load(std::memory_order_relaxed);
+    stats.lossDecreases = lossDecreases.load(std::memory_order_relaxed);
+    stats.targetBitrateKbps = targetKbps.load(std::memory_order_relaxed);
+    stats.maxFrameBytes = maxFrameBytes.load(std::memory_order_relaxed);
+    stats.receiveRateKbps = receiveRateKbps.load(std::memory_order_relaxed);
+    stats.lossRate = lossPermille.load(std::memory_order_relaxed) / 1000.0;
+    stats.delayGradientUsPerS = gradientUsPerS.load(std::memory_order_relaxed);
+    stats.state = state.load(std::memory_order_relaxed);
+    return stats;
+}
+
+const char* BitrateController::stateName(State state) {
+    switch (state) {
+        case State::Increase: return "increase";
+        case State::Decrease: return "decrease";
+        default: return "hold";
+    }
+}
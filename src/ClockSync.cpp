@@ -0,0 +1,126 @@
+#include "ClockSync.h"
+#include <cmath>
+#include <algorithm>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 往返时间不超过窗口最小值加该容差（或最小值的1/8）的样本才被采用
+const uint32_t kRttToleranceUs = 100;
+// 样本时间跨度不足该值时不估计漂移，只取偏差平均值
+const uint64_t kMinDriftSpanUs = 5000000;
+// 石英晶振的漂移通常在±100ppm以内，超出视为测量噪声
+const double kMaxDrift = 500e-6;
+// 偏差突变超过该值（如远端重启）时丢弃原有估计重新同步
+const double kStepUs = 50000.0;
+
+} // namespace
+
+ClockSync::ClockSync() {
+    reset();
+}
+
+void ClockSync::reset() {
+    windowCount = 0;
+    windowNext = 0;
+    samples = 0;
+    samplesUsed = 0;
+    lastRttUs = 0;
+    historyCount = 0;
+    historyNext = 0;
+    baseLocalUs = 0;
+    baseOffsetUs = 0.0;
+    drift = 0.0;
+}
+
+uint32_t ClockSync::windowMinRtt() const {
+    uint32_t result = UINT32_MAX;
+    for (unsigned int i = 0; i < windowCount; i++) {
+        result = std::min(result, rttWindow[i]);
+    }
+    return result;
+}
+
+void ClockSync::addSample(uint64_t t1, uint64_t t2, uint64_t t3, uint64_t t4) {
+    samples++;
+
+    int64_t rtt = (static_cast<int64_t>(t4) - static_cast<int64_t>(t1)) -
+                  (static_cast<int64_t>(t3) - static_cast<int64_t>(t2));
+    lastRttUs = static_cast<uint32_t>(std::min<int64_t>(std::max<int64_t>(rtt, 0), UINT32_MAX));
+    double offset = ((static_cast<double>(t2) - static_cast<double>(t1)) +
+                     (static_cast<double>(t3) - static_cast<double>(t4))) / 2.0;
+    uint64_t localUs = t1 + (t4 - t1) / 2;
+
+    rttWindow[windowNext] = lastRttUs;
+    windowNext = (windowNext + 1) % kWindow;
+    windowCount = std::min(windowCount + 1, kWindow);
+
+    uint32_t minRtt = windowMinRtt();
+    if (lastRttUs > minRtt + std::max(kRttToleranceUs, minRtt / 8)) {
+        return;
+    }
+
+    // 偏差突变时丢弃原有样本
+    if (samplesUsed > 0 && std::fabs(offset - static_cast<double>(offsetAt(localUs))) > kStepUs) {
+        samplesUsed = 0;
+        historyCount = 0;
+        historyNext = 0;
+    }
+
+    samplesUsed++;
+    historyLocalUs[historyNext] = localUs;
+    historyOffsetUs[historyNext] = offset;
+    historyNext = (historyNext + 1) % kHistory;
+    historyCount = std::min(historyCount + 1, kHistory);
+    fit();
+}
+
+void ClockSync::fit() {
+    // 以最新样本为原点，避免大数相减损失精度
+    unsigned int newest = (historyNext + kHistory - 1) % kHistory;
+    baseLocalUs = historyLocalUs[newest];
+
+    double sumX = 0.0;
+    double sumY = 0.0;
+    for (unsigned int i = 0; i < historyCount; i++) {
+        sumX += static_cast<double>(static_cast<int64_t>(historyLocalUs[i] - baseLocalUs));
+        sumY += historyOffsetUs[i];
+    }
+    double meanX = sumX / historyCount;
+    double meanY = sumY / historyCount;
+
+    double sumXX = 0.0;
+    double sumXY = 0.0;
+    for (unsigned int i = 0; i < historyCount; i++) {
+        double x = static_cast<double>(static_cast<int64_t>(historyLocalUs[i] - baseLocalUs)) - meanX;
+        sumXX += x * x;
+        sumXY += x * (historyOffsetUs[i] - meanY);
+    }
+
+    drift = 0.0;
+    uint64_t span = baseLocalUs - historyLocalUs[historyCount < kHistory ? 0 : historyNext];
+    if (historyCount >= kMinSamples && span >= kMinDriftSpanUs && sumXX > 0.0) {
+        drift = std::min(std::max(sumXY / sumXX, -kMaxDrift), kMaxDrift);
+    }
+    baseOffsetUs = meanY - drift * meanX;
+}
+
+int64_t ClockSync::offsetAt(uint64_t localUs) const {
+    double elapsed = static_cast<double>(static_cast<int64_t>(localUs - baseLocalUs));
+    return static_cast<int64_t>(std::llround(baseOffsetUs + drift * elapsed));
+}
+
+ClockSync::Stats ClockSync::getStats() const {
+    Stats result;
+    result.samples = samples;
+    result.samplesUsed = samplesUsed;
+    result.synchronized = isSynchronized();
+    result.offsetUs = samplesUsed > 0 ? static_cast<int64_t>(std::llround(baseOffsetUs)) : 0;
+    result.rttUs = lastRttUs;
+    result.minRttUs = windowCount > 0 ? windowMinRtt() : 0;
+    result.driftPpm = drift * 1e6;
+    return result;
+}
@@ -10,11 +10,50 @@ void ConfigManager::setDefaultConfig() {
     config.displayIndex = 0;
     config.outputWidth = 640;
     config.outputHeight = 640;
+    config.alignCapture = false;
+    config.capturePhaseUs = 500;
+    config.captureSpinUs = 0;
+    config.pipelineMode = "pipelined";
+    config.captureThread = "any";
+    config.encodeThread = "any";
+    config.sendThread = "any";
+    config.lockMemory = false;
+    config.schedProbe = 0;
     config.frameRate = 200;
     config.bitrate = 15000;
     config.serverIP = "127.0.0.1";
     config.serverPort = 5000;
     config.maxPacketSize = 1400;
+    config.pathMtu = false;
+    config.pathMtuIntervalMs = 60000;
+    config.sendBackend = "auto";
+    config.zeroCopy = false;
+    config.uringSqPoll = false;
+    config.uringEntries = 256;
+    config.fecMode = "none";
+    config.fecRedundancy = 0.1;
+    config.fecKeyframeRedundancy = 0.3;
+    config.fecGroupSize = 48;
+    config.nackPort = 0;
+    config.retransmitRing = 4096;
+    config.retransmitDeadlineMs = 20;
+    config.interleave = false;
+    config.pacing = false;
+    config.pacingFraction = 0.5;
+    config.pacingBurst = 4;
+    config.abr = false;
+    config.abrMinBitrate = 1000;
+    config.abrMaxBitrate = 0;
+    config.protocol = "custom";
+    config.rtpPayloadType = 96;
+    config.sdpFile = "";
+    config.transport = "udp";
+    config.shmName = "lls_stream";
+    config.shmSlots = 8;
+    config.shmSlotSize = 1 << 20;
+    config.frameDeadlineMs = 0;
+    config.congestionDrop = true;
+    config.metricsPort = 0;
 }
 
 bool ConfigManager::loadFromCommandLine(int argc, char* argv[]) {
@@ -35,6 +74,38 @@ bool ConfigManager::loadFromCommandLine(int argc, char* argv[]) {
                 if (i + 1 < argc) {
                     config.outputHeight = std::stoi(argv[++i]);
                 }
+            } else if (arg == "--align-capture") {
+                config.alignCapture = true;
+            } else if (arg == "--capture-phase-us") {
+                if (i + 1 < argc) {
+                    config.capturePhaseUs = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--capture-spin-us") {
+                if (i + 1 < argc) {
+                    config.captureSpinUs = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--pipeline") {
+                if (i + 1 < argc) {
+                    config.pipelineMode = argv[++i];
+                }
+            } else if (arg == "--capture-thread") {
+                if (i + 1 < argc) {
+                    config.captureThread = argv[++i];
+                }
+            } else if (arg == "--encode-thread") {
+                if (i + 1 < argc) {
+                    config.encodeThread = argv[++i];
+                }
+            } else if (arg == "--send-thread") {
+                if (i + 1 < argc) {
+                    config.sendThread = argv[++i];
+                }
+            } else if (arg == "--mlock") {
+                config.lockMemory = true;
+            } else if (arg == "--sched-probe") {
+                if (i + 1 < argc) {
+                    config.schedProbe = std::stoi(argv[++i]);
+                }
             }
             
             // 解析编码参数
@@ -59,7 +130,144 @@ bool ConfigManager::loadFromCommandLine(int argc, char* argv[]) {
                 }
             } else if (arg == "--max-packet-size") {
                 if (i + 1 < argc) {
-                    config.maxPacketSize = std::stoi(argv[++i]);
+                    std::string value = argv[++i];
+                    if (value == "auto") {
+                        // 由路径MTU探测决定，上限放宽到巨型帧
+                        config.pathMtu = true;
+                        config.maxPacketSize = kJumboPacketSize;
+                    } else {
+                        config.maxPacketSize = std::stoi(value);
+                    }
+                }
+            } else if (arg == "--pmtu") {
+                config.pathMtu = true;
+            } else if (arg == "--pmtu-interval-ms") {
+                if (i + 1 < argc) {
+                    config.pathMtuIntervalMs = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--send-backend") {
+                if (i + 1 < argc) {
+                    config.sendBackend = argv[++i];
+                }
+            } else if (arg == "--zero-copy") {
+                config.zeroCopy = true;
+            } else if (arg == "--uring-sqpoll") {
+                config.uringSqPoll = true;
+            } else if (arg == "--uring-entries") {
+                if (i + 1 < argc) {
+                    config.uringEntries = std::stoi(argv[++i]);
+                }
+            }
+            
+            // 解析前向纠错参数
+            else if (arg == "--fec") {
+                if (i + 1 < argc) {
+                    config.fecMode = argv[++i];
+                }
+            } else if (arg == "--fec-redundancy") {
+                if (i + 1 < argc) {
+                    config.fecRedundancy = std::stod(argv[++i]);
+                }
+            } else if (arg == "--fec-keyframe-redundancy") {
+                if (i + 1 < argc) {
+                    config.fecKeyframeRedundancy = std::stod(argv[++i]);
+                }
+            } else if (arg == "--fec-group-size") {
+                if (i + 1 < argc) {
+                    config.fecGroupSize = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--interleave") {
+                config.interleave = true;
+            }
+            
+            // 解析重传参数
+            else if (arg == "--nack-port") {
+                if (i + 1 < argc) {
+                    config.nackPort = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--retransmit-ring") {
+                if (i + 1 < argc) {
+                    config.retransmitRing = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--retransmit-deadline-ms") {
+                if (i + 1 < argc) {
+                    config.retransmitDeadlineMs = std::stoi(argv[++i]);
+                }
+            }
+            
+            // 解析节奏控制参数
+            else if (arg == "--pacing") {
+                config.pacing = true;
+            } else if (arg == "--pacing-fraction") {
+                if (i + 1 < argc) {
+                    config.pacingFraction = std::stod(argv[++i]);
+                }
+            } else if (arg == "--pacing-burst") {
+                if (i + 1 < argc) {
+                    config.pacingBurst = std::stoi(argv[++i]);
+                }
+            }
+            
+            // 解析自适应码率参数
+            else if (arg == "--abr") {
+                config.abr = true;
+            } else if (arg == "--abr-min-bitrate") {
+                if (i + 1 < argc) {
+                    config.abrMinBitrate = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--abr-max-bitrate") {
+                if (i + 1 < argc) {
+                    config.abrMaxBitrate = std::stoi(argv[++i]);
+                }
+            }
+            
+            // 解析RTP参数
+            else if (arg == "--protocol") {
+                if (i + 1 < argc) {
+                    config.protocol = argv[++i];
+                }
+            } else if (arg == "--rtp-payload-type") {
+                if (i + 1 < argc) {
+                    config.rtpPayloadType = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--sdp") {
+                if (i + 1 < argc) {
+                    config.sdpFile = argv[++i];
+                }
+            }
+            
+            // 解析共享内存传输参数
+            else if (arg == "--transport") {
+                if (i + 1 < argc) {
+                    config.transport = argv[++i];
+                }
+            } else if (arg == "--shm-name") {
+                if (i + 1 < argc) {
+                    config.shmName = argv[++i];
+                }
+            } else if (arg == "--shm-slots") {
+                if (i + 1 < argc) {
+                    config.shmSlots = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--shm-slot-size") {
+                if (i + 1 < argc) {
+                    config.shmSlotSize = std::stoi(argv[++i]);
+                }
+            }
+            
+            // 解析丢帧策略参数
+            else if (arg == "--frame-deadline-ms") {
+                if (i + 1 < argc) {
+                    config.frameDeadlineMs = std::stoi(argv[++i]);
+                }
+            } else if (arg == "--no-congestion-drop") {
+                config.congestionDrop = false;
+            }
+            
+            // 解析指标导出参数
+            else if (arg == "--metrics-port") {
+                if (i + 1 < argc) {
+                    config.metricsPort = std::stoi(argv[++i]);
                 }
             }
         }
@@ -0,0 +1,353 @@
+#include "FecCodec.h"
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+    #define FEC_X86 1
+    #include <immintrin.h>
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #endif
+#endif
+
+// GCC/Clang需要按函数开启指令集，MSVC可直接使用内建函数
+#if defined(__GNUC__)
+    #define FEC_TARGET(arch) __attribute__((target(arch)))
+#else
+    #define FEC_TARGET(arch)
+#endif
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// GF(256)运算表，本原多项式x^8 + x^4 + x^3 + x^2 + 1（0x11D）
+struct GaloisTables {
+    uint8_t exp[512];
+    uint8_t log[256];
+    uint8_t inv[256];
+    uint8_t mul[256][256];
+    // 半字节乘法表，供SIMD内核使用：low[c][x] = c * x，high[c][x] = c * (x << 4)
+    uint8_t low[256][16];
+    uint8_t high[256][16];
+
+    GaloisTables() {
+        unsigned int x = 1;
+        for (unsigned int i = 0; i < 255; i++) {
+            exp[i] = static_cast<uint8_t>(x);
+            log[x] = static_cast<uint8_t>(i);
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= 0x11D;
+            }
+        }
+        for (unsigned int i = 255; i < 512; i++) {
+            exp[i] = exp[i - 255];
+        }
+        log[0] = 0;
+
+        for (unsigned int a = 0; a < 256; a++) {
+            for (unsigned int b = 0; b < 256; b++) {
+                mul[a][b] = (a == 0 || b == 0) ? 0 : exp[log[a] + log[b]];
+            }
+            inv[a] = (a == 0) ? 0 : exp[255 - log[a]];
+            for (unsigned int n = 0; n < 16; n++) {
+                low[a][n] = mul[a][n];
+                high[a][n] = mul[a][n << 4];
+            }
+        }
+    }
+};
+
+const GaloisTables& tables() {
+    static const GaloisTables instance;
+    return instance;
+}
+
+void mulAddScalar(uint8_t* dst, const uint8_t* src, uint8_t c, size_t size) {
+    const uint8_t* row = tables().mul[c];
+    for (size_t i = 0; i < size; i++) {
+        dst[i] ^= row[src[i]];
+    }
+}
+
+#ifdef FEC_X86
+FEC_TARGET("ssse3")
+void mulAddSsse3(uint8_t* dst, const uint8_t* src, uint8_t c, size_t size) {
+    const GaloisTables& t = tables();
+    const __m128i lowTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.low[c]));
+    const __m128i highTable = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.high[c]));
+    const __m128i mask = _mm_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i lo = _mm_and_si128(in, mask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi64(in, 4), mask);
+        __m128i product = _mm_xor_si128(_mm_shuffle_epi8(lowTable, lo), _mm_shuffle_epi8(highTable, hi));
+        __m128i out = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(out, product));
+    }
+    mulAddScalar(dst + i, src + i, c, size - i);
+}
+
+FEC_TARGET("avx2")
+void mulAddAvx2(uint8_t* dst, const uint8_t* src, uint8_t c, size_t size) {
+    const GaloisTables& t = tables();
+    const __m256i lowTable = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.low[c])));
+    const __m256i highTable = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(t.high[c])));
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i lo = _mm256_and_si256(in, mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi64(in, 4), mask);
+        __m256i product = _mm256_xor_si256(_mm256_shuffle_epi8(lowTable, lo), _mm256_shuffle_epi8(highTable, hi));
+        __m256i out = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(out, product));
+    }
+    mulAddSsse3(dst + i, src + i, c, size - i);
+}
+
+bool cpuHasSsse3() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+typedef void (*MulAddFunc)(uint8_t*, const uint8_t*, uint8_t, size_t);
+
+struct Kernel {
+    MulAddFunc func;
+    const char* name;
+};
+
+const Kernel& kernel() {
+    static const Kernel selected = [] {
+#ifdef FEC_X86
+        if (cpuHasAvx2()) {
+            return Kernel{ mulAddAvx2, "avx2" };
+        }
+        if (cpuHasSsse3()) {
+            return Kernel{ mulAddSsse3, "ssse3" };
+        }
+#endif
+        return Kernel{ mulAddScalar, "scalar" };
+    }();
+    return selected;
+}
+
+void xorInto(uint8_t* dst, const uint8_t* src, size_t size) {
+    // 系数为1时退化为异或，交给编译器自动向量化
+    for (size_t i = 0; i < size; i++) {
+        dst[i] ^= src[i];
+    }
+}
+
+} // namespace
+
+void FecCodec::mulAdd(uint8_t* dst, const uint8_t* src, uint8_t c, size_t size) {
+    if (c == 0) {
+        return;
+    }
+    if (c == 1) {
+        xorInto(dst, src, size);
+        return;
+    }
+    kernel().func(dst, src, c, size);
+}
+
+const char* FecCodec::kernelName() {
+    return kernel().name;
+}
+
+uint8_t FecCodec::coefficient(Mode mode, unsigned int parityIndex, unsigned int dataIndex, unsigned int k) {
+    if (mode == Mode::Xor) {
+        return 1;
+    }
+    // Cauchy矩阵：x_j = k + j，y_i = i，元素为1 / (x_j + y_i)
+    return tables().inv[(k + parityIndex) ^ dataIndex];
+}
+
+void FecCodec::planGroups(const Config& config, unsigned int packetCount, bool keyframe,
+                          unsigned int& groupSize, unsigned int& parityPerGroup) {
+    groupSize = std::max(packetCount, 1u);
+    parityPerGroup = 0;
+
+    double ratio = keyframe ? config.keyframeRedundancy : config.redundancy;
+    if (config.mode == Mode::None || packetCount == 0 || ratio <= 0.0) {
+        return;
+    }
+
+    unsigned int maxGroup = std::min(std::max(config.maxGroupSize, 1u), kMaxShards - 1);
+
+    if (config.mode == Mode::Xor) {
+        // 每组1个校验包，组大小由冗余比例决定
+        unsigned int size = static_cast<unsigned int>(std::lround(1.0 / ratio));
+        groupSize = std::min(std::max(size, 1u), maxGroup);
+        parityPerGroup = 1;
+        return;
+    }
+
+    groupSize = std::min(packetCount, maxGroup);
+    unsigned int parity = static_cast<unsigned int>(std::ceil(groupSize * ratio));
+    parityPerGroup = std::min(std::max(parity, 1u), kMaxShards - groupSize);
+}
+
+void FecCodec::encode(Mode mode, const uint8_t* const* data, const uint32_t* dataSizes, unsigned int k,
+                      uint8_t* const* parity, unsigned int m, size_t symbolSize) {
+    for (unsigned int j = 0; j < m; j++) {
+        memset(parity[j], 0, symbolSize);
+        for (unsigned int i = 0; i < k; i++) {
+            // 数据包尾部视为0，不参与运算
+            size_t size = std::min<size_t>(dataSizes[i], symbolSize);
+            mulAdd(parity[j], data[i], coefficient(mode, j, i, k), size);
+        }
+    }
+}
+
+bool FecCodec::decode(Mode mode, uint8_t* const* shards, const bool* present, unsigned int k, unsigned int m,
+                      size_t symbolSize) {
+    if (k + m > kMaxShards) {
+        return false;
+    }
+
+    // 统计缺失的数据分片
+    unsigned int lost[kMaxShards];
+    unsigned int lostCount = 0;
+    for (unsigned int i = 0; i < k; i++) {
+        if (!present[i]) {
+            lost[lostCount++] = i;
+        }
+    }
+    if (lostCount == 0) {
+        return true;
+    }
+
+    // 选取与缺失数量相同的已收到校验分片
+    unsigned int rows[kMaxShards];
+    unsigned int rowCount = 0;
+    for (unsigned int j = 0; j < m && rowCount < lostCount; j++) {
+        if (present[k + j]) {
+            rows[rowCount++] = j;
+        }
+    }
+    if (rowCount < lostCount) {
+        return false;
+    }
+
+    // 校正子：从校验分片中消去已收到的数据分片，结果就地写回校验分片
+    for (unsigned int r = 0; r < rowCount; r++) {
+        uint8_t* syndrome = shards[k + rows[r]];
+        for (unsigned int i = 0; i < k; i++) {
+            if (present[i]) {
+                mulAdd(syndrome, shards[i], coefficient(mode, rows[r], i, k), symbolSize);
+            }
+        }
+    }
+
+    // 构造缺失列对应的子矩阵并在GF(256)上求逆（高斯-约当消元）
+    const GaloisTables& t = tables();
+    unsigned int n = lostCount;
+    std::vector<uint8_t> matrix(n * n);
+    std::vector<uint8_t> inverse(n * n, 0);
+    for (unsigned int r = 0; r < n; r++) {
+        for (unsigned int c = 0; c < n; c++) {
+            matrix[r * n + c] = coefficient(mode, rows[r], lost[c], k);
+        }
+        inverse[r * n + r] = 1;
+    }
+
+    for (unsigned int col = 0; col < n; col++) {
+        unsigned int pivot = col;
+        while (pivot < n && matrix[pivot * n + col] == 0) {
+            pivot++;
+        }
+        if (pivot == n) {
+            return false;
+        }
+        if (pivot != col) {
+            for (unsigned int c = 0; c < n; c++) {
+                std::swap(matrix[pivot * n + c], matrix[col * n + c]);
+                std::swap(inverse[pivot * n + c], inverse[col * n + c]);
+            }
+        }
+
+        uint8_t scale = t.inv[matrix[col * n + col]];
+        for (unsigned int c = 0; c < n; c++) {
+            matrix[col * n + c] = t.mul[scale][matrix[col * n + c]];
+            inverse[col * n + c] = t.mul[scale][inverse[col * n + c]];
+        }
+
+        for (unsigned int r = 0; r < n; r++) {
+            uint8_t factor = matrix[r * n + col];
+            if (r == col || factor == 0) {
+                continue;
+            }
+            for (unsigned int c = 0; c < n; c++) {
+                matrix[r * n + c] ^= t.mul[factor][matrix[col * n + c]];
+                inverse[r * n + c] ^= t.mul[factor][inverse[col * n + c]];
+            }
+        }
+    }
+
+    // 缺失数据 = 逆矩阵 × 校正子
+    for (unsigned int a = 0; a < n; a++) {
+        uint8_t* out = shards[lost[a]];
+        memset(out, 0, symbolSize);
+        for (unsigned int r = 0; r < n; r++) {
+            mulAdd(out, shards[k + rows[r]], inverse[a * n + r], symbolSize);
+        }
+    }
+
+    return true;
+}
+
+const char* FecCodec::modeName(Mode mode) {
+    switch (mode) {
+        case Mode::None: return "none";
+        case Mode::Xor: return "xor";
+        case Mode::ReedSolomon: return "rs";
+    }
+    return "unknown";
+}
+
+bool FecCodec::parseMode(const std::string& name, Mode& mode) {
+    if (name == "none") {
+        mode = Mode::None;
+    } else if (name == "xor") {
+        mode = Mode::Xor;
+    } else if (name == "rs") {
+        mode = Mode::ReedSolomon;
+    } else {
+        return false;
+    }
+    return true;
+}
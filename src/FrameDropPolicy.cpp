@@ -0,0 +1,222 @@
+#include "FrameDropPolicy.h"
+#include "H264Utils.h"
+#include <iostream>
+
+FrameDropPolicy::FrameDropPolicy() {
+    reset();
+}
+
+void FrameDropPolicy::configure(const Config& cfg) {
+    config = cfg;
+    reset();
+
+    if (config.deadlineMs > 0) {
+        std::cout << "Frame deadline: " << config.deadlineMs << " ms after capture" << std::endl;
+    }
+}
+
+void FrameDropPolicy::reset() {
+    {
+        std::lock_guard<std::mutex> lock(chainMutex);
+        lastIdrSequence = 0;
+        firstLostSequence = 0;
+    }
+    nextSequence = 1;
+    keyframeRequested = false;
+    framesAdmitted = 0;
+    framesLate = 0;
+    keyframeRequests = 0;
+    for (unsigned int stage = 0; stage < kStages; stage++) {
+        for (unsigned int reason = 0; reason < kReasons; reason++) {
+            dropped[stage][reason] = 0;
+        }
+    }
+    for (unsigned int priority = 0; priority < kPriorities; priority++) {
+        droppedByPriority[priority] = 0;
+    }
+}
+
+FrameDropPolicy::Priority FrameDropPolicy::classify(const uint8_t* data, size_t size) {
+    size_t pos = h264::findNalStart(data, size, 0);
+    while (pos < size) {
+        uint8_t type = h264::nalType(data[pos]);
+        if (type == h264::NAL_IDR) {
+            return Priority::Idr;
+        }
+        if (type == h264::NAL_SLICE) {
+            return h264::nalRefIdc(data[pos]) != 0 ? Priority::Reference : Priority::NonReference;
+        }
+        pos = h264::findNalStart(data, size, pos + 1);
+    }
+    return Priority::Reference;
+}
+
+FrameDropPolicy::FrameInfo FrameDropPolicy::makeFrame(uint64_t captureUs) {
+    FrameInfo frame;
+    frame.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    frame.captureUs = captureUs;
+    frame.deadlineUs = config.deadlineMs > 0 ? captureUs + static_cast<uint64_t>(config.deadlineMs) * 1000 : 0;
+    return frame;
+}
+
+bool FrameDropPolicy::isLate(const FrameInfo& frame, uint64_t nowUs) {
+    return frame.deadlineUs != 0 && nowUs > frame.deadlineUs;
+}
+
+bool FrameDropPolicy::expire(Stage stage, const FrameInfo& frame, uint64_t nowUs) {
+    if (!isLate(frame, nowUs)) {
+        return false;
+    }
+    // 编码前丢弃没有代价；编码后丢弃参考帧要靠一个IDR恢复，IDR本身又会使后续帧晚到，
+    // 代价大于晚到一帧，因此编码后只丢弃非参考帧
+    if (stage != Stage::Capture && frame.priority != Priority::NonReference) {
+        return false;
+    }
+    drop(stage, Reason::Expired, frame);
+    return true;
+}
+
+bool FrameDropPolicy::admit(Stage stage, const FrameInfo& frame, uint64_t nowUs, bool congested) {
+    if (referenceLost(frame)) {
+        drop(stage, Reason::ReferenceLost, frame);
+        return false;
+    }
+    if (expire(stage, frame, nowUs)) {
+        return false;
+    }
+    // 拥塞时只丢弃不被参考的帧，参考帧的丢弃代价是一个IDR
+    if (congested && config.congestionDrop && frame.priority == Priority::NonReference) {
+        drop(stage, Reason::Congestion, frame);
+        return false;
+    }
+
+    framesAdmitted.fetch_add(1, std::memory_order_relaxed);
+    if (isLate(frame, nowUs)) {
+        framesLate.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool FrameDropPolicy::referenceLost(const FrameInfo& frame) {
+    std::lock_guard<std::mutex> lock(chainMutex);
+    if (frame.priority == Priority::Idr) {
+        // IDR之后的帧不再参考此前的帧
+        if (frame.sequence > lastIdrSequence) {
+            lastIdrSequence = frame.sequence;
+            if (firstLostSequence != 0 && firstLostSequence < frame.sequence) {
+                firstLostSequence = 0;
+            }
+        }
+        return false;
+    }
+    return firstLostSequence != 0 && frame.sequence > firstLostSequence;
+}
+
+void FrameDropPolicy::drop(Stage stage, Reason reason, const FrameInfo& frame) {
+    count(stage, reason, frame.priority);
+
+    // 采集阶段的帧尚未编码，不影响参考链
+    if (stage == Stage::Capture || frame.priority != Priority::Reference) {
+        return;
+    }
+
+    // 参考帧丢失：记录自上一个IDR以来第一个丢失的参考帧，只在参考链刚中断时请求IDR
+    std::lock_guard<std::mutex> lock(chainMutex);
+    if (frame.sequence <= lastIdrSequence) {
+        return;
+    }
+    if (firstLostSequence == 0 || frame.sequence < firstLostSequence) {
+        bool broken = firstLostSequence != 0;
+        firstLostSequence = frame.sequence;
+        if (!broken) {
+            keyframeRequested.store(true, std::memory_order_relaxed);
+            keyframeRequests.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void FrameDropPolicy::count(Stage stage, Reason reason, Priority priority) {
+    dropped[static_cast<unsigned int>(stage)][static_cast<unsigned int>(reason)].fetch_add(1, std::memory_order_relaxed);
+    if (stage == Stage::Capture) {
+        return;
+    }
+    droppedByPriority[static_cast<unsigned int>(priority)].fetch_add(1, std::memory_order_relaxed);
+}
+
+FrameDropPolicy::Stats FrameDropPolicy::getStats() const {
+    Stats stats;
+    stats.framesAdmitted = framesAdmitted.load(std::memory_order_relaxed);
+    stats.framesLate = framesLate.load(std::memory_order_relaxed);
+    for (unsigned int stage = 0; stage < kStages; stage++) {
+        for (unsigned int reason = 0; reason < kReasons; reason++) {
+            stats.dropped[stage][reason] = dropped[stage][reason].load(std::memory_order_relaxed);
+        }
+    }
+    for (unsigned int priority = 0; priority < kPriorities; priority++) {
+        stats.droppedByPriority[priority] = droppedByPriority[priority].load(std::memory_order_relaxed);
+    }
+    stats.keyframeRequests = keyframeRequests.load(std::memory_order_relaxed);
+    return stats;
+}
+
+uint64_t FrameDropPolicy::Stats::total() const {
+    uint64_t sum = 0;
+    for (unsigned int stage = 0; stage < kStages; stage++) {
+        sum += byStage(static_cast<Stage>(stage));
+    }
+    return sum;
+}
+
+uint64_t FrameDropPolicy::Stats::byStage(Stage stage) const {
+    uint64_t sum = 0;
+    for (unsigned int reason = 0; reason < kReasons; reason++) {
+        sum += dropped[static_cast<unsigned int>(stage)][reason];
+    }
+    return sum;
+}
+
+uint64_t FrameDropPolicy::Stats::byReason(Reason reason) const {
+    uint64_t sum = 0;
+    for (unsigned int stage = 0; stage < kStages; stage++) {
+        sum += dropped[stage][static_cast<unsigned int>(reason)];
+    }
+    return sum;
+}
+
+const char* FrameDropPolicy::priorityName(Priority priority) {
+    switch (priority) {
+        case Priority::NonReference:
+            return "non-reference";
+        case Priority::Reference:
+            return "reference";
+        case Priority::Idr:
+            return "IDR";
+    }
+    return "unknown";
+}
+
+const char* FrameDropPolicy::stageName(Stage stage) {
+    switch (stage) {
+        case Stage::Capture:
+            return "capture";
+        case Stage::Encode:
+            return "encode";
+        case Stage::Send:
+            return "send";
+    }
+    return "unknown";
+}
+
+const char* FrameDropPolicy::reasonName(Reason reason) {
+    switch (reason) {
+        case Reason::QueueFull:
+            return "queue full";
+        case Reason::Expired:
+            return "expired";
+        case Reason::Congestion:
+            return "congestion";
+        case Reason::ReferenceLost:
+            return "reference lost";
+    }
+    return "unknown";
+}
@@ -1,18 +1,60 @@
 #include "LiveStreamer.h"
+#include "PreciseTimer.h"
 #include <iostream>
 #include <chrono>
+#include <cctype>
+
+// 下游线程等待新帧的最长时间，超时后重新检查running
+static const unsigned int kQueueWaitUs = 10000;
+
+// 指标标签值：名称中的空格换成下划线并转为小写，如"queue full" -> "queue_full"
+static std::string metricLabel(const char* key, const char* value) {
+    std::string label = key;
+    label += "=\"";
+    for (const char* c = value; *c; c++) {
+        label += *c == ' ' ? '_' : static_cast<char>(tolower(static_cast<unsigned char>(*c)));
+    }
+    label += '"';
+    return label;
+}
 
 LiveStreamer::LiveStreamer()
-    : running(false) {
+    : framesCaptured(0),
+      framesEncoded(0),
+      framesSent(0),
+      lastScrapeFrames(),
+      lastScrapeUs(0),
+      appliedBitrateKbps(0),
+      captureQueue(1, SpscRing<CapturedFrame>::Overflow::OverwriteOldest),
+      encodeQueue(1, SpscRing<EncodedFrame>::Overflow::OverwriteOldest),
+      running(false) {
     // 默认配置
     config.displayIndex = 0;
     config.outputWidth = 640;
     config.outputHeight = 640;
+    config.captureClock = FrameClock::Config();
+    config.alignCapture = false;
+    config.pipelineMode = PipelineMode::Pipelined;
+    config.threads = ThreadTuning::Config();
     config.frameRate = 200;
     config.bitrate = 15000;
     config.serverIP = "127.0.0.1";
     config.serverPort = 5000;
     config.maxPacketSize = 1400;
+    config.pathMtu = PathMtuDiscovery::Config();
+    config.sendBackend = UDPTransmitter::SendBackend::Auto;
+    config.zeroCopy = false;
+    config.uring = UringSender::Config();
+    config.fec = FecCodec::Config();
+    config.interleave = false;
+    config.retransmit = UDPTransmitter::RetransmitConfig();
+    config.pacing = PacketPacer::Config();
+    config.abr = BitrateController::Config();
+    config.rtp = RtpPacketizer::Config();
+    config.sharedMemory = false;
+    config.shm = SharedMemoryWriter::Config();
+    config.frameDrop = FrameDropPolicy::Config();
+    config.metricsPort = 0;
 }
 
 LiveStreamer::~LiveStreamer() {
@@ -21,6 +63,7 @@ LiveStreamer::~LiveStreamer() {
 
 bool LiveStreamer::initialize(const Config& config) {
     this->config = config;
+    dropPolicy.configure(config.frameDrop);
     
     // 初始化屏幕采集
     if (!screenCapture.initialize(config.displayIndex, config.outputWidth, config.outputHeight)) {
@@ -42,8 +85,39 @@ bool LiveStreamer::initialize(const Config& config) {
         return false;
     }
     
+    // 共享内存传输：编码帧直接写入共享内存，不初始化UDP发送和码率控制
+    if (config.sharedMemory) {
+        if (!shmWriter.create(config.shm)) {
+            std::cerr << "Failed to initialize shared memory transport" << std::endl;
+            return false;
+        }
+        return true;
+    }
+    
     // 初始化UDP传输
-    if (!transmitter.initialize(config.serverIP, config.serverPort, config.maxPacketSize)) {
+    transmitter.setFecConfig(config.fec);
+    transmitter.setInterleaving(config.interleave);
+    transmitter.setRetransmitConfig(config.retransmit);
+    transmitter.setPacingConfig(config.pacing, config.bitrate, config.frameRate);
+    transmitter.setRtpConfig(config.rtp);
+    transmitter.setUringConfig(config.uring);
+    transmitter.setPathMtuConfig(config.pathMtu);
+    
+    // 自适应码率：接收报告经反馈线程送入码率控制，编码线程按目标重配置编码器
+    BitrateController::Config abr = config.abr;
+    if (abr.enabled && config.retransmit.feedbackPort == 0) {
+        std::cerr << "Warning: Adaptive bitrate requires a feedback port, disabled" << std::endl;
+        abr.enabled = false;
+    }
+    bitrateController.configure(abr, config.bitrate, config.frameRate);
+    appliedBitrateKbps = bitrateController.getTargetBitrate();
+    if (abr.enabled) {
+        transmitter.setReportHandler([this](const UDPTransmitter::ReceiverReport& report) {
+            bitrateController.onReport(report);
+        });
+    }
+    if (!transmitter.initialize(config.serverIP, config.serverPort, config.maxPacketSize, config.sendBackend,
+                                 config.zeroCopy)) {
         std::cerr << "Failed to initialize UDP transmitter" << std::endl;
         return false;
     }
@@ -57,6 +131,34 @@ void LiveStreamer::start() {
     }
     
     running = true;
+    latency.reset();
+    framesCaptured = 0;
+    framesEncoded = 0;
+    framesSent = 0;
+    lastScrapeFrames = FrameCounts();
+    lastScrapeUs = timing::nowMicros();
+    
+    // 指标导出只读取原子计数和无锁直方图，端口不可用时只输出警告
+    if (config.metricsPort != 0 && !metricsServer.start(config.metricsPort, [this]() { return formatMetrics(); })) {
+        std::cerr << "Warning: Metrics export disabled" << std::endl;
+    }
+    
+    // 线程启动前检查调度设置；run-to-completion下只有采集线程
+    ThreadTuning::Config threads = config.threads;
+    if (config.pipelineMode == PipelineMode::RunToCompletion) {
+        threads.stage(ThreadTuning::Stage::Encode) = ThreadTuning::StageConfig();
+        threads.stage(ThreadTuning::Stage::Send) = ThreadTuning::StageConfig();
+    }
+    threadTuning.configure(threads);
+    for (const auto& warning : threadTuning.getWarnings()) {
+        std::cerr << "Warning: " << warning << std::endl;
+    }
+    
+    // run-to-completion：一个线程依次完成采集、编码、分包和发送，没有线程间交接
+    if (config.pipelineMode == PipelineMode::RunToCompletion) {
+        captureThread = std::thread(&LiveStreamer::runToCompletionThreadFunc, this);
+        return;
+    }
     
     // 启动采集线程
     captureThread = std::thread(&LiveStreamer::captureThreadFunc, this);
@@ -64,13 +166,8 @@ void LiveStreamer::start() {
     // 启动编码线程
     encodeThread = std::thread(&LiveStreamer::encodeThreadFunc, this);
     
-    // 启动传输线程
+    // 启动传输线程（线程优先级和CPU绑定由各线程启动时设置）
     transmitThread = std::thread(&LiveStreamer::transmitThreadFunc, this);
-    
-    // 设置线程优先级
-    SetThreadPriority(captureThread.native_handle(), THREAD_PRIORITY_HIGHEST);
-    SetThreadPriority(encodeThread.native_handle(), THREAD_PRIORITY_HIGHEST);
-    SetThreadPriority(transmitThread.native_handle(), THREAD_PRIORITY_ABOVE_NORMAL);
 }
 
 void LiveStreamer::stop() {
@@ -80,6 +177,10 @@ void LiveStreamer::stop() {
     
     running = false;
     
+    // 唤醒阻塞等待新帧的线程
+    captureQueue.notify();
+    encodeQueue.notify();
+    
     // 等待线程结束
     if (captureThread.joinable()) {
         captureThread.join();
@@ -90,61 +191,306 @@ void LiveStreamer::stop() {
     if (transmitThread.joinable()) {
         transmitThread.join();
     }
+    metricsServer.stop();
     
     // 停止模块
     screenCapture.stop();
     encoder.stop();
     transmitter.stop();
+    shmWriter.close();
+}
+
+void LiveStreamer::startCaptureClock() {
+    // 节拍从线程完成调度设置（包括调度延迟的测量）之后开始计，测量期间不算错过的节拍
+    FrameClock::Config clockConfig = config.captureClock;
+    clockConfig.frameRate = config.frameRate;
+    captureClock.configure(clockConfig);
+}
+
+bool LiveStreamer::captureNextFrame(CapturedFrame& frame) {
+    // 控制采集频率：等到下一个节拍的绝对截止时刻
+    captureClock.waitNextTick();
+    
+    if (!screenCapture.captureFrame(frame.capture)) {
+        return false;
+    }
+    frame.times = PipelineLatency::FrameTimes();
+    frame.times.set(PipelineLatency::Point::Acquire, frame.capture.acquireNs);
+    frame.times.set(PipelineLatency::Point::CropCopy, frame.capture.copyNs);
+    
+    // 新呈现的画面带有呈现时刻，节拍向它对齐，使每次采集都紧跟在呈现之后
+    if (config.alignCapture && frame.capture.presentTime != 0) {
+        captureClock.alignTo(frame.capture.presentTime);
+    }
+    framesCaptured.fetch_add(1, std::memory_order_relaxed);
+    return true;
 }
 
 void LiveStreamer::captureThreadFunc() {
+    threadTuning.applyToCurrentThread(ThreadTuning::Stage::Capture, "capture");
+    startCaptureClock();
     while (running) {
-        ScreenCapture::CaptureFrame frame;
-        if (screenCapture.captureFrame(frame)) {
-            // 检查队列大小，避免缓冲过多
-            if (!captureQueue.empty()) {
-                // 丢弃旧帧，保持实时性
-                ScreenCapture::CaptureFrame oldFrame;
-                captureQueue.pop(oldFrame);
+        CapturedFrame frame;
+        if (captureNextFrame(frame)) {
+            // 编码线程还没取走上一帧时挤掉它，保持实时性
+            CapturedFrame oldFrame;
+            frame.times.mark(PipelineLatency::Point::CapturePublish);
+            if (captureQueue.pushOverwrite(std::move(frame), oldFrame)) {
+                dropPolicy.drop(FrameDropPolicy::Stage::Capture, FrameDropPolicy::Reason::QueueFull,
+                                dropPolicy.makeFrame(oldFrame.capture.timestamp));
             }
-            captureQueue.push(frame);
         }
-        
-        // 控制采集频率
-        std::this_thread::sleep_for(std::chrono::microseconds(1000000 / config.frameRate));
     }
 }
 
 void LiveStreamer::encodeThreadFunc() {
+    threadTuning.applyToCurrentThread(ThreadTuning::Stage::Encode, "encode");
     while (running) {
-        ScreenCapture::CaptureFrame captureFrame;
-        if (captureQueue.pop(captureFrame)) {
-            std::vector<uint8_t> encodedData;
-            if (encoder.encode(captureFrame.texture, encodedData)) {
-                // 检查队列大小，避免缓冲过多
-                if (!encodeQueue.empty()) {
-                    // 丢弃旧帧，保持实时性
-                    std::vector<uint8_t> oldData;
-                    encodeQueue.pop(oldData);
-                }
-                encodeQueue.push(encodedData);
+        CapturedFrame capturedFrame;
+        if (captureQueue.popWait(capturedFrame, kQueueWaitUs)) {
+            EncodedFrame encodedFrame;
+            if (encodeCapturedFrame(capturedFrame, encodedFrame)) {
+                enqueueEncodedFrame(std::move(encodedFrame));
             }
         }
-        
-        // 短暂睡眠，避免CPU占用过高
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
 }
 
 void LiveStreamer::transmitThreadFunc() {
+    threadTuning.applyToCurrentThread(ThreadTuning::Stage::Send, "transmit");
     while (running) {
-        std::vector<uint8_t> encodedData;
-        if (encodeQueue.pop(encodedData)) {
-            // 直接发送H.264裸流
-            transmitter.sendFrame(encodedData);
+        EncodedFrame encodedFrame;
+        if (encodeQueue.popWait(encodedFrame, kQueueWaitUs)) {
+            sendEncodedFrame(encodedFrame);
         }
-        
-        // 短暂睡眠，避免CPU占用过高
-        std::this_thread::sleep_for(std::chrono::microseconds(100));
     }
 }
+
+void LiveStreamer::runToCompletionThreadFunc() {
+    threadTuning.applyToCurrentThread(ThreadTuning::Stage::Capture, "run-to-completion");
+    startCaptureClock();
+    while (running) {
+        CapturedFrame capturedFrame;
+        EncodedFrame encodedFrame;
+        if (captureNextFrame(capturedFrame) && encodeCapturedFrame(capturedFrame, encodedFrame)) {
+            sendEncodedFrame(encodedFrame);
+        }
+    }
+}
+
+bool LiveStreamer::encodeCapturedFrame(const CapturedFrame& capturedFrame, EncodedFrame& encodedFrame) {
+    const ScreenCapture::CaptureFrame& captureFrame = capturedFrame.capture;
+    encodedFrame.times = capturedFrame.times;
+    encodedFrame.times.mark(PipelineLatency::Point::EncodeTake);
+    
+    // 采集→编码：排队期间已过截止时刻的帧不再编码
+    FrameDropPolicy::FrameInfo info = dropPolicy.makeFrame(captureFrame.timestamp);
+    if (dropPolicy.expire(FrameDropPolicy::Stage::Capture, info, timing::nowMicros())) {
+        return false;
+    }
+    applyTargetBitrate();
+    
+    // 发送端丢弃了参考帧时下一帧编码为IDR
+    if (dropPolicy.takeKeyframeRequest()) {
+        encoder.requestKeyframe();
+    }
+    
+    if (!encoder.encode(captureFrame.texture, encodedFrame.data)) {
+        return false;
+    }
+    encodedFrame.times.set(PipelineLatency::Point::EncodeSubmit, encoder.getLastTiming().submitNs);
+    encodedFrame.times.set(PipelineLatency::Point::EncodeComplete, encoder.getLastTiming().completeNs);
+    framesEncoded.fetch_add(1, std::memory_order_relaxed);
+    info.priority = FrameDropPolicy::classify(encodedFrame.data.data(), encodedFrame.data.size());
+    encodedFrame.info = info;
+    
+    // 编码→发送：编码耗时可能使帧过期
+    return !dropPolicy.expire(FrameDropPolicy::Stage::Encode, info, timing::nowMicros());
+}
+
+void LiveStreamer::sendEncodedFrame(EncodedFrame& encodedFrame) {
+    // 发送前：参考链已断开、已过截止时刻或拥塞时的低优先级帧不再发送
+    encodedFrame.times.mark(PipelineLatency::Point::SendTake);
+    if (!dropPolicy.admit(FrameDropPolicy::Stage::Send, encodedFrame.info, timing::nowMicros(),
+                          isCongested())) {
+        return;
+    }
+    
+    if (config.sharedMemory) {
+        // 共享内存一次写入整帧，第一个和最后一个分包的时刻相同
+        shmWriter.write(encodedFrame.data.data(), encodedFrame.data.size());
+        uint64_t writtenNs = timing::nowNanos();
+        encodedFrame.times.set(PipelineLatency::Point::FirstPacket, writtenNs);
+        encodedFrame.times.set(PipelineLatency::Point::LastPacket, writtenNs);
+    } else {
+        // 直接发送H.264裸流，转移缓冲区所有权以便零拷贝发送；
+        // 包头携带采集时刻，接收端同步时钟后可得到采集到接收的单向延迟
+        transmitter.sendFrame(std::move(encodedFrame.data), encodedFrame.info.captureUs);
+        encodedFrame.times.set(PipelineLatency::Point::FirstPacket, transmitter.getLastPacketTimes().firstNs);
+        encodedFrame.times.set(PipelineLatency::Point::LastPacket, transmitter.getLastPacketTimes().lastNs);
+    }
+    latency.record(encodedFrame.times);
+    framesSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LiveStreamer::applyTargetBitrate() {
+    if (!bitrateController.isEnabled()) {
+        return;
+    }
+    
+    uint32_t target = bitrateController.getTargetBitrate();
+    if (target == appliedBitrateKbps) {
+        return;
+    }
+    
+    if (encoder.reconfigure(target, bitrateController.getMaxFrameBytes())) {
+        transmitter.setTargetBitrate(target);
+    }
+    // 失败时不反复重试，等待下一个目标
+    appliedBitrateKbps = target;
+}
+
+void LiveStreamer::enqueueEncodedFrame(EncodedFrame&& frame) {
+    frame.times.mark(PipelineLatency::Point::EncodePublish);
+    // 发送队列最多保留一帧：队列中已有帧时挤掉两者中优先级较低的一帧，同优先级时挤掉较旧的。
+    // 队列为OverwriteOldest模式，生产者可以先取出排队的帧再比较
+    EncodedFrame queued;
+    EncodedFrame evicted;
+    if (encodeQueue.pop(queued)) {
+        FrameDropPolicy::FrameInfo candidates[2] = {queued.info, frame.info};
+        size_t victim = FrameDropPolicy::selectVictim(candidates, candidates + 2,
+                                                      [](const FrameDropPolicy::FrameInfo& info) { return info; });
+        if (victim == 1) {
+            dropPolicy.drop(FrameDropPolicy::Stage::Encode, FrameDropPolicy::Reason::QueueFull, frame.info);
+            encodeQueue.pushOverwrite(std::move(queued), evicted);
+            return;
+        }
+        dropPolicy.drop(FrameDropPolicy::Stage::Encode, FrameDropPolicy::Reason::QueueFull, queued.info);
+    }
+    // 只有本线程推入，上面取空后不会再挤掉帧；pushOverwrite仅用于等待消费者取完正在取出的槽位
+    encodeQueue.pushOverwrite(std::move(frame), evicted);
+}
+
+bool LiveStreamer::isCongested() const {
+    if (config.sharedMemory) {
+        return false;
+    }
+    return transmitter.isCongested() ||
+           (bitrateController.isEnabled() && bitrateController.getState() == BitrateController::State::Decrease);
+}
+
+LiveStreamer::FrameCounts LiveStreamer::getFrameCounts() const {
+    FrameCounts counts;
+    counts.captured = framesCaptured.load(std::memory_order_relaxed);
+    counts.encoded = framesEncoded.load(std::memory_order_relaxed);
+    counts.sent = framesSent.load(std::memory_order_relaxed);
+    return counts;
+}
+
+std::string LiveStreamer::formatMetrics() {
+    // 只读取原子计数和无锁直方图，不与流水线线程争锁
+    FrameCounts frames = getFrameCounts();
+    uint64_t now = timing::nowMicros();
+    double seconds = now > lastScrapeUs ? (now - lastScrapeUs) / 1000000.0 : 0.0;
+    const char* stages[3] = {"capture", "encode", "send"};
+    uint64_t counts[3] = {frames.captured, frames.encoded, frames.sent};
+    uint64_t lastCounts[3] = {lastScrapeFrames.captured, lastScrapeFrames.encoded, lastScrapeFrames.sent};
+    lastScrapeFrames = frames;
+    lastScrapeUs = now;
+    
+    OpenMetricsWriter writer;
+    writer.family("lls_frames", "counter", nullptr, "Frames completed by each pipeline stage.");
+    for (unsigned int i = 0; i < 3; i++) {
+        writer.sample("lls_frames_total", metricLabel("stage", stages[i]), counts[i]);
+    }
+    writer.family("lls_stage_fps", "gauge", nullptr, "Frames per second of each stage since the previous scrape.");
+    for (unsigned int i = 0; i < 3; i++) {
+        double fps = seconds > 0.0 ? (counts[i] - lastCounts[i]) / seconds : 0.0;
+        writer.sample("lls_stage_fps", metricLabel("stage", stages[i]), fps);
+    }
+    
+    FrameClock::Stats clockStats = captureClock.getStats();
+    writer.family("lls_capture_ticks", "counter", nullptr, "Capture clock ticks fired.");
+    writer.sample("lls_capture_ticks_total", "", clockStats.ticks);
+    writer.family("lls_capture_missed_ticks", "counter", nullptr, "Capture clock ticks skipped after falling behind.");
+    writer.sample("lls_capture_missed_ticks_total", "", clockStats.missedTicks);
+    writer.family("lls_capture_tick_lateness_seconds", "histogram", "seconds",
+                  "Time from each capture tick deadline to the capture thread waking up.");
+    writer.histogram("lls_capture_tick_lateness_seconds", "", captureClock.latenessHistogram());
+    
+    writer.family("lls_frame_latency_seconds", "histogram", "seconds",
+                  "Per-frame latency of pipeline stages and queues, from frame acquire to last packet sent.");
+    for (unsigned int i = 0; i < PipelineLatency::kSpans; i++) {
+        PipelineLatency::Span span = static_cast<PipelineLatency::Span>(i);
+        const char* kind = PipelineLatency::isQueue(span) ? "queue"
+                         : (span == PipelineLatency::Span::Total ? "total" : "stage");
+        writer.histogram("lls_frame_latency_seconds",
+                         metricLabel("span", PipelineLatency::spanKey(span)) + "," + metricLabel("kind", kind),
+                         latency.histogram(span));
+    }
+    
+    FrameDropPolicy::Stats drops = dropPolicy.getStats();
+    writer.family("lls_dropped_frames", "counter", nullptr, "Frames dropped before sending, by stage and reason.");
+    for (unsigned int stage = 0; stage < FrameDropPolicy::kStages; stage++) {
+        for (unsigned int reason = 0; reason < FrameDropPolicy::kReasons; reason++) {
+            std::string labels =
+                metricLabel("stage", FrameDropPolicy::stageName(static_cast<FrameDropPolicy::Stage>(stage))) + "," +
+                metricLabel("reason", FrameDropPolicy::reasonName(static_cast<FrameDropPolicy::Reason>(reason)));
+            writer.sample("lls_dropped_frames_total", labels, drops.dropped[stage][reason]);
+        }
+    }
+    
+    // 共享内存输出时每帧算一个包
+    uint64_t bytes = 0;
+    uint64_t packets = 0;
+    uint64_t packetsDropped = 0;
+    uint64_t blockedSends = 0;
+    uint64_t sendErrors = 0;
+    if (config.sharedMemory) {
+        SharedMemoryWriter::Stats shmStats = shmWriter.getStats();
+        bytes = shmStats.bytesWritten;
+        packets = shmStats.framesWritten;
+    } else {
+        UDPTransmitter::TransmitStats transmitStats = transmitter.getStats();
+        bytes = transmitStats.bytesSent;
+        packets = transmitStats.packetsSent;
+        packetsDropped = transmitStats.packetsDropped;
+        blockedSends = transmitStats.blockedSends;
+        sendErrors = transmitStats.sendErrors;
+    }
+    writer.family("lls_sent_bytes", "counter", "bytes", "Bytes sent, or written to shared memory.");
+    writer.sample("lls_sent_bytes_total", "", bytes);
+    writer.family("lls_sent_packets", "counter", nullptr, "Packets sent, or frames written to shared memory.");
+    writer.sample("lls_sent_packets_total", "", packets);
+    writer.family("lls_dropped_packets", "counter", nullptr,
+                  "Packets dropped after the send buffer stayed full past the retry deadline.");
+    writer.sample("lls_dropped_packets_total", "", packetsDropped);
+    writer.family("lls_blocked_sends", "counter", nullptr, "Sends that found the socket send buffer full.");
+    writer.sample("lls_blocked_sends_total", "", blockedSends);
+    writer.family("lls_socket_errors", "counter", nullptr, "Frames abandoned on a socket send error.");
+    writer.sample("lls_socket_errors_total", "", sendErrors);
+    
+    uint64_t targetKbps = bitrateController.isEnabled() ? bitrateController.getTargetBitrate() : config.bitrate;
+    writer.family("lls_target_bitrate_kbps", "gauge", nullptr, "Encoder target bitrate in kbps.");
+    writer.sample("lls_target_bitrate_kbps", "", targetKbps);
+    return writer.finish();
+}
+
+const char* LiveStreamer::pipelineModeName(PipelineMode mode) {
+    switch (mode) {
+        case PipelineMode::Pipelined: return "pipelined";
+        case PipelineMode::RunToCompletion: return "run-to-completion";
+    }
+    return "unknown";
+}
+
+bool LiveStreamer::parsePipelineMode(const std::string& name, PipelineMode& mode) {
+    if (name == "pipelined") {
+        mode = PipelineMode::Pipelined;
+    } else if (name == "rtc" || name == "run-to-completion") {
+        mode = PipelineMode::RunToCompletion;
+    } else {
+        return false;
+    }
+    return true;
+}
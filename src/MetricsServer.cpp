@@ -0,0 +1,276 @@
+#include "MetricsServer.h"
+#include "PreciseTimer.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+#endif
+
+// 10us～250ms，覆盖单个阶段到整条流水线的延迟
+const uint64_t OpenMetricsWriter::kLatencyBoundsNs[kLatencyBuckets] = {
+    10000, 25000, 50000, 100000, 250000, 500000, 1000000,
+    2500000, 5000000, 10000000, 25000000, 50000000, 100000000, 250000000
+};
+
+const char* const OpenMetricsWriter::kLatencyBoundLabels[kLatencyBuckets] = {
+    "0.00001", "0.000025", "0.00005", "0.0001", "0.00025", "0.0005", "0.001",
+    "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "0.25"
+};
+
+namespace {
+
+// 服务线程的nice值（Linux），抓取不与流水线线程和界面线程争抢CPU
+const int kServeThreadNice = 10;
+
+// 服务线程降为低优先级
+void lowerThreadPriority() {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_BELOW_NORMAL);
+#elif defined(__linux__)
+    // Linux上nice值按线程生效
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), kServeThreadNice);
+#endif
+}
+
+// 对端已关闭时不产生SIGPIPE
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL;
+#else
+const int kSendFlags = 0;
+#endif
+
+// 在期限内写完data，返回是否全部写出
+bool sendAll(SOCKET s, const std::string& data, uint64_t deadlineUs) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        int result = send(s, data.data() + offset, static_cast<int>(data.size() - offset), kSendFlags);
+        if (result > 0) {
+            offset += result;
+            continue;
+        }
+        uint64_t now = timing::nowMicros();
+        if (result == SOCKET_ERROR && net::isWouldBlock(net::lastError()) && now < deadlineUs &&
+            net::waitWritable(s, deadlineUs - now)) {
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+void sendResponse(SOCKET s, const char* status, const char* contentType, const std::string& body, bool includeBody,
+                  uint64_t deadlineUs) {
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Type: ";
+    response += contentType;
+    response += "\r\nContent-Length: " + std::to_string(body.size());
+    response += "\r\nConnection: close\r\n\r\n";
+    if (includeBody) {
+        response += body;
+    }
+    sendAll(s, response, deadlineUs);
+}
+
+} // namespace
+
+void OpenMetricsWriter::family(const char* name, const char* type, const char* unit, const char* help) {
+    text += "# TYPE ";
+    text += name;
+    text += ' ';
+    text += type;
+    text += '\n';
+    if (unit) {
+        text += "# UNIT ";
+        text += name;
+        text += ' ';
+        text += unit;
+        text += '\n';
+    }
+    text += "# HELP ";
+    text += name;
+    text += ' ';
+    text += help;
+    text += '\n';
+}
+
+void OpenMetricsWriter::sample(const char* name, const std::string& labels, uint64_t value) {
+    appendSample(name, "", labels, std::to_string(value).c_str());
+}
+
+void OpenMetricsWriter::sample(const char* name, const std::string& labels, double value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", value);
+    appendSample(name, "", labels, buffer);
+}
+
+void OpenMetricsWriter::histogram(const char* name, const std::string& labels, const HdrHistogram& histogram) {
+    // 各桶计数来自同一次遍历，随上界单调不减，+Inf桶与_count相同
+    uint64_t cumulative[kLatencyBuckets];
+    uint64_t total = histogram.cumulativeCounts(kLatencyBoundsNs, kLatencyBuckets, cumulative);
+    std::string prefix = labels.empty() ? std::string() : labels + ",";
+    for (unsigned int i = 0; i < kLatencyBuckets; i++) {
+        appendSample(name, "_bucket", prefix + "le=\"" + kLatencyBoundLabels[i] + "\"",
+                     std::to_string(cumulative[i]).c_str());
+    }
+    appendSample(name, "_bucket", prefix + "le=\"+Inf\"", std::to_string(total).c_str());
+    appendSample(name, "_count", labels, std::to_string(total).c_str());
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", histogram.sum() / 1e9);
+    appendSample(name, "_sum", labels, buffer);
+}
+
+std::string OpenMetricsWriter::finish() {
+    text += "# EOF\n";
+    std::string result;
+    result.swap(text);
+    return result;
+}
+
+void OpenMetricsWriter::appendSample(const char* name, const char* suffix, const std::string& labels,
+                                     const char* value) {
+    text += name;
+    text += suffix;
+    if (!labels.empty()) {
+        text += '{';
+        text += labels;
+        text += '}';
+    }
+    text += ' ';
+    text += value;
+    text += '\n';
+}
+
+MetricsServer::MetricsServer()
+    : listenSocket(INVALID_SOCKET),
+      port(0),
+      running(false),
+      scrapes(0) {
+    if (!net::startup()) {
+        std::cerr << "WSAStartup failed: " << net::lastError() << std::endl;
+    }
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+    net::cleanup();
+}
+
+bool MetricsServer::start(unsigned int port, Collector collector) {
+    if (running) {
+        return true;
+    }
+
+    listenSocket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listenSocket == INVALID_SOCKET) {
+        std::cerr << "Failed to create metrics socket: " << net::lastError() << std::endl;
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+
+    // 只监听回环地址，指标不对外网暴露
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(listenSocket, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR ||
+        listen(listenSocket, 4) == SOCKET_ERROR || !net::setNonBlocking(listenSocket)) {
+        std::cerr << "Failed to listen on metrics port " << port << ": " << net::lastError() << std::endl;
+        net::closeSocket(listenSocket);
+        listenSocket = INVALID_SOCKET;
+        return false;
+    }
+
+    this->port = port;
+    this->collector = collector;
+    scrapes = 0;
+    running = true;
+    serveThread = std::thread(&MetricsServer::serveThreadFunc, this);
+    std::cout << "Metrics available at http://127.0.0.1:" << port << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsServer::stop() {
+    if (!running) {
+        return;
+    }
+
+    running = false;
+    if (serveThread.joinable()) {
+        serveThread.join();
+    }
+    net::closeSocket(listenSocket);
+    listenSocket = INVALID_SOCKET;
+}
+
+void MetricsServer::serveThreadFunc() {
+    lowerThreadPriority();
+    while (running) {
+        if (!net::waitReadable(listenSocket, kPollIntervalMs * 1000ull)) {
+            continue;
+        }
+        SOCKET client = accept(listenSocket, nullptr, nullptr);
+        if (client == INVALID_SOCKET) {
+            continue;
+        }
+        handleConnection(client);
+        net::closeSocket(client);
+    }
+}
+
+void MetricsServer::handleConnection(SOCKET client) {
+    // 接受的套接字在Windows上继承监听套接字的非阻塞模式，Linux上不继承，统一设为非阻塞后按期限等待
+    net::setNonBlocking(client);
+    uint64_t deadline = timing::nowMicros() + kRequestTimeoutMs * 1000ull;
+
+    // 读到请求头结束（空行）为止，忽略请求体
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        uint64_t now = timing::nowMicros();
+        if (now >= deadline || !net::waitReadable(client, deadline - now)) {
+            return;
+        }
+        int received = recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            if (received == SOCKET_ERROR && net::isWouldBlock(net::lastError())) {
+                continue;
+            }
+            return;
+        }
+        request.append(buffer, received);
+    }
+
+    // 请求行：方法 路径 版本
+    size_t methodEnd = request.find(' ');
+    size_t pathEnd = methodEnd == std::string::npos ? std::string::npos : request.find(' ', methodEnd + 1);
+    if (pathEnd == std::string::npos) {
+        sendResponse(client, "400 Bad Request", "text/plain; charset=utf-8", "Bad Request\n", true, deadline);
+        return;
+    }
+    std::string method = request.substr(0, methodEnd);
+    std::string path = request.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+    path = path.substr(0, path.find('?'));
+
+    if (method != "GET" && method != "HEAD") {
+        sendResponse(client, "405 Method Not Allowed", "text/plain; charset=utf-8", "Method Not Allowed\n", true,
+                     deadline);
+        return;
+    }
+    if (path != "/metrics") {
+        sendResponse(client, "404 Not Found", "text/plain; charset=utf-8", "Not Found\n", method == "GET", deadline);
+        return;
+    }
+
+    std::string body = collector();
+    scrapes.fetch_add(1, std::memory_order_relaxed);
+    sendResponse(client, "200 OK", "application/openmetrics-text; version=1.0.0; charset=utf-8", body,
+                 method == "GET", deadline);
+}
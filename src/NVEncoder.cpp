@@ -1,4 +1,5 @@
 #include "NVEncoder.h"
+#include "PreciseTimer.h"
 #include <stdexcept>
 #include <cstring>
 #include <iostream>
@@ -114,6 +115,41 @@ bool NVEncoder::initNVENC() {
 #endif
 }
 
+bool NVEncoder::reconfigure(int bitrateKbps, int maxFrameBytes) {
+    if (bitrateKbps <= 0) {
+        return false;
+    }
+
+#ifdef NVENC_AVAILABLE
+    if (nvencEncoder) {
+        NV_ENC_CONFIG newConfig = encodeConfig;
+        newConfig.rcParams.averageBitRate = bitrateKbps * 1000;
+        newConfig.rcParams.maxBitRate = bitrateKbps * 1000;
+        newConfig.rcParams.vbvBufferSize = maxFrameBytes > 0 ? maxFrameBytes * 8 : bitrateKbps * 1000 / fps;
+        newConfig.rcParams.vbvInitialDelay = newConfig.rcParams.vbvBufferSize;
+
+        // 保持会话和参考帧，不插入IDR
+        NV_ENC_RECONFIGURE_PARAMS reconfigureParams = {};
+        reconfigureParams.version = NV_ENC_RECONFIGURE_PARAMS_VER;
+        reconfigureParams.reInitEncodeParams = initParams;
+        reconfigureParams.reInitEncodeParams.encodeConfig = &newConfig;
+        reconfigureParams.resetEncoder = 0;
+        reconfigureParams.forceIDR = 0;
+
+        if (nvenc.nvEncReconfigureEncoder(nvencEncoder, &reconfigureParams) != NV_ENC_SUCCESS) {
+            std::cerr << "Failed to reconfigure NVENC bitrate to " << bitrateKbps << " kbps" << std::endl;
+            return false;
+        }
+
+        encodeConfig = newConfig;
+        initParams.encodeConfig = &encodeConfig;
+    }
+#endif
+
+    bitrate = bitrateKbps;
+    return true;
+}
+
 bool NVEncoder::encode(
     ID3D11Texture2D* inputTexture,
     std::vector<uint8_t>& output
@@ -153,8 +189,13 @@ bool NVEncoder::encode(
         picParams.inputWidth = width;
         picParams.inputHeight = height;
         picParams.pictureStruct = NV_ENC_PIC_STRUCT_FRAME;
+        if (keyframePending) {
+            picParams.encodePicFlags = NV_ENC_PIC_FLAG_FORCEIDR | NV_ENC_PIC_FLAG_OUTPUT_SPSPPS;
+            keyframePending = false;
+        }
 
         // 编码图片
+        lastTiming.submitNs = timing::nowNanos();
         if (nvenc.nvEncEncodePicture(nvencEncoder, &picParams) != NV_ENC_SUCCESS) {
             std::cerr << "Failed to encode picture" << std::endl;
             nvenc.nvEncUnmapInputResource(nvencEncoder, mapRes.mappedResource);
@@ -175,6 +216,7 @@ bool NVEncoder::encode(
             // 解锁bitstream
             nvenc.nvEncUnlockBitstream(nvencEncoder, lockBitstream.outputBitstream);
         }
+        lastTiming.completeNs = timing::nowNanos();
 
         // 清理资源
         nvenc.nvEncUnmapInputResource(nvencEncoder, mapRes.mappedResource);
@@ -185,10 +227,20 @@ bool NVEncoder::encode(
 #endif
 
     // NVENC不可用，使用简化实现
-    // 生成一个简单的测试数据，模拟H.264比特流
+    // 生成一个简单的测试数据，模拟H.264比特流：起始码 + 切片NAL头，每fps帧或按请求为IDR
+    lastTiming.submitNs = timing::nowNanos();
+    bool keyframe = keyframePending || fps <= 0 || frameCount % fps == 0;
+    keyframePending = false;
+    frameCount++;
     output.resize(1024); // 1KB测试数据
     for (size_t i = 0; i < output.size(); i++) {
-        output[i] = static_cast<uint8_t>(i % 256);
+        output[i] = static_cast<uint8_t>(i % 255 + 1);
     }
+    output[0] = 0x00;
+    output[1] = 0x00;
+    output[2] = 0x00;
+    output[3] = 0x01;
+    output[4] = keyframe ? 0x65 : 0x41;
+    lastTiming.completeNs = timing::nowNanos();
     return true;
 }
@@ -0,0 +1,231 @@
+#include "NetworkImpairment.h"
+#include <cmath>
+#include <algorithm>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// Pareto抖动的形状参数：α=3时方差有限，尾部仍明显长于正态分布
+const double kParetoAlpha = 3.0;
+
+const double kPi = 3.14159265358979323846;
+
+// 重复的数据包紧随原包之后送达
+const uint64_t kDuplicateGapUs = 1;
+
+} // namespace
+
+NetworkImpairment::NetworkImpairment()
+    : badState(false),
+      linkFreeUs(0),
+      lastReleaseUs(0) {
+    stats = Stats();
+}
+
+void NetworkImpairment::configure(const Config& cfg) {
+    config = cfg;
+    config.lossRate = std::min(std::max(config.lossRate, 0.0), 1.0);
+    config.burstEnter = std::min(std::max(config.burstEnter, 0.0), 1.0);
+    config.burstExit = std::min(std::max(config.burstExit, 0.0), 1.0);
+    config.reorderRate = std::min(std::max(config.reorderRate, 0.0), 1.0);
+    config.duplicateRate = std::min(std::max(config.duplicateRate, 0.0), 1.0);
+
+    random.seed(config.seed);
+    badState = false;
+    linkFreeUs = 0;
+    lastReleaseUs = 0;
+    stats = Stats();
+}
+
+double NetworkImpairment::uniform() {
+    // 取高53位得到[0, 1)内的double，不依赖标准库分布的实现
+    return static_cast<double>(random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+int64_t NetworkImpairment::sampleDelay(double u1, double u2) {
+    double jitter = static_cast<double>(config.jitterUs);
+    double offset = 0.0;
+
+    switch (config.distribution) {
+        case DelayDistribution::Uniform:
+            offset = (u1 * 2.0 - 1.0) * jitter;
+            break;
+        case DelayDistribution::Normal:
+            // Box-Muller变换
+            offset = std::sqrt(-2.0 * std::log(1.0 - u1)) * std::cos(2.0 * kPi * u2) * jitter;
+            break;
+        case DelayDistribution::Pareto: {
+            // 以x_m = 抖动×(α-1)平移到0起点，均值等于抖动
+            double scale = jitter * (kParetoAlpha - 1.0);
+            offset = scale * (std::pow(1.0 - u1, -1.0 / kParetoAlpha) - 1.0);
+            break;
+        }
+    }
+
+    return std::max<int64_t>(0, static_cast<int64_t>(config.delayUs) + static_cast<int64_t>(offset));
+}
+
+unsigned int NetworkImpairment::process(size_t size, uint64_t nowUs, uint64_t releaseUs[2]) {
+    // 每个包固定消耗7个随机数，分支不影响后续包的随机序列
+    double uState = uniform();
+    double uBurstLoss = uniform();
+    double uLoss = uniform();
+    double uDelay1 = uniform();
+    double uDelay2 = uniform();
+    double uReorder = uniform();
+    double uDuplicate = uniform();
+
+    stats.packetsIn++;
+    stats.bytesIn += size;
+
+    // Gilbert-Elliott状态转移
+    if (config.burstEnter > 0.0) {
+        if (badState) {
+            badState = uState >= config.burstExit;
+        } else if (uState < config.burstEnter) {
+            badState = true;
+            stats.burstEpisodes++;
+        }
+        if (uBurstLoss < (badState ? config.burstLossBad : config.burstLossGood)) {
+            stats.droppedBurst++;
+            return 0;
+        }
+    }
+
+    if (uLoss < config.lossRate) {
+        stats.droppedRandom++;
+        return 0;
+    }
+
+    // 带宽上限：数据包排在链路队列末尾，队列积压超过上限时尾部丢弃
+    uint64_t departUs = nowUs;
+    if (config.bandwidthKbps > 0) {
+        uint64_t startUs = std::max(nowUs, linkFreeUs);
+        double backlogBytes = static_cast<double>(startUs - nowUs) * config.bandwidthKbps / 8000.0;
+        if (backlogBytes + size > config.queueBytes) {
+            stats.droppedQueue++;
+            return 0;
+        }
+        linkFreeUs = startUs + static_cast<uint64_t>(size * 8000.0 / config.bandwidthKbps);
+        departUs = linkFreeUs;
+        stats.maxQueueDelayUs = std::max(stats.maxQueueDelayUs, departUs - nowUs);
+    }
+
+    // 抖动只拉开间隔，不越过前一个包；乱序由reorderRate单独控制
+    uint64_t release = departUs + static_cast<uint64_t>(sampleDelay(uDelay1, uDelay2));
+    if (uReorder < config.reorderRate) {
+        release = std::max(release, lastReleaseUs) + config.reorderDelayUs;
+        stats.reordered++;
+    } else {
+        release = std::max(release, lastReleaseUs);
+        lastReleaseUs = release;
+    }
+
+    releaseUs[0] = release;
+    stats.packetsOut++;
+    if (uDuplicate < config.duplicateRate) {
+        releaseUs[1] = release + kDuplicateGapUs;
+        stats.duplicated++;
+        stats.packetsOut++;
+        return 2;
+    }
+    return 1;
+}
+
+bool NetworkImpairment::applyScenario(const std::string& name, Config& config) {
+    uint64_t seed = config.seed;
+    config = Config();
+    config.seed = seed;
+
+    if (name == "clean") {
+        return true;
+    }
+    if (name == "lan") {
+        // 交换机局域网：亚毫秒时延，几乎无抖动
+        config.delayUs = 200;
+        config.jitterUs = 50;
+        return true;
+    }
+    if (name == "wifi") {
+        // 家用WiFi：链路层重传造成长尾时延和短突发丢包
+        config.delayUs = 2000;
+        config.jitterUs = 1500;
+        config.distribution = DelayDistribution::Pareto;
+        config.lossRate = 0.002;
+        config.burstEnter = 0.002;
+        config.burstExit = 0.4;
+        config.reorderRate = 0.002;
+        config.reorderDelayUs = 2000;
+        return true;
+    }
+    if (name == "lossy") {
+        // 2%独立随机丢包，用于比较FEC冗余比例
+        config.delayUs = 5000;
+        config.jitterUs = 500;
+        config.lossRate = 0.02;
+        return true;
+    }
+    if (name == "burst") {
+        // 平均5个包的突发丢包，平均丢包率约2.4%
+        config.delayUs = 5000;
+        config.jitterUs = 500;
+        config.burstEnter = 0.005;
+        config.burstExit = 0.2;
+        config.burstLossBad = 1.0;
+        return true;
+    }
+    if (name == "congested") {
+        // 瓶颈链路低于推流码率，用于验证分包节奏控制和自适应码率
+        config.delayUs = 10000;
+        config.jitterUs = 1000;
+        config.distribution = DelayDistribution::Normal;
+        config.bandwidthKbps = 12000;
+        config.queueBytes = 150000;
+        return true;
+    }
+    if (name == "mobile") {
+        // 蜂窝网络：较大的时延和抖动、突发丢包、少量乱序和重复
+        config.delayUs = 30000;
+        config.jitterUs = 8000;
+        config.distribution = DelayDistribution::Normal;
+        config.lossRate = 0.005;
+        config.burstEnter = 0.01;
+        config.burstExit = 0.25;
+        config.reorderRate = 0.01;
+        config.reorderDelayUs = 5000;
+        config.duplicateRate = 0.001;
+        config.bandwidthKbps = 20000;
+        config.queueBytes = 250000;
+        return true;
+    }
+    return false;
+}
+
+std::vector<std::string> NetworkImpairment::scenarioNames() {
+    return {"clean", "lan", "wifi", "lossy", "burst", "congested", "mobile"};
+}
+
+bool NetworkImpairment::parseDistribution(const std::string& name, DelayDistribution& distribution) {
+    if (name == "uniform") {
+        distribution = DelayDistribution::Uniform;
+    } else if (name == "normal") {
+        distribution = DelayDistribution::Normal;
+    } else if (name == "pareto") {
+        distribution = DelayDistribution::Pareto;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* NetworkImpairment::distributionName(DelayDistribution distribution) {
+    switch (distribution) {
+        case DelayDistribution::Uniform: return "uniform";
+        case DelayDistribution::Normal: return "normal";
+        case DelayDistribution::Pareto: return "pareto";
+    }
+    return "unknown";
+}
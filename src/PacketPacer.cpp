@@ -0,0 +1,111 @@
+#include "PacketPacer.h"
+#include "PreciseTimer.h"
+#include <algorithm>
+#include <cmath>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+PacketPacer::PacketPacer()
+    : spinUs(0),
+      baseRate(0.0),
+      windowUs(0.0),
+      capacity(0.0),
+      rate(0.0),
+      tokens(0.0),
+      lastRefillUs(0),
+      lastDepartureUs(0),
+      lastGapUs(-1),
+      jitterUs(0.0),
+      waits(0),
+      totalWaitUs(0),
+      totalLatenessUs(0),
+      departureJitterUs(0),
+      lastRateKbps(0) {
+}
+
+void PacketPacer::configure(const Config& config, unsigned int bitrateKbps, unsigned int frameRate,
+                            unsigned int maxPacketSize) {
+    this->config = config;
+    this->config.frameFraction = std::min(std::max(config.frameFraction, 0.05), 1.0);
+    this->config.burstPackets = std::max(config.burstPackets, 1u);
+    spinUs = config.spinUs ? config.spinUs : timing::defaultSpinUs();
+
+    // 平均帧在窗口内发完所需的速率作为下限，码率未知时不设下限
+    frameRate = std::max(frameRate, 1u);
+    windowUs = 1000000.0 / frameRate * this->config.frameFraction;
+    baseRate = bitrateKbps * 1000.0 / 8.0 / 1000000.0 / this->config.frameFraction;
+    capacity = static_cast<double>(this->config.burstPackets) * maxPacketSize;
+
+    rate = baseRate;
+    tokens = capacity;
+    lastRefillUs = timing::nowMicros();
+
+    if (config.enabled) {
+        timing::enableHighResolution();
+    }
+}
+
+void PacketPacer::setBitrate(unsigned int bitrateKbps) {
+    baseRate = bitrateKbps * 1000.0 / 8.0 / 1000000.0 / config.frameFraction;
+}
+
+void PacketPacer::beginFrame(size_t frameBytes) {
+    rate = std::max(baseRate, static_cast<double>(frameBytes) / windowUs);
+    lastRateKbps.store(static_cast<uint32_t>(rate * 1000000.0 * 8.0 / 1000.0), std::memory_order_relaxed);
+
+    // 帧之间的出发间隔不计入抖动
+    lastGapUs = -1;
+    lastDepartureUs = 0;
+}
+
+void PacketPacer::acquire(size_t bytes) {
+    uint64_t now = timing::nowMicros();
+
+    // 按当前速率补充令牌，最多补满容量
+    tokens = std::min(capacity, tokens + (now - lastRefillUs) * rate);
+    lastRefillUs = now;
+
+    uint64_t departure = now;
+    if (tokens < static_cast<double>(bytes)) {
+        uint64_t waitUs = static_cast<uint64_t>(std::ceil((bytes - tokens) / rate));
+        uint64_t target = now + waitUs;
+        timing::sleepUntil(target, spinUs);
+
+        departure = timing::nowMicros();
+        waits.fetch_add(1, std::memory_order_relaxed);
+        totalWaitUs.fetch_add(departure - now, std::memory_order_relaxed);
+        totalLatenessUs.fetch_add(departure - target, std::memory_order_relaxed);
+
+        tokens = std::min(capacity, tokens + (departure - lastRefillUs) * rate);
+        lastRefillUs = departure;
+    }
+    tokens -= static_cast<double>(bytes);
+
+    // 出发间隔抖动：相邻两次突发间隔之差的平滑值
+    if (lastDepartureUs != 0) {
+        int64_t gap = static_cast<int64_t>(departure - lastDepartureUs);
+        if (lastGapUs >= 0) {
+            jitterUs += (std::fabs(static_cast<double>(gap - lastGapUs)) - jitterUs) / 16.0;
+            departureJitterUs.store(static_cast<uint32_t>(jitterUs), std::memory_order_relaxed);
+        }
+        lastGapUs = gap;
+    }
+    lastDepartureUs = departure;
+}
+
+void PacketPacer::refund(size_t bytes) {
+    tokens = std::min(capacity, tokens + static_cast<double>(bytes));
+}
+
+PacketPacer::Stats PacketPacer::getStats() const {
+    Stats stats;
+    stats.waits = waits.load(std::memory_order_relaxed);
+    stats.totalWaitUs = totalWaitUs.load(std::memory_order_relaxed);
+    stats.totalLatenessUs = totalLatenessUs.load(std::memory_order_relaxed);
+    stats.departureJitterUs = departureJitterUs.load(std::memory_order_relaxed);
+    stats.lastRateKbps = lastRateKbps.load(std::memory_order_relaxed);
+    stats.avgLatenessUs = stats.waits ? static_cast<double>(stats.totalLatenessUs) / stats.waits : 0.0;
+    return stats;
+}
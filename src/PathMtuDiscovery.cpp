@@ -0,0 +1,298 @@
+#include "PathMtuDiscovery.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 重新探测的等待按该粒度检查退出标志
+const unsigned int kStopCheckMs = 100;
+// 按往返时间缩短的应答等待时间不低于该值，避免调度延迟造成误判
+const unsigned int kMinProbeTimeoutMs = 20;
+
+} // namespace
+
+PathMtuDiscovery::PathMtuDiscovery()
+    : sock(INVALID_SOCKET),
+      maxPacketSize(0),
+      acknowledged(false),
+      running(false),
+      nextProbeId(0),
+      lastAckedId(0),
+      minRttUs(0),
+      packetSize(0),
+      kernelMtu(0),
+      probesSent(0),
+      probesAcked(0),
+      probesRejected(0),
+      searches(0),
+      receiverResponding(false) {
+}
+
+PathMtuDiscovery::~PathMtuDiscovery() {
+    stop();
+}
+
+bool PathMtuDiscovery::start(const sockaddr_in& destination, unsigned int maxPacketSize, bool acknowledged,
+                             const Config& cfg, const ChangeHandler& handler) {
+    config = cfg;
+    config.granularity = std::max(config.granularity, 1u);
+    config.probeRetries = std::max(config.probeRetries, 1u);
+    this->maxPacketSize = maxPacketSize;
+    this->acknowledged = acknowledged;
+    changeHandler = handler;
+
+    if (maxPacketSize < sizeof(Probe)) {
+        std::cerr << "Invalid max packet size for path MTU discovery: " << maxPacketSize << std::endl;
+        return false;
+    }
+
+    // 探测套接字连接到数据目的地址，内核为其缓存路由MTU
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) {
+        std::cerr << "Failed to create path MTU probe socket: " << net::lastError() << std::endl;
+        return false;
+    }
+    if (connect(sock, reinterpret_cast<const sockaddr*>(&destination), sizeof(destination)) == SOCKET_ERROR) {
+        std::cerr << "Failed to connect path MTU probe socket: " << net::lastError() << std::endl;
+        net::closeSocket(sock);
+        sock = INVALID_SOCKET;
+        return false;
+    }
+
+    // 探测包必须设置DF位，超过路径MTU时被丢弃而不是被分片后重组
+#ifdef __linux__
+    int discover = IP_PMTUDISC_DO;
+    if (setsockopt(sock, IPPROTO_IP, IP_MTU_DISCOVER, &discover, sizeof(discover)) != 0) {
+        std::cerr << "Failed to set IP_MTU_DISCOVER: " << net::lastError() << std::endl;
+    }
+#elif defined(_WIN32)
+    DWORD dontFragment = 1;
+    if (setsockopt(sock, IPPROTO_IP, IP_DONTFRAGMENT, reinterpret_cast<const char*>(&dontFragment),
+                   sizeof(dontFragment)) != 0) {
+        std::cerr << "Failed to set IP_DONTFRAGMENT: " << net::lastError() << std::endl;
+    }
+#endif
+
+    probeBuffer.assign(maxPacketSize, 0);
+
+    // 在第一次搜索完成前使用保守的分包大小
+    packetSize = std::min(std::min(config.fallbackPacketSize, maxPacketSize), kernelLimit());
+    std::cout << "Path MTU discovery: initial packet size " << packetSize.load()
+              << (acknowledged ? "" : " (receiver cannot acknowledge, tracking kernel route MTU only)")
+              << std::endl;
+
+    running = true;
+    thread = std::thread(&PathMtuDiscovery::threadFunc, this);
+    return true;
+}
+
+void PathMtuDiscovery::stop() {
+    if (running) {
+        {
+            std::lock_guard<std::mutex> lock(ackMutex);
+            running = false;
+        }
+        ackArrived.notify_all();
+    }
+    if (thread.joinable()) {
+        thread.join();
+    }
+    if (sock != INVALID_SOCKET) {
+        net::closeSocket(sock);
+        sock = INVALID_SOCKET;
+    }
+}
+
+bool PathMtuDiscovery::queryKernelMtu(SOCKET sock, unsigned int& mtu) {
+#ifdef __linux__
+    int value = 0;
+    socklen_t length = sizeof(value);
+    if (getsockopt(sock, IPPROTO_IP, IP_MTU, &value, &length) != 0 || value <= 0) {
+        return false;
+    }
+    mtu = static_cast<unsigned int>(value);
+    return true;
+#else
+    (void)sock;
+    (void)mtu;
+    return false;
+#endif
+}
+
+unsigned int PathMtuDiscovery::kernelLimit() {
+    unsigned int mtu = 0;
+    if (!queryKernelMtu(sock, mtu) || mtu <= kIpUdpOverhead) {
+        return maxPacketSize;
+    }
+    kernelMtu.store(mtu, std::memory_order_relaxed);
+    return std::min(maxPacketSize, mtu - kIpUdpOverhead);
+}
+
+void PathMtuDiscovery::threadFunc() {
+    while (running) {
+        update(search());
+
+        if (config.intervalMs == 0) {
+            break;
+        }
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(config.intervalMs);
+        while (running && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(kStopCheckMs));
+        }
+    }
+}
+
+unsigned int PathMtuDiscovery::search() {
+    searches.fetch_add(1, std::memory_order_relaxed);
+
+    unsigned int upper = kernelLimit();
+    if (!acknowledged) {
+        // 无法确认接收端能收下更大的分包，只向下跟随路由MTU
+        return std::min(config.fallbackPacketSize, upper);
+    }
+
+    // 先确认接收端会应答最小探测，否则无法区分"过大"和"不支持"
+    unsigned int lower = std::min(std::max(config.minPacketSize, static_cast<unsigned int>(sizeof(Probe))), upper);
+    if (!probe(lower)) {
+        if (receiverResponding.exchange(false) || searches.load(std::memory_order_relaxed) == 1) {
+            std::cerr << "Path MTU probes are not acknowledged, using fallback packet size" << std::endl;
+        }
+        return std::min(config.fallbackPacketSize, kernelLimit());
+    }
+    receiverResponding = true;
+
+    // 常见情况下上限即可通过，只需一个探测
+    if (probe(upper)) {
+        return upper;
+    }
+    // EMSGSIZE时内核已更新路由MTU，上限可能随之降低
+    upper = std::max(std::min(upper, kernelLimit()), lower);
+
+    // 以太网路径上默认分包大小通常可达，先确认它可以省去大部分二分步骤
+    if (config.fallbackPacketSize > lower && config.fallbackPacketSize < upper && probe(config.fallbackPacketSize)) {
+        lower = config.fallbackPacketSize;
+    }
+
+    // 二分搜索：lower已确认可达，upper视为不可达
+    while (upper - lower > config.granularity && running) {
+        unsigned int middle = lower + (upper - lower) / 2;
+        if (probe(middle)) {
+            lower = middle;
+        } else {
+            upper = middle;
+        }
+    }
+    return lower;
+}
+
+bool PathMtuDiscovery::probe(unsigned int size) {
+    for (unsigned int attempt = 0; attempt < config.probeRetries && running; attempt++) {
+        uint32_t probeId;
+        {
+            std::lock_guard<std::mutex> lock(ackMutex);
+            probeId = ++nextProbeId;
+        }
+
+        Probe header;
+        header.magic = kProbeMagic;
+        header.probeId = probeId;
+        header.size = size;
+        header.check = ~kProbeMagic;
+        memcpy(probeBuffer.data(), &header, sizeof(header));
+
+        int result = send(sock, reinterpret_cast<const char*>(probeBuffer.data()), static_cast<int>(size), 0);
+        if (result == SOCKET_ERROR) {
+            int error = net::lastError();
+#ifdef _WIN32
+            bool tooBig = error == WSAEMSGSIZE;
+#else
+            bool tooBig = error == EMSGSIZE;
+#endif
+            if (tooBig) {
+                // 超出本地已知的路径MTU，重试也不会成功
+                probesRejected.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            // 其他错误（如之前的探测触发ICMP端口不可达）按丢失处理
+            continue;
+        }
+        probesSent.fetch_add(1, std::memory_order_relaxed);
+        auto sendTime = std::chrono::steady_clock::now();
+
+        std::unique_lock<std::mutex> lock(ackMutex);
+        bool acked = ackArrived.wait_for(lock, std::chrono::milliseconds(probeTimeoutMs()), [&] {
+            return lastAckedId == probeId || !running;
+        });
+        if (acked && lastAckedId == probeId) {
+            uint64_t rttUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - sendTime
+            ).count();
+            minRttUs = minRttUs ? std::min(minRttUs, rttUs) : std::max<uint64_t>(rttUs, 1);
+            probesAcked.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+unsigned int PathMtuDiscovery::probeTimeoutMs() const {
+    // 过大的探测只能靠超时判定，二分搜索的耗时主要取决于该等待时间
+    if (minRttUs == 0) {
+        return config.probeTimeoutMs;
+    }
+    unsigned int timeoutMs = static_cast<unsigned int>(minRttUs * 4 / 1000);
+    return std::min(config.probeTimeoutMs, std::max(timeoutMs, kMinProbeTimeoutMs));
+}
+
+void PathMtuDiscovery::handleAck(const uint8_t* message, size_t size) {
+    if (size < sizeof(Ack)) {
+        return;
+    }
+
+    Ack ack;
+    memcpy(&ack, message, sizeof(ack));
+    if (ack.magic != kAckMagic) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(ackMutex);
+        lastAckedId = ack.probeId;
+    }
+    ackArrived.notify_all();
+}
+
+void PathMtuDiscovery::update(unsigned int size) {
+    unsigned int previous = packetSize.exchange(size);
+    if (size == previous) {
+        return;
+    }
+
+    std::cout << "Path MTU discovery: packet size " << previous << " -> " << size;
+    if (kernelMtu.load(std::memory_order_relaxed) != 0) {
+        std::cout << " (route MTU " << kernelMtu.load(std::memory_order_relaxed) << ")";
+    }
+    std::cout << std::endl;
+
+    if (changeHandler) {
+        changeHandler(size);
+    }
+}
+
+PathMtuDiscovery::Stats PathMtuDiscovery::getStats() const {
+    Stats stats;
+    stats.packetSize = packetSize.load(std::memory_order_relaxed);
+    stats.kernelMtu = kernelMtu.load(std::memory_order_relaxed);
+    stats.probesSent = probesSent.load(std::memory_order_relaxed);
+    stats.probesAcked = probesAcked.load(std::memory_order_relaxed);
+    stats.probesRejected = probesRejected.load(std::memory_order_relaxed);
+    stats.searches = searches.load(std::memory_order_relaxed);
+    stats.receiverResponding = receiverResponding.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -0,0 +1,150 @@
+#include "RetransmitRing.h"
+#include <cstring>
+
+RetransmitRing::RetransmitRing()
+    : packetCapacity(0),
+      frameCapacity(0),
+      maxPacketSize(0),
+      writePosition(0),
+      currentFramePosition(0) {
+}
+
+bool RetransmitRing::initialize(unsigned int packetCapacity, unsigned int frameCapacity, unsigned int maxPacketSize) {
+    if (packetCapacity == 0 || frameCapacity == 0 || maxPacketSize == 0) {
+        return false;
+    }
+
+    this->packetCapacity = packetCapacity;
+    this->frameCapacity = frameCapacity;
+    this->maxPacketSize = maxPacketSize;
+
+    // std::atomic不可复制，只能按数量构造
+    packetSlots = std::vector<PacketSlot>(packetCapacity);
+    for (PacketSlot& slot : packetSlots) {
+        slot.sequence.store(0, std::memory_order_relaxed);
+        slot.frameId = 0;
+        slot.packetId = 0;
+        slot.size = 0;
+    }
+    packetData.assign(static_cast<size_t>(packetCapacity) * maxPacketSize, 0);
+
+    frameEntries = std::vector<FrameEntry>(frameCapacity);
+    for (FrameEntry& entry : frameEntries) {
+        entry.sequence.store(0, std::memory_order_relaxed);
+        entry.frameId = 0;
+        entry.packetCount = 0;
+        entry.firstPosition = 0;
+        entry.sendTimeUs = 0;
+    }
+
+    writePosition = 0;
+    currentFramePosition = 0;
+    return true;
+}
+
+void RetransmitRing::beginFrame(uint32_t frameId, uint16_t packetCount, uint64_t sendTimeUs) {
+    currentFramePosition = writePosition;
+    writePosition += packetCount;
+
+    FrameEntry& entry = frameEntries[frameId % frameCapacity];
+    uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+    entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    entry.frameId = frameId;
+    entry.packetCount = packetCount;
+    entry.firstPosition = currentFramePosition;
+    entry.sendTimeUs = sendTimeUs;
+
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void RetransmitRing::storePacket(uint32_t frameId, uint16_t packetId, const uint8_t* header, size_t headerSize,
+                                 const uint8_t* payload, size_t payloadSize) {
+    if (headerSize + payloadSize > maxPacketSize) {
+        return;
+    }
+
+    size_t index = static_cast<size_t>((currentFramePosition + packetId) % packetCapacity);
+    PacketSlot& slot = packetSlots[index];
+    uint8_t* data = packetData.data() + index * maxPacketSize;
+
+    uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.frameId = frameId;
+    slot.packetId = packetId;
+    slot.size = static_cast<uint32_t>(headerSize + payloadSize);
+    memcpy(data, header, headerSize);
+    memcpy(data + headerSize, payload, payloadSize);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool RetransmitRing::findFrame(uint32_t frameId, uint64_t& sendTimeUs, uint16_t& packetCount) const {
+    if (frameCapacity == 0) {
+        return false;
+    }
+
+    const FrameEntry& entry = frameEntries[frameId % frameCapacity];
+    uint32_t before = entry.sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+
+    uint32_t storedFrameId = entry.frameId;
+    uint16_t storedPacketCount = entry.packetCount;
+    uint64_t storedSendTime = entry.sendTimeUs;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.sequence.load(std::memory_order_relaxed) != before || storedFrameId != frameId || before == 0) {
+        return false;
+    }
+
+    sendTimeUs = storedSendTime;
+    packetCount = storedPacketCount;
+    return true;
+}
+
+bool RetransmitRing::readPacket(uint32_t frameId, uint16_t packetId, uint8_t* packet, size_t& size) const {
+    if (frameCapacity == 0) {
+        return false;
+    }
+
+    // 先从帧索引得到分包位置
+    const FrameEntry& entry = frameEntries[frameId % frameCapacity];
+    uint32_t frameBefore = entry.sequence.load(std::memory_order_acquire);
+    if (frameBefore & 1) {
+        return false;
+    }
+    uint32_t storedFrameId = entry.frameId;
+    uint16_t storedPacketCount = entry.packetCount;
+    uint64_t firstPosition = entry.firstPosition;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.sequence.load(std::memory_order_relaxed) != frameBefore || storedFrameId != frameId ||
+        frameBefore == 0 || packetId >= storedPacketCount) {
+        return false;
+    }
+
+    size_t index = static_cast<size_t>((firstPosition + packetId) % packetCapacity);
+    const PacketSlot& slot = packetSlots[index];
+    const uint8_t* data = packetData.data() + index * maxPacketSize;
+
+    uint32_t before = slot.sequence.load(std::memory_order_acquire);
+    if (before & 1) {
+        return false;
+    }
+    uint32_t storedSize = slot.size;
+    bool matches = slot.frameId == frameId && slot.packetId == packetId && storedSize <= maxPacketSize;
+    if (matches) {
+        memcpy(packet, data, storedSize);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!matches || slot.sequence.load(std::memory_order_relaxed) != before) {
+        return false;
+    }
+
+    size = storedSize;
+    return true;
+}
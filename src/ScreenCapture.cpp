@@ -1,9 +1,30 @@
 #include "ScreenCapture.h"
+#include "PreciseTimer.h"
 #include <iostream>
 #include <chrono>
 #include <d3dcompiler.h>
 #pragma comment(lib, "d3dcompiler.lib")
 
+namespace {
+
+// DXGI的呈现时刻是QueryPerformanceCounter计数：按它距当前计数的时长换算到timing::nowMicros()的时钟
+uint64_t presentTimeMicros(int64_t presentQpc, uint64_t nowUs) {
+    if (presentQpc == 0) {
+        return 0;
+    }
+    LARGE_INTEGER counter;
+    LARGE_INTEGER frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    int64_t ageUs = (counter.QuadPart - presentQpc) * 1000000 / frequency.QuadPart;
+    if (ageUs < 0 || static_cast<uint64_t>(ageUs) > nowUs) {
+        return 0;
+    }
+    return nowUs - static_cast<uint64_t>(ageUs);
+}
+
+} // namespace
+
 ScreenCapture::ScreenCapture()
     : device(nullptr),
       deviceContext(nullptr),
@@ -182,6 +203,7 @@ bool ScreenCapture::captureFrame(CaptureFrame& frame) {
         std::cerr << "Failed to acquire next frame: " << hr << std::endl;
         return false;
     }
+    uint64_t acquireNs = timing::nowNanos();
     
     // 获取桌面纹理
     ID3D11Texture2D* desktopTexture = nullptr;
@@ -346,9 +368,10 @@ bool ScreenCapture::captureFrame(CaptureFrame& frame) {
     frame.texture = outputTexture;
     frame.width = outputWidth;
     frame.height = outputHeight;
-    frame.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::high_resolution_clock::now().time_since_epoch()
-    ).count();
+    frame.timestamp = timing::nowMicros();
+    frame.presentTime = presentTimeMicros(frameInfo.LastPresentTime.QuadPart, frame.timestamp);
+    frame.acquireNs = acquireNs;
+    frame.copyNs = timing::nowNanos();
     
     return true;
 }
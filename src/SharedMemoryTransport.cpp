@@ -0,0 +1,457 @@
+#include "SharedMemoryTransport.h"
+#include "H264Utils.h"
+#include "PreciseTimer.h"
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+#include <new>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <linux/futex.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <errno.h>
+    #include <time.h>
+#endif
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 门铃等待前先自旋检查的次数：生产者通常在一个帧间隔内发布，自旋能避开大部分等待系统调用
+const unsigned int kReadSpins = 2000;
+
+#ifdef _WIN32
+// 同名自动重置事件一次只唤醒一个等待者，其他消费者以该间隔轮询
+const unsigned int kWindowsWaitSliceMs = 1;
+#endif
+
+} // namespace
+
+namespace shm {
+
+Mapping::Mapping()
+    : owner(false),
+      base(nullptr),
+      length(0),
+#ifdef _WIN32
+      mappingHandle(nullptr),
+      eventHandle(nullptr) {
+#else
+      fd(-1) {
+#endif
+}
+
+Mapping::~Mapping() {
+    close();
+}
+
+bool Mapping::create(const std::string& mappingName, size_t size) {
+    close();
+    name = mappingName;
+    owner = true;
+    length = size;
+
+#ifdef _WIN32
+    std::string objectName = "Local\\" + name;
+    mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                       static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                       static_cast<DWORD>(size & 0xFFFFFFFF), objectName.c_str());
+    if (mappingHandle == nullptr) {
+        std::cerr << "Failed to create shared memory " << objectName << ": " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    eventHandle = CreateEventA(nullptr, FALSE, FALSE, (objectName + "_doorbell").c_str());
+    if (base == nullptr || eventHandle == nullptr) {
+        std::cerr << "Failed to map shared memory " << objectName << ": " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+#else
+    std::string objectName = "/" + name;
+    // 上次异常退出残留的同名对象直接替换
+    shm_unlink(objectName.c_str());
+    fd = shm_open(objectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::cerr << "Failed to create shared memory " << objectName << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << objectName << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<uint8_t*>(address);
+#endif
+
+    return true;
+}
+
+bool Mapping::open(const std::string& mappingName) {
+    close();
+    name = mappingName;
+    owner = false;
+
+#ifdef _WIN32
+    std::string objectName = "Local\\" + name;
+    mappingHandle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, objectName.c_str());
+    if (mappingHandle == nullptr) {
+        std::cerr << "Failed to open shared memory " << objectName << ": " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    eventHandle = OpenEventA(SYNCHRONIZE | EVENT_MODIFY_STATE, FALSE, (objectName + "_doorbell").c_str());
+    MEMORY_BASIC_INFORMATION info;
+    if (base == nullptr || eventHandle == nullptr || VirtualQuery(base, &info, sizeof(info)) == 0) {
+        std::cerr << "Failed to map shared memory " << objectName << ": " << GetLastError() << std::endl;
+        close();
+        return false;
+    }
+    length = info.RegionSize;
+#else
+    std::string objectName = "/" + name;
+    fd = shm_open(objectName.c_str(), O_RDWR, 0);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        std::cerr << "Failed to open shared memory " << objectName << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+    void* address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+        std::cerr << "Failed to map shared memory " << objectName << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+    base = static_cast<uint8_t*>(address);
+#endif
+
+    return true;
+}
+
+void Mapping::close() {
+#ifdef _WIN32
+    if (base != nullptr) {
+        UnmapViewOfFile(base);
+    }
+    if (eventHandle != nullptr) {
+        CloseHandle(eventHandle);
+        eventHandle = nullptr;
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+#else
+    if (base != nullptr) {
+        munmap(base, length);
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+        // 已映射的消费者不受影响，新的消费者无法再打开
+        if (owner) {
+            shm_unlink(("/" + name).c_str());
+        }
+    }
+#endif
+    base = nullptr;
+    length = 0;
+    owner = false;
+}
+
+void Mapping::wait(std::atomic<uint32_t>* doorbell, uint32_t observed, unsigned int timeoutMs) {
+#ifdef _WIN32
+    if (doorbell->load(std::memory_order_acquire) != observed) {
+        return;
+    }
+    WaitForSingleObject(eventHandle, std::min(timeoutMs, kWindowsWaitSliceMs));
+#else
+    // 跨进程futex不能使用FUTEX_PRIVATE_FLAG；值已改变时立即返回EAGAIN
+    struct timespec timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_nsec = static_cast<long>(timeoutMs % 1000) * 1000000;
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(doorbell), FUTEX_WAIT, observed, &timeout, nullptr, 0);
+#endif
+}
+
+void Mapping::wake(std::atomic<uint32_t>* doorbell) {
+#ifdef _WIN32
+    (void)doorbell;
+    SetEvent(eventHandle);
+#else
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(doorbell), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+} // namespace shm
+
+SharedMemoryWriter::SharedMemoryWriter()
+    : header(nullptr),
+      sequence(0),
+      framesWritten(0),
+      bytesWritten(0),
+      framesTooLarge(0),
+      wakeups(0),
+      keyframes(0) {
+}
+
+SharedMemoryWriter::~SharedMemoryWriter() {
+    close();
+}
+
+bool SharedMemoryWriter::create(const Config& cfg) {
+    close();
+    config = cfg;
+    config.slotCount = std::max(config.slotCount, 2u);
+    config.slotSize = std::max(config.slotSize, 4096u);
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory ring needs lock-free 64-bit atomics");
+
+    if (!mapping.create(config.name, shm::mappingSize(config.slotCount, config.slotSize))) {
+        return false;
+    }
+
+    // 新建的共享内存内容为零，原子变量直接在映射区上构造
+    header = new (mapping.data()) shm::RingHeader();
+    header->slotCount = config.slotCount;
+    header->slotSize = config.slotSize;
+    header->writeSequence.store(0, std::memory_order_relaxed);
+    header->doorbell.store(0, std::memory_order_relaxed);
+    header->waiters.store(0, std::memory_order_relaxed);
+    header->closed.store(0, std::memory_order_relaxed);
+    size_t stride = shm::slotStride(config.slotSize);
+    for (unsigned int i = 0; i < config.slotCount; i++) {
+        new (mapping.data() + sizeof(shm::RingHeader) + stride * i) shm::SlotHeader();
+    }
+    sequence = 0;
+
+    // 魔数最后写入，消费者据此判断头部已初始化
+    header->version = shm::kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = shm::kMagic;
+
+    std::cout << "Shared memory transport: " << config.name << ", " << config.slotCount << " slots of "
+              << config.slotSize << " bytes" << std::endl;
+    return true;
+}
+
+void SharedMemoryWriter::close() {
+    if (header == nullptr) {
+        return;
+    }
+
+    // 通知正在等待的消费者生产者已退出
+    header->closed.store(1, std::memory_order_release);
+    header->doorbell.fetch_add(1, std::memory_order_acq_rel);
+    mapping.wake(&header->doorbell);
+
+    header = nullptr;
+    mapping.close();
+}
+
+bool SharedMemoryWriter::write(const uint8_t* data, size_t size) {
+    if (header == nullptr || data == nullptr || size == 0) {
+        return false;
+    }
+    if (size > config.slotSize) {
+        if (framesTooLarge.fetch_add(1, std::memory_order_relaxed) == 0) {
+            std::cerr << "Frame of " << size << " bytes exceeds shared memory slot size " << config.slotSize
+                      << ", dropped" << std::endl;
+        }
+        return false;
+    }
+
+    size_t stride = shm::slotStride(config.slotSize);
+    uint8_t* slotBase = mapping.data() + sizeof(shm::RingHeader) + stride * (sequence % config.slotCount);
+    shm::SlotHeader* slot = reinterpret_cast<shm::SlotHeader*>(slotBase);
+
+    // 顺序锁：先标记写入中，数据写入必须在标记之后对消费者可见
+    slot->sequence.store(sequence * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    bool keyframe = h264::isKeyframe(data, size);
+    memcpy(slotBase + sizeof(shm::SlotHeader), data, size);
+    slot->size = static_cast<uint32_t>(size);
+    slot->flags = keyframe ? shm::kFlagKeyframe : 0;
+    slot->timestampUs = timing::nowMicros();
+
+    slot->sequence.store(sequence * 2 + 2, std::memory_order_release);
+    sequence++;
+    header->writeSequence.store(sequence, std::memory_order_release);
+
+    // 门铃计数总是递增，只有存在等待者时才进入内核
+    header->doorbell.fetch_add(1, std::memory_order_seq_cst);
+    if (header->waiters.load(std::memory_order_seq_cst) != 0) {
+        mapping.wake(&header->doorbell);
+        wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    framesWritten.fetch_add(1, std::memory_order_relaxed);
+    bytesWritten.fetch_add(size, std::memory_order_relaxed);
+    if (keyframe) {
+        keyframes.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+SharedMemoryWriter::Stats SharedMemoryWriter::getStats() const {
+    Stats stats;
+    stats.framesWritten = framesWritten.load(std::memory_order_relaxed);
+    stats.bytesWritten = bytesWritten.load(std::memory_order_relaxed);
+    stats.framesTooLarge = framesTooLarge.load(std::memory_order_relaxed);
+    stats.wakeups = wakeups.load(std::memory_order_relaxed);
+    stats.keyframes = keyframes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+SharedMemoryReader::SharedMemoryReader()
+    : header(nullptr),
+      slots(nullptr),
+      stride(0),
+      nextSequence(0) {
+    stats = Stats();
+}
+
+SharedMemoryReader::~SharedMemoryReader() {
+    close();
+}
+
+bool SharedMemoryReader::open(const std::string& name) {
+    close();
+    if (!mapping.open(name)) {
+        return false;
+    }
+
+    shm::RingHeader* ring = reinterpret_cast<shm::RingHeader*>(mapping.data());
+    if (mapping.size() < sizeof(shm::RingHeader) || ring->magic != shm::kMagic) {
+        std::cerr << "Shared memory " << name << " is not initialized" << std::endl;
+        mapping.close();
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (ring->version != shm::kVersion || ring->slotCount == 0 ||
+        mapping.size() < shm::mappingSize(ring->slotCount, ring->slotSize)) {
+        std::cerr << "Shared memory " << name << " has an incompatible layout" << std::endl;
+        mapping.close();
+        return false;
+    }
+
+    header = ring;
+    slots = mapping.data() + sizeof(shm::RingHeader);
+    stride = shm::slotStride(header->slotSize);
+    nextSequence = header->writeSequence.load(std::memory_order_acquire);
+    stats = Stats();
+
+    std::cout << "Opened shared memory " << name << ": " << header->slotCount << " slots of "
+              << header->slotSize << " bytes" << std::endl;
+    return true;
+}
+
+void SharedMemoryReader::close() {
+    header = nullptr;
+    slots = nullptr;
+    mapping.close();
+}
+
+bool SharedMemoryReader::isClosed() const {
+    return header == nullptr || header->closed.load(std::memory_order_acquire) != 0;
+}
+
+bool SharedMemoryReader::tryRead(std::vector<uint8_t>& data, FrameInfo& info) {
+    uint64_t published = header->writeSequence.load(std::memory_order_acquire);
+    while (nextSequence < published) {
+        // 落后超过一圈：最旧的槽位可能正被覆盖，直接跳到仍然完整的帧
+        if (published - nextSequence >= header->slotCount) {
+            uint64_t skipTo = published - header->slotCount + 1;
+            stats.framesSkipped += skipTo - nextSequence;
+            nextSequence = skipTo;
+        }
+
+        uint8_t* slotBase = slots + stride * (nextSequence % header->slotCount);
+        shm::SlotHeader* slot = reinterpret_cast<shm::SlotHeader*>(slotBase);
+        uint64_t expected = nextSequence * 2 + 2;
+
+        uint64_t before = slot->sequence.load(std::memory_order_acquire);
+        if (before == expected) {
+            uint32_t size = std::min(slot->size, header->slotSize);
+            uint32_t flags = slot->flags;
+            uint64_t timestampUs = slot->timestampUs;
+            data.resize(size);
+            memcpy(data.data(), slotBase + sizeof(shm::SlotHeader), size);
+
+            // 复制期间槽位未被重写才有效
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->sequence.load(std::memory_order_relaxed) == expected) {
+                info.sequence = nextSequence;
+                info.timestampUs = timestampUs;
+                info.keyframe = (flags & shm::kFlagKeyframe) != 0;
+                nextSequence++;
+                stats.framesRead++;
+                return true;
+            }
+        }
+
+        // 槽位已被更新的帧覆盖
+        stats.framesSkipped++;
+        nextSequence++;
+        published = header->writeSequence.load(std::memory_order_acquire);
+    }
+    return false;
+}
+
+bool SharedMemoryReader::read(std::vector<uint8_t>& data, FrameInfo& info, unsigned int timeoutMs) {
+    if (header == nullptr) {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < kReadSpins; i++) {
+        if (tryRead(data, info)) {
+            return true;
+        }
+    }
+
+    uint64_t deadline = timing::nowMicros() + static_cast<uint64_t>(timeoutMs) * 1000;
+    while (!isClosed()) {
+        // 先登记等待者再检查，保证生产者发布后能看到等待者并唤醒
+        uint32_t observed = header->doorbell.load(std::memory_order_seq_cst);
+        header->waiters.fetch_add(1, std::memory_order_seq_cst);
+        if (tryRead(data, info)) {
+            header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+            return true;
+        }
+
+        uint64_t now = timing::nowMicros();
+        if (now >= deadline) {
+            header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+            return false;
+        }
+        unsigned int remainingMs = static_cast<unsigned int>((deadline - now + 999) / 1000);
+        mapping.wait(&header->doorbell, observed, remainingMs);
+        header->waiters.fetch_sub(1, std::memory_order_seq_cst);
+        stats.waits++;
+
+        if (tryRead(data, info)) {
+            return true;
+        }
+    }
+
+    // 生产者关闭前发布的帧仍然读完
+    return tryRead(data, info);
+}
@@ -0,0 +1,428 @@
+#include "ThreadTuning.h"
+#include "PreciseTimer.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+
+#ifndef _WIN32
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+#endif
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 预先触碰的栈大小，小于各平台线程栈的默认大小（Windows 1MB，Linux 8MB）
+const size_t kPrefaultStackBytes = 256 * 1024;
+const size_t kPageBytes = 4096;
+
+bool isRealtime(ThreadTuning::Policy policy) {
+    return policy == ThreadTuning::Policy::Fifo || policy == ThreadTuning::Policy::RoundRobin;
+}
+
+int rtPriority(const ThreadTuning::StageConfig& config) {
+    return config.priority > 0 ? config.priority : ThreadTuning::kDefaultRtPriority;
+}
+
+void appendError(std::string& errors, const std::string& error) {
+    if (!errors.empty()) {
+        errors += "; ";
+    }
+    errors += error;
+}
+
+bool readFirstLine(const char* path, std::string& line) {
+    std::ifstream file(path);
+    return file && std::getline(file, line);
+}
+
+// "0-2,5"形式的CPU列表
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) {
+            continue;
+        }
+        try {
+            size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            // 忽略无法解析的项
+        }
+    }
+    return cpus;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return "none";
+    }
+    std::string list;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        list += (i ? "," : "") + std::to_string(cpus[i]);
+    }
+    return list;
+}
+
+// 触碰栈上的每一页，之后的调用不再因栈增长缺页
+void prefaultStack() {
+    volatile unsigned char stack[kPrefaultStackBytes];
+    for (size_t i = 0; i < kPrefaultStackBytes; i += kPageBytes) {
+        stack[i] = 0;
+    }
+    (void)stack;
+}
+
+bool setAffinity(int cpu, std::string& error) {
+#ifdef _WIN32
+    if (cpu >= static_cast<int>(sizeof(DWORD_PTR) * 8)) {
+        appendError(error, "CPU " + std::to_string(cpu) + " is outside the thread affinity mask");
+        return false;
+    }
+    if (SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu) == 0) {
+        appendError(error, "SetThreadAffinityMask(" + std::to_string(cpu) + ") failed with error " +
+                    std::to_string(GetLastError()));
+        return false;
+    }
+    return true;
+#elif defined(__linux__)
+    if (cpu >= CPU_SETSIZE) {
+        appendError(error, "CPU " + std::to_string(cpu) + " is outside the CPU set");
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (result != 0) {
+        appendError(error, "cannot pin to CPU " + std::to_string(cpu) + ": " + strerror(result));
+        return false;
+    }
+    return true;
+#else
+    appendError(error, "CPU affinity is not supported on this platform");
+    return false;
+#endif
+}
+
+bool setPolicy(ThreadTuning::Stage stage, const ThreadTuning::StageConfig& config, std::string& error) {
+#ifdef _WIN32
+    // Windows没有按线程的实时调度策略，实时策略映射为最高的线程优先级
+    int priority;
+    switch (config.policy) {
+    case ThreadTuning::Policy::Normal:
+        priority = THREAD_PRIORITY_NORMAL;
+        break;
+    case ThreadTuning::Policy::Fifo:
+    case ThreadTuning::Policy::RoundRobin:
+        priority = THREAD_PRIORITY_TIME_CRITICAL;
+        break;
+    default:
+        priority = stage == ThreadTuning::Stage::Send ? THREAD_PRIORITY_ABOVE_NORMAL : THREAD_PRIORITY_HIGHEST;
+        break;
+    }
+    if (!SetThreadPriority(GetCurrentThread(), priority)) {
+        appendError(error, "SetThreadPriority failed with error " + std::to_string(GetLastError()));
+        return false;
+    }
+    return true;
+#else
+    (void)stage;
+    if (config.policy == ThreadTuning::Policy::Default) {
+        return true;
+    }
+
+    int policy = SCHED_OTHER;
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    if (isRealtime(config.policy)) {
+        policy = config.policy == ThreadTuning::Policy::Fifo ? SCHED_FIFO : SCHED_RR;
+        param.sched_priority = std::min(std::max(rtPriority(config), sched_get_priority_min(policy)),
+                                        sched_get_priority_max(policy));
+    }
+    int result = pthread_setschedparam(pthread_self(), policy, &param);
+    if (result != 0) {
+        appendError(error, std::string("cannot set scheduling policy ") + ThreadTuning::policyName(config.policy) +
+                    ": " + strerror(result) + (result == EPERM ? " (needs CAP_SYS_NICE or RLIMIT_RTPRIO)" : ""));
+        return false;
+    }
+    return true;
+#endif
+}
+
+// 调度延迟：请求休眠intervalUs，实际醒来晚于请求时刻的量
+LatencyHistogram probeWakeLatency(unsigned int iterations, unsigned int intervalUs) {
+    LatencyHistogram histogram;
+    histogram.clear();
+    for (unsigned int i = 0; i < iterations; i++) {
+        uint64_t target = timing::nowMicros() + intervalUs;
+        std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+        uint64_t woke = timing::nowMicros();
+        histogram.record(woke > target ? static_cast<int64_t>(woke - target) : 0);
+    }
+    return histogram;
+}
+
+} // namespace
+
+ThreadTuning::ThreadTuning()
+    : memoryLocked(false) {
+}
+
+void ThreadTuning::configure(const Config& config) {
+    this->config = config;
+    memoryLocked = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        warnings.clear();
+        reports.clear();
+    }
+
+    // 调度延迟的测量依赖系统时钟分辨率
+    timing::enableHighResolution();
+    checkConfig();
+
+    if (config.lockMemory) {
+        std::string error;
+        memoryLocked = lockProcessMemory(error);
+        if (!memoryLocked) {
+            warn("Memory not locked: " + error);
+        }
+    }
+}
+
+void ThreadTuning::checkConfig() {
+    unsigned int cpuCount = std::thread::hardware_concurrency();
+    std::vector<int> isolated = isolatedCpus();
+    bool anyRealtime = false;
+
+    for (unsigned int i = 0; i < kStages; i++) {
+        const StageConfig& stage = config.stages[i];
+        std::string name = stageName(static_cast<Stage>(i));
+        if (isRealtime(stage.policy)) {
+            anyRealtime = true;
+            if (stage.cpu < 0) {
+                warn(name + " thread uses " + policyName(stage.policy) +
+                     " without CPU affinity; pin it to an isolated core to keep other work off its CPU");
+            }
+        }
+        if (stage.cpu < 0) {
+            continue;
+        }
+        if (cpuCount > 0 && stage.cpu >= static_cast<int>(cpuCount)) {
+            warn(name + " thread is pinned to CPU " + std::to_string(stage.cpu) + ", but only " +
+                 std::to_string(cpuCount) + " CPUs are present");
+            continue;
+        }
+#ifdef __linux__
+        if (std::find(isolated.begin(), isolated.end(), stage.cpu) == isolated.end()) {
+            warn(name + " thread is pinned to CPU " + std::to_string(stage.cpu) + ", which is not isolated (isolated CPUs: " +
+                 formatCpuList(isolated) + "); other processes can still be scheduled there");
+        }
+#endif
+        // 同一核上的两个实时线程：优先级低的要等另一个阻塞后才能运行
+        for (unsigned int j = 0; j < i; j++) {
+            const StageConfig& other = config.stages[j];
+            if (other.cpu == stage.cpu && isRealtime(stage.policy) && isRealtime(other.policy)) {
+                warn(std::string(stageName(static_cast<Stage>(j))) + " and " + name + " threads share CPU " +
+                     std::to_string(stage.cpu) + " with real-time priority; one waits until the other blocks");
+            }
+        }
+    }
+
+#ifdef __linux__
+    // 实时调度限流：实时线程在每个周期内的运行时间超过限额后被暂停到周期结束
+    std::string runtime;
+    std::string period;
+    if (anyRealtime && readFirstLine("/proc/sys/kernel/sched_rt_runtime_us", runtime) && runtime != "-1" &&
+        readFirstLine("/proc/sys/kernel/sched_rt_period_us", period)) {
+        warn("Real-time throttling is active: real-time threads may run " + runtime + " us of every " + period +
+             " us (sched_rt_runtime_us = -1 disables it)");
+    }
+#else
+    (void)anyRealtime;
+    (void)isolated;
+#endif
+}
+
+bool ThreadTuning::lockProcessMemory(std::string& error) {
+#ifdef _WIN32
+    error = "memory locking is not supported on Windows, thread stacks are only pre-faulted";
+    return false;
+#else
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        error = std::string("mlockall failed: ") + strerror(errno) + " (needs CAP_IPC_LOCK or a larger RLIMIT_MEMLOCK)";
+        return false;
+    }
+    return true;
+#endif
+}
+
+void ThreadTuning::applyToCurrentThread(Stage stage, const std::string& name) {
+    const StageConfig& stageConfig = config.stage(stage);
+
+    ThreadReport report;
+    report.name = name;
+    report.stage = stage;
+    report.cpu = -1;
+    report.policy = Policy::Default;
+    report.priority = 0;
+
+    if (stageConfig.cpu >= 0 && setAffinity(stageConfig.cpu, report.error)) {
+        report.cpu = stageConfig.cpu;
+    }
+    if (setPolicy(stage, stageConfig, report.error)) {
+        report.policy = stageConfig.policy;
+        report.priority = isRealtime(stageConfig.policy) ? rtPriority(stageConfig) : 0;
+    }
+    if (config.lockMemory) {
+        prefaultStack();
+    }
+
+    // 在新的设置下测量：绑定到未隔离的核或未能使用实时策略时，尾部延迟明显变大
+    report.wakeLatency.clear();
+    if (config.probeIterations > 0) {
+        report.wakeLatency = probeWakeLatency(config.probeIterations, config.probeIntervalUs);
+    }
+
+    if (!report.error.empty()) {
+        std::cerr << "Warning: " << name << " thread: " << report.error << std::endl;
+    }
+    std::cout << name << " thread: cpu " << (report.cpu >= 0 ? std::to_string(report.cpu) : "any")
+              << ", policy " << policyName(report.policy);
+    if (report.priority > 0) {
+        std::cout << " (priority " << report.priority << ")";
+    }
+    if (config.lockMemory) {
+        std::cout << (memoryLocked ? ", memory locked" : ", stack pre-faulted");
+    }
+    if (report.wakeLatency.count > 0) {
+        std::cout << "; scheduling latency p50 " << report.wakeLatency.percentile(0.5)
+                  << " us, p99 " << report.wakeLatency.percentile(0.99)
+                  << " us, max " << report.wakeLatency.maxUs << " us";
+    }
+    std::cout << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    reports.push_back(report);
+}
+
+std::vector<std::string> ThreadTuning::getWarnings() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return warnings;
+}
+
+std::vector<ThreadTuning::ThreadReport> ThreadTuning::getReports() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return reports;
+}
+
+void ThreadTuning::warn(const std::string& message) {
+    std::lock_guard<std::mutex> lock(mutex);
+    warnings.push_back(message);
+}
+
+const char* ThreadTuning::stageName(Stage stage) {
+    switch (stage) {
+    case Stage::Capture: return "capture";
+    case Stage::Encode: return "encode";
+    case Stage::Send: return "send";
+    default: return "unknown";
+    }
+}
+
+const char* ThreadTuning::policyName(Policy policy) {
+    switch (policy) {
+    case Policy::Default: return "default";
+    case Policy::Normal: return "normal";
+    case Policy::Fifo: return "fifo";
+    case Policy::RoundRobin: return "rr";
+    default: return "unknown";
+    }
+}
+
+bool ThreadTuning::parseStage(const std::string& spec, StageConfig& result) {
+    std::vector<std::string> fields;
+    std::stringstream stream(spec);
+    std::string field;
+    while (std::getline(stream, field, ':')) {
+        fields.push_back(field);
+    }
+    if (fields.empty() || fields.size() > 3) {
+        return false;
+    }
+
+    StageConfig parsed;
+    try {
+        if (fields[0] != "any" && !fields[0].empty()) {
+            size_t used = 0;
+            parsed.cpu = std::stoi(fields[0], &used);
+            if (used != fields[0].size() || parsed.cpu < 0) {
+                return false;
+            }
+        }
+
+        if (fields.size() > 1) {
+            const std::string& policy = fields[1];
+            if (policy == "default") {
+                parsed.policy = Policy::Default;
+            } else if (policy == "normal") {
+                parsed.policy = Policy::Normal;
+            } else if (policy == "fifo") {
+                parsed.policy = Policy::Fifo;
+            } else if (policy == "rr") {
+                parsed.policy = Policy::RoundRobin;
+            } else {
+                return false;
+            }
+        }
+
+        // 优先级只对实时策略有意义
+        if (fields.size() > 2) {
+            size_t used = 0;
+            parsed.priority = std::stoi(fields[2], &used);
+            if (used != fields[2].size() || !isRealtime(parsed.policy) || parsed.priority < 1 || parsed.priority > 99) {
+                return false;
+            }
+        }
+    } catch (const std::exception&) {
+        return false;
+    }
+
+    result = parsed;
+    return true;
+}
+
+std::string ThreadTuning::formatStage(const StageConfig& config) {
+    std::string spec = config.cpu >= 0 ? std::to_string(config.cpu) : "any";
+    if (config.policy != Policy::Default) {
+        spec += std::string(":") + policyName(config.policy);
+        if (isRealtime(config.policy)) {
+            spec += ":" + std::to_string(rtPriority(config));
+        }
+    }
+    return spec;
+}
+
+std::vector<int> ThreadTuning::isolatedCpus() {
+#ifdef __linux__
+    std::string list;
+    if (readFirstLine("/sys/devices/system/cpu/isolated", list)) {
+        return parseCpuList(list);
+    }
+#endif
+    return std::vector<int>();
+}
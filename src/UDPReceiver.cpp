@@ -0,0 +1,923 @@
+#include "UDPReceiver.h"
+#include "FecCodec.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+// 取消Windows宏定义，避免与std::min/std::max冲突
+#undef min
+#undef max
+
+namespace {
+
+// 发送端时间戳与本地时间均为steady_clock微秒：同一主机上可直接相减，跨主机时经时钟同步换算
+
+// 单次recvmmsg接收的最大分包数
+const unsigned int kReceiveBatch = 32;
+// 接收线程检查退出标志的间隔
+const unsigned int kReceiveTimeoutMs = 50;
+
+uint64_t steadyMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+// 启动时以较短间隔连续发送的时钟同步探测数
+const unsigned int kClockFastProbes = 8;
+const unsigned int kClockFastIntervalUs = 50000;
+
+// frameId按uint32回绕比较：a是否比b新
+bool isNewer(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) > 0;
+}
+
+} // namespace
+
+UDPReceiver::UDPReceiver()
+    : cellSize(0),
+      sock(INVALID_SOCKET),
+      running(false),
+      streamStarted(false),
+      firstFrameId(0),
+      highestFrameId(0),
+      highestPacketId(0),
+      anyDelivered(false),
+      lastDeliveredFrameId(0),
+      haveTransit(false),
+      lastTransitUs(0),
+      baseTransitUs(0),
+      jitterUs(0.0),
+      haveSender(false),
+      nackRttUs(0.0),
+      reportSequence(0),
+      reportStartTime(0),
+      reportPacketsExpected(0),
+      reportPacketsReceived(0),
+      reportBytesReceived(0),
+      reportTransitOrigin(0),
+      reportSamples(0),
+      reportSumX(0.0),
+      reportSumY(0.0),
+      reportSumXY(0.0),
+      reportSumXX(0.0),
+      clockSequence(0),
+      lastClockProbeTime(0),
+      totalCompletionLatencyUs(0),
+      totalBufferDelayUs(0) {
+    memset(&stats, 0, sizeof(stats));
+    memset(&senderAddr, 0, sizeof(senderAddr));
+
+    // 初始化Winsock
+    if (!net::startup()) {
+        std::cerr << "WSAStartup failed: " << net::lastError() << std::endl;
+    }
+}
+
+UDPReceiver::~UDPReceiver() {
+    stop();
+    // 清理Winsock
+    net::cleanup();
+}
+
+bool UDPReceiver::initialize(const Config& config) {
+    this->config = config;
+
+    if (config.maxPacketSize <= sizeof(UDPTransmitter::PacketHeader) || config.frameSlots == 0 ||
+        config.maxPacketsPerFrame == 0 || config.maxPacketsPerFrame > 0x10000) {
+        std::cerr << "Invalid receiver configuration" << std::endl;
+        return false;
+    }
+    if (config.reportIntervalUs != 0 && config.nackPort == 0) {
+        std::cerr << "Receiver reports require a sender feedback port" << std::endl;
+        return false;
+    }
+    // 时钟同步探测同样发往反馈端口，未配置时关闭
+    if (config.nackPort == 0) {
+        this->config.clockSyncIntervalUs = 0;
+    }
+    cellSize = config.maxPacketSize - sizeof(UDPTransmitter::PacketHeader);
+
+    // 创建UDP套接字
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) {
+        std::cerr << "Failed to create socket: " << net::lastError() << std::endl;
+        return false;
+    }
+
+    if (!net::setReceiveBufferSize(sock, config.socketBufferSize)) {
+        std::cerr << "Failed to set receive buffer size: " << net::lastError() << std::endl;
+        // 继续执行，使用系统默认缓冲区
+    }
+    // 启用NACK时缩短接收超时，保证尾部丢包也能及时请求重传
+    unsigned int timeoutMs = kReceiveTimeoutMs;
+    if (config.nackPort != 0) {
+        timeoutMs = std::max(config.nackDelayUs / 1000, 1u);
+    }
+    if (config.reportIntervalUs != 0) {
+        timeoutMs = std::min(timeoutMs, std::max(config.reportIntervalUs / 1000, 1u));
+    }
+    if (!net::setReceiveTimeout(sock, timeoutMs)) {
+        std::cerr << "Failed to set receive timeout: " << net::lastError() << std::endl;
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+        std::cerr << "Failed to bind port " << config.port << ": " << net::lastError() << std::endl;
+        net::closeSocket(sock);
+        sock = INVALID_SOCKET;
+        return false;
+    }
+
+    // 预分配全部帧槽位和接收缓冲区，接收路径上不再分配内存
+    slots.resize(config.frameSlots);
+    for (FrameSlot& slot : slots) {
+        slot.state = SlotState::Empty;
+        slot.cells.assign(static_cast<size_t>(config.maxPacketsPerFrame) * cellSize, 0);
+        slot.present.assign(config.maxPacketsPerFrame, 0);
+        slot.groupDataReceived.assign(256, 0);
+        slot.groupParityReceived.assign(256, 0);
+    }
+    receiveBuffers.assign(static_cast<size_t>(kReceiveBatch) * (config.maxPacketSize + 1), 0);
+
+    return true;
+}
+
+void UDPReceiver::start() {
+    if (running || sock == INVALID_SOCKET) {
+        return;
+    }
+
+    running = true;
+    receiveThread = std::thread(&UDPReceiver::receiveThreadFunc, this);
+}
+
+void UDPReceiver::stop() {
+    if (running) {
+        running = false;
+        frameReady.notify_all();
+        if (receiveThread.joinable()) {
+            receiveThread.join();
+        }
+    }
+
+    if (sock != INVALID_SOCKET) {
+        net::closeSocket(sock);
+        sock = INVALID_SOCKET;
+    }
+}
+
+void UDPReceiver::receiveThreadFunc() {
+    // 多接收1字节用于识别超长分包
+    const size_t bufferSize = config.maxPacketSize + 1;
+
+#ifdef __linux__
+    mmsghdr messages[kReceiveBatch];
+    iovec iov[kReceiveBatch];
+    sockaddr_in addresses[kReceiveBatch];
+    for (unsigned int i = 0; i < kReceiveBatch; i++) {
+        iov[i].iov_base = receiveBuffers.data() + i * bufferSize;
+        iov[i].iov_len = bufferSize;
+    }
+
+    while (running) {
+        memset(messages, 0, sizeof(messages));
+        for (unsigned int i = 0; i < kReceiveBatch; i++) {
+            messages[i].msg_hdr.msg_iov = &iov[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &addresses[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+        }
+
+        // 阻塞等待第一个分包，之后取走已到达的全部分包
+        int count = recvmmsg(sock, messages, kReceiveBatch, MSG_WAITFORONE, nullptr);
+
+        uint64_t now = steadyMicros();
+        std::lock_guard<std::mutex> lock(slotMutex);
+        for (int i = 0; i < count; i++) {
+            handlePacket(receiveBuffers.data() + i * bufferSize, messages[i].msg_len, addresses[i], now);
+        }
+        sendNacks(now);
+        sendReport(now);
+        sendClockProbe(now);
+    }
+#else
+    char* buffer = reinterpret_cast<char*>(receiveBuffers.data());
+
+    while (running) {
+        sockaddr_in from;
+        int fromLength = sizeof(from);
+        int received = recvfrom(sock, buffer, static_cast<int>(bufferSize), 0,
+                                reinterpret_cast<sockaddr*>(&from), &fromLength);
+
+        uint64_t now = steadyMicros();
+        std::lock_guard<std::mutex> lock(slotMutex);
+        if (received > 0) {
+            handlePacket(receiveBuffers.data(), received, from, now);
+        }
+        sendNacks(now);
+        sendReport(now);
+        sendClockProbe(now);
+    }
+#endif
+}
+
+void UDPReceiver::handlePacket(const uint8_t* packet, size_t size, const sockaddr_in& from, uint64_t now) {
+    const size_t headerSize = sizeof(UDPTransmitter::PacketHeader);
+
+    // 时钟同步应答与媒体包共用流套接字，按长度和magic识别
+    if (size == sizeof(UDPTransmitter::ClockReply)) {
+        uint32_t magic;
+        memcpy(&magic, packet, sizeof(magic));
+        if (magic == UDPTransmitter::kClockReplyMagic) {
+            handleClockReply(packet, now);
+            return;
+        }
+    }
+
+    // 路径MTU探测同样经流套接字到达，magic和校验字同时匹配才识别为探测
+    if (size >= sizeof(PathMtuDiscovery::Probe)) {
+        PathMtuDiscovery::Probe probe;
+        memcpy(&probe, packet, sizeof(probe));
+        if (probe.magic == PathMtuDiscovery::kProbeMagic && probe.check == ~PathMtuDiscovery::kProbeMagic) {
+            handlePathMtuProbe(probe, size, from);
+            return;
+        }
+    }
+
+    if (size < headerSize || size > config.maxPacketSize) {
+        stats.packetsInvalid++;
+        return;
+    }
+
+    UDPTransmitter::PacketHeader header;
+    memcpy(&header, packet, headerSize);
+    const uint8_t* payload = packet + headerSize;
+    uint32_t payloadSize = static_cast<uint32_t>(size - headerSize);
+
+    // 校验包头：分组参数决定整帧占用的分包数，必须能放入一个槽位；每组数据包和校验包合计不超过FEC分片上限
+    bool parity = (header.flags & UDPTransmitter::PACKET_FLAG_PARITY) != 0;
+    bool fec = header.fecGroupSize > 0 && header.fecGroupParity > 0;
+    size_t groupCount = fec ? (header.packetCount + header.fecGroupSize - 1) / header.fecGroupSize : 0;
+    size_t totalPackets = header.packetCount + groupCount * header.fecGroupParity;
+    if (header.packetCount == 0 || totalPackets > config.maxPacketsPerFrame ||
+        header.packetId >= totalPackets || parity != (header.packetId >= header.packetCount) ||
+        (parity && !fec) || groupCount > 256 ||
+        (fec && static_cast<unsigned int>(header.fecGroupSize) + header.fecGroupParity > FecCodec::kMaxShards)) {
+        stats.packetsInvalid++;
+        return;
+    }
+
+    stats.packetsReceived++;
+    stats.bytesReceived += size;
+    reportBytesReceived += static_cast<uint32_t>(size);
+    if (parity) {
+        stats.parityPacketsReceived++;
+    }
+
+    // NACK发往数据包来源主机的反馈端口
+    bool retransmit = (header.flags & UDPTransmitter::PACKET_FLAG_RETRANSMIT) != 0;
+    if (retransmit) {
+        stats.packetsRetransmitReceived++;
+    } else {
+        senderAddr = from;
+        senderAddr.sin_port = htons(config.nackPort);
+        haveSender = true;
+        reportPacketsReceived++;
+    }
+
+    // 帧内的发送位置：交织发送的帧按发送端的顺序换算，否则即packetId
+    uint16_t position = header.packetId;
+    if (header.flags & UDPTransmitter::PACKET_FLAG_INTERLEAVED) {
+        position = static_cast<uint16_t>(PacketInterleaver::sendPosition(header.packetId, header.packetCount,
+                                                                         header.fecGroupSize, header.fecGroupParity));
+    }
+
+    // 乱序统计：按(frameId, 发送位置)与已见到的最大位置比较，重传包不计入
+    if (!retransmit) {
+        if (!streamStarted) {
+            streamStarted = true;
+            firstFrameId = header.frameId;
+            highestFrameId = header.frameId;
+            highestPacketId = position;
+        } else if (isNewer(highestFrameId, header.frameId) ||
+                   (highestFrameId == header.frameId && position < highestPacketId)) {
+            stats.packetsReordered++;
+        } else {
+            highestFrameId = header.frameId;
+            highestPacketId = position;
+        }
+    }
+
+    // 所属帧或更新的帧已交付（帧完整后到达的校验包属正常情况，不计入）
+    if (anyDelivered && !isNewer(header.frameId, lastDeliveredFrameId)) {
+        if (!parity) {
+            stats.packetsLate++;
+        }
+        return;
+    }
+
+    // 重传包只补齐仍在重组的帧，不重新打开已淘汰的帧
+    FrameSlot* slot = acquireSlot(header, !retransmit, now);
+    if (!slot) {
+        stats.packetsLate++;
+        return;
+    }
+
+    // 同一帧的分包数和分组参数必须与槽位按首包记录的一致，否则分组换算会越界
+    if (header.packetCount != slot->packetCount || header.fecGroupSize != slot->fecGroupSize ||
+        header.fecGroupParity != slot->fecGroupParity) {
+        stats.packetsInvalid++;
+        return;
+    }
+
+    if (!retransmit) {
+        notePacketPosition(*slot, position);
+    }
+
+    if (slot->state == SlotState::Complete) {
+        // 帧已完整（通常是FEC恢复后到达的数据包或多余的校验包）
+        return;
+    }
+    if (slot->present[header.packetId]) {
+        stats.packetsDuplicate++;
+        return;
+    }
+
+    // 分包负载大小：非末尾数据包和校验包都等于发送端的分包负载
+    bool fullSize = parity || header.packetId + 1 < header.packetCount;
+    if (fullSize) {
+        if (slot->payloadStride == 0) {
+            slot->payloadStride = payloadSize;
+        } else if (slot->payloadStride != payloadSize) {
+            stats.packetsInvalid++;
+            return;
+        }
+    }
+
+    // 存入单元，不足部分补0供FEC解码使用
+    uint8_t* cell = slot->cells.data() + static_cast<size_t>(header.packetId) * cellSize;
+    memcpy(cell, payload, payloadSize);
+    if (payloadSize < cellSize) {
+        memset(cell + payloadSize, 0, cellSize - payloadSize);
+    }
+    slot->present[header.packetId] = 1;
+    slot->lastPacketTime = now;
+    if (!parity && header.packetId + 1 == header.packetCount) {
+        slot->lastPayloadSize = static_cast<int32_t>(payloadSize);
+    }
+
+    if (retransmit) {
+        slot->retransmitted = true;
+        if (slot->lastNackTime != 0) {
+            double sample = static_cast<double>(now - slot->lastNackTime);
+            nackRttUs = nackRttUs == 0.0 ? sample : nackRttUs + (sample - nackRttUs) / 8.0;
+        }
+    }
+
+    unsigned int group = 0;
+    if (parity) {
+        group = (header.packetId - header.packetCount) / header.fecGroupParity;
+        slot->groupParityReceived[group]++;
+    } else {
+        slot->dataReceived++;
+        if (fec) {
+            group = header.packetId / header.fecGroupSize;
+            slot->groupDataReceived[group]++;
+        }
+    }
+
+    // 组内缺失的数据包数不超过已收到的校验包数时即可恢复
+    if (fec) {
+        unsigned int k = groupDataCount(*slot, group);
+        unsigned int dataCount = slot->groupDataReceived[group];
+        unsigned int parityCount = slot->groupParityReceived[group];
+        if (dataCount < k && parityCount > 0 && dataCount + parityCount >= k) {
+            recoverGroup(*slot, group);
+        }
+    }
+
+    if (slot->dataReceived == slot->packetCount) {
+        completeFrame(*slot, now);
+    }
+}
+
+UDPReceiver::FrameSlot* UDPReceiver::acquireSlot(const UDPTransmitter::PacketHeader& header, bool create,
+                                                 uint64_t now) {
+    FrameSlot& slot = slots[header.frameId % slots.size()];
+
+    if (slot.state != SlotState::Empty) {
+        if (slot.frameId == header.frameId) {
+            return &slot;
+        }
+        if (isNewer(slot.frameId, header.frameId)) {
+            // 槽位已被更新的帧占用
+            return nullptr;
+        }
+    }
+    if (!create) {
+        return nullptr;
+    }
+    if (slot.state != SlotState::Empty) {
+        releaseSlot(slot);
+    }
+
+    slot.state = SlotState::Assembling;
+    slot.frameId = header.frameId;
+    slot.packetCount = header.packetCount;
+    slot.frameSize = header.frameSize;
+    slot.timestamp = header.timestamp;
+    slot.flags = header.flags & ~(UDPTransmitter::PACKET_FLAG_PARITY | UDPTransmitter::PACKET_FLAG_RETRANSMIT);
+    slot.fecGroupSize = header.fecGroupSize;
+    slot.fecGroupParity = header.fecGroupParity;
+    slot.payloadStride = 0;
+    slot.lastPayloadSize = -1;
+    slot.dataReceived = 0;
+    slot.dataRecovered = 0;
+    slot.firstPacketTime = now;
+    slot.completeTime = 0;
+    slot.transitUs = 0;
+    slot.endToEndUs = 0;
+    slot.clockSynchronized = false;
+    slot.lastPacketTime = now;
+    slot.nackCount = 0;
+    slot.lastNackTime = 0;
+    slot.retransmitted = false;
+    slot.totalPackets = header.packetCount;
+    if (header.fecGroupSize > 0) {
+        slot.totalPackets += (header.packetCount + header.fecGroupSize - 1) / header.fecGroupSize * header.fecGroupParity;
+    }
+    slot.reportedPackets = 0;
+    std::fill(slot.present.begin(), slot.present.end(), 0);
+    std::fill(slot.groupDataReceived.begin(), slot.groupDataReceived.end(), 0);
+    std::fill(slot.groupParityReceived.begin(), slot.groupParityReceived.end(), 0);
+
+    noteFrameStart(header, now);
+    return &slot;
+}
+
+void UDPReceiver::releaseSlot(FrameSlot& slot) {
+    notePacketPosition(slot, slot.totalPackets - 1);
+    if (slot.state == SlotState::Assembling) {
+        stats.packetsLost += slot.packetCount - (slot.dataReceived - slot.dataRecovered);
+    } else if (slot.state == SlotState::Complete) {
+        stats.framesSkipped++;
+    }
+    slot.state = SlotState::Empty;
+}
+
+unsigned int UDPReceiver::groupDataCount(const FrameSlot& slot, unsigned int group) const {
+    unsigned int first = group * slot.fecGroupSize;
+    return std::min<unsigned int>(slot.fecGroupSize, slot.packetCount - first);
+}
+
+void UDPReceiver::recoverGroup(FrameSlot& slot, unsigned int group) {
+    if (slot.payloadStride == 0 || slot.payloadStride > cellSize) {
+        return;
+    }
+
+    unsigned int first = group * slot.fecGroupSize;
+    unsigned int k = groupDataCount(slot, group);
+    unsigned int m = slot.fecGroupParity;
+
+    uint8_t* shards[FecCodec::kMaxShards];
+    bool present[FecCodec::kMaxShards];
+    for (unsigned int i = 0; i < k; i++) {
+        shards[i] = slot.cells.data() + static_cast<size_t>(first + i) * cellSize;
+        present[i] = slot.present[first + i] != 0;
+    }
+    for (unsigned int j = 0; j < m; j++) {
+        unsigned int packetId = slot.packetCount + group * m + j;
+        shards[k + j] = slot.cells.data() + static_cast<size_t>(packetId) * cellSize;
+        present[k + j] = slot.present[packetId] != 0;
+    }
+
+    FecCodec::Mode mode = (slot.flags & UDPTransmitter::PACKET_FLAG_FEC_XOR)
+        ? FecCodec::Mode::Xor : FecCodec::Mode::ReedSolomon;
+    if (!FecCodec::decode(mode, shards, present, k, m, slot.payloadStride)) {
+        return;
+    }
+
+    for (unsigned int i = 0; i < k; i++) {
+        if (!present[i]) {
+            slot.present[first + i] = 1;
+            slot.dataReceived++;
+            slot.dataRecovered++;
+            slot.groupDataReceived[group]++;
+            stats.packetsRecovered++;
+        }
+    }
+
+    // 校验包已被解码改写为校正子，本组不再需要
+    for (unsigned int j = 0; j < m; j++) {
+        slot.present[slot.packetCount + group * m + j] = 1;
+    }
+}
+
+void UDPReceiver::completeFrame(FrameSlot& slot, uint64_t now) {
+    // 帧大小必须与分包数和分包负载一致，否则无法还原：不超过全部单元的容量；
+    // 直接收到末尾数据包时须等于前面的整包加末包负载，末包经FEC恢复时须落在最后一个分包的范围内
+    uint64_t leading = static_cast<uint64_t>(slot.packetCount - 1) * slot.payloadStride;
+    bool valid = slot.frameSize <= static_cast<uint64_t>(slot.packetCount) * cellSize;
+    if (slot.lastPayloadSize >= 0) {
+        valid = valid && slot.frameSize == leading + static_cast<uint64_t>(slot.lastPayloadSize);
+    }
+    if (slot.packetCount > 1 || slot.lastPayloadSize < 0) {
+        valid = valid && slot.frameSize > leading && slot.frameSize <= leading + slot.payloadStride;
+    }
+    if (!valid) {
+        stats.packetsInvalid++;
+        releaseSlot(slot);
+        return;
+    }
+
+    slot.state = SlotState::Complete;
+    slot.completeTime = now;
+    slot.transitUs = static_cast<int64_t>(now - slot.timestamp);
+    slot.clockSynchronized = clockSync.isSynchronized();
+    slot.endToEndUs = slot.clockSynchronized
+        ? static_cast<int64_t>(clockSync.toRemote(now) - slot.timestamp) : slot.transitUs;
+
+    stats.framesCompleted++;
+    if (slot.dataRecovered > 0) {
+        stats.framesRecovered++;
+    }
+    if (slot.retransmitted) {
+        stats.framesRetransmitted++;
+    }
+
+    uint32_t completionLatency = static_cast<uint32_t>(now - slot.firstPacketTime);
+    totalCompletionLatencyUs += completionLatency;
+    stats.maxCompletionLatencyUs = std::max(stats.maxCompletionLatencyUs, completionLatency);
+    stats.completionHistogram.record(completionLatency);
+    // 启用时钟同步时，同步完成前的帧含未知的时钟偏差，不计入
+    if (slot.clockSynchronized || config.clockSyncIntervalUs == 0) {
+        stats.endToEndHistogram.record(slot.endToEndUs);
+    }
+
+    // 到达抖动（RFC 3550）：相邻完整帧传输时间差的平滑值。
+    // 基准传输时间取最小值并缓慢上移，以跟随两端时钟的相对漂移。
+    // 重传补齐的帧额外延迟已由NACK延迟下限覆盖，不参与估计
+    if (!slot.retransmitted) {
+        if (haveTransit) {
+            double difference = std::fabs(static_cast<double>(slot.transitUs - lastTransitUs));
+            jitterUs += (difference - jitterUs) / 16.0;
+            if (slot.transitUs < baseTransitUs) {
+                baseTransitUs = slot.transitUs;
+            } else {
+                baseTransitUs += (slot.transitUs - baseTransitUs) / 256;
+            }
+        } else {
+            haveTransit = true;
+            baseTransitUs = slot.transitUs;
+        }
+        lastTransitUs = slot.transitUs;
+    }
+
+    // 最新完整帧优先：更早的未完成帧不再等待（仍可通过NACK补齐的除外）
+    abandonOlderFrames(slot.frameId, now);
+
+    frameReady.notify_one();
+}
+
+void UDPReceiver::abandonOlderFrames(uint32_t frameId, uint64_t now) {
+    for (FrameSlot& slot : slots) {
+        if (slot.state == SlotState::Assembling && isNewer(frameId, slot.frameId) && !isRepairable(slot, now)) {
+            releaseSlot(slot);
+        }
+    }
+}
+
+bool UDPReceiver::isRepairable(const FrameSlot& slot, uint64_t now) const {
+    return config.nackPort != 0 && slot.nackCount < config.maxNackRetries &&
+           now - slot.firstPacketTime < config.nackDeadlineUs;
+}
+
+void UDPReceiver::sendNacks(uint64_t now) {
+    if (config.nackPort == 0 || !haveSender) {
+        return;
+    }
+
+    for (FrameSlot& slot : slots) {
+        if (slot.state != SlotState::Assembling || !isRepairable(slot, now)) {
+            continue;
+        }
+        // 出现更新的帧，或帧停止到达超过nackDelayUs，才认为缺失的分包已丢失而非乱序
+        if (!isNewer(highestFrameId, slot.frameId) && now - slot.lastPacketTime < config.nackDelayUs) {
+            continue;
+        }
+        if (slot.nackCount > 0 && now - slot.lastNackTime < config.nackRetryIntervalUs) {
+            continue;
+        }
+        sendNack(slot, now);
+    }
+}
+
+void UDPReceiver::sendNack(FrameSlot& slot, uint64_t now) {
+    uint8_t message[sizeof(UDPTransmitter::NackHeader) +
+                    UDPTransmitter::kMaxNackRanges * sizeof(UDPTransmitter::NackRange)];
+    UDPTransmitter::NackHeader header;
+    header.magic = UDPTransmitter::kNackMagic;
+    header.frameId = slot.frameId;
+    header.rangeCount = 0;
+    header.reserved = 0;
+
+    auto flush = [&]() {
+        memcpy(message, &header, sizeof(header));
+        size_t size = sizeof(header) + header.rangeCount * sizeof(UDPTransmitter::NackRange);
+        sendto(sock, reinterpret_cast<const char*>(message), static_cast<int>(size), 0,
+               reinterpret_cast<const sockaddr*>(&senderAddr), sizeof(senderAddr));
+        stats.nacksSent++;
+        header.rangeCount = 0;
+    };
+
+    // 合并连续缺失的数据包为区间
+    UDPTransmitter::NackRange range;
+    range.count = 0;
+    for (unsigned int i = 0; i <= slot.packetCount; i++) {
+        bool missing = i < slot.packetCount && !slot.present[i];
+        if (missing && range.count > 0 && range.firstPacketId + range.count == i) {
+            range.count++;
+            continue;
+        }
+        if (range.count > 0) {
+            memcpy(message + sizeof(header) + header.rangeCount * sizeof(range), &range, sizeof(range));
+            stats.packetsNacked += range.count;
+            header.rangeCount++;
+            if (header.rangeCount == UDPTransmitter::kMaxNackRanges) {
+                flush();
+            }
+            range.count = 0;
+        }
+        if (missing) {
+            range.firstPacketId = static_cast<uint16_t>(i);
+            range.count = 1;
+        }
+    }
+    if (header.rangeCount > 0) {
+        flush();
+    }
+
+    slot.nackCount++;
+    slot.lastNackTime = now;
+}
+
+void UDPReceiver::noteFrameStart(const UDPTransmitter::PacketHeader& header, uint64_t now) {
+    if (config.reportIntervalUs == 0) {
+        return;
+    }
+    if (reportStartTime == 0) {
+        reportStartTime = now;
+    }
+
+    // 首包传输时间包含两端时钟偏差，只使用区间内的变化量
+    int64_t transit = static_cast<int64_t>(now - header.timestamp);
+    if (reportSamples == 0) {
+        reportTransitOrigin = transit;
+    }
+    double x = (now - reportStartTime) / 1000.0;
+    double y = static_cast<double>(transit - reportTransitOrigin);
+    reportSamples++;
+    reportSumX += x;
+    reportSumY += y;
+    reportSumXY += x * y;
+    reportSumXX += x * x;
+}
+
+void UDPReceiver::notePacketPosition(FrameSlot& slot, uint32_t packetId) {
+    // 分包按发送位置顺序发出：见到的最大位置之前的分包都应已到达，
+    // 帧结束（交付或淘汰）时补齐尾部，区间边界不会把仍在途的分包计为丢失
+    if (config.reportIntervalUs == 0 || packetId + 1 <= slot.reportedPackets) {
+        return;
+    }
+    reportPacketsExpected += packetId + 1 - slot.reportedPackets;
+    slot.reportedPackets = packetId + 1;
+}
+
+void UDPReceiver::sendReport(uint64_t now) {
+    if (config.reportIntervalUs == 0 || !haveSender || reportStartTime == 0 ||
+        now - reportStartTime < config.reportIntervalUs) {
+        return;
+    }
+
+    UDPTransmitter::ReceiverReport report;
+    report.magic = UDPTransmitter::kReportMagic;
+    report.sequence = ++reportSequence;
+    report.intervalUs = static_cast<uint32_t>(now - reportStartTime);
+    report.packetsExpected = reportPacketsExpected;
+    report.packetsReceived = std::min(reportPacketsReceived, reportPacketsExpected);
+    report.bytesReceived = reportBytesReceived;
+    report.highestFrameId = highestFrameId;
+
+    // 斜率单位为微秒/毫秒，换算为微秒/秒
+    double n = reportSamples;
+    double denominator = n * reportSumXX - reportSumX * reportSumX;
+    double slope = 0.0;
+    if (reportSamples >= 2 && denominator > 0.0) {
+        slope = (n * reportSumXY - reportSumX * reportSumY) / denominator * 1000.0;
+    }
+    report.delayGradient = static_cast<int32_t>(std::max(std::min(slope, 1e9), -1e9));
+
+    sendto(sock, reinterpret_cast<const char*>(&report), sizeof(report), 0,
+           reinterpret_cast<const sockaddr*>(&senderAddr), sizeof(senderAddr));
+    stats.reportsSent++;
+    stats.delayGradientUsPerS = report.delayGradient;
+
+    reportStartTime = now;
+    reportPacketsExpected = 0;
+    reportPacketsReceived = 0;
+    reportBytesReceived = 0;
+    reportSamples = 0;
+    reportSumX = 0.0;
+    reportSumY = 0.0;
+    reportSumXY = 0.0;
+    reportSumXX = 0.0;
+}
+
+void UDPReceiver::sendClockProbe(uint64_t now) {
+    if (config.clockSyncIntervalUs == 0 || !haveSender) {
+        return;
+    }
+    unsigned int interval = clockSequence < kClockFastProbes
+        ? std::min(kClockFastIntervalUs, config.clockSyncIntervalUs) : config.clockSyncIntervalUs;
+    if (lastClockProbeTime != 0 && now - lastClockProbeTime < interval) {
+        return;
+    }
+
+    UDPTransmitter::ClockProbe probe;
+    probe.magic = UDPTransmitter::kClockProbeMagic;
+    probe.sequence = ++clockSequence;
+    probe.originateUs = steadyMicros();
+    sendto(sock, reinterpret_cast<const char*>(&probe), sizeof(probe), 0,
+           reinterpret_cast<const sockaddr*>(&senderAddr), sizeof(senderAddr));
+    stats.clockProbesSent++;
+    lastClockProbeTime = now;
+}
+
+void UDPReceiver::handleClockReply(const uint8_t* packet, uint64_t now) {
+    UDPTransmitter::ClockReply reply;
+    memcpy(&reply, packet, sizeof(reply));
+    // 只接受本端发出过的探测的应答，且t1不晚于收到应答的时刻
+    if (config.clockSyncIntervalUs == 0 || reply.sequence == 0 || reply.sequence > clockSequence ||
+        reply.originateUs > now || reply.transmitUs < reply.receiveUs) {
+        return;
+    }
+    clockSync.addSample(reply.originateUs, reply.receiveUs, reply.transmitUs, now);
+}
+
+void UDPReceiver::handlePathMtuProbe(const PathMtuDiscovery::Probe& probe, size_t size, const sockaddr_in& from) {
+    stats.pathMtuProbesReceived++;
+
+    // 超过接收缓冲区的探测被截断，长度与声明不符时不应答，发送端因此不会选用本端无法接收的分包大小
+    if (config.nackPort == 0 || size != probe.size) {
+        return;
+    }
+
+    PathMtuDiscovery::Ack ack;
+    ack.magic = PathMtuDiscovery::kAckMagic;
+    ack.probeId = probe.probeId;
+    ack.size = probe.size;
+
+    // 探测可能先于第一个媒体包到达，应答直接发往探测来源主机的反馈端口
+    sockaddr_in target = from;
+    target.sin_port = htons(config.nackPort);
+    sendto(sock, reinterpret_cast<const char*>(&ack), sizeof(ack), 0,
+           reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+    stats.pathMtuProbesAnswered++;
+}
+
+uint32_t UDPReceiver::targetDelayUs() const {
+    double delay = config.jitterMultiplier * jitterUs;
+    delay = std::max(delay, static_cast<double>(config.minDelayUs));
+    // 启用NACK时至少留出一次重传的时间
+    if (config.nackPort != 0) {
+        delay = std::max(delay, config.nackDelayUs + 2.0 * nackRttUs);
+    }
+    delay = std::min(delay, static_cast<double>(config.maxDelayUs));
+    return static_cast<uint32_t>(delay);
+}
+
+uint64_t UDPReceiver::readyTime(const FrameSlot& slot) const {
+    // 播放时刻 = 发送时间戳 + 基准传输时间 + 目标延迟；到达较晚的帧相应少等
+    int64_t extraTransit = slot.transitUs - baseTransitUs;
+    int64_t wait = static_cast<int64_t>(targetDelayUs()) - std::max<int64_t>(extraTransit, 0);
+    return slot.completeTime + static_cast<uint64_t>(std::max<int64_t>(wait, 0));
+}
+
+UDPReceiver::FrameSlot* UDPReceiver::findDeliverableFrame(uint64_t now, uint64_t& nextReadyTime) {
+    FrameSlot* latest = nullptr;
+    nextReadyTime = UINT64_MAX;
+
+    for (FrameSlot& slot : slots) {
+        if (slot.state != SlotState::Complete) {
+            continue;
+        }
+        uint64_t ready = readyTime(slot);
+        if (ready > now) {
+            nextReadyTime = std::min(nextReadyTime, ready);
+            continue;
+        }
+        if (!latest || isNewer(slot.frameId, latest->frameId)) {
+            latest = &slot;
+        }
+    }
+
+    return latest;
+}
+
+void UDPReceiver::deliverFrame(FrameSlot& slot, ReceivedFrame& frame, uint64_t now) {
+    // 拼接分包负载；frame.data容量不足时才分配
+    frame.data.resize(slot.frameSize);
+    if (slot.packetCount == 1) {
+        memcpy(frame.data.data(), slot.cells.data(), slot.frameSize);
+    } else {
+        for (unsigned int i = 0; i < slot.packetCount; i++) {
+            size_t offset = static_cast<size_t>(i) * slot.payloadStride;
+            size_t length = std::min<size_t>(slot.payloadStride, slot.frameSize - offset);
+            memcpy(frame.data.data() + offset, slot.cells.data() + static_cast<size_t>(i) * cellSize, length);
+        }
+    }
+
+    frame.frameId = slot.frameId;
+    frame.timestamp = slot.timestamp;
+    frame.keyframe = (slot.flags & UDPTransmitter::PACKET_FLAG_KEYFRAME) != 0;
+    frame.recovered = slot.dataRecovered > 0;
+    frame.completionLatencyUs = static_cast<uint32_t>(slot.completeTime - slot.firstPacketTime);
+    frame.endToEndLatencyUs = slot.endToEndUs;
+    frame.clockSynchronized = slot.clockSynchronized;
+    frame.bufferDelayUs = static_cast<uint32_t>(now - slot.completeTime);
+
+    stats.framesDelivered++;
+    totalBufferDelayUs += frame.bufferDelayUs;
+    anyDelivered = true;
+    lastDeliveredFrameId = slot.frameId;
+    notePacketPosition(slot, slot.totalPackets - 1);
+    slot.state = SlotState::Empty;
+
+    // 更早的帧已不可能再交付
+    for (FrameSlot& other : slots) {
+        if (other.state != SlotState::Empty && !isNewer(other.frameId, lastDeliveredFrameId)) {
+            releaseSlot(other);
+        }
+    }
+}
+
+bool UDPReceiver::waitFrame(ReceivedFrame& frame, unsigned int timeoutMs) {
+    std::unique_lock<std::mutex> lock(slotMutex);
+    uint64_t deadline = steadyMicros() + static_cast<uint64_t>(timeoutMs) * 1000;
+
+    while (true) {
+        uint64_t now = steadyMicros();
+        uint64_t nextReadyTime;
+        FrameSlot* slot = findDeliverableFrame(now, nextReadyTime);
+        if (slot) {
+            deliverFrame(*slot, frame, now);
+            return true;
+        }
+        if (!running || now >= deadline) {
+            return false;
+        }
+
+        // 等待新帧完整或缓冲中的帧到达播放时刻
+        uint64_t wakeTime = std::min(deadline, nextReadyTime);
+        frameReady.wait_until(lock, std::chrono::steady_clock::time_point(std::chrono::microseconds(wakeTime)));
+    }
+}
+
+UDPReceiver::ReceiveStats UDPReceiver::getStats() {
+    std::lock_guard<std::mutex> lock(slotMutex);
+
+    ReceiveStats result = stats;
+
+    // 未收到任何分包的帧只能由frameId范围推算
+    uint64_t assembling = 0;
+    for (const FrameSlot& slot : slots) {
+        if (slot.state == SlotState::Assembling) {
+            assembling++;
+        }
+    }
+    result.framesExpected = streamStarted ? static_cast<uint64_t>(highestFrameId - firstFrameId) + 1 : 0;
+    uint64_t accounted = result.framesCompleted + assembling;
+    result.framesLost = result.framesExpected > accounted ? result.framesExpected - accounted : 0;
+
+    result.jitterUs = static_cast<uint32_t>(jitterUs);
+    result.targetDelayUs = targetDelayUs();
+    if (result.framesCompleted > 0) {
+        result.avgCompletionLatencyUs = static_cast<double>(totalCompletionLatencyUs) / result.framesCompleted;
+    }
+    result.avgEndToEndLatencyUs = stats.endToEndHistogram.mean();
+    result.maxEndToEndLatencyUs = stats.endToEndHistogram.maxUs;
+    if (result.framesDelivered > 0) {
+        result.avgBufferDelayUs = static_cast<double>(totalBufferDelayUs) / result.framesDelivered;
+    }
+    result.nackRttUs = static_cast<uint32_t>(nackRttUs);
+    result.clock = clockSync.getStats();
+
+    return result;
+}
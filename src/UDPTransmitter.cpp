@@ -1,201 +1,1351 @@
 #include "UDPTransmitter.h"
+#include "H264Utils.h"
+#include "PreciseTimer.h"
 #include <iostream>
 #include <chrono>
 #include <algorithm>
+#include <thread>
+#include <cstring>
+#include <cstddef>
+
+#ifdef __linux__
+    #include <sys/uio.h>
+    #include <linux/errqueue.h>
+    // 旧版glibc头文件中可能缺少UDP GSO和零拷贝相关定义
+    #ifndef SOL_UDP
+        #define SOL_UDP 17
+    #endif
+    #ifndef UDP_SEGMENT
+        #define UDP_SEGMENT 103
+    #endif
+    #ifndef SO_ZEROCOPY
+        #define SO_ZEROCOPY 60
+    #endif
+    #ifndef MSG_ZEROCOPY
+        #define MSG_ZEROCOPY 0x4000000
+    #endif
+    #ifndef SO_EE_ORIGIN_ZEROCOPY
+        #define SO_EE_ORIGIN_ZEROCOPY 5
+    #endif
+    #ifndef SO_EE_CODE_ZEROCOPY_COPIED
+        #define SO_EE_CODE_ZEROCOPY_COPIED 1
+    #endif
+#endif
 
 // 取消Windows宏定义，避免与std::min/std::max冲突
 #undef min
 #undef max
 
+namespace {
+
+// 单次sendmmsg提交的最大分包数
+const unsigned int kBatchSize = 64;
+// 单次GSO发送的最大分段数（内核UDP_MAX_SEGMENTS）
+const unsigned int kMaxGsoSegments = 64;
+// 单个GSO超级包的最大负载（IPv4 UDP负载上限）
+const unsigned int kMaxGsoBytes = 65507;
+// 零拷贝时每个分段的包头和负载各占至少一个页片段，而单个skb最多容纳17个片段，
+// 因此零拷贝GSO超级包只能携带少量分段
+const unsigned int kMaxZeroCopyGsoSegments = 5;
+
+} // namespace
+
 UDPTransmitter::UDPTransmitter()
     : sock(INVALID_SOCKET),
       serverPort(0),
       maxPacketSize(1400),
-      running(false) {
+      requestedBackend(SendBackend::Auto),
+      activeBackend(SendBackend::PerPacket),
+      zeroCopyRequested(false),
+      zeroCopyEnabled(false),
+      bitrateKbps(0),
+      frameRate(200),
+      running(false),
+      targetBitrateKbps(0),
+      sdpWritten(false),
+      packetSize(1400),
+      rtpPacketSize(1400),
+      feedbackSock(INVALID_SOCKET),
+      frameIdCounter(0),
+      interleaving(false),
+      zeroCopyNextSlot(0),
+      zeroCopyNextNotification(0),
+      frameSendFlags(0),
+      frameZeroCopyMessages(0),
+      framesSent(0),
+      packetsSent(0),
+      bytesSent(0),
+      packetsDropped(0),
+      blockedSends(0),
+      sendErrors(0),
+      syscalls(0),
+      totalSendTimeUs(0),
+      lastFrameSyscalls(0),
+      lastFrameSendTimeUs(0),
+      congested(false),
+      allocations(0),
+      bytesCopied(0),
+      zeroCopySends(0),
+      zeroCopyCompletions(0),
+      zeroCopyDeferredCopies(0),
+      zeroCopySlotStalls(0),
+      keyframesSent(0),
+      fecParityPackets(0),
+      fecEncodeTimeUs(0),
+      nacksReceived(0),
+      retransmitRequests(0),
+      packetsRetransmitted(0),
+      retransmitExpired(0),
+      retransmitUnavailable(0),
+      reportsReceived(0),
+      clockProbesAnswered(0),
+      packetsBuilt(0),
+      headerBytes(0),
+      payloadBytes(0),
+      interleavedFrames(0) {
+    for (unsigned int i = 0; i < kZeroCopySlots; i++) {
+        zeroCopySlots[i].firstNotification = 0;
+        zeroCopySlots[i].notificationCount = 0;
+        zeroCopySlots[i].completedCount = 0;
+        zeroCopySlots[i].inFlight = false;
+    }
+
     // 初始化Winsock
-    WSADATA wsaData;
-    int result = WSAStartup(MAKEWORD(2, 2), &wsaData);
-    if (result != 0) {
-        std::cerr << "WSAStartup failed: " << result << std::endl;
+    if (!net::startup()) {
+        std::cerr << "WSAStartup failed: " << net::lastError() << std::endl;
     }
 }
 
 UDPTransmitter::~UDPTransmitter() {
     stop();
     // 清理Winsock
-    WSACleanup();
+    net::cleanup();
 }
 
-bool UDPTransmitter::initialize(const std::string& serverIP, unsigned int serverPort, unsigned int maxPacketSize) {
+bool UDPTransmitter::initialize(const std::string& serverIP, unsigned int serverPort, unsigned int maxPacketSize,
+                                SendBackend backend, bool zeroCopy) {
     this->serverIP = serverIP;
     this->serverPort = serverPort;
     this->maxPacketSize = maxPacketSize;
-    
+    this->packetSize = maxPacketSize;
+    this->rtpPacketSize = maxPacketSize;
+    this->requestedBackend = backend;
+    this->zeroCopyRequested = zeroCopy;
+
+    if (maxPacketSize <= sizeof(PacketHeader)) {
+        std::cerr << "Invalid max packet size: " << maxPacketSize << std::endl;
+        return false;
+    }
+
+    if (rtpConfig.enabled) {
+        // RTP分包不携带FEC分组和帧内序号，校验包和NACK重传依赖自定义包头
+        if (fecConfig.mode != FecCodec::Mode::None) {
+            std::cerr << "FEC is not available in RTP mode, disabling" << std::endl;
+            fecConfig.mode = FecCodec::Mode::None;
+        }
+        if (retransmitConfig.feedbackPort != 0) {
+            std::cerr << "NACK retransmission is not available in RTP mode, "
+                      << "feedback port only accepts receiver reports" << std::endl;
+        }
+        if (interleaving) {
+            std::cerr << "Packet interleaving is not available in RTP mode, disabling" << std::endl;
+            interleaving = false;
+        }
+        rtpPacketizer.configure(rtpConfig, maxPacketSize);
+        sdpWritten = false;
+        std::cout << "UDP transmitter RTP output: payload type " << static_cast<unsigned int>(rtpConfig.payloadType)
+                  << ", SSRC " << rtpPacketizer.getSsrc() << std::endl;
+    }
+
     // 创建UDP套接字
     sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
     if (sock == INVALID_SOCKET) {
-        std::cerr << "Failed to create socket: " << WSAGetLastError() << std::endl;
+        std::cerr << "Failed to create socket: " << net::lastError() << std::endl;
         return false;
     }
-    
+
     // 设置服务器地址
     memset(&serverAddr, 0, sizeof(serverAddr));
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_port = htons(serverPort);
-    
+
     // 将IP地址转换为二进制格式
     if (inet_pton(AF_INET, serverIP.c_str(), &serverAddr.sin_addr) != 1) {
         std::cerr << "Invalid address: " << serverIP << std::endl;
-        closesocket(sock);
+        net::closeSocket(sock);
         sock = INVALID_SOCKET;
         return false;
     }
-    
+
     // 设置套接字为非阻塞模式（可选，用于更好的流量控制）
-    u_long mode = 1;
-    if (ioctlsocket(sock, FIONBIO, &mode) != 0) {
-        std::cerr << "Failed to set non-blocking mode: " << WSAGetLastError() << std::endl;
+    if (!net::setNonBlocking(sock)) {
+        std::cerr << "Failed to set non-blocking mode: " << net::lastError() << std::endl;
         // 继续执行，不强制要求非阻塞模式
     }
-    
+
+    activeBackend = resolveBackend(backend);
+    if (activeBackend == SendBackend::Uring) {
+        // io_uring下的零拷贝由注册缓冲区和SEND_ZC实现，不使用MSG_ZEROCOPY的错误队列
+        UringSender::Config config = uringConfig;
+        config.registeredBuffers = zeroCopy;
+        config.bufferSize = maxPacketSize;
+        if (uring.initialize(sock, serverAddr, config)) {
+            std::cout << "UDP transmitter io_uring: " << uring.getChainCapacity() << " entries"
+                      << (uring.isSqPoll() ? ", SQPOLL" : "")
+                      << (uring.usesRegisteredBuffers() ? ", registered buffers (SEND_ZC)" : "") << std::endl;
+        } else {
+            std::cerr << "Failed to initialize io_uring, falling back to auto" << std::endl;
+            activeBackend = resolveBackend(SendBackend::Auto);
+        }
+    }
+    std::cout << "UDP transmitter send backend: " << backendName(activeBackend) << std::endl;
+
+    zeroCopyEnabled = zeroCopy && activeBackend != SendBackend::Uring && enableZeroCopy();
+    if (zeroCopyEnabled) {
+        std::cout << "UDP transmitter MSG_ZEROCOPY enabled" << std::endl;
+    }
+
+    // 交织只在FEC组之间调换顺序，分包仍需节奏控制才会分布到整个发送窗口
+    if (interleaving) {
+        if (fecConfig.mode == FecCodec::Mode::None) {
+            std::cerr << "Packet interleaving requires FEC, disabling" << std::endl;
+            interleaving = false;
+        } else {
+            if (!pacingConfig.enabled) {
+                pacingConfig.enabled = true;
+                std::cout << "UDP transmitter pacing enabled for packet interleaving" << std::endl;
+            }
+            std::cout << "UDP transmitter interleaving: packets alternate between FEC groups" << std::endl;
+        }
+    }
+
+    // 突发容量按上限计算；探测得到更小的分包时同一突发可容纳更多分包
+    pacer.configure(pacingConfig, bitrateKbps, frameRate, maxPacketSize);
+    if (pacer.isEnabled()) {
+        std::cout << "UDP transmitter pacing: " << pacingConfig.frameFraction * 100 << "% of frame interval, burst "
+                  << pacer.getBurstPackets() << " packets" << std::endl;
+    }
+
     running = true;
+
+    if (retransmitConfig.feedbackPort != 0 && !startFeedback()) {
+        std::cerr << "NACK retransmission disabled" << std::endl;
+    }
+
+    // 探测应答经反馈端口返回；RTP接收端不认识探测包，只跟踪内核路由MTU
+    if (pathMtuConfig.enabled) {
+        bool acknowledged = feedbackSock != INVALID_SOCKET && !rtpConfig.enabled;
+        if (pathMtu.start(serverAddr, maxPacketSize, acknowledged, pathMtuConfig,
+                          [this](unsigned int size) { packetSize.store(size, std::memory_order_relaxed); })) {
+            packetSize = pathMtu.getPacketSize();
+        } else {
+            std::cerr << "Path MTU discovery disabled, using max packet size " << maxPacketSize << std::endl;
+        }
+    }
+
     return true;
 }
 
-bool UDPTransmitter::sendFrame(const UDPFrame& frame) {
-    if (!running || sock == INVALID_SOCKET) {
+bool UDPTransmitter::startFeedback() {
+    // 重传环按最大分包大小预分配；帧索引容量足以覆盖重传环中的全部帧
+    if (!retransmitRing.initialize(retransmitConfig.ringPackets, std::max(retransmitConfig.ringPackets / 4, 64u),
+                                   maxPacketSize)) {
+        std::cerr << "Invalid retransmit ring size: " << retransmitConfig.ringPackets << std::endl;
+        return false;
+    }
+
+    feedbackSock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (feedbackSock == INVALID_SOCKET) {
+        std::cerr << "Failed to create feedback socket: " << net::lastError() << std::endl;
+        return false;
+    }
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(retransmitConfig.feedbackPort);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(feedbackSock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+        std::cerr << "Failed to bind feedback port " << retransmitConfig.feedbackPort << ": "
+                  << net::lastError() << std::endl;
+        net::closeSocket(feedbackSock);
+        feedbackSock = INVALID_SOCKET;
         return false;
     }
-    
-    // 计算数据包大小
+
+    // 接收超时用于定期检查退出标志
+    net::setReceiveTimeout(feedbackSock, 50);
+
+    feedbackThread = std::thread(&UDPTransmitter::feedbackThreadFunc, this);
+    std::cout << "NACK feedback listening on port " << retransmitConfig.feedbackPort
+              << " (ring " << retransmitConfig.ringPackets << " packets, deadline "
+              << retransmitConfig.deadlineMs << " ms)" << std::endl;
+    return true;
+}
+
+UDPTransmitter::SendBackend UDPTransmitter::resolveBackend(SendBackend backend) const {
+#ifdef __linux__
+    if (backend == SendBackend::Uring) {
+        if (UringSender::isSupported()) {
+            return SendBackend::Uring;
+        }
+        std::cerr << "io_uring not supported by kernel, falling back to auto" << std::endl;
+        backend = SendBackend::Auto;
+    }
+    if (backend == SendBackend::Auto || backend == SendBackend::Segmented) {
+        // 探测内核是否支持UDP GSO（Linux 4.18+）
+        int gsoSize = 0;
+        if (setsockopt(sock, SOL_UDP, UDP_SEGMENT, &gsoSize, sizeof(gsoSize)) == 0) {
+            return SendBackend::Segmented;
+        }
+        if (backend == SendBackend::Segmented) {
+            std::cerr << "UDP GSO not supported by kernel, falling back to sendmmsg" << std::endl;
+        }
+        return SendBackend::Batched;
+    }
+    return backend;
+#else
+    if (backend == SendBackend::Batched || backend == SendBackend::Segmented || backend == SendBackend::Uring) {
+        std::cerr << "Batched send backends are only available on Linux, using per-packet sendto" << std::endl;
+    }
+    return SendBackend::PerPacket;
+#endif
+}
+
+bool UDPTransmitter::enableZeroCopy() {
+#ifdef __linux__
+    // UDP的MSG_ZEROCOPY需要Linux 5.0+
+    int one = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) != 0) {
+        std::cerr << "MSG_ZEROCOPY not supported: " << net::lastError() << std::endl;
+        return false;
+    }
+    return true;
+#else
+    std::cerr << "MSG_ZEROCOPY is only available on Linux" << std::endl;
+    return false;
+#endif
+}
+
+bool UDPTransmitter::sendFrame(const UDPFrame& frame) {
+    return sendFrameData(frame.data.data(), frame.data.size(), frame.frameId, frame.timestamp);
+}
+
+bool UDPTransmitter::sendFrame(const std::vector<uint8_t>& data) {
+    // 生成帧ID和时间戳；时间戳与时钟同步应答使用同一时钟
+    uint32_t frameId = frameIdCounter++;
+    return sendFrameData(data.data(), data.size(), frameId, timing::nowMicros());
+}
+
+bool UDPTransmitter::sendFrame(std::vector<uint8_t>&& data) {
+    return sendFrame(std::move(data), timing::nowMicros());
+}
+
+bool UDPTransmitter::sendFrame(std::vector<uint8_t>&& data, uint64_t timestamp) {
+    uint32_t frameId = frameIdCounter++;
+
+    if (zeroCopyEnabled) {
+        return sendFrameZeroCopy(data, frameId, timestamp);
+    }
+    return sendFrameData(data.data(), data.size(), frameId, timestamp);
+}
+
+int UDPTransmitter::packetize(const uint8_t* data, size_t size, uint32_t frameId, uint64_t timestamp,
+                              FrameStorage& storage) {
+    if (rtpConfig.enabled) {
+        return packetizeRtp(data, size, timestamp, storage);
+    }
+
+    // 计算数据包大小；路径MTU探测可能在帧之间调整分包大小，整帧使用同一取值
     unsigned int headerSize = sizeof(PacketHeader);
-    unsigned int payloadSize = maxPacketSize - headerSize;
-    
+    unsigned int payloadSize = packetSize.load(std::memory_order_relaxed) - headerSize;
+
     // 计算分包数量
-    unsigned int packetCount = (frame.data.size() + payloadSize - 1) / payloadSize;
-    
-    // 发送所有数据包
-    for (unsigned int i = 0; i < packetCount; i++) {
-        // 计算当前包的偏移量和大小
-        unsigned int offset = i * payloadSize;
-        unsigned int currentPayloadSize = std::min(payloadSize, (unsigned int)(frame.data.size() - offset));
-        
-        // 创建数据包
-        std::vector<uint8_t> packet(headerSize + currentPayloadSize);
-        
+    size_t packetCount = (size + payloadSize - 1) / payloadSize;
+
+    // 按帧类型确定FEC分组和冗余度，关键帧使用更高的冗余比例
+    bool keyframe = h264::isKeyframe(data, size);
+    unsigned int groupSize = 0;
+    unsigned int parityPerGroup = 0;
+    FecCodec::planGroups(fecConfig, static_cast<unsigned int>(packetCount), keyframe, groupSize, parityPerGroup);
+    size_t groupCount = parityPerGroup ? (packetCount + groupSize - 1) / groupSize : 0;
+    if (interleaving && groupCount > 1) {
+        // 组数和每组校验包数不变，各组数据包数均衡，交织矩阵的各列等长
+        groupSize = static_cast<unsigned int>((packetCount + groupCount - 1) / groupCount);
+    }
+    size_t parityCount = groupCount * parityPerGroup;
+
+    if (packetCount + parityCount > 0xFFFF || groupCount > 256 || size > 0xFFFFFFFFu) {
+        std::cerr << "Frame too large to packetize: " << size << " bytes" << std::endl;
+        return -1;
+    }
+
+    size_t totalCount = packetCount + parityCount;
+
+    // 包头数组、校验包缓冲区和分包描述跨帧复用，只有帧比以往都大时才会扩容
+    if (storage.headers.capacity() < totalCount) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (storage.parity.capacity() < parityCount * payloadSize) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (outPackets.capacity() < totalCount) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    storage.headers.resize(totalCount);
+    storage.parity.resize(parityCount * payloadSize);
+    outPackets.resize(totalCount);
+
+    uint8_t flags = keyframe ? PACKET_FLAG_KEYFRAME : 0;
+    if (fecConfig.mode == FecCodec::Mode::Xor) {
+        flags |= PACKET_FLAG_FEC_XOR;
+    }
+    if (interleaving && groupCount > 1) {
+        flags |= PACKET_FLAG_INTERLEAVED;
+    }
+
+    for (size_t i = 0; i < totalCount; i++) {
         // 填充包头
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(packet.data());
-        header->frameId = frame.frameId;
-        header->packetId = static_cast<uint16_t>(i);
-        header->packetCount = static_cast<uint16_t>(packetCount);
-        header->timestamp = frame.timestamp;
-        
-        // 填充负载
-        memcpy(packet.data() + headerSize, frame.data.data() + offset, currentPayloadSize);
-        
-        // 发送数据包
-        int result = sendto(
-            sock,
-            reinterpret_cast<const char*>(packet.data()),
-            packet.size(),
-            0,
-            reinterpret_cast<const sockaddr*>(&serverAddr),
-            sizeof(serverAddr)
-        );
-        
-        if (result == SOCKET_ERROR) {
-            int error = WSAGetLastError();
-            // 非阻塞模式下的WSAEWOULDBLOCK错误是正常的，其他错误需要处理
-            if (error != WSAEWOULDBLOCK) {
-                std::cerr << "Failed to send packet: " << error << std::endl;
-                // 直接返回失败，丢弃整个帧
-                return false;
-            }
+        PacketHeader& header = storage.headers[i];
+        header.frameId = frameId;
+        header.packetId = static_cast<uint16_t>(i);
+        header.packetCount = static_cast<uint16_t>(packetCount);
+        header.timestamp = timestamp;
+        header.frameSize = static_cast<uint32_t>(size);
+        header.flags = flags;
+        header.fecGroupParity = static_cast<uint8_t>(parityPerGroup);
+
+        OutPacket& packet = outPackets[i];
+        packet.header = reinterpret_cast<const uint8_t*>(&header);
+        packet.headerSize = headerSize;
+
+        if (i < packetCount) {
+            // 负载直接引用编码帧缓冲区，不做复制
+            size_t offset = i * payloadSize;
+            size_t group = parityPerGroup ? i / groupSize : 0;
+            header.fecGroup = static_cast<uint8_t>(group);
+            header.fecGroupSize = parityPerGroup ? static_cast<uint8_t>(groupSize) : 0;
+
+            packet.payload = data + offset;
+            packet.payloadSize = static_cast<uint32_t>(std::min<size_t>(payloadSize, size - offset));
+        } else {
+            // 校验包负载指向校验缓冲区，由encodeParity填充
+            size_t parityIndex = i - packetCount;
+            size_t group = parityIndex / parityPerGroup;
+            header.flags |= PACKET_FLAG_PARITY;
+            header.fecGroup = static_cast<uint8_t>(group);
+            header.fecGroupSize = static_cast<uint8_t>(groupSize);
+
+            packet.payload = storage.parity.data() + parityIndex * payloadSize;
+            packet.payloadSize = payloadSize;
+        }
+    }
+
+    bytesCopied.fetch_add(totalCount * headerSize, std::memory_order_relaxed);
+    packetsBuilt.fetch_add(totalCount, std::memory_order_relaxed);
+    headerBytes.fetch_add(totalCount * headerSize, std::memory_order_relaxed);
+    payloadBytes.fetch_add(size + parityCount * payloadSize, std::memory_order_relaxed);
+    if (keyframe) {
+        keyframesSent.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (parityCount > 0) {
+        encodeParity(static_cast<unsigned int>(packetCount), groupSize, parityPerGroup, payloadSize, storage);
+    }
+
+    return static_cast<int>(totalCount);
+}
+
+void UDPTransmitter::encodeParity(unsigned int packetCount, unsigned int groupSize, unsigned int parityPerGroup,
+                                  unsigned int payloadSize, FrameStorage& storage) {
+    auto encodeStart = std::chrono::steady_clock::now();
+
+    const uint8_t* dataShards[FecCodec::kMaxShards];
+    uint32_t dataSizes[FecCodec::kMaxShards];
+    uint8_t* parityShards[FecCodec::kMaxShards];
+
+    unsigned int parityIndex = 0;
+    for (unsigned int first = 0; first < packetCount; first += groupSize) {
+        unsigned int k = std::min(groupSize, packetCount - first);
+        for (unsigned int i = 0; i < k; i++) {
+            dataShards[i] = outPackets[first + i].payload;
+            dataSizes[i] = outPackets[first + i].payloadSize;
         }
-        
-        // 简单的流量控制：如果发送缓冲区满了，稍微延迟一下
-        if (result == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK) {
-            // 短暂睡眠，避免CPU占用过高
-            Sleep(1);
+        for (unsigned int j = 0; j < parityPerGroup; j++) {
+            parityShards[j] = storage.parity.data() + static_cast<size_t>(parityIndex + j) * payloadSize;
         }
+
+        FecCodec::encode(fecConfig.mode, dataShards, dataSizes, k, parityShards, parityPerGroup, payloadSize);
+        parityIndex += parityPerGroup;
     }
-    
-    return true;
+
+    uint64_t encodeTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - encodeStart
+    ).count();
+    fecParityPackets.fetch_add(parityIndex, std::memory_order_relaxed);
+    fecEncodeTimeUs.fetch_add(encodeTimeUs, std::memory_order_relaxed);
 }
 
-bool UDPTransmitter::sendFrame(const std::vector<uint8_t>& data) {
+int UDPTransmitter::packetizeRtp(const uint8_t* data, size_t size, uint64_t timestamp, FrameStorage& storage) {
+    unsigned int currentPacketSize = packetSize.load(std::memory_order_relaxed);
+    if (currentPacketSize != rtpPacketSize) {
+        rtpPacketizer.setMaxPacketSize(currentPacketSize);
+        rtpPacketSize = currentPacketSize;
+    }
+
+    size_t headerCapacity = storage.rtpHeaders.capacity();
+    size_t packetCapacity = rtpPackets.capacity();
+
+    unsigned int packetCount = rtpPacketizer.packetize(data, size, timestamp, storage.rtpHeaders, rtpPackets);
+    if (packetCount == 0) {
+        std::cerr << "Frame contains no NAL units: " << size << " bytes" << std::endl;
+        return -1;
+    }
+
+    if (storage.rtpHeaders.capacity() != headerCapacity) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (rtpPackets.capacity() != packetCapacity) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (outPackets.capacity() < packetCount) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    outPackets.resize(packetCount);
+
+    // 包头缓冲区已不再增长，此时才能把偏移换算为指针
+    size_t framePayloadBytes = 0;
+    for (unsigned int i = 0; i < packetCount; i++) {
+        const RtpPacketizer::Packet& rtpPacket = rtpPackets[i];
+        OutPacket& packet = outPackets[i];
+        packet.header = storage.rtpHeaders.data() + rtpPacket.headerOffset;
+        packet.headerSize = rtpPacket.headerSize;
+        packet.payload = rtpPacket.payload;
+        packet.payloadSize = rtpPacket.payloadSize;
+        framePayloadBytes += rtpPacket.payloadSize;
+    }
+
+    bytesCopied.fetch_add(storage.rtpHeaders.size(), std::memory_order_relaxed);
+    packetsBuilt.fetch_add(packetCount, std::memory_order_relaxed);
+    headerBytes.fetch_add(storage.rtpHeaders.size(), std::memory_order_relaxed);
+    payloadBytes.fetch_add(framePayloadBytes, std::memory_order_relaxed);
+    if (h264::isKeyframe(data, size)) {
+        keyframesSent.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 首次取得参数集后写出SDP，播放器据此获得sprop-parameter-sets
+    if (!sdpWritten && !rtpConfig.sdpPath.empty() && rtpPacketizer.hasParameterSets()) {
+        if (rtpPacketizer.writeSdp(rtpConfig.sdpPath, serverIP, serverPort, frameRate)) {
+            std::cout << "SDP written to " << rtpConfig.sdpPath << std::endl;
+        }
+        sdpWritten = true;
+    }
+
+    return static_cast<int>(packetCount);
+}
+
+std::string UDPTransmitter::getSdp() const {
+    return rtpPacketizer.generateSdp(serverIP, serverPort, frameRate);
+}
+
+bool UDPTransmitter::sendFrameData(const uint8_t* data, size_t size, uint32_t frameId, uint64_t timestamp) {
     if (!running || sock == INVALID_SOCKET) {
         return false;
     }
-    
-    // 计算数据包大小
-    unsigned int headerSize = sizeof(PacketHeader);
-    unsigned int payloadSize = maxPacketSize - headerSize;
-    
-    // 计算分包数量
-    unsigned int packetCount = (data.size() + payloadSize - 1) / payloadSize;
-    
-    // 生成帧ID和时间戳
-    static uint32_t frameIdCounter = 0;
-    uint32_t frameId = frameIdCounter++;
-    uint64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
-        std::chrono::high_resolution_clock::now().time_since_epoch()
+
+    int packetCount = packetize(data, size, frameId, timestamp, frameStorage);
+    if (packetCount < 0) {
+        return false;
+    }
+
+    storeForRetransmit();
+    interleavePackets(packetCount);
+    return transmitPackets(packetCount);
+}
+
+bool UDPTransmitter::sendFrameZeroCopy(std::vector<uint8_t>& data, uint32_t frameId, uint64_t timestamp) {
+    if (!running || sock == INVALID_SOCKET) {
+        return false;
+    }
+
+    reapZeroCopyCompletions();
+
+    ZeroCopySlot& slot = zeroCopySlots[zeroCopyNextSlot];
+    if (slot.inFlight) {
+        // 在途帧尚未全部完成，不能覆盖其缓冲区，本帧退回普通（内核复制）发送
+        zeroCopySlotStalls.fetch_add(1, std::memory_order_relaxed);
+        return sendFrameData(data.data(), data.size(), frameId, timestamp);
+    }
+
+    // 帧数据移入在途槽位，调用方拿回该槽位上一个已完成的缓冲区
+    slot.data.swap(data);
+
+    int packetCount = packetize(slot.data.data(), slot.data.size(), frameId, timestamp, slot.storage);
+    if (packetCount < 0) {
+        return false;
+    }
+
+    storeForRetransmit();
+    interleavePackets(packetCount);
+
+    frameSendFlags = MSG_ZEROCOPY;
+    frameZeroCopyMessages = 0;
+    bool result = transmitPackets(packetCount);
+    frameSendFlags = 0;
+
+    // 每条成功提交的零拷贝消息占用一个连续的通知序号
+    slot.firstNotification = zeroCopyNextNotification;
+    slot.notificationCount = frameZeroCopyMessages;
+    slot.completedCount = 0;
+    slot.inFlight = frameZeroCopyMessages > 0;
+    zeroCopyNextNotification += frameZeroCopyMessages;
+    zeroCopySends.fetch_add(frameZeroCopyMessages, std::memory_order_relaxed);
+
+    zeroCopyNextSlot = (zeroCopyNextSlot + 1) % kZeroCopySlots;
+    return result;
+}
+
+void UDPTransmitter::reapZeroCopyCompletions() {
+#ifdef __linux__
+    char control[128];
+
+    // 非阻塞读取错误队列中的全部完成通知
+    while (true) {
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (recvmsg(sock, &msg, MSG_ERRQUEUE) < 0) {
+            break;
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_IP || cmsg->cmsg_type != IP_RECVERR) {
+                continue;
+            }
+
+            sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+
+            // 通知为闭区间[ee_info, ee_data]，序号按uint32回绕
+            uint32_t low = err.ee_info;
+            uint32_t count = err.ee_data - err.ee_info + 1;
+            zeroCopyCompletions.fetch_add(count, std::memory_order_relaxed);
+            if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                zeroCopyDeferredCopies.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            for (unsigned int i = 0; i < kZeroCopySlots; i++) {
+                ZeroCopySlot& slot = zeroCopySlots[i];
+                if (!slot.inFlight) {
+                    continue;
+                }
+
+                uint32_t overlap = 0;
+                uint32_t fromSlot = low - slot.firstNotification;
+                uint32_t fromRange = slot.firstNotification - low;
+                if (fromSlot < slot.notificationCount) {
+                    overlap = std::min(count, slot.notificationCount - fromSlot);
+                } else if (fromRange < count) {
+                    overlap = std::min(slot.notificationCount, count - fromRange);
+                }
+
+                slot.completedCount += overlap;
+                if (slot.completedCount >= slot.notificationCount) {
+                    slot.inFlight = false;
+                }
+            }
+        }
+    }
+#endif
+}
+
+void UDPTransmitter::storeForRetransmit() {
+    if (feedbackSock == INVALID_SOCKET || outPackets.empty() || rtpConfig.enabled) {
+        return;
+    }
+
+    // 只保存数据包；校验包可由接收端按需请求对应数据包代替
+    const PacketHeader& first = *reinterpret_cast<const PacketHeader*>(outPackets[0].header);
+    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
     ).count();
-    
-    // 发送所有数据包
+    retransmitRing.beginFrame(first.frameId, first.packetCount, now);
+
+    for (unsigned int i = 0; i < first.packetCount; i++) {
+        const OutPacket& packet = outPackets[i];
+        retransmitRing.storePacket(first.frameId, static_cast<uint16_t>(i),
+                                   packet.header, packet.headerSize,
+                                   packet.payload, packet.payloadSize);
+    }
+}
+
+void UDPTransmitter::interleavePackets(unsigned int packetCount) {
+    if (!interleaving || packetCount == 0) {
+        return;
+    }
+    const PacketHeader& first = *reinterpret_cast<const PacketHeader*>(outPackets[0].header);
+    if (!(first.flags & PACKET_FLAG_INTERLEAVED)) {
+        return;
+    }
+
+    // 校验包编码和重传环都按packetId索引分包描述，因此在两者之后才重排
+    if (sendOrder.capacity() < packetCount || interleavedPackets.capacity() < packetCount) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    sendOrder.resize(packetCount);
+    interleavedPackets.resize(packetCount);
+    PacketInterleaver::buildOrder(first.packetCount, first.fecGroupSize, first.fecGroupParity, sendOrder.data());
     for (unsigned int i = 0; i < packetCount; i++) {
-        // 计算当前包的偏移量和大小
-        unsigned int offset = i * payloadSize;
-        unsigned int currentPayloadSize = std::min(payloadSize, (unsigned int)(data.size() - offset));
-        
-        // 创建数据包
-        std::vector<uint8_t> packet(headerSize + currentPayloadSize);
-        
-        // 填充包头
-        PacketHeader* header = reinterpret_cast<PacketHeader*>(packet.data());
-        header->frameId = frameId;
-        header->packetId = static_cast<uint16_t>(i);
-        header->packetCount = static_cast<uint16_t>(packetCount);
-        header->timestamp = timestamp;
-        
-        // 填充负载
-        memcpy(packet.data() + headerSize, data.data() + offset, currentPayloadSize);
-        
-        // 发送数据包
-        int result = sendto(
+        interleavedPackets[i] = outPackets[sendOrder[i]];
+    }
+    outPackets.swap(interleavedPackets);
+    interleavedFrames.fetch_add(1, std::memory_order_relaxed);
+}
+
+void UDPTransmitter::feedbackThreadFunc() {
+    std::vector<uint8_t> message(sizeof(NackHeader) + kMaxNackRanges * sizeof(NackRange));
+    std::vector<uint8_t> packet(maxPacketSize);
+
+    while (running) {
+        int received = recvfrom(feedbackSock, reinterpret_cast<char*>(message.data()),
+                                static_cast<int>(message.size()), 0, nullptr, nullptr);
+        uint64_t receiveUs = timing::nowMicros();
+        if (received < static_cast<int>(sizeof(uint32_t))) {
+            continue;
+        }
+
+        // 按消息头的magic区分NACK、接收报告、路径MTU探测应答和时钟同步探测
+        uint32_t magic;
+        memcpy(&magic, message.data(), sizeof(magic));
+        if (magic == kReportMagic) {
+            handleReport(message.data(), received);
+        } else if (magic == PathMtuDiscovery::kAckMagic) {
+            pathMtu.handleAck(message.data(), received);
+        } else if (magic == kClockProbeMagic) {
+            handleClockProbe(message.data(), received, receiveUs);
+        } else {
+            handleNack(message.data(), received, packet.data());
+        }
+    }
+}
+
+void UDPTransmitter::handleReport(const uint8_t* message, size_t size) {
+    if (size < sizeof(ReceiverReport)) {
+        return;
+    }
+
+    ReceiverReport report;
+    memcpy(&report, message, sizeof(report));
+    reportsReceived.fetch_add(1, std::memory_order_relaxed);
+
+    if (reportHandler) {
+        reportHandler(report);
+    }
+}
+
+void UDPTransmitter::handleClockProbe(const uint8_t* message, size_t size, uint64_t receiveUs) {
+    // RTP接收端（如ffplay）无法识别应答，不向媒体路径发送
+    if (size < sizeof(ClockProbe) || rtpConfig.enabled) {
+        return;
+    }
+
+    ClockProbe probe;
+    memcpy(&probe, message, sizeof(probe));
+
+    ClockReply reply;
+    reply.magic = kClockReplyMagic;
+    reply.sequence = probe.sequence;
+    reply.originateUs = probe.originateUs;
+    reply.receiveUs = receiveUs;
+    reply.transmitUs = timing::nowMicros();
+    int result = sendto(feedbackSock, reinterpret_cast<const char*>(&reply), sizeof(reply), 0,
+                        reinterpret_cast<const sockaddr*>(&serverAddr), sizeof(serverAddr));
+    if (result != SOCKET_ERROR) {
+        clockProbesAnswered.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void UDPTransmitter::handleNack(const uint8_t* message, size_t size, uint8_t* packet) {
+    if (size < sizeof(NackHeader)) {
+        return;
+    }
+
+    NackHeader header;
+    memcpy(&header, message, sizeof(header));
+    if (header.magic != kNackMagic || header.rangeCount > kMaxNackRanges ||
+        size < sizeof(NackHeader) + header.rangeCount * sizeof(NackRange)) {
+        return;
+    }
+    nacksReceived.fetch_add(1, std::memory_order_relaxed);
+
+    uint64_t requested = 0;
+    const uint8_t* ranges = message + sizeof(NackHeader);
+    for (unsigned int r = 0; r < header.rangeCount; r++) {
+        NackRange range;
+        memcpy(&range, ranges + r * sizeof(NackRange), sizeof(range));
+        requested += range.count;
+    }
+    retransmitRequests.fetch_add(requested, std::memory_order_relaxed);
+
+    // 超过期限的帧即使补齐也已无用，整帧放弃
+    uint64_t sendTimeUs = 0;
+    uint16_t packetCount = 0;
+    if (!retransmitRing.findFrame(header.frameId, sendTimeUs, packetCount)) {
+        retransmitUnavailable.fetch_add(requested, std::memory_order_relaxed);
+        return;
+    }
+    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+    if (now - sendTimeUs > static_cast<uint64_t>(retransmitConfig.deadlineMs) * 1000) {
+        retransmitExpired.fetch_add(requested, std::memory_order_relaxed);
+        return;
+    }
+
+    for (unsigned int r = 0; r < header.rangeCount; r++) {
+        NackRange range;
+        memcpy(&range, ranges + r * sizeof(NackRange), sizeof(range));
+
+        for (unsigned int i = 0; i < range.count; i++) {
+            uint32_t packetId = static_cast<uint32_t>(range.firstPacketId) + i;
+            size_t packetSize = 0;
+            if (packetId >= packetCount ||
+                !retransmitRing.readPacket(header.frameId, static_cast<uint16_t>(packetId), packet, packetSize)) {
+                retransmitUnavailable.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // 标记为重传，接收端据此区分乱序和重传
+            packet[offsetof(PacketHeader, flags)] |= PACKET_FLAG_RETRANSMIT;
+
+            int result = sendto(feedbackSock, reinterpret_cast<const char*>(packet), static_cast<int>(packetSize), 0,
+                                reinterpret_cast<const sockaddr*>(&serverAddr), sizeof(serverAddr));
+            if (result != SOCKET_ERROR) {
+                packetsRetransmitted.fetch_add(1, std::memory_order_relaxed);
+                bytesSent.fetch_add(result, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+bool UDPTransmitter::transmitPackets(unsigned int packetCount) {
+    auto sendStart = std::chrono::steady_clock::now();
+    lastPacketTimes = PacketTimes();
+
+    // 发送缓冲区满时最多重试到下一帧到来之前
+    uint64_t frameIntervalUs = 1000000 / std::max(frameRate, 1u);
+    uint64_t retryDeadline = timing::nowMicros() + frameIntervalUs;
+    bool blocked = false;
+
+    if (pacer.isEnabled()) {
+        // 码率控制调整了编码器码率时同步更新基础发送速率
+        unsigned int target = targetBitrateKbps.exchange(0, std::memory_order_relaxed);
+        if (target != 0) {
+            pacer.setBitrate(target);
+        }
+
+        size_t frameBytes = 0;
+        for (unsigned int i = 0; i < packetCount; i++) {
+            frameBytes += outPackets[i].headerSize + outPackets[i].payloadSize;
+        }
+        pacer.beginFrame(frameBytes);
+    }
+
+    int frameSyscalls = 0;
+    unsigned int next = 0;
+    while (next < packetCount) {
+        // 启用节奏控制时每次最多发出一个突发，令牌不足时等待
+        unsigned int chunk = packetCount - next;
+        if (pacer.isEnabled()) {
+            chunk = std::min(chunk, pacer.getBurstPackets());
+            size_t chunkBytes = 0;
+            for (unsigned int i = 0; i < chunk; i++) {
+                chunkBytes += outPackets[next + i].headerSize + outPackets[next + i].payloadSize;
+            }
+            pacer.acquire(chunkBytes);
+        }
+
+        unsigned int sent = 0;
+        int calls = sendPackets(outPackets.data() + next, chunk, sent);
+        if (calls < 0) {
+            // 直接返回失败，丢弃整个帧
+            sendErrors.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        frameSyscalls += calls;
+        if (sent > 0 && next == 0) {
+            lastPacketTimes.firstNs = timing::nowNanos();
+        }
+        next += sent;
+
+        if (sent < chunk) {
+            // 发送缓冲区已满：等待套接字可写后从阻塞的分包继续发送，超过期限才丢弃剩余分包。
+            // 未发出的分包已在本次突发中计费，归还令牌，重试时重新申请
+            blockedSends.fetch_add(1, std::memory_order_relaxed);
+            blocked = true;
+            if (pacer.isEnabled()) {
+                size_t unsentBytes = 0;
+                for (unsigned int i = next; i < next + (chunk - sent); i++) {
+                    unsentBytes += outPackets[i].headerSize + outPackets[i].payloadSize;
+                }
+                pacer.refund(unsentBytes);
+            }
+            uint64_t now = timing::nowMicros();
+            if (now >= retryDeadline || !net::waitWritable(sock, retryDeadline - now)) {
+                packetsDropped.fetch_add(packetCount - next, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+
+    uint32_t sendTimeUs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - sendStart
+    ).count());
+    if (next > 0) {
+        lastPacketTimes.lastNs = timing::nowNanos();
+    }
+
+    framesSent.fetch_add(1, std::memory_order_relaxed);
+    syscalls.fetch_add(frameSyscalls, std::memory_order_relaxed);
+    totalSendTimeUs.fetch_add(sendTimeUs, std::memory_order_relaxed);
+    lastFrameSyscalls.store(frameSyscalls, std::memory_order_relaxed);
+    lastFrameSendTimeUs.store(sendTimeUs, std::memory_order_relaxed);
+    congested.store(blocked || sendTimeUs > frameIntervalUs, std::memory_order_relaxed);
+
+    return true;
+}
+
+int UDPTransmitter::sendPackets(const OutPacket* packets, unsigned int count, unsigned int& sent) {
+    switch (activeBackend.load(std::memory_order_relaxed)) {
+#ifdef __linux__
+        case SendBackend::Segmented:
+            return sendSegmented(packets, count, sent);
+        case SendBackend::Batched:
+            return sendBatched(packets, count, sent);
+        case SendBackend::Uring:
+            return sendUring(packets, count, sent);
+#endif
+        default:
+            return sendPerPacket(packets, count, sent);
+    }
+}
+
+int UDPTransmitter::sendPerPacket(const OutPacket* packets, unsigned int count, unsigned int& sent) {
+    int frameSyscalls = 0;
+
+    // 发送所有数据包，包头和负载以两段缓冲区提交
+    for (unsigned int i = 0; i < count; i++) {
+        const OutPacket& packet = packets[i];
+
+#ifdef _WIN32
+        WSABUF buffers[2];
+        buffers[0].buf = reinterpret_cast<CHAR*>(const_cast<uint8_t*>(packet.header));
+        buffers[0].len = packet.headerSize;
+        buffers[1].buf = reinterpret_cast<CHAR*>(const_cast<uint8_t*>(packet.payload));
+        buffers[1].len = packet.payloadSize;
+
+        DWORD sentBytes = 0;
+        int result = WSASendTo(
             sock,
-            reinterpret_cast<const char*>(packet.data()),
-            packet.size(),
+            buffers,
+            2,
+            &sentBytes,
             0,
             reinterpret_cast<const sockaddr*>(&serverAddr),
-            sizeof(serverAddr)
+            sizeof(serverAddr),
+            nullptr,
+            nullptr
         );
-        
+        if (result == 0) {
+            result = static_cast<int>(sentBytes);
+        }
+#else
+        iovec iov[2];
+        iov[0].iov_base = const_cast<uint8_t*>(packet.header);
+        iov[0].iov_len = packet.headerSize;
+        iov[1].iov_base = const_cast<uint8_t*>(packet.payload);
+        iov[1].iov_len = packet.payloadSize;
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &serverAddr;
+        msg.msg_namelen = sizeof(serverAddr);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+
+        int result = static_cast<int>(sendmsg(sock, &msg, frameSendFlags));
+#endif
+        frameSyscalls++;
+
         if (result == SOCKET_ERROR) {
-            int error = WSAGetLastError();
-            // 非阻塞模式下的WSAEWOULDBLOCK错误是正常的，其他错误需要处理
-            if (error != WSAEWOULDBLOCK) {
+            int error = net::lastError();
+            // 非阻塞模式下的WOULDBLOCK错误是正常的，其他错误需要处理
+            if (!net::isWouldBlock(error)) {
                 std::cerr << "Failed to send packet: " << error << std::endl;
-                // 直接返回失败，丢弃整个帧
-                return false;
+                return -1;
+            }
+
+            // 发送缓冲区已满，阻塞的分包及之后的分包由调用方重试
+            sent = i;
+            return frameSyscalls;
+        }
+
+        packetsSent.fetch_add(1, std::memory_order_relaxed);
+        bytesSent.fetch_add(result, std::memory_order_relaxed);
+        if (frameSendFlags) {
+            frameZeroCopyMessages++;
+        }
+    }
+
+    sent = count;
+    return frameSyscalls;
+}
+
+#ifdef __linux__
+int UDPTransmitter::sendBatched(const OutPacket* packets, unsigned int count, unsigned int& sent) {
+    mmsghdr msgs[kBatchSize];
+    iovec iovs[kBatchSize * 2];
+
+    int frameSyscalls = 0;
+    unsigned int next = 0;
+
+    while (next < count) {
+        unsigned int batch = std::min(kBatchSize, count - next);
+
+        // 构造本批次的消息数组，每条消息由包头和负载切片两段iovec组成
+        for (unsigned int i = 0; i < batch; i++) {
+            const OutPacket& packet = packets[next + i];
+            iovs[i * 2].iov_base = const_cast<uint8_t*>(packet.header);
+            iovs[i * 2].iov_len = packet.headerSize;
+            iovs[i * 2 + 1].iov_base = const_cast<uint8_t*>(packet.payload);
+            iovs[i * 2 + 1].iov_len = packet.payloadSize;
+
+            memset(&msgs[i], 0, sizeof(mmsghdr));
+            msgs[i].msg_hdr.msg_name = &serverAddr;
+            msgs[i].msg_hdr.msg_namelen = sizeof(serverAddr);
+            msgs[i].msg_hdr.msg_iov = &iovs[i * 2];
+            msgs[i].msg_hdr.msg_iovlen = 2;
+        }
+
+        unsigned int done = 0;
+        while (done < batch) {
+            int result = sendmmsg(sock, msgs + done, batch - done, frameSendFlags);
+            frameSyscalls++;
+
+            if (result < 0) {
+                int error = net::lastError();
+                if (!net::isWouldBlock(error)) {
+                    std::cerr << "Failed to send packet batch: " << error << std::endl;
+                    return -1;
+                }
+
+                // 发送缓冲区已满，阻塞的分包及之后的分包由调用方重试
+                sent = next + done;
+                return frameSyscalls;
+            }
+
+            for (int i = 0; i < result; i++) {
+                bytesSent.fetch_add(msgs[done + i].msg_len, std::memory_order_relaxed);
+            }
+            packetsSent.fetch_add(result, std::memory_order_relaxed);
+            if (frameSendFlags) {
+                frameZeroCopyMessages += result;
+            }
+            done += result;
+        }
+
+        next += batch;
+    }
+
+    sent = count;
+    return frameSyscalls;
+}
+
+int UDPTransmitter::sendSegmented(const OutPacket* packets, unsigned int count, unsigned int& sent) {
+    iovec iovs[kMaxGsoSegments * 2];
+    char control[CMSG_SPACE(sizeof(uint16_t))];
+
+    unsigned int maxSegments = frameSendFlags ? kMaxZeroCopyGsoSegments : kMaxGsoSegments;
+    int frameSyscalls = 0;
+    unsigned int next = 0;
+
+    while (next < count) {
+        // 以首包大小作为分段大小，连续收集同样大小的分包；
+        // 较小的分包只能作为超级包的最后一段
+        uint32_t segmentSize = packets[next].headerSize + packets[next].payloadSize;
+        unsigned int segments = 0;
+        size_t length = 0;
+
+        while (next + segments < count && segments < maxSegments) {
+            const OutPacket& packet = packets[next + segments];
+            uint32_t packetSize = packet.headerSize + packet.payloadSize;
+            if (packetSize > segmentSize || length + packetSize > kMaxGsoBytes) {
+                break;
+            }
+
+            iovs[segments * 2].iov_base = const_cast<uint8_t*>(packet.header);
+            iovs[segments * 2].iov_len = packet.headerSize;
+            iovs[segments * 2 + 1].iov_base = const_cast<uint8_t*>(packet.payload);
+            iovs[segments * 2 + 1].iov_len = packet.payloadSize;
+            length += packetSize;
+            segments++;
+
+            if (packetSize < segmentSize) {
+                break;
+            }
+        }
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &serverAddr;
+        msg.msg_namelen = sizeof(serverAddr);
+        msg.msg_iov = iovs;
+        msg.msg_iovlen = segments * 2;
+
+        // 通过控制消息指定分段大小，内核按segmentSize把超级包切成独立的UDP报文
+        if (segments > 1) {
+            memset(control, 0, sizeof(control));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_UDP;
+            cmsg->cmsg_type = UDP_SEGMENT;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+            uint16_t gsoSize = static_cast<uint16_t>(segmentSize);
+            memcpy(CMSG_DATA(cmsg), &gsoSize, sizeof(gsoSize));
+        }
+
+        int flags = frameSendFlags;
+        ssize_t result = sendmsg(sock, &msg, flags);
+        frameSyscalls++;
+
+        if (result < 0 && flags && net::lastError() == EMSGSIZE) {
+            // 页片段数超出skb上限，本超级包改为由内核复制发送
+            flags = 0;
+            result = sendmsg(sock, &msg, flags);
+            frameSyscalls++;
+        }
+
+        if (result < 0) {
+            int error = net::lastError();
+            if (net::isWouldBlock(error)) {
+                // 发送缓冲区已满，整个超级包由调用方重试
+                sent = next;
+                return frameSyscalls;
+            } else if (error == EIO || error == EINVAL) {
+                // 网卡不支持校验和卸载或分段大小超出路径MTU，剩余分包改用sendmmsg
+                std::cerr << "UDP GSO send failed (" << error << "), falling back to sendmmsg" << std::endl;
+                activeBackend = SendBackend::Batched;
+                unsigned int batchedSent = 0;
+                int batchedSyscalls = sendBatched(packets + next, count - next, batchedSent);
+                sent = next + batchedSent;
+                return batchedSyscalls < 0 ? -1 : frameSyscalls + batchedSyscalls;
+            } else {
+                std::cerr << "Failed to send segmented packets: " << error << std::endl;
+                return -1;
+            }
+        }
+
+        packetsSent.fetch_add(segments, std::memory_order_relaxed);
+        bytesSent.fetch_add(result, std::memory_order_relaxed);
+        if (flags) {
+            frameZeroCopyMessages++;
+        }
+
+        next += segments;
+    }
+
+    sent = count;
+    return frameSyscalls;
+}
+
+int UDPTransmitter::sendUring(const OutPacket* packets, unsigned int count, unsigned int& sent) {
+    int frameSyscalls = 0;
+    unsigned int next = 0;
+
+    while (next < count) {
+        // 整帧（或一个突发）作为一条链，超过提交队列深度时分成多条
+        unsigned int chain = 0;
+        while (next + chain < count) {
+            const OutPacket& packet = packets[next + chain];
+            if (!uring.prepareSend(packet.header, packet.headerSize, packet.payload, packet.payloadSize)) {
+                break;
             }
+            chain++;
+        }
+        if (chain == 0) {
+            std::cerr << "Failed to queue packet for io_uring" << std::endl;
+            return -1;
         }
-        
-        // 简单的流量控制：如果发送缓冲区满了，稍微延迟一下
-        if (result == SOCKET_ERROR && WSAGetLastError() == WSAEWOULDBLOCK) {
-            // 短暂睡眠，避免CPU占用过高
-            Sleep(1);
+
+        unsigned int chainSent = 0;
+        size_t chainBytes = 0;
+        bool blocked = false;
+        int calls = uring.submitChain(chainSent, chainBytes, blocked);
+        if (calls < 0) {
+            return -1;
+        }
+        frameSyscalls += calls;
+
+        packetsSent.fetch_add(chainSent, std::memory_order_relaxed);
+        bytesSent.fetch_add(chainBytes, std::memory_order_relaxed);
+        if (uring.usesRegisteredBuffers()) {
+            // 分包整体复制到注册缓冲区
+            bytesCopied.fetch_add(chainBytes, std::memory_order_relaxed);
         }
+        next += chainSent;
+
+        if (blocked) {
+            // 发送缓冲区已满，阻塞的分包之后的SQE已被取消，由调用方从阻塞的分包重试
+            sent = next;
+            return frameSyscalls;
+        }
+    }
+
+    sent = count;
+    return frameSyscalls;
+}
+#endif
+
+UDPTransmitter::TransmitStats UDPTransmitter::getStats() const {
+    TransmitStats stats;
+    stats.framesSent = framesSent.load(std::memory_order_relaxed);
+    stats.packetsSent = packetsSent.load(std::memory_order_relaxed);
+    stats.bytesSent = bytesSent.load(std::memory_order_relaxed);
+    stats.packetsDropped = packetsDropped.load(std::memory_order_relaxed);
+    stats.blockedSends = blockedSends.load(std::memory_order_relaxed);
+    stats.sendErrors = sendErrors.load(std::memory_order_relaxed);
+    stats.syscalls = syscalls.load(std::memory_order_relaxed);
+    stats.totalSendTimeUs = totalSendTimeUs.load(std::memory_order_relaxed);
+    stats.lastFrameSyscalls = lastFrameSyscalls.load(std::memory_order_relaxed);
+    stats.lastFrameSendTimeUs = lastFrameSendTimeUs.load(std::memory_order_relaxed);
+    stats.avgSyscallsPerFrame = stats.framesSent ? static_cast<double>(stats.syscalls) / stats.framesSent : 0.0;
+    stats.avgSendTimeUs = stats.framesSent ? static_cast<double>(stats.totalSendTimeUs) / stats.framesSent : 0.0;
+    stats.backend = activeBackend.load(std::memory_order_relaxed);
+    stats.allocations = allocations.load(std::memory_order_relaxed);
+    stats.bytesCopied = bytesCopied.load(std::memory_order_relaxed);
+    stats.avgAllocationsPerFrame = stats.framesSent ? static_cast<double>(stats.allocations) / stats.framesSent : 0.0;
+    stats.avgBytesCopiedPerFrame = stats.framesSent ? static_cast<double>(stats.bytesCopied) / stats.framesSent : 0.0;
+    stats.zeroCopy = zeroCopyEnabled;
+    stats.zeroCopySends = zeroCopySends.load(std::memory_order_relaxed);
+    stats.zeroCopyCompletions = zeroCopyCompletions.load(std::memory_order_relaxed);
+    stats.zeroCopyDeferredCopies = zeroCopyDeferredCopies.load(std::memory_order_relaxed);
+    stats.zeroCopySlotStalls = zeroCopySlotStalls.load(std::memory_order_relaxed);
+    stats.keyframesSent = keyframesSent.load(std::memory_order_relaxed);
+    stats.fecParityPackets = fecParityPackets.load(std::memory_order_relaxed);
+    stats.fecEncodeTimeUs = fecEncodeTimeUs.load(std::memory_order_relaxed);
+    stats.avgFecEncodeTimeUs = stats.framesSent ? static_cast<double>(stats.fecEncodeTimeUs) / stats.framesSent : 0.0;
+    stats.nacksReceived = nacksReceived.load(std::memory_order_relaxed);
+    stats.retransmitRequests = retransmitRequests.load(std::memory_order_relaxed);
+    stats.packetsRetransmitted = packetsRetransmitted.load(std::memory_order_relaxed);
+    stats.retransmitExpired = retransmitExpired.load(std::memory_order_relaxed);
+    stats.retransmitUnavailable = retransmitUnavailable.load(std::memory_order_relaxed);
+    stats.reportsReceived = reportsReceived.load(std::memory_order_relaxed);
+    stats.clockProbesAnswered = clockProbesAnswered.load(std::memory_order_relaxed);
+
+    stats.interleaving = interleaving;
+    stats.interleavedFrames = interleavedFrames.load(std::memory_order_relaxed);
+
+    PacketPacer::Stats pacing = pacer.getStats();
+    stats.pacing = pacer.isEnabled();
+    stats.pacingWaits = pacing.waits;
+    stats.avgPacingLatenessUs = pacing.avgLatenessUs;
+    stats.departureJitterUs = pacing.departureJitterUs;
+    stats.pacingRateKbps = pacing.lastRateKbps;
+
+    RtpPacketizer::Stats rtp = rtpPacketizer.getStats();
+    stats.rtp = rtpConfig.enabled;
+    stats.rtpSingleNals = rtp.singleNals;
+    stats.rtpAggregatedNals = rtp.aggregatedNals;
+    stats.rtpAggregationPackets = rtp.aggregationPackets;
+    stats.rtpFragmentedNals = rtp.fragmentedNals;
+
+    UringSender::Stats uringStats = uring.getStats();
+    stats.uringSqPoll = uring.isSqPoll();
+    stats.uringRegisteredBuffers = uring.usesRegisteredBuffers();
+    stats.uringSubmitted = uringStats.submitted;
+    stats.uringCancelled = uringStats.cancelled;
+    stats.uringEnters = uringStats.enters;
+    stats.uringWakeups = uringStats.wakeups;
+    stats.uringNotifications = uringStats.notifications;
+    stats.uringBufferStalls = uringStats.bufferStalls;
+
+    // 线上字节 = 协议头 + 负载 + 每包IPv4/UDP头
+    uint64_t built = packetsBuilt.load(std::memory_order_relaxed);
+    uint64_t overhead = headerBytes.load(std::memory_order_relaxed) + built * PathMtuDiscovery::kIpUdpOverhead;
+    uint64_t wireBytes = overhead + payloadBytes.load(std::memory_order_relaxed);
+    stats.packetSize = packetSize.load(std::memory_order_relaxed);
+    stats.avgPacketsPerFrame = stats.framesSent ? static_cast<double>(built) / stats.framesSent : 0.0;
+    stats.headerOverheadPercent = wireBytes ? overhead * 100.0 / wireBytes : 0.0;
+
+    PathMtuDiscovery::Stats pmtu = pathMtu.getStats();
+    stats.pathMtu = pathMtu.isRunning();
+    stats.pathMtuKernelMtu = pmtu.kernelMtu;
+    stats.pathMtuProbesSent = pmtu.probesSent;
+    stats.pathMtuProbesAcked = pmtu.probesAcked;
+    stats.pathMtuProbesRejected = pmtu.probesRejected;
+    stats.pathMtuSearches = pmtu.searches;
+    stats.pathMtuResponding = pmtu.receiverResponding;
+    return stats;
+}
+
+const char* UDPTransmitter::backendName(SendBackend backend) {
+    switch (backend) {
+        case SendBackend::Auto: return "auto";
+        case SendBackend::PerPacket: return "sendto";
+        case SendBackend::Batched: return "sendmmsg";
+        case SendBackend::Segmented: return "gso";
+        case SendBackend::Uring: return "uring";
+    }
+    return "unknown";
+}
+
+bool UDPTransmitter::parseBackend(const std::string& name, SendBackend& backend) {
+    if (name == "auto") {
+        backend = SendBackend::Auto;
+    } else if (name == "sendto") {
+        backend = SendBackend::PerPacket;
+    } else if (name == "sendmmsg") {
+        backend = SendBackend::Batched;
+    } else if (name == "gso") {
+        backend = SendBackend::Segmented;
+    } else if (name == "uring") {
+        backend = SendBackend::Uring;
+    } else {
+        return false;
     }
-    
     return true;
 }
 
 void UDPTransmitter::stop() {
     running = false;
-    
+
+    // 探测线程等待的应答来自反馈线程，先于反馈线程停止
+    pathMtu.stop();
+
+    if (feedbackThread.joinable()) {
+        feedbackThread.join();
+    }
+    if (feedbackSock != INVALID_SOCKET) {
+        net::closeSocket(feedbackSock);
+        feedbackSock = INVALID_SOCKET;
+    }
+
     if (sock != INVALID_SOCKET) {
-        closesocket(sock);
+        // 关闭前收取剩余的零拷贝通知；内核会持有页面引用直到发送完成，
+        // 因此关闭后释放在途缓冲区是安全的
+        if (zeroCopyEnabled) {
+            reapZeroCopyCompletions();
+        }
+        uring.shutdown();
+
+        net::closeSocket(sock);
         sock = INVALID_SOCKET;
     }
-}
\ No newline at end of file
+}
+
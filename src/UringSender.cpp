@@ -0,0 +1,571 @@
+#include "UringSender.h"
+#include <iostream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <thread>
+#include <chrono>
+
+#if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>)
+        #define HAVE_IO_URING 1
+    #endif
+#endif
+
+#ifdef HAVE_IO_URING
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    // 旧版内核头文件中可能缺少SEND_ZC相关定义，此时只能使用SENDMSG
+    #ifndef IORING_RECVSEND_FIXED_BUF
+        #define URING_NO_SEND_ZC 1
+    #endif
+#endif
+
+namespace {
+
+#ifdef HAVE_IO_URING
+// SQPOLL模式下先自旋等待完成事件，超过该次数再进入内核等待
+const unsigned int kCompletionSpins = 4096;
+
+// user_data：低32位为链内序号，高32位为注册缓冲区槽位+1（0表示未使用注册缓冲区）
+uint64_t makeUserData(unsigned int index, unsigned int slot) {
+    return (static_cast<uint64_t>(slot) << 32) | index;
+}
+
+unsigned int loadAcquire(const unsigned int* p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void storeRelease(unsigned int* p, unsigned int value) {
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+int uringSetup(unsigned int entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringRegister(int fd, unsigned int opcode, const void* arg, unsigned int count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+#endif
+
+} // namespace
+
+UringSender::UringSender()
+    : ringFd(-1),
+      sqRing(nullptr),
+      sqRingSize(0),
+      cqRing(nullptr),
+      cqRingSize(0),
+      sqeMemory(nullptr),
+      sqeMemorySize(0),
+      sqHead(nullptr),
+      sqTail(nullptr),
+      sqMask(nullptr),
+      sqFlags(nullptr),
+      sqArray(nullptr),
+      sqEntries(0),
+      cqHead(nullptr),
+      cqTail(nullptr),
+      cqMask(nullptr),
+      cqes(nullptr),
+      chainLength(0),
+      chainTail(0),
+      buffers(nullptr),
+      buffersSize(0),
+      bufferSlots(0),
+      nextSlot(0),
+      busySlots(0),
+      submitted(0),
+      completed(0),
+      failed(0),
+      cancelled(0),
+      enters(0),
+      wakeups(0),
+      notifications(0),
+      bufferStalls(0) {
+    memset(&destination, 0, sizeof(destination));
+}
+
+UringSender::~UringSender() {
+    shutdown();
+}
+
+bool UringSender::isSupported() {
+#ifdef HAVE_IO_URING
+    static const bool supported = [] {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        int fd = uringSetup(2, &params);
+        if (fd < 0) {
+            return false;
+        }
+        close(fd);
+        return true;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool UringSender::initialize(SOCKET sock, const sockaddr_in& destination, const Config& config) {
+#ifdef HAVE_IO_URING
+    shutdown();
+    this->destination = destination;
+    this->config = config;
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    if (config.sqPoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = config.sqPollIdleMs;
+    }
+
+    ringFd = uringSetup(config.entries, &params);
+    if (ringFd < 0) {
+        std::cerr << "io_uring_setup failed: " << errno << std::endl;
+        return false;
+    }
+
+    // 映射提交队列、完成队列和SQE数组；较新的内核中两个队列共用一次映射
+    sqEntries = params.sq_entries;
+    sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) {
+        sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+    }
+
+    sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+        sqRing = nullptr;
+        std::cerr << "Failed to map io_uring submission queue: " << errno << std::endl;
+        shutdown();
+        return false;
+    }
+
+    if (singleMmap) {
+        cqRing = sqRing;
+    } else {
+        cqRing = mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqRing == MAP_FAILED) {
+            cqRing = nullptr;
+            std::cerr << "Failed to map io_uring completion queue: " << errno << std::endl;
+            shutdown();
+            return false;
+        }
+    }
+
+    sqeMemorySize = params.sq_entries * sizeof(io_uring_sqe);
+    sqeMemory = mmap(nullptr, sqeMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqeMemory == MAP_FAILED) {
+        sqeMemory = nullptr;
+        std::cerr << "Failed to map io_uring SQEs: " << errno << std::endl;
+        shutdown();
+        return false;
+    }
+
+    uint8_t* sq = static_cast<uint8_t*>(sqRing);
+    uint8_t* cq = static_cast<uint8_t*>(cqRing);
+    sqHead = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+    sqFlags = reinterpret_cast<unsigned int*>(sq + params.sq_off.flags);
+    sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+    cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+    cqes = cq + params.cq_off.cqes;
+    chainTail = *sqTail;
+    chainLength = 0;
+
+    // 套接字注册为固定文件，SQE中以索引0引用，省去每次提交的文件查找和引用计数
+    int fd = static_cast<int>(sock);
+    if (uringRegister(ringFd, IORING_REGISTER_FILES, &fd, 1) < 0) {
+        std::cerr << "Failed to register socket with io_uring: " << errno << std::endl;
+        shutdown();
+        return false;
+    }
+
+    if (this->config.registeredBuffers && !probeSendZc()) {
+        std::cerr << "io_uring SEND_ZC is not supported, registered buffers disabled" << std::endl;
+        this->config.registeredBuffers = false;
+    }
+
+    if (this->config.registeredBuffers) {
+        // 每个SQE至少两个槽位，完成通知稍有延迟时不阻塞下一条链
+        bufferSlots = sqEntries * 2;
+        buffersSize = static_cast<size_t>(bufferSlots) * this->config.bufferSize;
+        buffers = static_cast<uint8_t*>(mmap(nullptr, buffersSize, PROT_READ | PROT_WRITE,
+                                             MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0));
+        if (buffers == MAP_FAILED) {
+            buffers = nullptr;
+            std::cerr << "Failed to allocate io_uring buffers: " << errno << std::endl;
+            shutdown();
+            return false;
+        }
+
+        iovec region;
+        region.iov_base = buffers;
+        region.iov_len = buffersSize;
+        if (uringRegister(ringFd, IORING_REGISTER_BUFFERS, &region, 1) < 0) {
+            std::cerr << "Failed to register io_uring buffers: " << errno << ", registered buffers disabled" << std::endl;
+            munmap(buffers, buffersSize);
+            buffers = nullptr;
+            buffersSize = 0;
+            bufferSlots = 0;
+            this->config.registeredBuffers = false;
+        } else {
+            slotBusy.assign(bufferSlots, 0);
+            busySlots = 0;
+            nextSlot = 0;
+        }
+    }
+
+    messages.resize(sqEntries);
+    iovecs.resize(sqEntries * 2);
+    results.resize(sqEntries);
+    return true;
+#else
+    (void)sock;
+    (void)destination;
+    (void)config;
+    std::cerr << "io_uring is not available on this platform" << std::endl;
+    return false;
+#endif
+}
+
+void UringSender::shutdown() {
+#ifdef HAVE_IO_URING
+    if (ringFd >= 0) {
+        // 等待在途的SEND_ZC完成通知，之后内核不再引用注册缓冲区
+        for (unsigned int i = 0; i < 1000 && busySlots > 0; i++) {
+            reapCompletions();
+            if (busySlots > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    }
+
+    if (sqeMemory) {
+        munmap(sqeMemory, sqeMemorySize);
+        sqeMemory = nullptr;
+    }
+    if (cqRing && cqRing != sqRing) {
+        munmap(cqRing, cqRingSize);
+    }
+    cqRing = nullptr;
+    if (sqRing) {
+        munmap(sqRing, sqRingSize);
+        sqRing = nullptr;
+    }
+    if (ringFd >= 0) {
+        close(ringFd);
+        ringFd = -1;
+    }
+    if (buffers) {
+        munmap(buffers, buffersSize);
+        buffers = nullptr;
+    }
+#endif
+    buffersSize = 0;
+    bufferSlots = 0;
+    busySlots = 0;
+    slotBusy.clear();
+    chainLength = 0;
+    sqEntries = 0;
+}
+
+bool UringSender::probeSendZc() {
+#if defined(HAVE_IO_URING) && !defined(URING_NO_SEND_ZC)
+    const unsigned int opCount = 256;
+    std::vector<uint8_t> storage(sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op), 0);
+    io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (uringRegister(ringFd, IORING_REGISTER_PROBE, probe, opCount) < 0) {
+        return false;
+    }
+    return IORING_OP_SEND_ZC <= probe->last_op && (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED);
+#else
+    return false;
+#endif
+}
+
+bool UringSender::prepareSend(const uint8_t* header, uint32_t headerSize, const uint8_t* payload, uint32_t payloadSize) {
+#ifdef HAVE_IO_URING
+    if (ringFd < 0 || chainLength >= sqEntries) {
+        return false;
+    }
+
+    unsigned int index = (chainTail + chainLength) & *sqMask;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqeMemory) + index;
+    memset(sqe, 0, sizeof(*sqe));
+
+    // 链中每个SQE都带IO_LINK，提交时清除最后一个的标志；MSG_DONTWAIT使发送缓冲区满时
+    // 立即以EAGAIN完成（而不是由io_uring挂起重试），链中后续分包随之取消
+    sqe->fd = 0;
+    sqe->flags = IOSQE_FIXED_FILE | IOSQE_IO_LINK;
+    sqe->msg_flags = MSG_DONTWAIT;
+
+#ifndef URING_NO_SEND_ZC
+    if (config.registeredBuffers) {
+        size_t size = static_cast<size_t>(headerSize) + payloadSize;
+        unsigned int slot = 0;
+        if (size > config.bufferSize || !acquireSlot(slot)) {
+            return false;
+        }
+
+        uint8_t* buffer = buffers + static_cast<size_t>(slot) * config.bufferSize;
+        memcpy(buffer, header, headerSize);
+        memcpy(buffer + headerSize, payload, payloadSize);
+
+        sqe->opcode = IORING_OP_SEND_ZC;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer);
+        sqe->len = static_cast<uint32_t>(size);
+        sqe->ioprio = IORING_RECVSEND_FIXED_BUF;
+        sqe->buf_index = 0;
+        sqe->addr2 = reinterpret_cast<uint64_t>(&destination);
+        sqe->addr_len = sizeof(destination);
+        sqe->user_data = makeUserData(chainLength, slot + 1);
+    } else
+#endif
+    {
+        iovec* iov = &iovecs[chainLength * 2];
+        iov[0].iov_base = const_cast<uint8_t*>(header);
+        iov[0].iov_len = headerSize;
+        iov[1].iov_base = const_cast<uint8_t*>(payload);
+        iov[1].iov_len = payloadSize;
+
+        msghdr& msg = messages[chainLength];
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_name = &destination;
+        msg.msg_namelen = sizeof(destination);
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = reinterpret_cast<uint64_t>(&msg);
+        sqe->len = 1;
+        sqe->user_data = makeUserData(chainLength, 0);
+    }
+
+    sqArray[index] = index;
+    results[chainLength] = 0;
+    chainLength++;
+    return true;
+#else
+    (void)header;
+    (void)headerSize;
+    (void)payload;
+    (void)payloadSize;
+    return false;
+#endif
+}
+
+int UringSender::submitChain(unsigned int& sent, size_t& bytes, bool& blocked) {
+    sent = 0;
+    bytes = 0;
+    blocked = false;
+
+#ifdef HAVE_IO_URING
+    if (ringFd < 0) {
+        return -1;
+    }
+    if (chainLength == 0) {
+        return 0;
+    }
+
+    unsigned int length = chainLength;
+    io_uring_sqe* last = static_cast<io_uring_sqe*>(sqeMemory) + ((chainTail + length - 1) & *sqMask);
+    last->flags &= ~IOSQE_IO_LINK;
+
+    chainTail += length;
+    chainLength = 0;
+    storeRelease(sqTail, chainTail);
+    submitted.fetch_add(length, std::memory_order_relaxed);
+
+    int syscalls = 0;
+    unsigned int reaped = 0;
+
+    if (config.sqPoll) {
+        // 内核线程空闲休眠后需要显式唤醒；尾指针的写入必须先于标志的读取
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (loadAcquire(sqFlags) & IORING_SQ_NEED_WAKEUP) {
+            if (enter(0, 0, IORING_ENTER_SQ_WAKEUP) < 0) {
+                return -1;
+            }
+            syscalls++;
+            wakeups.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 完成事件直接从共享内存读取，自旋一段时间仍未到齐才进入内核等待
+        unsigned int spins = 0;
+        while (reaped < length) {
+            reaped += reapCompletions();
+            if (reaped >= length) {
+                break;
+            }
+            if (++spins < kCompletionSpins) {
+                continue;
+            }
+            // 自旋未果（如轮询线程与发送线程共用CPU）时一次等待剩余的全部完成事件
+            if (enter(0, length - reaped, IORING_ENTER_GETEVENTS) < 0) {
+                return -1;
+            }
+            syscalls++;
+            spins = 0;
+        }
+    } else {
+        // 一次系统调用提交整条链；MSG_DONTWAIT的UDP发送在提交时即完成，等待不会阻塞
+        if (enter(length, length, IORING_ENTER_GETEVENTS) < 0) {
+            return -1;
+        }
+        syscalls++;
+
+        reaped += reapCompletions();
+        while (reaped < length) {
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0) {
+                return -1;
+            }
+            syscalls++;
+            reaped += reapCompletions();
+        }
+    }
+
+    // 链中的分包按顺序执行，成功的分包一定位于失败分包之前
+    for (unsigned int i = 0; i < length; i++) {
+        int result = results[i];
+        if (result >= 0) {
+            sent++;
+            bytes += static_cast<size_t>(result);
+            continue;
+        }
+
+        if (result == -EAGAIN) {
+            blocked = true;
+        } else {
+            std::cerr << "io_uring send failed: " << -result << std::endl;
+            return -1;
+        }
+        break;
+    }
+
+    return syscalls;
+#else
+    return -1;
+#endif
+}
+
+int UringSender::enter(unsigned int toSubmit, unsigned int minComplete, unsigned int flags) {
+#ifdef HAVE_IO_URING
+    while (true) {
+        int result = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+        enters.fetch_add(1, std::memory_order_relaxed);
+        if (result >= 0) {
+            return result;
+        }
+        if (errno != EINTR) {
+            std::cerr << "io_uring_enter failed: " << errno << std::endl;
+            return -1;
+        }
+    }
+#else
+    (void)toSubmit;
+    (void)minComplete;
+    (void)flags;
+    return -1;
+#endif
+}
+
+unsigned int UringSender::reapCompletions() {
+#ifdef HAVE_IO_URING
+    unsigned int head = *cqHead;
+    unsigned int tail = loadAcquire(cqTail);
+    unsigned int mask = *cqMask;
+    unsigned int reaped = 0;
+
+    while (head != tail) {
+        const io_uring_cqe& cqe = static_cast<const io_uring_cqe*>(cqes)[head & mask];
+        unsigned int index = static_cast<unsigned int>(cqe.user_data & 0xFFFFFFFFu);
+        unsigned int slot = static_cast<unsigned int>(cqe.user_data >> 32);
+        head++;
+
+#ifndef URING_NO_SEND_ZC
+        // SEND_ZC的完成通知：内核不再引用该槽位的数据
+        if (cqe.flags & IORING_CQE_F_NOTIF) {
+            notifications.fetch_add(1, std::memory_order_relaxed);
+            if (slot > 0 && slotBusy[slot - 1]) {
+                slotBusy[slot - 1] = 0;
+                busySlots--;
+            }
+            continue;
+        }
+
+        // 没有后续通知（发送失败或被取消）时槽位立即可用
+        if (slot > 0 && !(cqe.flags & IORING_CQE_F_MORE) && slotBusy[slot - 1]) {
+            slotBusy[slot - 1] = 0;
+            busySlots--;
+        }
+#endif
+
+        if (index < results.size()) {
+            results[index] = cqe.res;
+        }
+        if (cqe.res >= 0) {
+            completed.fetch_add(1, std::memory_order_relaxed);
+        } else if (cqe.res == -ECANCELED) {
+            cancelled.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            failed.fetch_add(1, std::memory_order_relaxed);
+        }
+        reaped++;
+    }
+
+    storeRelease(cqHead, head);
+    return reaped;
+#else
+    return 0;
+#endif
+}
+
+bool UringSender::acquireSlot(unsigned int& slot) {
+#ifdef HAVE_IO_URING
+    if (slotBusy[nextSlot]) {
+        reapCompletions();
+    }
+
+    // 槽位仍被在途的SEND_ZC占用：等待完成通知（回环上通知在接收端取走数据后到达）
+    if (slotBusy[nextSlot]) {
+        bufferStalls.fetch_add(1, std::memory_order_relaxed);
+        while (slotBusy[nextSlot]) {
+            if (enter(0, 1, IORING_ENTER_GETEVENTS) < 0) {
+                return false;
+            }
+            reapCompletions();
+        }
+    }
+
+    slot = nextSlot;
+    slotBusy[slot] = 1;
+    busySlots++;
+    nextSlot = (nextSlot + 1) % bufferSlots;
+    return true;
+#else
+    (void)slot;
+    return false;
+#endif
+}
+
+UringSender::Stats UringSender::getStats() const {
+    Stats stats;
+    stats.submitted = submitted.load(std::memory_order_relaxed);
+    stats.completed = completed.load(std::memory_order_relaxed);
+    stats.failed = failed.load(std::memory_order_relaxed);
+    stats.cancelled = cancelled.load(std::memory_order_relaxed);
+    stats.enters = enters.load(std::memory_order_relaxed);
+    stats.wakeups = wakeups.load(std::memory_order_relaxed);
+    stats.notifications = notifications.load(std::memory_order_relaxed);
+    stats.bufferStalls = bufferStalls.load(std::memory_order_relaxed);
+    return stats;
+}
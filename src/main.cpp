@@ -34,10 +34,76 @@ int main(int argc, char* argv[]) {
     std::cout << "  Display Index: " << config.displayIndex << std::endl;
     std::cout << "  Output Resolution: " << config.outputWidth << "x" << config.outputHeight << std::endl;
     std::cout << "  Frame Rate: " << config.frameRate << " FPS" << std::endl;
+    std::cout << "  Pipeline: " << config.pipelineMode << std::endl;
+    std::cout << "  Threads: capture " << config.captureThread << ", encode " << config.encodeThread
+              << ", send " << config.sendThread << (config.lockMemory ? ", memory locked" : "") << std::endl;
+    std::cout << "  Capture Clock: spin ";
+    if (config.captureSpinUs) {
+        std::cout << config.captureSpinUs << " us";
+    } else {
+        std::cout << "adaptive";
+    }
+    if (config.alignCapture) {
+        std::cout << ", aligned " << config.capturePhaseUs << " us after present";
+    }
+    std::cout << std::endl;
     std::cout << "  Bitrate: " << config.bitrate << " kbps" << std::endl;
     std::cout << "  Server IP: " << config.serverIP << std::endl;
     std::cout << "  Server Port: " << config.serverPort << std::endl;
     std::cout << "  Max Packet Size: " << config.maxPacketSize << " bytes" << std::endl;
+    if (config.pathMtu) {
+        std::cout << "  Path MTU Discovery: on (re-probe every " << config.pathMtuIntervalMs << " ms)" << std::endl;
+    }
+    std::cout << "  Send Backend: " << config.sendBackend << std::endl;
+    std::cout << "  Zero Copy: " << (config.zeroCopy ? "on" : "off") << std::endl;
+    if (config.sendBackend == "uring") {
+        std::cout << "  io_uring: " << config.uringEntries << " entries, SQPOLL "
+                  << (config.uringSqPoll ? "on" : "off") << std::endl;
+    }
+    std::cout << "  FEC: " << config.fecMode << " (redundancy " << config.fecRedundancy
+              << ", keyframe " << config.fecKeyframeRedundancy << ", group " << config.fecGroupSize
+              << ", kernel " << FecCodec::kernelName() << ")" << std::endl;
+    std::cout << "  Interleaving: " << (config.interleave ? "on" : "off") << std::endl;
+    if (config.nackPort != 0) {
+        std::cout << "  NACK Port: " << config.nackPort << " (ring " << config.retransmitRing
+                  << " packets, deadline " << config.retransmitDeadlineMs << " ms)" << std::endl;
+    } else {
+        std::cout << "  NACK: off" << std::endl;
+    }
+    if (config.pacing) {
+        std::cout << "  Pacing: " << config.pacingFraction * 100 << "% of frame interval, burst "
+                  << config.pacingBurst << " packets" << std::endl;
+    } else {
+        std::cout << "  Pacing: off" << std::endl;
+    }
+    if (config.abr) {
+        std::cout << "  Adaptive Bitrate: " << config.abrMinBitrate << " - "
+                  << (config.abrMaxBitrate ? config.abrMaxBitrate : config.bitrate) << " kbps" << std::endl;
+    } else {
+        std::cout << "  Adaptive Bitrate: off" << std::endl;
+    }
+    if (config.frameDeadlineMs > 0) {
+        std::cout << "  Frame Deadline: " << config.frameDeadlineMs << " ms after capture" << std::endl;
+    } else {
+        std::cout << "  Frame Deadline: off" << std::endl;
+    }
+    std::cout << "  Congestion Drop: " << (config.congestionDrop ? "non-reference frames" : "off") << std::endl;
+    if (config.transport == "shm") {
+        std::cout << "  Transport: shared memory " << config.shmName << " (" << config.shmSlots << " slots of "
+                  << config.shmSlotSize << " bytes)" << std::endl;
+    }
+    std::cout << "  Protocol: " << config.protocol;
+    if (config.protocol == "rtp") {
+        std::cout << " (payload type " << config.rtpPayloadType;
+        if (!config.sdpFile.empty()) {
+            std::cout << ", SDP " << config.sdpFile;
+        }
+        std::cout << ")";
+    }
+    std::cout << std::endl;
+    if (config.metricsPort != 0) {
+        std::cout << "  Metrics: http://127.0.0.1:" << config.metricsPort << "/metrics" << std::endl;
+    }
     
     // 初始化LiveStreamer
     LiveStreamer streamer;
@@ -47,11 +113,69 @@ int main(int argc, char* argv[]) {
     streamerConfig.displayIndex = config.displayIndex;
     streamerConfig.outputWidth = config.outputWidth;
     streamerConfig.outputHeight = config.outputHeight;
+    streamerConfig.captureClock.spinUs = config.captureSpinUs;
+    streamerConfig.captureClock.phaseOffsetUs = config.capturePhaseUs;
+    streamerConfig.alignCapture = config.alignCapture;
+    if (!LiveStreamer::parsePipelineMode(config.pipelineMode, streamerConfig.pipelineMode)) {
+        std::cerr << "Warning: Unknown pipeline mode '" << config.pipelineMode << "', using pipelined" << std::endl;
+        streamerConfig.pipelineMode = LiveStreamer::PipelineMode::Pipelined;
+    }
+    const std::string* threadSpecs[ThreadTuning::kStages] = {&config.captureThread, &config.encodeThread, &config.sendThread};
+    for (unsigned int i = 0; i < ThreadTuning::kStages; i++) {
+        if (!ThreadTuning::parseStage(*threadSpecs[i], streamerConfig.threads.stages[i])) {
+            std::cerr << "Warning: Invalid " << ThreadTuning::stageName(static_cast<ThreadTuning::Stage>(i))
+                      << " thread setting '" << *threadSpecs[i] << "', using default scheduling" << std::endl;
+        }
+    }
+    streamerConfig.threads.lockMemory = config.lockMemory;
+    streamerConfig.threads.probeIterations = config.schedProbe;
     streamerConfig.frameRate = config.frameRate;
     streamerConfig.bitrate = config.bitrate;
     streamerConfig.serverIP = config.serverIP;
     streamerConfig.serverPort = config.serverPort;
     streamerConfig.maxPacketSize = config.maxPacketSize;
+    streamerConfig.pathMtu.enabled = config.pathMtu;
+    streamerConfig.pathMtu.intervalMs = config.pathMtuIntervalMs;
+    streamerConfig.zeroCopy = config.zeroCopy;
+    streamerConfig.uring.entries = config.uringEntries;
+    streamerConfig.uring.sqPoll = config.uringSqPoll;
+    if (!UDPTransmitter::parseBackend(config.sendBackend, streamerConfig.sendBackend)) {
+        std::cerr << "Warning: Unknown send backend '" << config.sendBackend << "', using auto" << std::endl;
+        streamerConfig.sendBackend = UDPTransmitter::SendBackend::Auto;
+    }
+    if (!FecCodec::parseMode(config.fecMode, streamerConfig.fec.mode)) {
+        std::cerr << "Warning: Unknown FEC mode '" << config.fecMode << "', FEC disabled" << std::endl;
+        streamerConfig.fec.mode = FecCodec::Mode::None;
+    }
+    streamerConfig.fec.redundancy = config.fecRedundancy;
+    streamerConfig.fec.keyframeRedundancy = config.fecKeyframeRedundancy;
+    streamerConfig.fec.maxGroupSize = config.fecGroupSize;
+    streamerConfig.interleave = config.interleave;
+    streamerConfig.retransmit.feedbackPort = config.nackPort;
+    streamerConfig.retransmit.ringPackets = config.retransmitRing;
+    streamerConfig.retransmit.deadlineMs = config.retransmitDeadlineMs;
+    streamerConfig.pacing.enabled = config.pacing;
+    streamerConfig.pacing.frameFraction = config.pacingFraction;
+    streamerConfig.pacing.burstPackets = config.pacingBurst;
+    streamerConfig.abr.enabled = config.abr;
+    streamerConfig.abr.minBitrateKbps = config.abrMinBitrate;
+    streamerConfig.abr.maxBitrateKbps = config.abrMaxBitrate;
+    if (config.protocol != "custom" && config.protocol != "rtp") {
+        std::cerr << "Warning: Unknown protocol '" << config.protocol << "', using custom" << std::endl;
+    }
+    streamerConfig.rtp.enabled = config.protocol == "rtp";
+    streamerConfig.rtp.payloadType = static_cast<uint8_t>(config.rtpPayloadType);
+    streamerConfig.rtp.sdpPath = config.sdpFile;
+    if (config.transport != "udp" && config.transport != "shm") {
+        std::cerr << "Warning: Unknown transport '" << config.transport << "', using udp" << std::endl;
+    }
+    streamerConfig.sharedMemory = config.transport == "shm";
+    streamerConfig.shm.name = config.shmName;
+    streamerConfig.shm.slotCount = config.shmSlots;
+    streamerConfig.shm.slotSize = config.shmSlotSize;
+    streamerConfig.frameDrop.deadlineMs = config.frameDeadlineMs;
+    streamerConfig.frameDrop.congestionDrop = config.congestionDrop;
+    streamerConfig.metricsPort = config.metricsPort;
     
     // 初始化
     if (!streamer.initialize(streamerConfig)) {
@@ -73,6 +197,128 @@ int main(int argc, char* argv[]) {
     std::cout << "Stopping LiveStreamer..." << std::endl;
     streamer.stop();
     
+    // 输出采集节拍统计：实际帧率与目标帧率、节拍晚于截止时刻的分布
+    auto clockStats = streamer.getCaptureClockStats();
+    std::cout << "Capture clock statistics:" << std::endl;
+    std::cout << "  Frame Rate: " << clockStats.achievedFps << " of " << clockStats.targetFps << " FPS (ticks "
+              << clockStats.ticks << ", missed " << clockStats.missedTicks << ")" << std::endl;
+    std::cout << "  Tick Jitter: avg " << clockStats.avgLatenessUs << " us, p50 " << clockStats.latenessP50Us
+              << " us, p99 " << clockStats.latenessP99Us << " us, max " << clockStats.latenessMaxUs << " us" << std::endl;
+    std::cout << "  Sleep Overshoot: " << clockStats.avgOversleepUs << " us (spin " << clockStats.spinUs << " us)" << std::endl;
+    if (streamerConfig.alignCapture) {
+        std::cout << "  Phase Alignment: " << clockStats.phaseCorrections << " corrections, last error "
+                  << clockStats.phaseErrorUs << " us" << std::endl;
+    }
+    
+    // 输出逐帧延迟：各阶段和队列区间的分位数（纳秒记录，按微秒输出），没有样本的区间不输出
+    // （run-to-completion模式下没有队列区间）
+    auto latencyStats = streamer.getLatencyStats();
+    std::cout << "Pipeline latency (" << LiveStreamer::pipelineModeName(streamerConfig.pipelineMode) << ", "
+              << latencyStats.frames << " frames):" << std::endl;
+    for (unsigned int i = 0; i < PipelineLatency::kSpans; i++) {
+        PipelineLatency::Span which = static_cast<PipelineLatency::Span>(i);
+        const HdrHistogram::Summary& span = latencyStats.spans[i];
+        if (span.count == 0) {
+            continue;
+        }
+        const char* kind = PipelineLatency::isQueue(which) ? "[queue] "
+                         : (which == PipelineLatency::Span::Total ? "" : "[stage] ");
+        std::cout << "  " << kind << PipelineLatency::spanName(which) << ": avg " << span.meanNs / 1000.0
+                  << " us, p50 " << span.p50Ns / 1000.0 << " us, p99 " << span.p99Ns / 1000.0
+                  << " us, p999 " << span.p999Ns / 1000.0 << " us, max " << span.maxNs / 1000.0 << " us" << std::endl;
+    }
+    
+    // 输出丢帧统计：按原因、阶段和帧类型
+    auto dropStats = streamer.getDropStats();
+    std::cout << "Frame drop statistics:" << std::endl;
+    std::cout << "  Frames Admitted: " << dropStats.framesAdmitted << " (late " << dropStats.framesLate << ")" << std::endl;
+    std::cout << "  Frames Dropped: " << dropStats.total()
+              << " (queue full " << dropStats.byReason(FrameDropPolicy::Reason::QueueFull)
+              << ", expired " << dropStats.byReason(FrameDropPolicy::Reason::Expired)
+              << ", congestion " << dropStats.byReason(FrameDropPolicy::Reason::Congestion)
+              << ", reference lost " << dropStats.byReason(FrameDropPolicy::Reason::ReferenceLost) << ")" << std::endl;
+    std::cout << "  Dropped by Stage: capture " << dropStats.byStage(FrameDropPolicy::Stage::Capture)
+              << ", encode " << dropStats.byStage(FrameDropPolicy::Stage::Encode)
+              << ", send " << dropStats.byStage(FrameDropPolicy::Stage::Send) << std::endl;
+    std::cout << "  Dropped by Class: IDR " << dropStats.droppedByPriority[static_cast<int>(FrameDropPolicy::Priority::Idr)]
+              << ", reference " << dropStats.droppedByPriority[static_cast<int>(FrameDropPolicy::Priority::Reference)]
+              << ", non-reference " << dropStats.droppedByPriority[static_cast<int>(FrameDropPolicy::Priority::NonReference)]
+              << " (keyframe requests " << dropStats.keyframeRequests << ")" << std::endl;
+    
+    // 输出发送统计
+    if (streamerConfig.sharedMemory) {
+        auto shmStats = streamer.getSharedMemoryStats();
+        std::cout << "Shared memory statistics (" << streamerConfig.shm.name << "):" << std::endl;
+        std::cout << "  Frames Written: " << shmStats.framesWritten << " (keyframes " << shmStats.keyframes
+                  << ", too large " << shmStats.framesTooLarge << ")" << std::endl;
+        std::cout << "  Bytes Written: " << shmStats.bytesWritten << std::endl;
+        std::cout << "  Doorbell Wakeups: " << shmStats.wakeups << std::endl;
+        std::cout << "LiveStreamer stopped" << std::endl;
+        return 0;
+    }
+    auto stats = streamer.getTransmitStats();
+    std::cout << "Transmit statistics (" << UDPTransmitter::backendName(stats.backend) << "):" << std::endl;
+    std::cout << "  Frames Sent: " << stats.framesSent << std::endl;
+    std::cout << "  Packets Sent: " << stats.packetsSent << " (dropped " << stats.packetsDropped
+              << ", blocked sends " << stats.blockedSends << ", send errors " << stats.sendErrors << ")" << std::endl;
+    std::cout << "  Bytes Sent: " << stats.bytesSent << std::endl;
+    std::cout << "  Syscalls per Frame: " << stats.avgSyscallsPerFrame << std::endl;
+    std::cout << "  Send Time per Frame: " << stats.avgSendTimeUs << " us" << std::endl;
+    std::cout << "  Packet Size: " << stats.packetSize << " bytes (" << stats.avgPacketsPerFrame
+              << " packets per frame, header overhead " << stats.headerOverheadPercent << "%)" << std::endl;
+    if (stats.pathMtu) {
+        std::cout << "  Path MTU: route MTU " << stats.pathMtuKernelMtu << ", probes sent " << stats.pathMtuProbesSent
+                  << " (acked " << stats.pathMtuProbesAcked << ", rejected " << stats.pathMtuProbesRejected
+                  << "), searches " << stats.pathMtuSearches << ", receiver "
+                  << (stats.pathMtuResponding ? "responding" : "not responding") << std::endl;
+    }
+    std::cout << "  Allocations per Frame: " << stats.avgAllocationsPerFrame << std::endl;
+    std::cout << "  Bytes Copied per Frame: " << stats.avgBytesCopiedPerFrame << std::endl;
+    if (stats.zeroCopy) {
+        std::cout << "  Zero Copy Sends: " << stats.zeroCopySends
+                  << " (completed " << stats.zeroCopyCompletions
+                  << ", kernel copied " << stats.zeroCopyDeferredCopies
+                  << ", slot stalls " << stats.zeroCopySlotStalls << ")" << std::endl;
+    }
+    if (stats.backend == UDPTransmitter::SendBackend::Uring) {
+        std::cout << "  io_uring: submitted " << stats.uringSubmitted << " SQEs (cancelled " << stats.uringCancelled
+                  << "), enters " << stats.uringEnters << ", SQPOLL " << (stats.uringSqPoll ? "on" : "off")
+                  << " (wakeups " << stats.uringWakeups << "), registered buffers "
+                  << (stats.uringRegisteredBuffers ? "on" : "off") << " (notifications " << stats.uringNotifications
+                  << ", stalls " << stats.uringBufferStalls << ")" << std::endl;
+    }
+    if (streamerConfig.fec.mode != FecCodec::Mode::None) {
+        std::cout << "  FEC Parity Packets: " << stats.fecParityPackets
+                  << " (keyframes " << stats.keyframesSent << ")" << std::endl;
+        std::cout << "  FEC Encode Time per Frame: " << stats.avgFecEncodeTimeUs << " us" << std::endl;
+    }
+    if (stats.interleaving) {
+        std::cout << "  Interleaved Frames: " << stats.interleavedFrames << " of " << stats.framesSent << std::endl;
+    }
+    if (streamerConfig.retransmit.feedbackPort != 0) {
+        std::cout << "  NACKs Received: " << stats.nacksReceived << " (requested " << stats.retransmitRequests
+                  << ", retransmitted " << stats.packetsRetransmitted << ", expired " << stats.retransmitExpired
+                  << ", unavailable " << stats.retransmitUnavailable << ")" << std::endl;
+        std::cout << "  Clock Sync Probes Answered: " << stats.clockProbesAnswered << std::endl;
+    }
+    if (stats.pacing) {
+        std::cout << "  Pacing: rate " << stats.pacingRateKbps << " kbps, waits " << stats.pacingWaits
+                  << ", timer lateness " << stats.avgPacingLatenessUs << " us, departure jitter "
+                  << stats.departureJitterUs << " us" << std::endl;
+    }
+    if (stats.rtp) {
+        std::cout << "  RTP NAL Units: single " << stats.rtpSingleNals << ", aggregated " << stats.rtpAggregatedNals
+                  << " (in " << stats.rtpAggregationPackets << " STAP-A packets), fragmented "
+                  << stats.rtpFragmentedNals << " (FU-A)" << std::endl;
+    }
+    if (streamerConfig.abr.enabled) {
+        auto abrStats = streamer.getBitrateStats();
+        std::cout << "  Adaptive Bitrate: target " << abrStats.targetBitrateKbps << " kbps ("
+                  << BitrateController::stateName(abrStats.state) << "), receive rate " << abrStats.receiveRateKbps
+                  << " kbps, reports " << abrStats.reports << ", delay decreases " << abrStats.overuses
+                  << ", loss decreases " << abrStats.lossDecreases << std::endl;
+    }
+    
     std::cout << "LiveStreamer stopped" << std::endl;
     
     return 0;
@@ -0,0 +1,350 @@
+// 网络损伤代理：在SyntheticSender/推流程序与udp_receiver之间转发UDP数据包，
+// 按NetworkImpairment模型注入可复现的丢包、突发丢包、时延抖动、乱序、重复和带宽上限，
+// 用于在单机回环上对比分包节奏、FEC、NACK和自适应码率等传输特性
+#include "NetworkImpairment.h"
+#include "NetCompat.h"
+#include "PreciseTimer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: impairment_proxy [options]" << std::endl;
+    std::cout << "  --listen-port <port>          Port the sender sends to (default 5000)" << std::endl;
+    std::cout << "  --forward <ip:port>           Receiver address (default 127.0.0.1:5001)" << std::endl;
+    std::cout << "  --feedback-listen-port <port> Port the receiver sends NACKs/reports to (default 0 = direct)" << std::endl;
+    std::cout << "  --feedback-forward <ip:port>  Sender feedback address (required with --feedback-listen-port)" << std::endl;
+    std::cout << "  --feedback-impair             Apply the same impairments to the feedback path" << std::endl;
+    std::cout << "  --scenario <name>             Preset: clean, lan, wifi, lossy, burst, congested, mobile" << std::endl;
+    std::cout << "  --seed <n>                    Random seed (default 1)" << std::endl;
+    std::cout << "  --loss <percent>              Independent random loss" << std::endl;
+    std::cout << "  --burst-enter <percent>       Gilbert-Elliott good->bad transition per packet" << std::endl;
+    std::cout << "  --burst-exit <percent>        Gilbert-Elliott bad->good transition per packet (default 30)" << std::endl;
+    std::cout << "  --burst-loss-good <percent>   Loss in the good state (default 0)" << std::endl;
+    std::cout << "  --burst-loss-bad <percent>    Loss in the bad state (default 100)" << std::endl;
+    std::cout << "  --delay-ms <ms>               One-way delay" << std::endl;
+    std::cout << "  --jitter-ms <ms>              Delay variation" << std::endl;
+    std::cout << "  --jitter-distribution <name>  uniform, normal or pareto (default uniform)" << std::endl;
+    std::cout << "  --reorder <percent>           Packets held back past their successors" << std::endl;
+    std::cout << "  --reorder-delay-ms <ms>       Extra delay of reordered packets (default 1)" << std::endl;
+    std::cout << "  --duplicate <percent>         Duplicated packets" << std::endl;
+    std::cout << "  --bandwidth-kbps <kbps>       Bottleneck rate (default 0 = unlimited)" << std::endl;
+    std::cout << "  --queue-kb <kb>               Bottleneck queue, tail drop beyond it (default 64)" << std::endl;
+    std::cout << "  --duration <s>                Stop after N seconds (default 0 = run until killed)" << std::endl;
+}
+
+bool parseAddress(const std::string& text, sockaddr_in& addr) {
+    size_t colon = text.rfind(':');
+    if (colon == std::string::npos) {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(std::stoi(text.substr(colon + 1))));
+    return inet_pton(AF_INET, text.substr(0, colon).c_str(), &addr.sin_addr) == 1;
+}
+
+// 一个转发方向：监听套接字收包，按损伤模型排入送达队列，到时刻后从同一套接字发往目的地
+struct Path {
+    struct Pending {
+        uint64_t releaseUs;
+        uint64_t order;
+        std::vector<uint8_t> data;
+
+        bool operator>(const Pending& other) const {
+            return releaseUs != other.releaseUs ? releaseUs > other.releaseUs : order > other.order;
+        }
+    };
+
+    std::string name;
+    SOCKET sock = INVALID_SOCKET;
+    sockaddr_in destination;
+    bool impaired = true;
+    NetworkImpairment model;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending;
+    uint64_t order = 0;
+    uint64_t received = 0;
+    uint64_t forwarded = 0;
+    uint64_t sendErrors = 0;
+
+    bool open(unsigned int port) {
+        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if (sock == INVALID_SOCKET) {
+            std::cerr << "Failed to create socket: " << net::lastError() << std::endl;
+            return false;
+        }
+        net::setReceiveBufferSize(sock, 4 * 1024 * 1024);
+        int sendBuffer = 4 * 1024 * 1024;
+        setsockopt(sock, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&sendBuffer), sizeof(sendBuffer));
+
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+            std::cerr << "Failed to bind port " << port << ": " << net::lastError() << std::endl;
+            return false;
+        }
+        return net::setNonBlocking(sock);
+    }
+
+    // 收取所有已到达的数据包
+    void receive(std::vector<uint8_t>& buffer) {
+        while (true) {
+            int length = recvfrom(sock, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0,
+                                    nullptr, nullptr);
+            if (length <= 0) {
+                return;
+            }
+
+            received++;
+            uint64_t now = timing::nowMicros();
+            uint64_t release[2] = {now, now};
+            unsigned int copies = impaired ? model.process(length, now, release) : 1;
+            for (unsigned int i = 0; i < copies; i++) {
+                Pending packet;
+                packet.releaseUs = release[i];
+                packet.order = order++;
+                packet.data.assign(buffer.begin(), buffer.begin() + length);
+                pending.push(std::move(packet));
+            }
+        }
+    }
+
+    // 发出所有已到送达时刻的数据包
+    void flush(uint64_t now) {
+        while (!pending.empty() && pending.top().releaseUs <= now) {
+            const Pending& packet = pending.top();
+            int sent = sendto(sock, reinterpret_cast<const char*>(packet.data.data()), static_cast<int>(packet.data.size()),
+                              0, reinterpret_cast<const sockaddr*>(&destination), sizeof(destination));
+            if (sent < 0) {
+                sendErrors++;
+            } else {
+                forwarded++;
+            }
+            pending.pop();
+        }
+    }
+
+    uint64_t nextRelease() const {
+        return pending.empty() ? UINT64_MAX : pending.top().releaseUs;
+    }
+};
+
+void printModel(const Path& path) {
+    const NetworkImpairment::Config& config = path.model.getConfig();
+    std::cout << "  " << path.name << ": loss " << config.lossRate * 100 << "%, burst enter "
+              << config.burstEnter * 100 << "% exit " << config.burstExit * 100 << "% (loss good "
+              << config.burstLossGood * 100 << "% bad " << config.burstLossBad * 100 << "%), delay "
+              << config.delayUs / 1000.0 << " ms, jitter " << config.jitterUs / 1000.0 << " ms ("
+              << NetworkImpairment::distributionName(config.distribution) << "), reorder "
+              << config.reorderRate * 100 << "% (+" << config.reorderDelayUs / 1000.0 << " ms), duplicate "
+              << config.duplicateRate * 100 << "%, bandwidth "
+              << (config.bandwidthKbps ? std::to_string(config.bandwidthKbps) + " kbps" : std::string("unlimited"))
+              << ", queue " << config.queueBytes / 1024 << " KB, seed " << config.seed << std::endl;
+}
+
+void printStats(const Path& path) {
+    NetworkImpairment::Stats stats = path.model.getStats();
+    std::cout << "  " << path.name << ": in " << path.received << ", forwarded " << path.forwarded
+              << " | dropped random " << stats.droppedRandom << ", burst " << stats.droppedBurst
+              << " (" << stats.burstEpisodes << " bursts), queue " << stats.droppedQueue
+              << " | reordered " << stats.reordered << ", duplicated " << stats.duplicated
+              << " | max queue delay " << stats.maxQueueDelayUs << " us";
+    if (path.sendErrors) {
+        std::cout << " | send errors " << path.sendErrors;
+    }
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned int listenPort = 5000;
+    std::string forward = "127.0.0.1:5001";
+    unsigned int feedbackListenPort = 0;
+    std::string feedbackForward;
+    bool feedbackImpair = false;
+    unsigned int duration = 0;
+    NetworkImpairment::Config config;
+
+    try {
+        // 先应用预置场景，其余参数在其基础上覆盖
+        for (int i = 1; i + 1 < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--seed") {
+                config.seed = std::stoull(argv[i + 1]);
+            }
+        }
+        for (int i = 1; i + 1 < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--scenario" && !NetworkImpairment::applyScenario(argv[i + 1], config)) {
+                std::cerr << "Unknown scenario: " << argv[i + 1] << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "--listen-port" && hasValue) {
+                listenPort = std::stoi(argv[++i]);
+            } else if (arg == "--forward" && hasValue) {
+                forward = argv[++i];
+            } else if (arg == "--feedback-listen-port" && hasValue) {
+                feedbackListenPort = std::stoi(argv[++i]);
+            } else if (arg == "--feedback-forward" && hasValue) {
+                feedbackForward = argv[++i];
+            } else if (arg == "--feedback-impair") {
+                feedbackImpair = true;
+            } else if ((arg == "--scenario" || arg == "--seed") && hasValue) {
+                i++;
+            } else if (arg == "--loss" && hasValue) {
+                config.lossRate = std::stod(argv[++i]) / 100.0;
+            } else if (arg == "--burst-enter" && hasValue) {
+                config.burstEnter = std::stod(argv[++i]) / 100.0;
+            } else if (arg == "--burst-exit" && hasValue) {
+                config.burstExit = std::stod(argv[++i]) / 100.0;
+            } else if (arg == "--burst-loss-good" && hasValue) {
+                config.burstLossGood = std::stod(argv[++i]) / 100.0;
+            } else if (arg == "--burst-loss-bad" && hasValue) {
+                config.burstLossBad = std::stod(argv[++i]) / 100.0;
+            } else if (arg == "--delay-ms" && hasValue) {
+                config.delayUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--jitter-ms" && hasValue) {
+                config.jitterUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--jitter-distribution" && hasValue) {
+                if (!NetworkImpairment::parseDistribution(argv[++i], config.distribution)) {
+                    std::cerr << "Unknown jitter distribution: " << argv[i] << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--reorder" && hasValue) {
+                config.reorderRate = std::stod(argv[++i]) / 100.0;
+            } else if (arg == "--reorder-delay-ms" && hasValue) {
+                config.reorderDelayUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--duplicate" && hasValue) {
+                config.duplicateRate = std::stod(argv[++i]) / 100.0;
+            } else if (arg == "--bandwidth-kbps" && hasValue) {
+                config.bandwidthKbps = std::stoi(argv[++i]);
+            } else if (arg == "--queue-kb" && hasValue) {
+                config.queueBytes = std::stoi(argv[++i]) * 1024;
+            } else if (arg == "--duration" && hasValue) {
+                duration = std::stoi(argv[++i]);
+            } else if (arg == "--help") {
+                printUsage();
+                return 0;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse command line arguments: " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    if (!net::startup()) {
+        std::cerr << "Failed to initialize network" << std::endl;
+        return 1;
+    }
+
+    std::vector<Path> paths(feedbackListenPort != 0 ? 2 : 1);
+    Path& data = paths[0];
+    data.name = "data";
+    data.model.configure(config);
+    if (!parseAddress(forward, data.destination)) {
+        std::cerr << "Invalid forward address: " << forward << std::endl;
+        return 1;
+    }
+    if (!data.open(listenPort)) {
+        return 1;
+    }
+
+    if (feedbackListenPort != 0) {
+        Path& feedback = paths[1];
+        feedback.name = "feedback";
+        feedback.impaired = feedbackImpair;
+        // 反馈方向使用不同的随机序列，避免与数据方向的丢包同步
+        NetworkImpairment::Config feedbackConfig = config;
+        feedbackConfig.seed = config.seed ^ 0x9E3779B97F4A7C15ull;
+        feedback.model.configure(feedbackConfig);
+        if (!parseAddress(feedbackForward, feedback.destination)) {
+            std::cerr << "Invalid feedback forward address: " << feedbackForward << std::endl;
+            return 1;
+        }
+        if (!feedback.open(feedbackListenPort)) {
+            return 1;
+        }
+    }
+
+    std::cout << "Forwarding UDP port " << listenPort << " -> " << forward;
+    if (feedbackListenPort != 0) {
+        std::cout << ", feedback port " << feedbackListenPort << " -> " << feedbackForward
+                  << (feedbackImpair ? " (impaired)" : " (clean)");
+    }
+    std::cout << std::endl;
+    printModel(data);
+
+    std::vector<uint8_t> buffer(65536);
+    auto startTime = std::chrono::steady_clock::now();
+    auto lastReport = startTime;
+
+    while (true) {
+        // 等到下一个送达时刻或有新包到达
+        uint64_t now = timing::nowMicros();
+        uint64_t wakeUs = now + 10000;
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        SOCKET maxSock = 0;
+        for (Path& path : paths) {
+            wakeUs = std::min(wakeUs, path.nextRelease());
+            FD_SET(path.sock, &readSet);
+            maxSock = std::max(maxSock, path.sock);
+        }
+        uint64_t waitUs = wakeUs > now ? wakeUs - now : 0;
+        timeval timeout;
+        timeout.tv_sec = static_cast<long>(waitUs / 1000000);
+        timeout.tv_usec = static_cast<long>(waitUs % 1000000);
+        select(static_cast<int>(maxSock) + 1, &readSet, nullptr, nullptr, &timeout);
+
+        for (Path& path : paths) {
+            if (FD_ISSET(path.sock, &readSet)) {
+                path.receive(buffer);
+            }
+        }
+        now = timing::nowMicros();
+        for (Path& path : paths) {
+            path.flush(now);
+        }
+
+        auto current = std::chrono::steady_clock::now();
+        if (duration > 0 && current - startTime >= std::chrono::seconds(duration)) {
+            break;
+        }
+        if (current - lastReport >= std::chrono::seconds(1)) {
+            printStats(data);
+            lastReport = current;
+        }
+    }
+
+    std::cout << "Impairment statistics:" << std::endl;
+    for (Path& path : paths) {
+        printStats(path);
+        net::closeSocket(path.sock);
+    }
+    net::cleanup();
+    return 0;
+}
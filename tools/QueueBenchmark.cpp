@@ -0,0 +1,298 @@
+// 线程间队列基准：比较SpscRing、原LockFreeQueue和std::queue + mutex。
+// 吞吐测试由生产者尽快推入小元素、消费者忙等取出；帧交接测试按固定间隔推入帧缓冲区，
+// 消费者以各自的等待方式取出（SpscRing为popWait，LockFreeQueue为原流水线的100us轮询，
+// mutex队列为条件变量），统计推入到取出的延迟、消费者CPU占用和每个元素的堆分配次数
+#include "SpscRing.h"
+#include "LockFreeQueue.h"
+#include "LatencyHistogram.h"
+#include "PreciseTimer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <time.h>
+#endif
+
+using namespace std;
+
+// 统计整个进程的堆分配次数
+static std::atomic<uint64_t> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: queue_benchmark [options]" << std::endl;
+    std::cout << "  --items <n>                Items for the throughput test (default 2000000)" << std::endl;
+    std::cout << "  --capacity <n>             Queue capacity for the throughput test (default 1024)" << std::endl;
+    std::cout << "  --frames <n>               Frames for the handoff test (default 5000)" << std::endl;
+    std::cout << "  --interval-us <n>          Interval between frames in the handoff test (default 1000)" << std::endl;
+    std::cout << "  --frame-size <bytes>       Frame buffer size in the handoff test (default 65536)" << std::endl;
+}
+
+// 当前线程的CPU时间（微秒），不支持时返回0
+uint64_t threadCpuMicros() {
+#ifdef __linux__
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#else
+    return 0;
+#endif
+}
+
+struct Frame {
+    std::vector<uint8_t> data;
+    uint64_t pushUs = 0;
+};
+
+// 各队列统一为tryPush/tryPop/waitPop接口
+template <typename T>
+class RingAdapter {
+public:
+    static const char* name() { return "SpscRing"; }
+    explicit RingAdapter(size_t capacity) : ring(capacity) {}
+    bool tryPush(T& value) { return ring.tryPush(std::move(value)); }
+    bool tryPop(T& value) { return ring.pop(value); }
+    bool waitPop(T& value, unsigned int timeoutUs) { return ring.popWait(value, timeoutUs); }
+private:
+    SpscRing<T> ring;
+};
+
+template <typename T>
+class LockFreeAdapter {
+public:
+    static const char* name() { return "LockFreeQueue"; }
+    explicit LockFreeAdapter(size_t) {}
+    // 无界队列，推入总是成功
+    bool tryPush(T& value) {
+        queue.push(std::move(value));
+        return true;
+    }
+    bool tryPop(T& value) { return queue.pop(value); }
+    // 原流水线的等待方式：取不到时睡眠100us后重试
+    bool waitPop(T& value, unsigned int timeoutUs) {
+        uint64_t deadline = timing::nowMicros() + timeoutUs;
+        while (!queue.pop(value)) {
+            if (timing::nowMicros() >= deadline) {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+private:
+    LockFreeQueue<T> queue;
+};
+
+template <typename T>
+class MutexAdapter {
+public:
+    static const char* name() { return "std::queue+mutex"; }
+    explicit MutexAdapter(size_t capacity) : capacity(capacity) {}
+    bool tryPush(T& value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= capacity) {
+                return false;
+            }
+            queue.push(std::move(value));
+        }
+        cv.notify_one();
+        return true;
+    }
+    bool tryPop(T& value) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.empty()) {
+            return false;
+        }
+        value = std::move(queue.front());
+        queue.pop();
+        return true;
+    }
+    bool waitPop(T& value, unsigned int timeoutUs) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!cv.wait_for(lock, std::chrono::microseconds(timeoutUs), [this] { return !queue.empty(); })) {
+            return false;
+        }
+        value = std::move(queue.front());
+        queue.pop();
+        return true;
+    }
+private:
+    size_t capacity;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::queue<T> queue;
+};
+
+// 吞吐：生产者尽快推入，队列满时让出CPU；消费者取不到时让出CPU，并校验顺序
+template <template <typename> class Queue>
+void runThroughput(uint64_t items, size_t capacity) {
+    Queue<uint64_t> queue(capacity);
+    bool ordered = true;
+    uint64_t allocationsBefore = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread consumer([&] {
+        uint64_t expected = 0;
+        uint64_t value = 0;
+        while (expected < items) {
+            if (queue.tryPop(value)) {
+                ordered = ordered && value == expected;
+                expected++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (uint64_t i = 0; i < items; i++) {
+        uint64_t value = i;
+        while (!queue.tryPush(value)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t allocations = g_allocations.load() - allocationsBefore;
+    std::cout << "  " << Queue<uint64_t>::name() << ": " << items / seconds / 1e6 << " M items/s ("
+              << seconds * 1e9 / items << " ns/item), allocations per item "
+              << static_cast<double>(allocations) / items << (ordered ? "" : ", ORDER VIOLATION") << std::endl;
+}
+
+// 帧交接：每interval推入一帧（缓冲区轮流复用），消费者阻塞等待，统计推入到取出的延迟
+template <template <typename> class Queue>
+void runHandoff(unsigned int frames, unsigned int intervalUs, size_t frameSize) {
+    Queue<Frame> queue(2);
+    std::atomic<bool> done(false);
+    LatencyHistogram latency;
+    latency.clear();
+    uint64_t consumerCpuUs = 0;
+
+    // 预先分配的帧缓冲区在生产者和消费者之间往返，不计入队列本身的分配
+    std::vector<Frame> pool(4);
+    for (Frame& frame : pool) {
+        frame.data.resize(frameSize);
+    }
+    SpscRing<Frame> returned(8);
+    for (Frame& frame : pool) {
+        returned.tryPush(std::move(frame));
+    }
+
+    uint64_t allocationsBefore = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread consumer([&] {
+        uint64_t cpuStart = threadCpuMicros();
+        Frame frame;
+        unsigned int received = 0;
+        while (received < frames && !done) {
+            if (queue.waitPop(frame, 10000)) {
+                latency.record(static_cast<int64_t>(timing::nowMicros() - frame.pushUs));
+                received++;
+                returned.tryPush(std::move(frame));
+            }
+        }
+        consumerCpuUs = threadCpuMicros() - cpuStart;
+    });
+
+    uint64_t nextUs = timing::nowMicros();
+    for (unsigned int i = 0; i < frames; i++) {
+        nextUs += intervalUs;
+        timing::sleepUntil(nextUs, timing::defaultSpinUs());
+        Frame frame;
+        while (!returned.pop(frame)) {
+            std::this_thread::yield();
+        }
+        frame.pushUs = timing::nowMicros();
+        while (!queue.tryPush(frame)) {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    consumer.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t allocations = g_allocations.load() - allocationsBefore;
+    std::cout << "  " << Queue<Frame>::name() << ": handoff avg " << latency.mean() << " us, p50 "
+              << latency.percentile(0.5) << " us, p99 " << latency.percentile(0.99) << " us, max " << latency.maxUs
+              << " us, consumer CPU " << consumerCpuUs / (seconds * 1e4) << "%, allocations per frame "
+              << static_cast<double>(allocations) / frames << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t items = 2000000;
+    size_t capacity = 1024;
+    unsigned int frames = 5000;
+    unsigned int intervalUs = 1000;
+    size_t frameSize = 65536;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--items" && hasValue) {
+                items = std::stoull(argv[++i]);
+            } else if (arg == "--capacity" && hasValue) {
+                capacity = std::stoul(argv[++i]);
+            } else if (arg == "--frames" && hasValue) {
+                frames = std::stoi(argv[++i]);
+            } else if (arg == "--interval-us" && hasValue) {
+                intervalUs = std::stoi(argv[++i]);
+            } else if (arg == "--frame-size" && hasValue) {
+                frameSize = std::stoul(argv[++i]);
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage();
+                return 0;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse command line arguments: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Throughput (" << items << " items, capacity " << capacity << ", LockFreeQueue unbounded):" << std::endl;
+    runThroughput<RingAdapter>(items, capacity);
+    runThroughput<LockFreeAdapter>(items, capacity);
+    runThroughput<MutexAdapter>(items, capacity);
+
+    std::cout << "Frame handoff (" << frames << " frames every " << intervalUs << " us, capacity 2):" << std::endl;
+    runHandoff<RingAdapter>(frames, intervalUs, frameSize);
+    runHandoff<LockFreeAdapter>(frames, intervalUs, frameSize);
+    runHandoff<MutexAdapter>(frames, intervalUs, frameSize);
+
+    return 0;
+}
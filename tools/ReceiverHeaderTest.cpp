@@ -0,0 +1,174 @@
+// 接收端包头校验测试：在回环上向UDPReceiver发送构造的非法包头，检查其计为packetsInvalid、不产生帧且接收线程不崩溃。
+// 覆盖每组分片数超过FEC上限、同一帧内分组参数不一致、单包帧声明超大frameSize和frameSize与分包负载不符等情况，
+// 全部通过时返回0
+#include "UDPReceiver.h"
+#include "FecCodec.h"
+#include "PreciseTimer.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// 等待接收线程处理完已发出的分包
+const unsigned int kSettleMs = 100;
+
+class PacketSource {
+public:
+    PacketSource(unsigned int port) : sock(INVALID_SOCKET) {
+        memset(&target, 0, sizeof(target));
+        target.sin_family = AF_INET;
+        target.sin_port = htons(static_cast<uint16_t>(port));
+        target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    }
+
+    ~PacketSource() {
+        if (sock != INVALID_SOCKET) {
+            net::closeSocket(sock);
+        }
+    }
+
+    bool isValid() const { return sock != INVALID_SOCKET; }
+
+    void send(const UDPTransmitter::PacketHeader& header, size_t payloadSize) {
+        std::vector<uint8_t> packet(sizeof(header) + payloadSize, 0x5A);
+        memcpy(packet.data(), &header, sizeof(header));
+        sendto(sock, reinterpret_cast<const char*>(packet.data()), static_cast<int>(packet.size()), 0,
+               reinterpret_cast<const sockaddr*>(&target), sizeof(target));
+    }
+
+private:
+    SOCKET sock;
+    sockaddr_in target;
+};
+
+UDPTransmitter::PacketHeader makeHeader(uint32_t frameId, uint16_t packetId, uint16_t packetCount, uint32_t frameSize,
+                                        uint8_t groupSize, uint8_t groupParity) {
+    UDPTransmitter::PacketHeader header;
+    memset(&header, 0, sizeof(header));
+    header.frameId = frameId;
+    header.packetId = packetId;
+    header.packetCount = packetCount;
+    header.timestamp = timing::nowMicros();
+    header.frameSize = frameSize;
+    header.fecGroupSize = groupSize;
+    header.fecGroupParity = groupParity;
+    if (packetId >= packetCount) {
+        header.flags = UDPTransmitter::PACKET_FLAG_PARITY;
+        header.fecGroup = static_cast<uint8_t>((packetId - packetCount) / groupParity);
+    } else if (groupSize > 0) {
+        header.fecGroup = static_cast<uint8_t>(packetId / groupSize);
+    }
+    return header;
+}
+
+struct Result {
+    uint64_t invalid;
+    uint64_t completed;
+};
+
+Result snapshot(UDPReceiver& receiver) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(kSettleMs));
+    UDPReceiver::ReceiveStats stats = receiver.getStats();
+    Result result;
+    result.invalid = stats.packetsInvalid;
+    result.completed = stats.framesCompleted;
+    return result;
+}
+
+bool check(const char* name, bool passed) {
+    std::cout << (passed ? "PASS " : "FAIL ") << name << std::endl;
+    return passed;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    unsigned int port = 5990;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) {
+            port = std::stoi(argv[++i]);
+        } else if (arg == "--help") {
+            std::cout << "Usage: receiver_header_test [--port <port>] (default 5990)" << std::endl;
+            return 0;
+        }
+    }
+
+    if (!net::startup()) {
+        std::cerr << "Failed to initialize network" << std::endl;
+        return 1;
+    }
+
+    UDPReceiver::Config config;
+    config.port = port;
+    config.clockSyncIntervalUs = 0;
+    UDPReceiver receiver;
+    if (!receiver.initialize(config)) {
+        std::cerr << "Failed to initialize UDP receiver" << std::endl;
+        return 1;
+    }
+    receiver.start();
+
+    PacketSource source(port);
+    if (!source.isValid()) {
+        std::cerr << "Failed to create sender socket: " << net::lastError() << std::endl;
+        return 1;
+    }
+
+    const size_t payload = 1000;
+    bool passed = true;
+    Result before = snapshot(receiver);
+
+    // 每组200个数据包加100个校验包，超过FEC分片上限：缺一个数据包并送达一个校验包时会触发恢复
+    for (uint16_t i = 0; i < 199; i++) {
+        source.send(makeHeader(1, i, 200, 200 * payload, 200, 100), payload);
+    }
+    source.send(makeHeader(1, 200, 200, 200 * payload, 200, 100), payload);
+    Result after = snapshot(receiver);
+    passed &= check("FEC group exceeding the shard limit is rejected",
+                    after.invalid - before.invalid == 200 && after.completed == before.completed);
+    before = after;
+
+    // 同一帧内分组参数与首包不一致
+    source.send(makeHeader(2, 0, 4, 4 * payload, 4, 1), payload);
+    source.send(makeHeader(2, 1, 4, 4 * payload, 2, 2), payload);
+    after = snapshot(receiver);
+    passed &= check("FEC parameters changing within a frame are rejected", after.invalid - before.invalid == 1);
+    before = after;
+
+    // 单包帧声明1GiB的frameSize
+    source.send(makeHeader(3, 0, 1, 0x40000000, 0, 0), 100);
+    after = snapshot(receiver);
+    passed &= check("Oversized single-packet frame is rejected",
+                    after.invalid - before.invalid == 1 && after.completed == before.completed);
+    before = after;
+
+    // 多包帧的frameSize在末包范围内但与末包负载不符
+    source.send(makeHeader(4, 0, 2, payload + 500, 0, 0), payload);
+    source.send(makeHeader(4, 1, 2, payload + 500, 0, 0), 10);
+    after = snapshot(receiver);
+    passed &= check("Frame size not matching the last payload is rejected",
+                    after.invalid - before.invalid == 1 && after.completed == before.completed);
+    before = after;
+
+    // 合法的单包帧仍能交付
+    source.send(makeHeader(5, 0, 1, 100, 0, 0), 100);
+    UDPReceiver::ReceivedFrame frame;
+    bool delivered = receiver.waitFrame(frame, 1000);
+    after = snapshot(receiver);
+    passed &= check("Valid single-packet frame is delivered",
+                    delivered && frame.frameId == 5 && frame.data.size() == 100 && after.invalid == before.invalid);
+
+    receiver.stop();
+    net::cleanup();
+
+    std::cout << (passed ? "All checks passed" : "Some checks failed") << std::endl;
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// 共享内存接收工具：打开推流程序或SyntheticSender以--transport shm创建的共享内存，
+// 周期性输出帧率、跳帧数和帧交接延迟（生产者发布到消费者取得的时间），可与udp_receiver的端到端延迟对比
+#include "SharedMemoryTransport.h"
+#include "PreciseTimer.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: shm_receiver [options]" << std::endl;
+    std::cout << "  --shm-name <name>          Shared memory name, must match sender (default lls_stream)" << std::endl;
+    std::cout << "  --duration <s>             Stop after N seconds (default 0 = run until sender closes)" << std::endl;
+    std::cout << "  --output <file>            Write received Annex-B stream to file" << std::endl;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(fraction * (sorted.size() - 1));
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string name = "lls_stream";
+    unsigned int duration = 0;
+    std::string outputFile;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--shm-name" && hasValue) {
+                name = argv[++i];
+            } else if (arg == "--duration" && hasValue) {
+                duration = std::stoi(argv[++i]);
+            } else if (arg == "--output" && hasValue) {
+                outputFile = argv[++i];
+            } else if (arg == "--help" || arg == "-h") {
+                printUsage();
+                return 0;
+            } else {
+                std::cerr << "Unknown argument: " << arg << std::endl;
+                printUsage();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse command line arguments: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream output;
+    if (!outputFile.empty()) {
+        output.open(outputFile, std::ios::binary);
+        if (!output.is_open()) {
+            std::cerr << "Failed to open output file " << outputFile << std::endl;
+            return 1;
+        }
+    }
+
+    // 生产者可能尚未启动，等待共享内存出现
+    SharedMemoryReader reader;
+    auto startTime = std::chrono::steady_clock::now();
+    while (!reader.open(name)) {
+        if (duration > 0 && std::chrono::steady_clock::now() - startTime >= std::chrono::seconds(duration)) {
+            return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+
+    std::vector<uint8_t> frame;
+    SharedMemoryReader::FrameInfo info;
+    std::vector<uint64_t> latencies;
+    uint64_t bytesReceived = 0;
+    uint64_t lastBytes = 0;
+    uint64_t keyframes = 0;
+    uint64_t intervalLatencySum = 0;
+    uint64_t intervalLatencyMax = 0;
+    uint64_t intervalFrames = 0;
+
+    auto lastReport = std::chrono::steady_clock::now();
+    SharedMemoryReader::Stats lastStats = reader.getStats();
+
+    while (true) {
+        if (reader.read(frame, info, 100)) {
+            uint64_t latency = timing::nowMicros() - info.timestampUs;
+            latencies.push_back(latency);
+            intervalLatencySum += latency;
+            intervalLatencyMax = std::max(intervalLatencyMax, latency);
+            intervalFrames++;
+            bytesReceived += frame.size();
+            if (info.keyframe) {
+                keyframes++;
+            }
+            if (output.is_open()) {
+                output.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+            }
+        } else if (reader.isClosed()) {
+            std::cout << "Sender closed shared memory" << std::endl;
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (duration > 0 && now - startTime >= std::chrono::seconds(duration)) {
+            break;
+        }
+        if (now - lastReport < std::chrono::seconds(1)) {
+            continue;
+        }
+
+        SharedMemoryReader::Stats stats = reader.getStats();
+        double seconds = std::chrono::duration<double>(now - lastReport).count();
+        std::cout << "fps " << static_cast<int>((stats.framesRead - lastStats.framesRead) / seconds)
+                  << " | " << (bytesReceived - lastBytes) * 8 / seconds / 1e6 << " Mbps"
+                  << " | skipped " << stats.framesSkipped - lastStats.framesSkipped
+                  << " | waits " << stats.waits - lastStats.waits
+                  << " | handoff avg " << (intervalFrames ? intervalLatencySum / intervalFrames : 0)
+                  << " us max " << intervalLatencyMax << " us" << std::endl;
+        lastStats = stats;
+        lastBytes = bytesReceived;
+        lastReport = now;
+        intervalLatencySum = 0;
+        intervalLatencyMax = 0;
+        intervalFrames = 0;
+    }
+
+    SharedMemoryReader::Stats stats = reader.getStats();
+    std::sort(latencies.begin(), latencies.end());
+    uint64_t latencySum = 0;
+    for (uint64_t latency : latencies) {
+        latencySum += latency;
+    }
+
+    std::cout << "Receive statistics (shared memory):" << std::endl;
+    std::cout << "  Frames: read " << stats.framesRead << " (keyframes " << keyframes << "), skipped "
+              << stats.framesSkipped << std::endl;
+    std::cout << "  Bytes Received: " << bytesReceived << std::endl;
+    std::cout << "  Doorbell Waits: " << stats.waits << std::endl;
+    std::cout << "  Handoff Latency: avg " << (latencies.empty() ? 0 : latencySum / latencies.size())
+              << " us, p50 " << percentile(latencies, 0.5) << " us, p99 " << percentile(latencies, 0.99)
+              << " us, max " << (latencies.empty() ? 0 : latencies.back()) << " us" << std::endl;
+    return 0;
+}
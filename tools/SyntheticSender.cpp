@@ -0,0 +1,315 @@
+// 合成码流发送工具：按配置的帧率和码率生成Annex-B格式的伪H.264帧并通过UDPTransmitter发送，
+// 用于在没有GPU和桌面采集的环境下验证发送路径。命令行参数与推流程序一致。
+#include "UDPTransmitter.h"
+#include "ConfigManager.h"
+#include "BitrateController.h"
+#include "SharedMemoryTransport.h"
+#include "FrameDropPolicy.h"
+#include "PreciseTimer.h"
+#include "ThreadTuning.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+
+// 生成一帧：关键帧为SPS + PPS + IDR切片，其余为非IDR切片（disposable时nal_ref_idc为0，不被后续帧参考）
+void generateFrame(std::vector<uint8_t>& frame, size_t size, bool keyframe, bool disposable, uint32_t frameIndex) {
+    static const uint8_t keyframePrefix[] = {
+        0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0xC0, 0x1F,   // SPS
+        0x00, 0x00, 0x00, 0x01, 0x68, 0xCE, 0x3C, 0x80,   // PPS
+        0x00, 0x00, 0x00, 0x01, 0x65                      // IDR切片
+    };
+    static const uint8_t slicePrefix[] = {0x00, 0x00, 0x00, 0x01, 0x41};
+    static const uint8_t disposablePrefix[] = {0x00, 0x00, 0x00, 0x01, 0x01};
+
+    const uint8_t* prefix = keyframe ? keyframePrefix : (disposable ? disposablePrefix : slicePrefix);
+    size_t prefixSize = keyframe ? sizeof(keyframePrefix) : sizeof(slicePrefix);
+    size = std::max(size, prefixSize + 1);
+
+    frame.resize(size);
+    memcpy(frame.data(), prefix, prefixSize);
+    // 负载不含0字节，避免出现伪起始码
+    for (size_t i = prefixSize; i < size; i++) {
+        frame[i] = static_cast<uint8_t>((i * 31 + frameIndex) % 255 + 1);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    ConfigManager configManager;
+    if (!configManager.loadFromCommandLine(argc, argv)) {
+        std::cerr << "Warning: Failed to load config from command line, using default config" << std::endl;
+    }
+    const auto& config = configManager.getConfig();
+
+    // 工具专用参数
+    unsigned int duration = 10;
+    unsigned int gop = 200;
+    double keyframeScale = 4.0;
+    unsigned int disposableInterval = 0;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--duration" && i + 1 < argc) {
+                duration = std::stoi(argv[++i]);
+            } else if (arg == "--gop" && i + 1 < argc) {
+                gop = std::max(std::stoi(argv[++i]), 1);
+            } else if (arg == "--keyframe-scale" && i + 1 < argc) {
+                keyframeScale = std::stod(argv[++i]);
+            } else if (arg == "--disposable-interval" && i + 1 < argc) {
+                // 每n帧中有一帧非参考帧（类似分层P帧的最高时域层），0表示全部为参考帧
+                disposableInterval = std::stoi(argv[++i]);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse command line arguments: " << e.what() << std::endl;
+        return 1;
+    }
+
+    UDPTransmitter::SendBackend backend;
+    if (!UDPTransmitter::parseBackend(config.sendBackend, backend)) {
+        std::cerr << "Warning: Unknown send backend '" << config.sendBackend << "', using auto" << std::endl;
+        backend = UDPTransmitter::SendBackend::Auto;
+    }
+    FecCodec::Config fec;
+    if (!FecCodec::parseMode(config.fecMode, fec.mode)) {
+        std::cerr << "Warning: Unknown FEC mode '" << config.fecMode << "', FEC disabled" << std::endl;
+        fec.mode = FecCodec::Mode::None;
+    }
+    fec.redundancy = config.fecRedundancy;
+    fec.keyframeRedundancy = config.fecKeyframeRedundancy;
+    fec.maxGroupSize = config.fecGroupSize;
+    UDPTransmitter::RetransmitConfig retransmit;
+    retransmit.feedbackPort = config.nackPort;
+    retransmit.ringPackets = config.retransmitRing;
+    retransmit.deadlineMs = config.retransmitDeadlineMs;
+    PacketPacer::Config pacing;
+    pacing.enabled = config.pacing;
+    pacing.frameFraction = config.pacingFraction;
+    pacing.burstPackets = config.pacingBurst;
+    RtpPacketizer::Config rtp;
+    if (config.protocol != "custom" && config.protocol != "rtp") {
+        std::cerr << "Warning: Unknown protocol '" << config.protocol << "', using custom" << std::endl;
+    }
+    rtp.enabled = config.protocol == "rtp";
+    rtp.payloadType = static_cast<uint8_t>(config.rtpPayloadType);
+    rtp.sdpPath = config.sdpFile;
+
+    if (config.transport != "udp" && config.transport != "shm") {
+        std::cerr << "Warning: Unknown transport '" << config.transport << "', using udp" << std::endl;
+    }
+    bool sharedMemory = config.transport == "shm";
+    SharedMemoryWriter::Config shmConfig;
+    shmConfig.name = config.shmName;
+    shmConfig.slotCount = config.shmSlots;
+    shmConfig.slotSize = config.shmSlotSize;
+    SharedMemoryWriter shmWriter;
+
+    UDPTransmitter transmitter;
+    transmitter.setFecConfig(fec);
+    transmitter.setInterleaving(config.interleave);
+    transmitter.setRetransmitConfig(retransmit);
+    transmitter.setPacingConfig(pacing, config.bitrate, config.frameRate);
+    transmitter.setRtpConfig(rtp);
+    UringSender::Config uring;
+    uring.entries = config.uringEntries;
+    uring.sqPoll = config.uringSqPoll;
+    transmitter.setUringConfig(uring);
+    PathMtuDiscovery::Config pathMtu;
+    pathMtu.enabled = config.pathMtu;
+    pathMtu.intervalMs = config.pathMtuIntervalMs;
+    transmitter.setPathMtuConfig(pathMtu);
+
+    // 自适应码率：按码率控制的目标调整后续帧的大小，模拟编码器重配置
+    BitrateController::Config abr;
+    abr.enabled = config.abr && retransmit.feedbackPort != 0;
+    abr.minBitrateKbps = config.abrMinBitrate;
+    abr.maxBitrateKbps = config.abrMaxBitrate;
+    BitrateController bitrateController;
+    bitrateController.configure(abr, config.bitrate, config.frameRate);
+    if (config.abr && !abr.enabled) {
+        std::cerr << "Warning: Adaptive bitrate requires a feedback port, disabled" << std::endl;
+    }
+    if (abr.enabled) {
+        transmitter.setReportHandler([&bitrateController](const UDPTransmitter::ReceiverReport& report) {
+            bitrateController.onReport(report);
+        });
+    }
+    if (sharedMemory) {
+        if (!shmWriter.create(shmConfig)) {
+            std::cerr << "Failed to initialize shared memory transport" << std::endl;
+            return 1;
+        }
+    } else if (!transmitter.initialize(config.serverIP, config.serverPort, config.maxPacketSize, backend,
+                                       config.zeroCopy)) {
+        std::cerr << "Failed to initialize UDP transmitter" << std::endl;
+        return 1;
+    }
+
+    // 丢帧策略：帧的采集时刻取其计划生成时刻，发送落后于计划时帧随之过期
+    FrameDropPolicy::Config frameDrop;
+    frameDrop.deadlineMs = config.frameDeadlineMs;
+    frameDrop.congestionDrop = config.congestionDrop;
+    FrameDropPolicy dropPolicy;
+    dropPolicy.configure(frameDrop);
+
+    // 按码率分配帧大小，关键帧按keyframeScale放大，保持GOP内平均码率不变
+    size_t frameSize = 0;
+    size_t keyframeSize = 0;
+    auto sizeFrames = [&](unsigned int bitrateKbps) {
+        double bytesPerGop = bitrateKbps * 1000.0 / 8.0 * gop / config.frameRate;
+        frameSize = static_cast<size_t>(bytesPerGop / (gop - 1 + keyframeScale));
+        keyframeSize = static_cast<size_t>(frameSize * keyframeScale);
+    };
+    unsigned int appliedBitrate = bitrateController.getTargetBitrate();
+    sizeFrames(appliedBitrate);
+
+    std::cout << "Sending synthetic stream to "
+              << (sharedMemory ? "shared memory " + shmConfig.name : config.serverIP + ":" + std::to_string(config.serverPort))
+              << " at " << config.frameRate << " FPS, " << config.bitrate << " kbps"
+              << " (frame " << frameSize << " bytes, keyframe " << keyframeSize << " bytes every " << gop << " frames)"
+              << std::endl;
+
+    // 发送循环运行在主线程上，按--send-thread设置CPU绑定和调度策略
+    ThreadTuning threadTuning;
+    ThreadTuning::Config threads;
+    if (!ThreadTuning::parseStage(config.sendThread, threads.stage(ThreadTuning::Stage::Send))) {
+        std::cerr << "Warning: Invalid send thread setting '" << config.sendThread << "', using default scheduling"
+                  << std::endl;
+    }
+    threads.lockMemory = config.lockMemory;
+    threads.probeIterations = config.schedProbe;
+    threadTuning.configure(threads);
+    for (const auto& warning : threadTuning.getWarnings()) {
+        std::cerr << "Warning: " << warning << std::endl;
+    }
+    threadTuning.applyToCurrentThread(ThreadTuning::Stage::Send, "send");
+
+    std::vector<uint8_t> frame;
+    auto frameInterval = std::chrono::microseconds(1000000 / config.frameRate);
+    auto startTime = std::chrono::steady_clock::now();
+    auto nextFrameTime = startTime;
+    uint64_t frameCount = static_cast<uint64_t>(duration) * config.frameRate;
+    uint64_t startUs = timing::nowMicros();
+    uint64_t gopStart = 0;
+
+    for (uint64_t i = 0; i < frameCount; i++) {
+        if (abr.enabled && bitrateController.getTargetBitrate() != appliedBitrate) {
+            appliedBitrate = bitrateController.getTargetBitrate();
+            sizeFrames(appliedBitrate);
+            transmitter.setTargetBitrate(appliedBitrate);
+        }
+
+        // 参考帧被丢弃后按请求立即插入关键帧，GOP从该帧重新计数
+        bool keyframe = (i - gopStart) % gop == 0 || dropPolicy.takeKeyframeRequest();
+        if (keyframe) {
+            gopStart = i;
+        }
+        bool disposable = !keyframe && disposableInterval > 0 && (i - gopStart) % disposableInterval == 0;
+        generateFrame(frame, keyframe ? keyframeSize : frameSize, keyframe, disposable, static_cast<uint32_t>(i));
+
+        FrameDropPolicy::FrameInfo info = dropPolicy.makeFrame(startUs + i * 1000000 / config.frameRate);
+        info.priority = FrameDropPolicy::classify(frame.data(), frame.size());
+        bool congested = !sharedMemory && (transmitter.isCongested() ||
+            (abr.enabled && bitrateController.getState() == BitrateController::State::Decrease));
+        if (dropPolicy.admit(FrameDropPolicy::Stage::Send, info, timing::nowMicros(), congested)) {
+            if (sharedMemory) {
+                shmWriter.write(frame.data(), frame.size());
+            } else {
+                transmitter.sendFrame(std::move(frame), info.captureUs);
+            }
+        }
+
+        nextFrameTime += frameInterval;
+        std::this_thread::sleep_until(nextFrameTime);
+    }
+
+    transmitter.stop();
+
+    auto dropStats = dropPolicy.getStats();
+    std::cout << "Frame drop statistics:" << std::endl;
+    std::cout << "  Frames Admitted: " << dropStats.framesAdmitted << " (late " << dropStats.framesLate << ")" << std::endl;
+    std::cout << "  Frames Dropped: " << dropStats.total()
+              << " (expired " << dropStats.byReason(FrameDropPolicy::Reason::Expired)
+              << ", congestion " << dropStats.byReason(FrameDropPolicy::Reason::Congestion)
+              << ", reference lost " << dropStats.byReason(FrameDropPolicy::Reason::ReferenceLost) << ")" << std::endl;
+    std::cout << "  Dropped by Class: IDR " << dropStats.droppedByPriority[static_cast<int>(FrameDropPolicy::Priority::Idr)]
+              << ", reference " << dropStats.droppedByPriority[static_cast<int>(FrameDropPolicy::Priority::Reference)]
+              << ", non-reference " << dropStats.droppedByPriority[static_cast<int>(FrameDropPolicy::Priority::NonReference)]
+              << " (keyframe requests " << dropStats.keyframeRequests << ")" << std::endl;
+
+    if (sharedMemory) {
+        auto shmStats = shmWriter.getStats();
+        shmWriter.close();
+        std::cout << "Shared memory statistics (" << shmConfig.name << "):" << std::endl;
+        std::cout << "  Frames Written: " << shmStats.framesWritten << " (keyframes " << shmStats.keyframes
+                  << ", too large " << shmStats.framesTooLarge << ")" << std::endl;
+        std::cout << "  Bytes Written: " << shmStats.bytesWritten << std::endl;
+        std::cout << "  Doorbell Wakeups: " << shmStats.wakeups << std::endl;
+        return 0;
+    }
+
+    auto stats = transmitter.getStats();
+    std::cout << "Transmit statistics (" << UDPTransmitter::backendName(stats.backend) << "):" << std::endl;
+    std::cout << "  Frames Sent: " << stats.framesSent << std::endl;
+    std::cout << "  Packets Sent: " << stats.packetsSent << " (dropped " << stats.packetsDropped
+              << ", blocked sends " << stats.blockedSends << ")" << std::endl;
+    std::cout << "  Bytes Sent: " << stats.bytesSent << std::endl;
+    std::cout << "  Syscalls per Frame: " << stats.avgSyscallsPerFrame << std::endl;
+    std::cout << "  Send Time per Frame: " << stats.avgSendTimeUs << " us" << std::endl;
+    std::cout << "  Packet Size: " << stats.packetSize << " bytes (" << stats.avgPacketsPerFrame
+              << " packets per frame, header overhead " << stats.headerOverheadPercent << "%)" << std::endl;
+    if (stats.pathMtu) {
+        std::cout << "  Path MTU: route MTU " << stats.pathMtuKernelMtu << ", probes sent " << stats.pathMtuProbesSent
+                  << " (acked " << stats.pathMtuProbesAcked << ", rejected " << stats.pathMtuProbesRejected
+                  << "), searches " << stats.pathMtuSearches << ", receiver "
+                  << (stats.pathMtuResponding ? "responding" : "not responding") << std::endl;
+    }
+    if (stats.backend == UDPTransmitter::SendBackend::Uring) {
+        std::cout << "  io_uring: submitted " << stats.uringSubmitted << " SQEs (cancelled " << stats.uringCancelled
+                  << "), enters " << stats.uringEnters << ", SQPOLL " << (stats.uringSqPoll ? "on" : "off")
+                  << " (wakeups " << stats.uringWakeups << "), registered buffers "
+                  << (stats.uringRegisteredBuffers ? "on" : "off") << " (notifications " << stats.uringNotifications
+                  << ", stalls " << stats.uringBufferStalls << ")" << std::endl;
+    }
+    if (fec.mode != FecCodec::Mode::None) {
+        std::cout << "  FEC Parity Packets: " << stats.fecParityPackets
+                  << " (keyframes " << stats.keyframesSent << ")" << std::endl;
+        std::cout << "  FEC Encode Time per Frame: " << stats.avgFecEncodeTimeUs << " us" << std::endl;
+    }
+    if (stats.interleaving) {
+        std::cout << "  Interleaved Frames: " << stats.interleavedFrames << " of " << stats.framesSent << std::endl;
+    }
+    if (retransmit.feedbackPort != 0) {
+        std::cout << "  NACKs Received: " << stats.nacksReceived << " (requested " << stats.retransmitRequests
+                  << ", retransmitted " << stats.packetsRetransmitted << ", expired " << stats.retransmitExpired
+                  << ", unavailable " << stats.retransmitUnavailable << ")" << std::endl;
+        std::cout << "  Clock Sync Probes Answered: " << stats.clockProbesAnswered << std::endl;
+    }
+    if (stats.pacing) {
+        std::cout << "  Pacing: rate " << stats.pacingRateKbps << " kbps, waits " << stats.pacingWaits
+                  << ", timer lateness " << stats.avgPacingLatenessUs << " us, departure jitter "
+                  << stats.departureJitterUs << " us" << std::endl;
+    }
+    if (stats.rtp) {
+        std::cout << "  RTP NAL Units: single " << stats.rtpSingleNals << ", aggregated " << stats.rtpAggregatedNals
+                  << " (in " << stats.rtpAggregationPackets << " STAP-A packets), fragmented "
+                  << stats.rtpFragmentedNals << " (FU-A)" << std::endl;
+    }
+    if (abr.enabled) {
+        auto abrStats = bitrateController.getStats();
+        std::cout << "  Adaptive Bitrate: target " << abrStats.targetBitrateKbps << " kbps ("
+                  << BitrateController::stateName(abrStats.state) << "), receive rate " << abrStats.receiveRateKbps
+                  << " kbps, reports " << abrStats.reports << ", delay decreases " << abrStats.overuses
+                  << ", loss decreases " << abrStats.lossDecreases << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,318 @@
+// UDP视频流接收工具：接收LowLatencyStreamer或SyntheticSender的推流，
+// 周期性输出丢包、乱序、FEC恢复和帧完成延迟统计，退出时输出单向延迟直方图，不依赖GPU，可在Linux回环上运行
+#include "UDPReceiver.h"
+#include "RtpPacketizer.h"
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+void printUsage() {
+    std::cout << "Usage: udp_receiver [options]" << std::endl;
+    std::cout << "  --port <port>              Listen port (default 5000)" << std::endl;
+    std::cout << "  --max-packet-size <bytes>  Max packet size, must be >= sender (default 1400)" << std::endl;
+    std::cout << "  --slots <n>                Frame slots (default 8)" << std::endl;
+    std::cout << "  --max-packets <n>          Max packets per frame incl. parity (default 1536)" << std::endl;
+    std::cout << "  --min-delay-ms <ms>        Jitter buffer minimum delay (default 0)" << std::endl;
+    std::cout << "  --max-delay-ms <ms>        Jitter buffer maximum delay (default 20)" << std::endl;
+    std::cout << "  --jitter-multiplier <x>    Target delay as a multiple of jitter (default 3)" << std::endl;
+    std::cout << "  --nack-port <port>         Sender feedback port for NACKs (default 0 = off)" << std::endl;
+    std::cout << "  --nack-delay-ms <ms>       Wait before requesting a missing packet (default 0.5)" << std::endl;
+    std::cout << "  --nack-retries <n>         Max NACKs per frame (default 3)" << std::endl;
+    std::cout << "  --nack-deadline-ms <ms>    Stop requesting after this frame age (default 20)" << std::endl;
+    std::cout << "  --report-interval-ms <ms>  Send receiver reports to the feedback port (default 0 = off)" << std::endl;
+    std::cout << "  --clock-sync-interval-ms <ms> Clock sync probe interval via the feedback port (default 1000, 0 = off)" << std::endl;
+    std::cout << "  --duration <s>             Stop after N seconds (default 0 = run until killed)" << std::endl;
+    std::cout << "  --output <file>            Write received Annex-B stream to file" << std::endl;
+    std::cout << "  --rtp                      Receive RTP/H.264 (RFC 6184) instead of the custom protocol" << std::endl;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    return sorted[static_cast<size_t>(fraction * (sorted.size() - 1))];
+}
+
+void printHistogram(const char* name, const LatencyHistogram& histogram, bool printBuckets) {
+    std::cout << "  " << name << " Histogram: count " << histogram.count << ", avg " << histogram.mean()
+              << " us, min " << histogram.minUs << " us, p50 " << histogram.percentile(0.5) << " us, p99 "
+              << histogram.percentile(0.99) << " us, max " << histogram.maxUs << " us" << std::endl;
+    uint64_t cumulative = 0;
+    for (unsigned int i = 0; printBuckets && i < LatencyHistogram::kBuckets; i++) {
+        if (histogram.counts[i] == 0) {
+            continue;
+        }
+        cumulative += histogram.counts[i];
+        std::cout << "    <= ";
+        if (i + 1 < LatencyHistogram::kBuckets) {
+            std::cout << LatencyHistogram::upperBound(i) << " us";
+        } else {
+            std::cout << "inf";
+        }
+        std::cout << ": " << histogram.counts[i] << " (cumulative " << 100.0 * cumulative / histogram.count << "%)"
+                  << std::endl;
+    }
+}
+
+// RTP模式：按序列号检测丢包，在marker位处重组整帧，含丢包的帧整帧丢弃
+int runRtp(unsigned int port, unsigned int duration, std::ofstream& output) {
+    if (!net::startup()) {
+        std::cerr << "Failed to initialize network" << std::endl;
+        return 1;
+    }
+
+    SOCKET sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock == INVALID_SOCKET) {
+        std::cerr << "Failed to create socket: " << net::lastError() << std::endl;
+        return 1;
+    }
+    net::setReceiveBufferSize(sock, 4 * 1024 * 1024);
+    net::setReceiveTimeout(sock, 100);
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == SOCKET_ERROR) {
+        std::cerr << "Failed to bind port " << port << ": " << net::lastError() << std::endl;
+        net::closeSocket(sock);
+        return 1;
+    }
+
+    std::cout << "Listening for RTP on UDP port " << port << std::endl;
+
+    RtpDepacketizer depacketizer;
+    std::vector<uint8_t> packet(65536);
+    std::vector<uint8_t> frame;
+    uint32_t rtpTimestamp = 0;
+    uint64_t bytesReceived = 0;
+    uint64_t lastBytes = 0;
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto lastReport = startTime;
+    RtpDepacketizer::Stats lastStats = depacketizer.getStats();
+
+    while (true) {
+        int received = recvfrom(sock, reinterpret_cast<char*>(packet.data()), static_cast<int>(packet.size()), 0,
+                                nullptr, nullptr);
+        if (received > 0) {
+            bytesReceived += received;
+            if (depacketizer.push(packet.data(), received, frame, rtpTimestamp) && output.is_open()) {
+                output.write(reinterpret_cast<const char*>(frame.data()), frame.size());
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (duration > 0 && now - startTime >= std::chrono::seconds(duration)) {
+            break;
+        }
+        if (now - lastReport < std::chrono::seconds(1)) {
+            continue;
+        }
+
+        RtpDepacketizer::Stats stats = depacketizer.getStats();
+        double seconds = std::chrono::duration<double>(now - lastReport).count();
+        std::cout << "fps " << static_cast<int>((stats.framesCompleted - lastStats.framesCompleted) / seconds)
+                  << " | " << (bytesReceived - lastBytes) * 8 / seconds / 1e6 << " Mbps"
+                  << " | dropped frames " << stats.framesDropped - lastStats.framesDropped
+                  << " | lost packets " << stats.packetsLost - lastStats.packetsLost
+                  << " | last frame " << frame.size() << " bytes, RTP timestamp " << rtpTimestamp << std::endl;
+        lastStats = stats;
+        lastBytes = bytesReceived;
+        lastReport = now;
+    }
+
+    net::closeSocket(sock);
+    net::cleanup();
+
+    RtpDepacketizer::Stats stats = depacketizer.getStats();
+    std::cout << "Receive statistics (RTP):" << std::endl;
+    std::cout << "  Packets Received: " << stats.packetsReceived << " (invalid " << stats.packetsInvalid << ")"
+              << std::endl;
+    std::cout << "  Packets Lost: " << stats.packetsLost << std::endl;
+    std::cout << "  Frames: completed " << stats.framesCompleted << ", dropped " << stats.framesDropped << std::endl;
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    UDPReceiver::Config config;
+    unsigned int duration = 0;
+    std::string outputFile;
+    bool rtp = false;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "--port" && hasValue) {
+                config.port = std::stoi(argv[++i]);
+            } else if (arg == "--max-packet-size" && hasValue) {
+                config.maxPacketSize = std::stoi(argv[++i]);
+            } else if (arg == "--slots" && hasValue) {
+                config.frameSlots = std::stoi(argv[++i]);
+            } else if (arg == "--max-packets" && hasValue) {
+                config.maxPacketsPerFrame = std::stoi(argv[++i]);
+            } else if (arg == "--min-delay-ms" && hasValue) {
+                config.minDelayUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--max-delay-ms" && hasValue) {
+                config.maxDelayUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--jitter-multiplier" && hasValue) {
+                config.jitterMultiplier = std::stod(argv[++i]);
+            } else if (arg == "--nack-port" && hasValue) {
+                config.nackPort = std::stoi(argv[++i]);
+            } else if (arg == "--nack-delay-ms" && hasValue) {
+                config.nackDelayUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--nack-retries" && hasValue) {
+                config.maxNackRetries = std::stoi(argv[++i]);
+            } else if (arg == "--nack-deadline-ms" && hasValue) {
+                config.nackDeadlineUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--report-interval-ms" && hasValue) {
+                config.reportIntervalUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--clock-sync-interval-ms" && hasValue) {
+                config.clockSyncIntervalUs = static_cast<unsigned int>(std::stod(argv[++i]) * 1000);
+            } else if (arg == "--duration" && hasValue) {
+                duration = std::stoi(argv[++i]);
+            } else if (arg == "--output" && hasValue) {
+                outputFile = argv[++i];
+            } else if (arg == "--rtp") {
+                rtp = true;
+            } else if (arg == "--help") {
+                printUsage();
+                return 0;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to parse command line arguments: " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    std::ofstream output;
+    if (!outputFile.empty()) {
+        output.open(outputFile, std::ios::binary);
+        if (!output) {
+            std::cerr << "Failed to open output file: " << outputFile << std::endl;
+            return 1;
+        }
+    }
+
+    if (rtp) {
+        return runRtp(config.port, duration, output);
+    }
+
+    UDPReceiver receiver;
+    if (!receiver.initialize(config)) {
+        std::cerr << "Failed to initialize UDP receiver" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Listening on UDP port " << config.port << std::endl;
+    receiver.start();
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto lastReport = startTime;
+    UDPReceiver::ReceiveStats lastStats = receiver.getStats();
+    UDPReceiver::ReceivedFrame frame;
+    // 每个交付帧的交付延迟（端到端延迟 + 抖动缓冲等待），用于输出分位数
+    std::vector<uint64_t> deliveryLatencies;
+
+    while (true) {
+        if (receiver.waitFrame(frame, 100)) {
+            deliveryLatencies.push_back(static_cast<uint64_t>(std::max<int64_t>(frame.endToEndLatencyUs, 0)) +
+                                        frame.bufferDelayUs);
+            if (output.is_open()) {
+                output.write(reinterpret_cast<const char*>(frame.data.data()), frame.data.size());
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (duration > 0 && now - startTime >= std::chrono::seconds(duration)) {
+            break;
+        }
+        if (now - lastReport < std::chrono::seconds(1)) {
+            continue;
+        }
+
+        // 每秒输出一次区间统计
+        UDPReceiver::ReceiveStats stats = receiver.getStats();
+        double seconds = std::chrono::duration<double>(now - lastReport).count();
+        std::cout << "fps " << static_cast<int>((stats.framesDelivered - lastStats.framesDelivered) / seconds)
+                  << " | " << (stats.bytesReceived - lastStats.bytesReceived) * 8 / seconds / 1e6 << " Mbps"
+                  << " | lost frames " << stats.framesLost - lastStats.framesLost
+                  << " packets " << stats.packetsLost - lastStats.packetsLost
+                  << " | reordered " << stats.packetsReordered - lastStats.packetsReordered
+                  << " | recovered " << stats.packetsRecovered - lastStats.packetsRecovered
+                  << " | retransmitted " << stats.packetsRetransmitReceived - lastStats.packetsRetransmitReceived
+                  << " | skipped " << stats.framesSkipped - lastStats.framesSkipped
+                  << " | last frame " << frame.completionLatencyUs << " us"
+                  << " e2e " << frame.endToEndLatencyUs << " us" << (frame.clockSynchronized ? " (synced)" : "")
+                  << " | gradient " << stats.delayGradientUsPerS << " us/s"
+                  << " | jitter " << stats.jitterUs << " us"
+                  << " target " << stats.targetDelayUs << " us" << std::endl;
+        lastStats = stats;
+        lastReport = now;
+    }
+
+    receiver.stop();
+
+    UDPReceiver::ReceiveStats stats = receiver.getStats();
+    std::cout << "Receive statistics:" << std::endl;
+    std::cout << "  Packets Received: " << stats.packetsReceived << " (parity " << stats.parityPacketsReceived
+              << ", reordered " << stats.packetsReordered << ", duplicate " << stats.packetsDuplicate
+              << ", late " << stats.packetsLate << ", invalid " << stats.packetsInvalid << ")" << std::endl;
+    std::cout << "  Packets Lost: " << stats.packetsLost << " (recovered by FEC " << stats.packetsRecovered << ")"
+              << std::endl;
+    std::cout << "  Frames: expected " << stats.framesExpected << ", completed " << stats.framesCompleted
+              << ", delivered " << stats.framesDelivered << ", skipped " << stats.framesSkipped
+              << ", lost " << stats.framesLost << ", FEC recovered " << stats.framesRecovered << std::endl;
+    std::cout << "  Completion Latency: avg " << stats.avgCompletionLatencyUs << " us, max "
+              << stats.maxCompletionLatencyUs << " us" << std::endl;
+    std::cout << "  End-to-End Latency: avg " << stats.avgEndToEndLatencyUs << " us, max "
+              << stats.maxEndToEndLatencyUs << " us" << std::endl;
+    std::sort(deliveryLatencies.begin(), deliveryLatencies.end());
+    std::cout << "  Frame Delivery Rate: "
+              << (stats.framesExpected ? 100.0 * stats.framesDelivered / stats.framesExpected : 0.0) << "%"
+              << std::endl;
+    std::cout << "  Delivery Latency: p50 " << percentile(deliveryLatencies, 0.5) << " us, p95 "
+              << percentile(deliveryLatencies, 0.95) << " us, p99 " << percentile(deliveryLatencies, 0.99)
+              << " us, max " << (deliveryLatencies.empty() ? 0 : deliveryLatencies.back()) << " us" << std::endl;
+    if (config.nackPort != 0) {
+        std::cout << "  NACKs Sent: " << stats.nacksSent << " (requested " << stats.packetsNacked
+                  << ", retransmits received " << stats.packetsRetransmitReceived
+                  << ", frames repaired " << stats.framesRetransmitted
+                  << ", RTT " << stats.nackRttUs << " us)" << std::endl;
+    }
+    if (config.reportIntervalUs != 0) {
+        std::cout << "  Receiver Reports Sent: " << stats.reportsSent << " (last delay gradient "
+                  << stats.delayGradientUsPerS << " us/s)" << std::endl;
+    }
+    std::cout << "  Jitter Buffer: jitter " << stats.jitterUs << " us, target " << stats.targetDelayUs
+              << " us, avg wait " << stats.avgBufferDelayUs << " us" << std::endl;
+    if (receiver.getConfig().clockSyncIntervalUs != 0) {
+        std::cout << "  Clock Sync: " << (stats.clock.synchronized ? "synchronized" : "not synchronized")
+                  << ", offset " << stats.clock.offsetUs << " us, drift " << stats.clock.driftPpm << " ppm, RTT "
+                  << stats.clock.rttUs << " us (min " << stats.clock.minRttUs << " us), samples used "
+                  << stats.clock.samplesUsed << "/" << stats.clock.samples << ", probes sent "
+                  << stats.clockProbesSent << std::endl;
+    }
+    if (stats.pathMtuProbesReceived != 0) {
+        std::cout << "  Path MTU Probes: received " << stats.pathMtuProbesReceived << ", answered "
+                  << stats.pathMtuProbesAnswered << std::endl;
+    }
+    printHistogram("One-Way Latency", stats.endToEndHistogram, true);
+    printHistogram("Completion Latency", stats.completionHistogram, false);
+
+    return 0;
+}
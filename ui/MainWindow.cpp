@@ -41,6 +41,22 @@ void MainWindow::drawConfigPanel(StreamConfig& config) {
     ImGui::Text("Network Configuration");
     ImGui::InputText("Target IP", config.targetIp, sizeof(config.targetIp));
     ImGui::InputInt("Port", &config.port, 1, 100);
+    ImGui::InputText("Extra Destinations", config.extraDestinations, sizeof(config.extraDestinations));
+    ImGui::TextDisabled("ip[:port][@kbps], comma separated; multicast groups allowed");
+    ImGui::InputInt("Multicast TTL", &config.multicastTtl, 1, 8);
+    ImGui::Checkbox("Shared Memory Output (same host)", &config.sharedMemoryOutput);
+    if (config.sharedMemoryOutput) {
+        ImGui::InputText("Shared Memory Name", config.shmName, sizeof(config.shmName));
+        ImGui::InputInt("Slots", &config.shmSlots, 1, 4);
+        ImGui::InputInt("Slot Size (KB)", &config.shmSlotSizeKb, 256, 1024);
+        ImGui::TextDisabled("Replaces UDP output; read with shm_receiver or SharedMemoryReader");
+    }
+    ImGui::Checkbox("RTP Output (H.264, RFC 6184)", &config.rtpOutput);
+    if (config.rtpOutput) {
+        ImGui::InputInt("Max Packet Size", &config.maxPacketSize, 100, 500);
+        ImGui::InputText("SDP File", config.sdpPath, sizeof(config.sdpPath));
+        ImGui::SliderInt("Pacing (% of frame interval, 0 = off)", &config.pacingPercent, 0, 100);
+    }
     ImGui::Spacing();
 
     // 视频配置
@@ -48,13 +64,35 @@ void MainWindow::drawConfigPanel(StreamConfig& config) {
     ImGui::InputInt("Width", &config.width, 32, 128);
     ImGui::InputInt("Height", &config.height, 32, 128);
     ImGui::InputInt("FPS", &config.fps, 10, 50);
+    ImGui::Checkbox("Align Capture to Display Present", &config.alignCapture);
+    if (config.alignCapture) {
+        ImGui::InputInt("Capture Phase (us after present)", &config.capturePhaseUs, 100, 1000);
+    }
     ImGui::InputInt("Bitrate (kbps)", &config.bitrateKbps, 1000, 5000);
+    ImGui::Checkbox("Adaptive Bitrate", &config.adaptiveBitrate);
+    if (config.adaptiveBitrate) {
+        ImGui::InputInt("Min Bitrate (kbps)", &config.minBitrateKbps, 500, 2000);
+        ImGui::InputInt("Max Bitrate (kbps, 0 = Bitrate)", &config.maxBitrateKbps, 1000, 5000);
+    }
     ImGui::Spacing();
 
     // 性能配置
     ImGui::Text("Performance Configuration");
-    ImGui::InputInt("Capture Queue Size", &config.captureQueueSize, 1, 5);
-    ImGui::InputInt("Encode Queue Size", &config.encodeQueueSize, 1, 5);
+    ImGui::Checkbox("Run to Completion (single thread)", &config.runToCompletion);
+    if (!config.runToCompletion) {
+        ImGui::InputInt("Send Queue Size (per destination)", &config.sendQueueSize, 1, 5);
+    }
+    ImGui::InputInt("Frame Deadline (ms, 0 = off)", &config.frameDeadlineMs, 5, 50);
+    ImGui::InputText("Capture Thread", config.captureThread, sizeof(config.captureThread));
+    if (!config.runToCompletion) {
+        ImGui::InputText("Encode Thread", config.encodeThread, sizeof(config.encodeThread));
+        ImGui::InputText("Send Thread", config.sendThread, sizeof(config.sendThread));
+    }
+    ImGui::TextDisabled("cpu[:policy[:priority]], e.g. 2:fifo:80; policy default/normal/fifo/rr");
+    ImGui::Checkbox("Lock Memory (pre-fault thread stacks)", &config.lockMemory);
+    ImGui::InputInt("Scheduling Probe Sleeps (0 = off)", &config.schedProbe, 50, 200);
+    ImGui::Checkbox("Congestion Drop (non-reference frames)", &config.congestionDrop);
+    ImGui::InputInt("Metrics Port (0 = off)", &config.metricsPort, 1, 100);
 
     // 限制范围
     if (config.width < 64) config.width = 64;
@@ -63,12 +101,30 @@ void MainWindow::drawConfigPanel(StreamConfig& config) {
     if (config.height > 4096) config.height = 4096;
     if (config.fps < 1) config.fps = 1;
     if (config.fps > 240) config.fps = 240;
+    if (config.capturePhaseUs < 0) config.capturePhaseUs = 0;
+    if (config.capturePhaseUs > 100000) config.capturePhaseUs = 100000;
     if (config.bitrateKbps < 1000) config.bitrateKbps = 1000;
     if (config.bitrateKbps > 50000) config.bitrateKbps = 50000;
-    if (config.captureQueueSize < 1) config.captureQueueSize = 1;
-    if (config.captureQueueSize > 10) config.captureQueueSize = 10;
-    if (config.encodeQueueSize < 1) config.encodeQueueSize = 1;
-    if (config.encodeQueueSize > 10) config.encodeQueueSize = 10;
+    if (config.minBitrateKbps < 100) config.minBitrateKbps = 100;
+    if (config.minBitrateKbps > 50000) config.minBitrateKbps = 50000;
+    if (config.maxBitrateKbps < 0) config.maxBitrateKbps = 0;
+    if (config.maxBitrateKbps > 50000) config.maxBitrateKbps = 50000;
+    if (config.multicastTtl < 1) config.multicastTtl = 1;
+    if (config.multicastTtl > 255) config.multicastTtl = 255;
+    if (config.maxPacketSize < 200) config.maxPacketSize = 200;
+    if (config.maxPacketSize > 65000) config.maxPacketSize = 65000;
+    if (config.sendQueueSize < 1) config.sendQueueSize = 1;
+    if (config.sendQueueSize > 10) config.sendQueueSize = 10;
+    if (config.frameDeadlineMs < 0) config.frameDeadlineMs = 0;
+    if (config.frameDeadlineMs > 1000) config.frameDeadlineMs = 1000;
+    if (config.shmSlots < 2) config.shmSlots = 2;
+    if (config.shmSlots > 64) config.shmSlots = 64;
+    if (config.shmSlotSizeKb < 64) config.shmSlotSizeKb = 64;
+    if (config.shmSlotSizeKb > 16384) config.shmSlotSizeKb = 16384;
+    if (config.schedProbe < 0) config.schedProbe = 0;
+    if (config.schedProbe > 10000) config.schedProbe = 10000;
+    if (config.metricsPort < 0) config.metricsPort = 0;
+    if (config.metricsPort > 65535) config.metricsPort = 65535;
 }
 
 void MainWindow::drawControlPanel(StreamConfig& config, StreamController& controller) {
@@ -81,6 +137,16 @@ void MainWindow::drawControlPanel(StreamConfig& config, StreamController& contro
             controller.stop();
         }
         ImGui::SameLine();
+        if (ImGui::Button("Apply Bitrate")) {
+            controller.setBitrate(config.bitrateKbps);
+        }
+        if (config.rtpOutput) {
+            ImGui::SameLine();
+            if (ImGui::Button("Save SDP")) {
+                controller.saveSdp(config.sdpPath);
+            }
+        }
+        ImGui::SameLine();
         ImGui::TextColored(ImVec4(0.0f, 1.0f, 0.0f, 1.0f), "Running");
     } else {
         if (ImGui::Button("Start Streaming")) {
@@ -129,23 +195,195 @@ void MainWindow::drawStatsPanel(StreamController& controller) {
 
     ImGui::Separator();
 
-    // 格式化字节数
-    int bytesSent = controller.getBytesSent();
+    // 格式化字节数（64位计数，长时间运行不溢出）
+    uint64_t bytesSent = controller.getBytesSent();
     std::string bytesStr;
-    if (bytesSent < 1024) {
+    if (bytesSent < 1024ull) {
         bytesStr = std::to_string(bytesSent) + " B";
-    } else if (bytesSent < 1024 * 1024) {
+    } else if (bytesSent < 1024ull * 1024) {
         bytesStr = std::to_string(bytesSent / 1024) + " KB";
-    } else if (bytesSent < 1024 * 1024 * 1024) {
+    } else if (bytesSent < 1024ull * 1024 * 1024) {
         bytesStr = std::to_string(bytesSent / (1024 * 1024)) + " MB";
     } else {
-        bytesStr = std::to_string(bytesSent / (1024 * 1024 * 1024)) + " GB";
+        bytesStr = std::to_string(bytesSent / (1024ull * 1024 * 1024)) + " GB";
     }
 
     ImGui::Text("%s", bytesStr.c_str());
     ImGui::NextColumn();
-    ImGui::Text("%d", controller.getPacketsSent());
+    ImGui::Text("%llu", static_cast<unsigned long long>(controller.getPacketsSent()));
+    ImGui::NextColumn();
+
+    ImGui::Separator();
+
+    ImGui::Text("Target Bitrate");
+    ImGui::NextColumn();
+    ImGui::Text("Receiver Reports");
     ImGui::NextColumn();
 
+    ImGui::Separator();
+
+    ImGui::Text("%d kbps", controller.getTargetBitrate());
+    ImGui::NextColumn();
+    ImGui::Text("%llu", static_cast<unsigned long long>(controller.getReportsReceived()));
+    ImGui::NextColumn();
+
+    ImGui::Columns(1);
+    ImGui::Spacing();
+
+    // 10秒窗口的速率和队列深度
+    const StreamStats::Snapshot& snapshot = controller.getStatsSnapshot();
+    ImGui::Text("10s Average: capture %.1f, encode %.1f, send %.1f FPS, %.0f kbps, %.1f drops/s",
+                snapshot.longWindow.stageFps(StreamStats::Stage::Capture),
+                snapshot.longWindow.stageFps(StreamStats::Stage::Encode),
+                snapshot.longWindow.stageFps(StreamStats::Stage::Send),
+                snapshot.longWindow.bitrateKbps, snapshot.longWindow.dropsPerSecond);
+    ImGui::Text("Queues: capture %u, encode %u, sinks %u (max %u); %llu blocked sends, %llu socket errors",
+                snapshot.captureQueueDepth, snapshot.encodeQueueDepth, snapshot.sinkQueueDepth, snapshot.sinkQueueMax,
+                static_cast<unsigned long long>(snapshot.blockedSends),
+                static_cast<unsigned long long>(snapshot.sendErrors));
+
+    // 本机指标导出
+    const MetricsServer& metricsServer = controller.getMetricsServer();
+    if (metricsServer.isRunning()) {
+        ImGui::Text("Metrics: http://127.0.0.1:%u/metrics (%llu scrapes)", metricsServer.getPort(),
+                    static_cast<unsigned long long>(metricsServer.getScrapes()));
+    }
+
+    // 丢帧统计（采集、编码阶段及共享内存输出）
+    const FrameDropPolicy::Stats& dropStats = controller.getDropStats();
+    ImGui::Text("Frames Dropped: %llu expired, %llu queue full (capture %llu, encode %llu), %llu keyframe requests",
+                static_cast<unsigned long long>(dropStats.byReason(FrameDropPolicy::Reason::Expired)),
+                static_cast<unsigned long long>(dropStats.byReason(FrameDropPolicy::Reason::QueueFull)),
+                static_cast<unsigned long long>(dropStats.byStage(FrameDropPolicy::Stage::Capture)),
+                static_cast<unsigned long long>(dropStats.byStage(FrameDropPolicy::Stage::Encode)),
+                static_cast<unsigned long long>(dropStats.keyframeRequests));
+
+    // 采集节拍：实际帧率与目标帧率、节拍晚于截止时刻的分布
+    const FrameClock::Stats& clockStats = controller.getCaptureClockStats();
+    ImGui::Text("Capture Clock: %.1f of %.0f FPS, %llu missed ticks, jitter p50 %lld us, p99 %lld us, max %lld us (spin %u us)",
+                clockStats.achievedFps, clockStats.targetFps,
+                static_cast<unsigned long long>(clockStats.missedTicks),
+                static_cast<long long>(clockStats.latenessP50Us),
+                static_cast<long long>(clockStats.latenessP99Us),
+                static_cast<long long>(clockStats.latenessMaxUs),
+                clockStats.spinUs);
+
+    // 线程调度：实际生效的设置和启动时测得的调度延迟（开启测量时）
+    const std::vector<ThreadTuning::ThreadReport>& threadReports = controller.getThreadReports();
+    ImGui::Text("Thread Scheduling:");
+    for (const auto& report : threadReports) {
+        std::string cpu = report.cpu >= 0 ? std::to_string(report.cpu) : "any";
+        if (report.wakeLatency.count > 0) {
+            ImGui::Text("  %s: cpu %s, %s (priority %d), scheduling latency p50 %lld us, p99 %lld us, max %lld us",
+                        report.name.c_str(), cpu.c_str(), ThreadTuning::policyName(report.policy), report.priority,
+                        static_cast<long long>(report.wakeLatency.percentile(0.5)),
+                        static_cast<long long>(report.wakeLatency.percentile(0.99)),
+                        static_cast<long long>(report.wakeLatency.maxUs));
+        } else {
+            ImGui::Text("  %s: cpu %s, %s (priority %d)", report.name.c_str(), cpu.c_str(),
+                        ThreadTuning::policyName(report.policy), report.priority);
+        }
+        if (!report.error.empty()) {
+            ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "    %s", report.error.c_str());
+        }
+    }
+    for (const auto& warning : controller.getThreadWarnings()) {
+        ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "  %s", warning.c_str());
+    }
+
+    // 逐帧延迟：各阶段和队列区间的分位数（纳秒记录，按微秒显示），没有样本的区间不显示
+    const PipelineLatency::Stats& latencyStats = controller.getLatencyStats();
+    ImGui::Text("Pipeline Latency (%s, %llu frames):", controller.isRunToCompletion() ? "run-to-completion" : "pipelined",
+                static_cast<unsigned long long>(latencyStats.frames));
+    for (unsigned int i = 0; i < PipelineLatency::kSpans; i++) {
+        PipelineLatency::Span which = static_cast<PipelineLatency::Span>(i);
+        const HdrHistogram::Summary& span = latencyStats.spans[i];
+        if (span.count == 0) {
+            continue;
+        }
+        const char* kind = PipelineLatency::isQueue(which) ? "[queue] "
+                         : (which == PipelineLatency::Span::Total ? "" : "[stage] ");
+        ImGui::Text("  %s%s: avg %.1f us, p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us",
+                    kind, PipelineLatency::spanName(which), span.meanNs / 1000.0,
+                    span.p50Ns / 1000.0, span.p99Ns / 1000.0, span.p999Ns / 1000.0, span.maxNs / 1000.0);
+    }
+
+    // 阶段交接延迟：帧放入信箱到下游线程取走
+    const HandoffStats* handoffs[2] = {&controller.getCaptureHandoffStats(), &controller.getEncodeHandoffStats()};
+    const char* handoffNames[2] = {"Capture -> Encode", "Encode -> Send"};
+    for (int i = 0; i < 2; i++) {
+        ImGui::Text("%s Handoff: avg %.1f us, p99 %llu us, max %llu us, %llu overwritten", handoffNames[i],
+                    handoffs[i]->meanUs(),
+                    static_cast<unsigned long long>(handoffs[i]->percentileUs(0.99)),
+                    static_cast<unsigned long long>(handoffs[i]->maxLatencyUs),
+                    static_cast<unsigned long long>(handoffs[i]->overwritten));
+    }
+
+    // 缓冲区池：稳态下分配数不再增长
+    const FramePoolStats& framePool = controller.getFramePoolStats();
+    const FramePoolStats& packetPool = controller.getPacketPoolStats();
+    ImGui::Text("Frame Buffers: %llu allocations (%llu new, %llu grown), peak %llu in use, peak %.1f KB; packet lists: %llu allocations",
+                static_cast<unsigned long long>(framePool.allocations()),
+                static_cast<unsigned long long>(framePool.buffersAllocated),
+                static_cast<unsigned long long>(framePool.growths),
+                static_cast<unsigned long long>(framePool.peakBuffersInUse),
+                framePool.peakRetainedBytes / 1024.0,
+                static_cast<unsigned long long>(packetPool.allocations()));
+
+    // 共享内存输出统计
+    if (controller.isSharedMemoryOutput()) {
+        const SharedMemoryWriter::Stats& shmStats = controller.getSharedMemoryStats();
+        ImGui::Text("Shared Memory: %llu frames written, %llu too large, %llu doorbell wakeups",
+                    static_cast<unsigned long long>(shmStats.framesWritten),
+                    static_cast<unsigned long long>(shmStats.framesTooLarge),
+                    static_cast<unsigned long long>(shmStats.wakeups));
+        return;
+    }
+
+    // 各目的地统计
+    const std::vector<SinkSet::SinkStats>& sinkStats = controller.getSinkStats();
+    if (sinkStats.empty()) {
+        return;
+    }
+
+    ImGui::Text("Destinations");
+    ImGui::Columns(5, "SinkColumns", false);
+    ImGui::Separator();
+
+    ImGui::Text("Address");
+    ImGui::NextColumn();
+    ImGui::Text("Frames Sent");
+    ImGui::NextColumn();
+    ImGui::Text("Frames Dropped (queue/expired/congestion/ref)");
+    ImGui::NextColumn();
+    ImGui::Text("Blocked Sends");
+    ImGui::NextColumn();
+    ImGui::Text("Sent (MB)");
+    ImGui::NextColumn();
+
+    ImGui::Separator();
+
+    for (const SinkSet::SinkStats& stats : sinkStats) {
+        if (stats.rateLimitKbps > 0) {
+            ImGui::Text("%s%s @%d kbps", stats.address.c_str(), stats.multicast ? " (multicast)" : "", stats.rateLimitKbps);
+        } else {
+            ImGui::Text("%s%s", stats.address.c_str(), stats.multicast ? " (multicast)" : "");
+        }
+        ImGui::NextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(stats.framesSent));
+        ImGui::NextColumn();
+        // 总数（队列已满/过期/拥塞/参考帧丢失）
+        ImGui::Text("%llu (%llu/%llu/%llu/%llu)", static_cast<unsigned long long>(stats.framesDropped),
+                    static_cast<unsigned long long>(stats.drops.byReason(FrameDropPolicy::Reason::QueueFull)),
+                    static_cast<unsigned long long>(stats.drops.byReason(FrameDropPolicy::Reason::Expired)),
+                    static_cast<unsigned long long>(stats.drops.byReason(FrameDropPolicy::Reason::Congestion)),
+                    static_cast<unsigned long long>(stats.drops.byReason(FrameDropPolicy::Reason::ReferenceLost)));
+        ImGui::NextColumn();
+        ImGui::Text("%llu", static_cast<unsigned long long>(stats.blockedSends));
+        ImGui::NextColumn();
+        ImGui::Text("%.1f", stats.bytesSent / (1024.0 * 1024.0));
+        ImGui::NextColumn();
+    }
+
     ImGui::Columns(1);
 }